@@ -44,8 +44,13 @@
 #include <stdlib.h>
 #include <string.h>
 
-/*	error reporting	*/
-const char *result_string_pointer = "SOIL initialized";
+/*	error reporting, kept per thread since Dolphin loads images on several threads	*/
+#ifdef _MSC_VER
+#define SOIL_THREAD_LOCAL __declspec(thread)
+#else
+#define SOIL_THREAD_LOCAL __thread
+#endif
+static SOIL_THREAD_LOCAL const char *result_string_pointer = "SOIL initialized";
 
 /*	for loading cube maps	*/
 enum{
@@ -0,0 +1,168 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+// An open-addressing hash table mapping u32 keys to an unordered list of values.
+//
+// All keys live inline in a single power-of-two sized array and are probed linearly, so a
+// lookup touches a handful of adjacent slots instead of chasing tree nodes. A key is removed
+// as soon as its value list becomes empty; removal uses backward-shift deletion, so the
+// table never accumulates tombstones.
+//
+// Slots are moved around on insertion and removal, so pointers returned by Find() are only
+// valid until the table is modified.
+template <typename T>
+class FlatMultiMap
+{
+public:
+  using ValueList = std::vector<T>;
+
+  FlatMultiMap() { Clear(); }
+
+  // Returns the values stored under key, or nullptr if there are none.
+  const ValueList* Find(u32 key) const
+  {
+    const size_t index = FindSlot(key);
+    return m_slots[index].used ? &m_slots[index].values : nullptr;
+  }
+
+  void Insert(u32 key, T value)
+  {
+    if ((m_size + 1) * 2 > m_slots.size())
+      Rehash(m_slots.size() * 2);
+
+    Slot& slot = m_slots[FindSlot(key)];
+    if (!slot.used)
+    {
+      slot.used = true;
+      slot.key = key;
+      m_size++;
+    }
+    slot.values.push_back(std::move(value));
+  }
+
+  // Removes a single occurrence of value from the list of key.
+  // Returns false if it was not present.
+  bool Erase(u32 key, const T& value)
+  {
+    const size_t index = FindSlot(key);
+    Slot& slot = m_slots[index];
+    if (!slot.used)
+      return false;
+
+    auto it = std::find(slot.values.begin(), slot.values.end(), value);
+    if (it == slot.values.end())
+      return false;
+
+    *it = std::move(slot.values.back());
+    slot.values.pop_back();
+    if (slot.values.empty())
+      EraseSlot(index);
+    return true;
+  }
+
+  // Removes every value of the given key.
+  void EraseKey(u32 key)
+  {
+    const size_t index = FindSlot(key);
+    if (m_slots[index].used)
+      EraseSlot(index);
+  }
+
+  void Clear()
+  {
+    m_slots.clear();
+    m_slots.resize(INITIAL_CAPACITY);
+    m_size = 0;
+  }
+
+  // Number of keys with at least one value.
+  size_t Size() const { return m_size; }
+  bool Empty() const { return m_size == 0; }
+
+  // Calls f(key, values) for every key in unspecified order.
+  // The table must not be modified from within f.
+  template <typename F>
+  void ForEach(F f) const
+  {
+    for (const Slot& slot : m_slots)
+    {
+      if (slot.used)
+        f(slot.key, slot.values);
+    }
+  }
+
+private:
+  static constexpr size_t INITIAL_CAPACITY = 16;
+
+  struct Slot
+  {
+    u32 key = 0;
+    bool used = false;
+    ValueList values;
+  };
+
+  size_t Mask() const { return m_slots.size() - 1; }
+
+  // Fibonacci hashing; spreads the low-entropy, aligned addresses this is typically keyed by.
+  size_t HomeIndex(u32 key) const
+  {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & Mask();
+  }
+
+  // Returns the slot holding key, or the empty slot where it would be inserted.
+  size_t FindSlot(u32 key) const
+  {
+    size_t index = HomeIndex(key);
+    while (m_slots[index].used && m_slots[index].key != key)
+      index = (index + 1) & Mask();
+    return index;
+  }
+
+  void EraseSlot(size_t index)
+  {
+    m_slots[index].used = false;
+    m_slots[index].values.clear();
+    m_size--;
+
+    // Shift back any following entries that would no longer be reachable from their home slot.
+    size_t hole = index;
+    size_t next = (index + 1) & Mask();
+    while (m_slots[next].used)
+    {
+      const size_t home = HomeIndex(m_slots[next].key);
+      if (((next - home) & Mask()) >= ((next - hole) & Mask()))
+      {
+        std::swap(m_slots[hole], m_slots[next]);
+        hole = next;
+      }
+      next = (next + 1) & Mask();
+    }
+  }
+
+  void Rehash(size_t capacity)
+  {
+    std::vector<Slot> old_slots(capacity);
+    std::swap(m_slots, old_slots);
+    for (Slot& slot : old_slots)
+    {
+      if (slot.used)
+        m_slots[FindSlot(slot.key)] = std::move(slot);
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  size_t m_size = 0;
+};
+}  // namespace Common
@@ -0,0 +1,98 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "Common/Thread.h"
+
+namespace Common
+{
+ThreadPool::ThreadPool(u32 num_threads, std::string name) : m_name(std::move(name))
+{
+  if (num_threads == 0)
+    num_threads = GetDefaultThreadCount();
+
+  m_threads.reserve(num_threads);
+  for (u32 i = 0; i < num_threads; ++i)
+    m_threads.emplace_back([this] { ThreadLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_shutdown = true;
+  }
+  m_wakeup.notify_all();
+
+  for (std::thread& thread : m_threads)
+    thread.join();
+}
+
+std::future<void> ThreadPool::Schedule(std::function<void()> task)
+{
+  std::packaged_task<void()> packaged_task(std::move(task));
+  std::future<void> future = packaged_task.get_future();
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_tasks.push(std::move(packaged_task));
+  }
+  m_wakeup.notify_one();
+  return future;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& function)
+{
+  if (count == 0)
+    return;
+
+  // Every participant grabs the next unprocessed index until none are left, so uneven work
+  // items balance out on their own.
+  std::atomic<size_t> next_index{0};
+  auto worker = [&] {
+    for (size_t i = next_index++; i < count; i = next_index++)
+      function(i);
+  };
+
+  const size_t num_helpers = std::min<size_t>(m_threads.size(), count - 1);
+  std::vector<std::future<void>> helpers;
+  helpers.reserve(num_helpers);
+  for (size_t i = 0; i < num_helpers; ++i)
+    helpers.push_back(Schedule(worker));
+
+  worker();
+
+  for (std::future<void>& helper : helpers)
+    helper.get();
+}
+
+u32 ThreadPool::GetDefaultThreadCount()
+{
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void ThreadPool::ThreadLoop()
+{
+  SetCurrentThreadName(m_name.c_str());
+
+  while (true)
+  {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lk(m_lock);
+      m_wakeup.wait(lk, [this] { return m_shutdown || !m_tasks.empty(); });
+      if (m_tasks.empty())
+        return;
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+    task();
+  }
+}
+}  // namespace Common
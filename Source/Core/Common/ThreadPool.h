@@ -0,0 +1,56 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// A fixed set of worker threads executing tasks from a shared queue.
+
+namespace Common
+{
+class ThreadPool final
+{
+public:
+  // A thread count of 0 uses one thread per logical CPU core.
+  explicit ThreadPool(u32 num_threads = 0, std::string name = "Worker thread");
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  u32 GetThreadCount() const { return static_cast<u32>(m_threads.size()); }
+
+  // Queues a task. The returned future becomes ready once the task has run.
+  std::future<void> Schedule(std::function<void()> task);
+
+  // Runs function(i) for every i in [0, count) on the pool and waits for all of them.
+  // The calling thread helps out, so this also makes progress while the pool is busy with
+  // other tasks. Must not be called from within a task of the same pool.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& function);
+
+  // The number of logical CPU cores, which is at least 1.
+  static u32 GetDefaultThreadCount();
+
+private:
+  void ThreadLoop();
+
+  std::vector<std::thread> m_threads;
+  std::queue<std::packaged_task<void()>> m_tasks;
+  std::mutex m_lock;
+  std::condition_variable m_wakeup;
+  std::string m_name;
+  bool m_shutdown = false;
+};
+}  // namespace Common
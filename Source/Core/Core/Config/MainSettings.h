@@ -15,6 +15,7 @@ namespace Config
 extern const ConfigInfo<bool> MAIN_SKIP_IPL;
 extern const ConfigInfo<int> MAIN_CPU_CORE;
 extern const ConfigInfo<bool> MAIN_FASTMEM;
+extern const ConfigInfo<bool> MAIN_JIT_DISK_CACHE;
 // Should really be in the DSP section, but we're kind of stuck with bad decisions made in the past.
 extern const ConfigInfo<bool> MAIN_DSP_HLE;
 extern const ConfigInfo<int> MAIN_TIMING_VARIANCE;
@@ -22,6 +23,12 @@ extern const ConfigInfo<bool> MAIN_CPU_THREAD;
 extern const ConfigInfo<bool> MAIN_SYNC_ON_SKIP_IDLE;
 extern const ConfigInfo<std::string> MAIN_DEFAULT_ISO;
 extern const ConfigInfo<bool> MAIN_ENABLE_CHEATS;
+extern const ConfigInfo<bool> MAIN_DELTA_SAVE_STATES;
+extern const ConfigInfo<bool> MAIN_ASYNC_SAVE_STATES;
+extern const ConfigInfo<int> MAIN_DISC_READAHEAD;
+extern const ConfigInfo<bool> MAIN_REWIND;
+extern const ConfigInfo<int> MAIN_REWIND_INTERVAL;
+extern const ConfigInfo<int> MAIN_REWIND_MEMORY_BUDGET;
 extern const ConfigInfo<int> MAIN_GC_LANGUAGE;
 extern const ConfigInfo<bool> MAIN_OVERRIDE_GC_LANGUAGE;
 extern const ConfigInfo<bool> MAIN_DPL2_DECODER;
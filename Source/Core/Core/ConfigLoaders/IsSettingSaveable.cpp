@@ -31,18 +31,23 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_CROP.location, Config::GFX_SAFE_TEXTURE_CACHE_COLOR_SAMPLES.location,
       Config::GFX_SHOW_FPS.location, Config::GFX_SHOW_NETPLAY_PING.location,
       Config::GFX_SHOW_NETPLAY_MESSAGES.location, Config::GFX_LOG_RENDER_TIME_TO_FILE.location,
+      Config::GFX_LOG_VIDEO_PROFILE_TO_FILE.location,
       Config::GFX_OVERLAY_STATS.location, Config::GFX_OVERLAY_PROJ_STATS.location,
       Config::GFX_DUMP_TEXTURES.location, Config::GFX_HIRES_TEXTURES.location,
-      Config::GFX_CACHE_HIRES_TEXTURES.location, Config::GFX_DUMP_EFB_TARGET.location,
+      Config::GFX_CACHE_HIRES_TEXTURES.location,
+      Config::GFX_HIRES_TEXTURES_MEMORY_BUDGET.location,
+      Config::GFX_CACHE_DECODED_TEXTURES.location, Config::GFX_DUMP_EFB_TARGET.location,
       Config::GFX_DUMP_FRAMES_AS_IMAGES.location, Config::GFX_FREE_LOOK.location,
       Config::GFX_USE_FFV1.location, Config::GFX_DUMP_FORMAT.location,
       Config::GFX_DUMP_CODEC.location, Config::GFX_DUMP_ENCODER.location,
       Config::GFX_DUMP_PATH.location, Config::GFX_BITRATE_KBPS.location,
       Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS.location,
-      Config::GFX_ENABLE_GPU_TEXTURE_DECODING.location, Config::GFX_ENABLE_PIXEL_LIGHTING.location,
-      Config::GFX_FAST_DEPTH_CALC.location, Config::GFX_MSAA.location, Config::GFX_SSAA.location,
-      Config::GFX_EFB_SCALE.location, Config::GFX_TEXFMT_OVERLAY_ENABLE.location,
-      Config::GFX_TEXFMT_OVERLAY_CENTER.location, Config::GFX_ENABLE_WIREFRAME.location,
+      Config::GFX_ENABLE_GPU_TEXTURE_DECODING.location,
+      Config::GFX_TEXTURE_DECODING_THREADS.location, Config::GFX_ENABLE_PIXEL_LIGHTING.location,
+      Config::GFX_FAST_DEPTH_CALC.location, Config::GFX_USE_32BIT_INDICES.location,
+      Config::GFX_MSAA.location, Config::GFX_SSAA.location, Config::GFX_EFB_SCALE.location,
+      Config::GFX_TEXFMT_OVERLAY_ENABLE.location, Config::GFX_TEXFMT_OVERLAY_CENTER.location,
+      Config::GFX_ENABLE_WIREFRAME.location,
       Config::GFX_DISABLE_FOG.location, Config::GFX_BORDERLESS_FULLSCREEN.location,
       Config::GFX_ENABLE_VALIDATION_LAYER.location, Config::GFX_BACKEND_MULTITHREADING.location,
       Config::GFX_COMMAND_BUFFER_EXECUTE_INTERVAL.location, Config::GFX_SHADER_CACHE.location,
@@ -54,7 +59,8 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_SW_ZCOMPLOC.location, Config::GFX_SW_ZFREEZE.location,
       Config::GFX_SW_DUMP_OBJECTS.location, Config::GFX_SW_DUMP_TEV_STAGES.location,
       Config::GFX_SW_DUMP_TEV_TEX_FETCHES.location, Config::GFX_SW_DRAW_START.location,
-      Config::GFX_SW_DRAW_END.location,
+      Config::GFX_SW_DRAW_END.location, Config::GFX_SW_RASTERIZER_THREADS.location,
+      Config::GFX_SW_DRAW_QUADS.location,
 
       // Graphics.Enhancements
 
@@ -238,6 +238,7 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("TimingVariance", iTimingVariance);
   core->Set("CPUCore", iCPUCore);
   core->Set("Fastmem", bFastmem);
+  core->Set("JITDiskCache", bJITDiskCache);
   core->Set("CPUThread", bCPUThread);
   core->Set("DSPHLE", bDSPHLE);
   core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
@@ -249,6 +250,12 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("AccurateNaNs", bAccurateNaNs);
   core->Set("DefaultISO", m_strDefaultISO);
   core->Set("EnableCheats", bEnableCheats);
+  core->Set("DeltaSaveStates", bDeltaSaveStates);
+  core->Set("AsyncSaveStates", bAsyncSaveStates);
+  core->Set("DiscReadahead", iDiscReadahead);
+  core->Set("Rewind", bRewind);
+  core->Set("RewindInterval", iRewindInterval);
+  core->Set("RewindMemoryBudget", iRewindMemoryBudget);
   core->Set("SelectedLanguage", SelectedLanguage);
   core->Set("OverrideGCLang", bOverrideGCLanguage);
   core->Set("DPL2Decoder", bDPL2Decoder);
@@ -524,12 +531,19 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
   core->Get("Fastmem", &bFastmem, true);
+  core->Get("JITDiskCache", &bJITDiskCache, false);
   core->Get("DSPHLE", &bDSPHLE, true);
   core->Get("TimingVariance", &iTimingVariance, 40);
   core->Get("CPUThread", &bCPUThread, true);
   core->Get("SyncOnSkipIdle", &bSyncGPUOnSkipIdleHack, true);
   core->Get("DefaultISO", &m_strDefaultISO);
   core->Get("EnableCheats", &bEnableCheats, false);
+  core->Get("DeltaSaveStates", &bDeltaSaveStates, false);
+  core->Get("AsyncSaveStates", &bAsyncSaveStates, false);
+  core->Get("DiscReadahead", &iDiscReadahead, 4);
+  core->Get("Rewind", &bRewind, false);
+  core->Get("RewindInterval", &iRewindInterval, 60);
+  core->Get("RewindMemoryBudget", &iRewindMemoryBudget, 512);
   core->Get("SelectedLanguage", &SelectedLanguage, 0);
   core->Get("OverrideGCLang", &bOverrideGCLanguage, false);
   core->Get("DPL2Decoder", &bDPL2Decoder, false);
@@ -90,6 +90,7 @@ struct SConfig
   bool bJITPairedOff = false;
   bool bJITSystemRegistersOff = false;
   bool bJITBranchOff = false;
+  bool bJITDiskCache = false;
 
   bool bFastmem;
   bool bFPRF = false;
@@ -102,6 +103,12 @@ struct SConfig
   bool bSyncGPUOnSkipIdleHack = true;
   bool bHLE_BS2 = true;
   bool bEnableCheats = false;
+  bool bDeltaSaveStates = false;
+  bool bAsyncSaveStates = false;
+  int iDiscReadahead = 4;
+  bool bRewind = false;
+  int iRewindInterval = 60;
+  int iRewindMemoryBudget = 512;
   bool bEnableMemcardSdWriting = true;
   bool bCopyWiiSaveNetplay = true;
 
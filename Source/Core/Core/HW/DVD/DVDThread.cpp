@@ -18,6 +18,7 @@
 #include "Common/Event.h"
 #include "Common/Flag.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/SPSCQueue.h"
 #include "Common/Thread.h"
@@ -32,6 +33,7 @@
 #include "Core/HW/SystemTimers.h"
 #include "Core/IOS/ES/Formats.h"
 
+#include "DiscIO/Blob.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Volume.h"
 
@@ -102,6 +104,10 @@ void Start()
   // much, because this will never get exposed to the emulated game.
   s_next_id = 0;
 
+  // Configured in MiB
+  const int readahead = MathUtil::Clamp(SConfig::GetInstance().iDiscReadahead, 0, 1024);
+  DiscIO::SetReadaheadSize(static_cast<u32>(readahead) * 1024 * 1024);
+
   StartDVDThread();
 }
 
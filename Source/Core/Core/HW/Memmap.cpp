@@ -10,13 +10,18 @@
 #include "Core/HW/Memmap.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Swap.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
@@ -113,6 +118,7 @@ struct LogicalMemoryView
 {
   void* mapped_pointer;
   u32 mapped_size;
+  u32 physical_address;
 };
 
 // Dolphin allocates memory to represent four regions:
@@ -222,6 +228,8 @@ void Init()
   m_IsInitialized = true;
 }
 
+static void ProtectLogicalView(const LogicalMemoryView& view);
+
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
   for (auto& entry : logical_mapped_entries)
@@ -256,30 +264,457 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
             PanicAlert("MemoryMap_Setup: Failed finding a memory base.");
             exit(0);
           }
-          logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+          logical_mapped_entries.push_back({mapped_pointer, mapped_size, intersection_start});
+          ProtectLogicalView(logical_mapped_entries.back());
         }
       }
     }
   }
 }
 
+// Delta states and snapshots find out about writes to RAM and EXRAM by write-protecting the
+// pages they are interested in. Writes from the JIT, the interpreter or emulated hardware then
+// fault, and the fault handler takes care of the page before lifting the protection and retrying
+// the write. Writes by the OS (e.g. read() into emulated memory) don't fault but fail instead,
+// which is why code doing that has to call PrepareForHostWrite first.
+//
+// Only the CPU thread accesses memory through the logical views, and UpdateLogicalMemory changes
+// them, so other threads only lift the protection of the physical view. The CPU thread lifts the
+// protection of the logical views when it faults on them.
+static const u32 PROTECTED_PAGE_SIZE = 0x1000;
+
+struct ProtectedRegion
+{
+  u8** data;
+  u32 physical_address;
+  u32 size;
+};
+
+static const ProtectedRegion s_protected_regions[] = {
+    {&m_pRAM, 0x00000000, RAM_SIZE},
+    {&m_pEXRAM, 0x10000000, EXRAM_SIZE},
+};
+
+struct DeltaRegion
+{
+  // Whether each page was written to since the base state was captured
+  std::unique_ptr<std::atomic<bool>[]> dirty;
+  // The pages which a delta state being saved contains, as of measuring it
+  std::vector<u32> changed_pages;
+};
+
+static DeltaRegion s_delta_regions[ArraySize(s_protected_regions)];
+static std::atomic<bool> s_tracking_writes{false};
+static bool s_delta_states_enabled = false;
+
+// Each page of a snapshot is copied to the savestate buffer by whichever thread gets to it first:
+// a thread about to write to it, through the fault handler, or the thread calling
+// CompleteSnapshot.
+enum : u8
+{
+  SNAPSHOT_PAGE_PENDING,
+  SNAPSHOT_PAGE_COPYING,
+  SNAPSHOT_PAGE_DONE,
+};
+
+struct SnapshotRegion
+{
+  u8* destination;
+  std::unique_ptr<std::atomic<u8>[]> page_states;
+  std::atomic<bool> active{false};
+};
+
+static SnapshotRegion s_snapshot_regions[ArraySize(s_protected_regions)];
+static std::atomic<bool> s_snapshot_pending{false};
+static std::mutex s_snapshot_lock;
+static bool s_snapshot_enabled = false;
+
+static bool IsPageProtected(size_t index, u32 page)
+{
+  const SnapshotRegion& snapshot = s_snapshot_regions[index];
+  return (s_tracking_writes && !s_delta_regions[index].dirty[page].load()) ||
+         (snapshot.active && snapshot.page_states[page].load() != SNAPSHOT_PAGE_DONE);
+}
+
+// Calls func(pointer, size) for a range of a region in its physical view, and if requested in
+// every logical view, which only the CPU thread may do.
+template <typename Func>
+static void ForEachView(size_t index, u32 offset, u32 size, bool logical_views, Func func)
+{
+  const ProtectedRegion& region = s_protected_regions[index];
+  func(*region.data + offset, size);
+  if (!logical_views)
+    return;
+
+  const u32 start = region.physical_address + offset;
+  const u32 end = start + size;
+  for (const LogicalMemoryView& view : logical_mapped_entries)
+  {
+    const u32 intersection_start = std::max(start, view.physical_address);
+    const u32 intersection_end = std::min(end, view.physical_address + view.mapped_size);
+    if (intersection_start < intersection_end)
+    {
+      func(static_cast<u8*>(view.mapped_pointer) + (intersection_start - view.physical_address),
+           intersection_end - intersection_start);
+    }
+  }
+}
+
+static void ProtectRegion(size_t index)
+{
+  ForEachView(index, 0, s_protected_regions[index].size, true,
+              [](u8* pointer, u32 size) { Common::WriteProtectMemory(pointer, size); });
+}
+
+static void UnprotectRegion(size_t index)
+{
+  ForEachView(index, 0, s_protected_regions[index].size, true,
+              [](u8* pointer, u32 size) { Common::UnWriteProtectMemory(pointer, size); });
+}
+
+// Lifts the protection of a page unless delta states or a snapshot still need to know about
+// writes to it.
+static void ReleasePage(size_t index, u32 page, bool logical_views)
+{
+  if (IsPageProtected(index, page))
+    return;
+
+  ForEachView(index, page * PROTECTED_PAGE_SIZE, PROTECTED_PAGE_SIZE, logical_views,
+              [](u8* pointer, u32 size) { Common::UnWriteProtectMemory(pointer, size); });
+}
+
+static void ProtectLogicalView(const LogicalMemoryView& view)
+{
+  if (!s_tracking_writes && !s_snapshot_pending)
+    return;
+
+  for (size_t index = 0; index < ArraySize(s_protected_regions); ++index)
+  {
+    const ProtectedRegion& region = s_protected_regions[index];
+    const u32 start = std::max(view.physical_address, region.physical_address);
+    const u32 end =
+        std::min(view.physical_address + view.mapped_size, region.physical_address + region.size);
+    u8* const pointer = static_cast<u8*>(view.mapped_pointer) - view.physical_address;
+
+    // Protect runs of pages at once
+    u32 run_start = end;
+    for (u32 address = start; address < end; address += PROTECTED_PAGE_SIZE)
+    {
+      const bool is_protected =
+          IsPageProtected(index, (address - region.physical_address) / PROTECTED_PAGE_SIZE);
+      if (is_protected && run_start == end)
+      {
+        run_start = address;
+      }
+      else if (!is_protected && run_start != end)
+      {
+        Common::WriteProtectMemory(pointer + run_start, address - run_start);
+        run_start = end;
+      }
+    }
+    if (run_start != end)
+      Common::WriteProtectMemory(pointer + run_start, end - run_start);
+  }
+}
+
+// Returns without waiting if another thread is already copying the page. The fault handler then
+// retries the write, which faults again until that thread is done.
+static void CopySnapshotPage(size_t index, u32 page, bool logical_views)
+{
+  SnapshotRegion& region = s_snapshot_regions[index];
+  u8 expected = SNAPSHOT_PAGE_PENDING;
+  if (!region.page_states[page].compare_exchange_strong(expected, SNAPSHOT_PAGE_COPYING))
+    return;
+
+  const u32 offset = page * PROTECTED_PAGE_SIZE;
+  std::memcpy(region.destination + offset, *s_protected_regions[index].data + offset,
+              PROTECTED_PAGE_SIZE);
+  region.page_states[page].store(SNAPSHOT_PAGE_DONE);
+  ReleasePage(index, page, logical_views);
+}
+
+// Outside of the fault handler, a page copied by another thread has to be waited for.
+static void CopySnapshotPageAndWait(size_t index, u32 page)
+{
+  CopySnapshotPage(index, page, false);
+  while (s_snapshot_regions[index].page_states[page].load() != SNAPSHOT_PAGE_DONE)
+    std::this_thread::yield();
+}
+
+static void BeginSnapshotRegion(PointerWrap& p, size_t index)
+{
+  SnapshotRegion& region = s_snapshot_regions[index];
+  const u32 size = s_protected_regions[index].size;
+  const u32 num_pages = size / PROTECTED_PAGE_SIZE;
+  if (!region.page_states)
+    region.page_states.reset(new std::atomic<u8>[num_pages]);
+  for (u32 i = 0; i < num_pages; ++i)
+    region.page_states[i].store(SNAPSHOT_PAGE_PENDING);
+
+  region.destination = *p.ptr;
+  region.active = true;
+  *p.ptr += size;
+
+  ProtectRegion(index);
+}
+
+static void DoDeltaRegion(PointerWrap& p, size_t index)
+{
+  DeltaRegion& region = s_delta_regions[index];
+  u8* const data = *s_protected_regions[index].data;
+  const u32 num_pages = s_protected_regions[index].size / PROTECTED_PAGE_SIZE;
+
+  // The changed pages are only collected while measuring, so that writing afterwards
+  // produces exactly the measured amount of data.
+  if (p.GetMode() == PointerWrap::MODE_MEASURE)
+  {
+    region.changed_pages.clear();
+    for (u32 i = 0; s_tracking_writes && i < num_pages; ++i)
+    {
+      if (region.dirty[i].load())
+        region.changed_pages.push_back(i);
+    }
+  }
+
+  p.Do(region.changed_pages);
+  for (u32 page : region.changed_pages)
+  {
+    if (page >= num_pages)
+    {
+      p.SetMode(PointerWrap::MODE_MEASURE);
+      return;
+    }
+
+    if (p.GetMode() == PointerWrap::MODE_READ && s_tracking_writes)
+    {
+      region.dirty[page] = true;
+      ReleasePage(index, page, true);
+    }
+    p.DoArray(data + page * PROTECTED_PAGE_SIZE, PROTECTED_PAGE_SIZE);
+  }
+}
+
+bool CanTrackWrites()
+{
+// The fault handler has to catch writes from every thread, which the Mach exception handler
+// doesn't do. It is also only installed along with fastmem.
+#if defined(_M_GENERIC) || (defined(__APPLE__) && !defined(USE_SIGACTION_ON_APPLE))
+  return false;
+#else
+  return SConfig::GetInstance().bFastmem;
+#endif
+}
+
+void CaptureDeltaBase()
+{
+  if (!CanTrackWrites())
+    return;
+
+  for (size_t index = 0; index < ArraySize(s_protected_regions); ++index)
+  {
+    const ProtectedRegion& region = s_protected_regions[index];
+    if (!*region.data)
+      continue;
+
+    const u32 num_pages = region.size / PROTECTED_PAGE_SIZE;
+    std::unique_ptr<std::atomic<bool>[]>& dirty = s_delta_regions[index].dirty;
+    if (!dirty)
+      dirty.reset(new std::atomic<bool>[num_pages]);
+    for (u32 i = 0; i < num_pages; ++i)
+      dirty[i].store(false);
+  }
+
+  s_tracking_writes = true;
+  for (size_t index = 0; index < ArraySize(s_protected_regions); ++index)
+  {
+    if (*s_protected_regions[index].data)
+      ProtectRegion(index);
+  }
+}
+
+void ClearDeltaBase()
+{
+  if (!s_tracking_writes)
+    return;
+
+  // Pages which a snapshot still needs would lose their protection as well.
+  CompleteSnapshot();
+
+  s_tracking_writes = false;
+  for (size_t index = 0; index < ArraySize(s_protected_regions); ++index)
+  {
+    if (*s_protected_regions[index].data)
+      UnprotectRegion(index);
+  }
+}
+
+void SetDeltaStatesEnabled(bool enabled)
+{
+  s_delta_states_enabled = enabled;
+}
+
+// Returns the physical address a pointer into RAM or EXRAM refers to, in any view.
+static bool GetPhysicalAddressOfView(uintptr_t address, u32* physical_address, bool* logical_view)
+{
+  const uintptr_t ram = reinterpret_cast<uintptr_t>(m_pRAM);
+  const uintptr_t exram = reinterpret_cast<uintptr_t>(m_pEXRAM);
+  *logical_view = false;
+  if (m_pRAM && address >= ram && address < ram + RAM_SIZE)
+  {
+    *physical_address = static_cast<u32>(address - ram);
+    return true;
+  }
+  if (m_pEXRAM && address >= exram && address < exram + EXRAM_SIZE)
+  {
+    *physical_address = 0x10000000 + static_cast<u32>(address - exram);
+    return true;
+  }
+
+  *logical_view = true;
+  for (const LogicalMemoryView& view : logical_mapped_entries)
+  {
+    const uintptr_t view_start = reinterpret_cast<uintptr_t>(view.mapped_pointer);
+    if (address >= view_start && address < view_start + view.mapped_size)
+    {
+      *physical_address = view.physical_address + static_cast<u32>(address - view_start);
+      return *physical_address < RAM_SIZE ||
+             (*physical_address >= 0x10000000 && *physical_address < 0x10000000 + EXRAM_SIZE);
+    }
+  }
+
+  return false;
+}
+
+bool CanSnapshotAsynchronously()
+{
+  // Every place where the OS writes to emulated memory has to call PrepareForHostWrite first.
+  // Asynchronous savestates are off by default in case one was missed.
+  return CanTrackWrites();
+}
+
+void SetSnapshotEnabled(bool enabled)
+{
+  s_snapshot_enabled = enabled;
+}
+
+void CompleteSnapshot()
+{
+  if (!s_snapshot_pending)
+    return;
+
+  std::lock_guard<std::mutex> lk(s_snapshot_lock);
+  if (!s_snapshot_pending)
+    return;
+
+  for (size_t index = 0; index < ArraySize(s_snapshot_regions); ++index)
+  {
+    SnapshotRegion& region = s_snapshot_regions[index];
+    if (!region.active)
+      continue;
+
+    for (u32 page = 0; page < s_protected_regions[index].size / PROTECTED_PAGE_SIZE; ++page)
+      CopySnapshotPageAndWait(index, page);
+    region.active = false;
+  }
+  s_snapshot_pending = false;
+}
+
+void PrepareForHostWrite(u32 address, u32 size)
+{
+  if (!s_tracking_writes && !s_snapshot_pending)
+    return;
+
+  address &= 0x3FFFFFFF;
+  for (size_t index = 0; index < ArraySize(s_protected_regions); ++index)
+  {
+    const ProtectedRegion& region = s_protected_regions[index];
+    const u64 start = std::max<u64>(address, region.physical_address);
+    const u64 end = std::min<u64>(u64{address} + size, region.physical_address + region.size);
+    if (!*region.data || start >= end)
+      continue;
+
+    const u32 first_page = static_cast<u32>(start - region.physical_address) / PROTECTED_PAGE_SIZE;
+    const u32 last_page = static_cast<u32>(end - 1 - region.physical_address) / PROTECTED_PAGE_SIZE;
+    SnapshotRegion& snapshot = s_snapshot_regions[index];
+    for (u32 page = first_page; page <= last_page; ++page)
+    {
+      if (snapshot.active && snapshot.page_states[page].load() != SNAPSHOT_PAGE_DONE)
+        CopySnapshotPageAndWait(index, page);
+      if (s_tracking_writes)
+        s_delta_regions[index].dirty[page] = true;
+      ReleasePage(index, page, false);
+    }
+  }
+}
+
+bool HandleWriteFault(uintptr_t address)
+{
+  u32 physical_address;
+  bool logical_view;
+  if (!GetPhysicalAddressOfView(address, &physical_address, &logical_view))
+    return false;
+
+  for (size_t index = 0; index < ArraySize(s_protected_regions); ++index)
+  {
+    const ProtectedRegion& region = s_protected_regions[index];
+    if (physical_address < region.physical_address ||
+        physical_address >= region.physical_address + region.size)
+    {
+      continue;
+    }
+
+    // Pages of RAM and EXRAM are only ever protected for delta states or snapshots, so the write
+    // can be retried once whatever they need is done. If another thread got to the page first,
+    // the protection of this view may still have to be lifted.
+    const u32 page = (physical_address - region.physical_address) / PROTECTED_PAGE_SIZE;
+    SnapshotRegion& snapshot = s_snapshot_regions[index];
+    if (snapshot.active && snapshot.page_states[page].load() != SNAPSHOT_PAGE_DONE)
+      CopySnapshotPage(index, page, logical_view);
+    if (s_tracking_writes)
+      s_delta_regions[index].dirty[page] = true;
+    ReleasePage(index, page, logical_view);
+    return true;
+  }
+
+  return false;
+}
+
 void DoState(PointerWrap& p)
 {
   bool wii = SConfig::GetInstance().bWii;
-  p.DoArray(m_pRAM, RAM_SIZE);
+  const bool snapshot = s_snapshot_enabled && p.GetMode() == PointerWrap::MODE_WRITE;
+  if (s_delta_states_enabled)
+    DoDeltaRegion(p, 0);
+  else if (snapshot)
+    BeginSnapshotRegion(p, 0);
+  else
+    p.DoArray(m_pRAM, RAM_SIZE);
   p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
   p.DoMarker("Memory RAM");
   if (m_pFakeVMEM)
     p.DoArray(m_pFakeVMEM, FAKEVMEM_SIZE);
   p.DoMarker("Memory FakeVMEM");
-  if (wii)
+  if (wii && s_delta_states_enabled)
+    DoDeltaRegion(p, 1);
+  else if (wii && snapshot)
+    BeginSnapshotRegion(p, 1);
+  else if (wii)
     p.DoArray(m_pEXRAM, EXRAM_SIZE);
   p.DoMarker("Memory EXRAM");
+
+  if (snapshot && !s_delta_states_enabled)
+    s_snapshot_pending = true;
 }
 
 void Shutdown()
 {
   m_IsInitialized = false;
+  CompleteSnapshot();
+  ClearDeltaBase();
+  for (DeltaRegion& region : s_delta_regions)
+    region = {};
+  for (SnapshotRegion& region : s_snapshot_regions)
+    region.page_states.reset();
   u32 flags = 0;
   if (SConfig::GetInstance().bWii)
     flags |= PhysicalMemoryRegion::WII_ONLY;
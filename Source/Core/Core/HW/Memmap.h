@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -64,6 +65,30 @@ void Init();
 void Shutdown();
 void DoState(PointerWrap& p);
 
+// Delta savestates only contain the pages of RAM and EXRAM which were written to since a base
+// state. CaptureDeltaBase has to be called right after the base state has been saved or loaded,
+// and write-protects RAM and EXRAM to find out which pages get written to until ClearDeltaBase
+// is called. While delta states are enabled, DoState only handles the changed pages.
+bool CanTrackWrites();
+void CaptureDeltaBase();
+void ClearDeltaBase();
+void SetDeltaStatesEnabled(bool enabled);
+
+// While snapshots are enabled, DoState only reserves space for RAM and EXRAM when writing and
+// write-protects them, so that emulation can continue right away. Pages get copied over as soon
+// as anything writes to them. CompleteSnapshot copies the rest and has to be called before the
+// savestate buffer is used.
+bool CanSnapshotAsynchronously();
+void SetSnapshotEnabled(bool enabled);
+void CompleteSnapshot();
+
+// Has to be called before the OS writes to emulated memory on behalf of the emulator, e.g. when
+// reading a file straight into it, since the OS fails instead of faulting on protected pages.
+void PrepareForHostWrite(u32 address, u32 size);
+// Called by the fault handler. Returns true if the access should be retried, which is the case
+// for writes to pages which delta states or a snapshot have write-protected.
+bool HandleWriteFault(uintptr_t address);
+
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
 
 void Clear();
@@ -221,6 +221,7 @@ IPCCommandResult FileIO::Read(const ReadWriteRequest& request)
   DEBUG_LOG(IOS_FILEIO, "Read 0x%x bytes to 0x%08x from %s", request.size, request.buffer,
             m_name.c_str());
   m_file->Seek(m_SeekPos, SEEK_SET);  // File might be opened twice, need to seek before we read
+  Memory::PrepareForHostWrite(request.buffer, requested_read_length);
   const u32 number_of_bytes_read = static_cast<u32>(
       fread(Memory::GetPointer(request.buffer), 1, requested_read_length, m_file->GetHandle()));
 
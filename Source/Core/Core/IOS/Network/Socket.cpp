@@ -19,6 +19,7 @@
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/IOS/Device.h"
 #include "Core/IOS/IOS.h"
 
@@ -529,6 +530,7 @@ void WiiSocket::Update(bool read, bool write, bool except)
           // Not a string, Windows requires a char* for recvfrom
           char* data = (char*)Memory::GetPointer(BufferOut);
           int data_len = BufferOutSize;
+          Memory::PrepareForHostWrite(BufferOut, BufferOutSize);
 
           sockaddr_in local_name;
           memset(&local_name, 0, sizeof(sockaddr_in));
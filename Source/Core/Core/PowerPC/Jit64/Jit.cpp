@@ -273,6 +273,7 @@ void Jit64::Shutdown()
   FreeStack();
   FreeCodeSpace();
 
+  m_disk_cache.Close();
   blocks.Shutdown();
   m_far_code.Shutdown();
   m_const_pool.Shutdown();
@@ -632,6 +633,41 @@ void Jit64::Jit(u32 em_address)
   JitBlock* b = blocks.AllocateBlock(em_address);
   DoJit(em_address, &code_buffer, b, nextPC);
   blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+
+  if (SConfig::GetInstance().bJITDiskCache && !SConfig::GetInstance().bEnableDebugging)
+  {
+    m_disk_cache.Open(SConfig::GetInstance().GetGameID());
+
+    // Reaching a block from a previous session means the code it belongs to has been loaded,
+    // so compile the other blocks from that session on the same pages as well.
+    const bool was_pending = m_disk_cache.IsPending(em_address, b->msrBits);
+    m_disk_cache.RecordBlock(*b);
+    if (was_pending)
+      PrecompileCachedBlocks(b->physical_addresses);
+  }
+}
+
+void Jit64::PrecompileCachedBlocks(const std::set<u32>& physical_addresses)
+{
+  const u32 msr_bits = MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+  for (u32 address : m_disk_cache.GetValidEntryPoints(physical_addresses, msr_bits))
+  {
+    // Whatever doesn't fit anymore stays pending.
+    if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull())
+      break;
+
+    if (blocks.GetBlockFromStartAddress(address, MSR))
+      continue;
+
+    const u32 nextPC = analyzer.Analyze(address, &code_block, &code_buffer, code_buffer.GetSize());
+    if (code_block.m_memory_exception)
+      continue;
+
+    JitBlock* b = blocks.AllocateBlock(address);
+    DoJit(address, &code_buffer, b, nextPC);
+    blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+    m_disk_cache.RecordBlock(*b);
+  }
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBlock* b, u32 nextPC)
@@ -27,6 +27,7 @@
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64Base.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
 class Jit64 : public Jitx86Base
@@ -237,6 +238,10 @@ private:
   void AllocStack();
   void FreeStack();
 
+  // Compiles the blocks from previous sessions which are on the same pages as the given
+  // physical addresses, if their guest code is unchanged.
+  void PrecompileCachedBlocks(const std::set<u32>& physical_addresses);
+
   GPRRegCache gpr{*this};
   FPURegCache fpr{*this};
 
@@ -244,6 +249,7 @@ private:
   // large chunk of memory for each recompiled block.
   PPCAnalyst::CodeBuffer code_buffer;
   Jit64AsmRoutineManager asm_routines;
+  JitDiskCache m_disk_cache;
 
   bool m_enable_blr_optimization;
   bool m_cleanup_after_stackfault;
@@ -15,6 +15,7 @@
 #include "Core/PowerPC/Jit64/Jit.h"
 #include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 
 using namespace Gen;
 
@@ -105,20 +106,28 @@ void Jit64AsmRoutineManager::Generate()
   const bool assembly_dispatcher = true;
   if (assembly_dispatcher)
   {
-    // Fast block number lookup.
+    JitBaseBlockCache* block_cache = g_jit->GetBlockCache();
+
+    // Dispatches are only counted while block profiling is enabled. Checking the flag at run time
+    // means the dispatcher doesn't have to be regenerated when profiling is toggled, and a
+    // predictable branch is cheaper than the memory increment.
+    MOV(64, R(RSCRATCH), ImmPtr(&Profiler::g_ProfileBlocks));
+    CMP(8, MatR(RSCRATCH), Imm8(0));
+    FixupBranch not_profiling = J_CC(CC_Z);
+    MOV(64, R(RSCRATCH), ImmPtr(&block_cache->GetDispatchStats()->dispatches));
+    ADD(64, MatR(RSCRATCH), Imm8(1));
+    SetJumpTarget(not_profiling);
+
+    // Fast block lookup.
+    // page = directory[PC >> shift]
     // ((PC >> 2) & mask) * sizeof(JitBlock*) = (PC & (mask << 2)) * 2
+    MOV(32, R(RSCRATCH2), PPCSTATE(pc));
+    SHR(32, R(RSCRATCH2), Imm8(JitBaseBlockCache::FAST_BLOCK_MAP_PAGE_SHIFT));
+    MOV(64, R(RSCRATCH), ImmPtr(block_cache->GetFastBlockMap()));
+    MOV(64, R(RSCRATCH2), MComplex(RSCRATCH, RSCRATCH2, SCALE_8, 0));
     MOV(32, R(RSCRATCH), PPCSTATE(pc));
-    u64 icache = reinterpret_cast<u64>(g_jit->GetBlockCache()->GetFastBlockMap());
-    AND(32, R(RSCRATCH), Imm32(JitBaseBlockCache::FAST_BLOCK_MAP_MASK << 2));
-    if (icache <= INT_MAX)
-    {
-      MOV(64, R(RSCRATCH), MScaled(RSCRATCH, SCALE_2, static_cast<s32>(icache)));
-    }
-    else
-    {
-      MOV(64, R(RSCRATCH2), Imm64(icache));
-      MOV(64, R(RSCRATCH), MComplex(RSCRATCH2, RSCRATCH, SCALE_2, 0));
-    }
+    AND(32, R(RSCRATCH), Imm32(JitBaseBlockCache::FAST_BLOCK_MAP_PAGE_MASK << 2));
+    MOV(64, R(RSCRATCH), MComplex(RSCRATCH2, RSCRATCH, SCALE_2, 0));
 
     // Check if we found a block.
     TEST(64, R(RSCRATCH), R(RSCRATCH));
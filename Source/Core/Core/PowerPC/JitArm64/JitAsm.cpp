@@ -13,6 +13,7 @@
 #include "Core/PowerPC/JitCommon/JitAsmCommon.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 
 using namespace Arm64Gen;
 
@@ -91,13 +92,29 @@ void JitArm64::GenerateAsm()
     MOVP2R(MEM_REG, Memory::logical_base);
     SetJumpTarget(membaseend);
 
-    // iCache[(address >> 2) & iCache_Mask];
+    JitBaseBlockCache* block_cache = g_jit->GetBlockCache();
     ARM64Reg pc_masked = W25;
     ARM64Reg cache_base = X27;
     ARM64Reg block = X30;
-    ORRI2R(pc_masked, WZR, JitBaseBlockCache::FAST_BLOCK_MAP_MASK << 3);
+
+    // Dispatches are only counted while block profiling is enabled. Checking the flag at run time
+    // means the dispatcher doesn't have to be regenerated when profiling is toggled, and a
+    // predictable branch is cheaper than the memory increment.
+    MOVP2R(cache_base, &Profiler::g_ProfileBlocks);
+    LDRB(INDEX_UNSIGNED, W30, cache_base, 0);
+    FixupBranch not_profiling = CBZ(W30);
+    MOVP2R(cache_base, &block_cache->GetDispatchStats()->dispatches);
+    LDR(INDEX_UNSIGNED, block, cache_base, 0);
+    ADD(block, block, 1);
+    STR(INDEX_UNSIGNED, block, cache_base, 0);
+    SetJumpTarget(not_profiling);
+
+    // iCache[address >> shift][(address >> 2) & iCache_Mask];
+    LSR(pc_masked, DISPATCHER_PC, JitBaseBlockCache::FAST_BLOCK_MAP_PAGE_SHIFT);
+    MOVP2R(cache_base, block_cache->GetFastBlockMap());
+    LDR(cache_base, cache_base, ArithOption(EncodeRegTo64(pc_masked), true));
+    ORRI2R(pc_masked, WZR, JitBaseBlockCache::FAST_BLOCK_MAP_PAGE_MASK << 3);
     AND(pc_masked, pc_masked, DISPATCHER_PC, ArithOption(DISPATCHER_PC, ST_LSL, 1));
-    MOVP2R(cache_base, g_jit->GetBlockCache()->GetFastBlockMap());
     LDR(block, cache_base, EncodeRegTo64(pc_masked));
     FixupBranch not_found = CBZ(block);
 
@@ -11,19 +11,24 @@
 
 #include <algorithm>
 #include <array>
+#include <cinttypes>
 #include <cstring>
 #include <functional>
-#include <map>
+#include <iterator>
+#include <memory>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/JitRegister.h"
+#include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -39,6 +44,10 @@ bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 
 JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
 {
+  // The directory is allocated once, since its address is baked into the dispatchers.
+  fast_block_map = std::make_unique<JitBlock**[]>(FAST_BLOCK_MAP_DIRECTORY_ELEMENTS);
+  std::fill_n(fast_block_map.get(), FAST_BLOCK_MAP_DIRECTORY_ELEMENTS,
+              empty_fast_block_page.data());
 }
 
 JitBaseBlockCache::~JitBaseBlockCache() = default;
@@ -52,6 +61,15 @@ void JitBaseBlockCache::Init()
 
 void JitBaseBlockCache::Shutdown()
 {
+  if (dispatch_stats.dispatches != 0)
+  {
+    INFO_LOG(DYNA_REC, "Dispatcher fast block map hit rate: %.2f%% of %" PRIu64 " dispatches",
+             100.0 * (dispatch_stats.dispatches - dispatch_stats.fast_map_misses) /
+                 dispatch_stats.dispatches,
+             dispatch_stats.dispatches);
+  }
+  dispatch_stats = {};
+
   JitRegister::Shutdown();
 }
 
@@ -64,17 +82,20 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
-  for (auto& e : block_map)
-  {
-    DestroyBlock(e.second);
-  }
-  block_map.clear();
-  links_to.clear();
-  block_range_map.clear();
+  block_map.ForEach([this](u32, const std::vector<JitBlock*>& blocks) {
+    for (JitBlock* block : blocks)
+    {
+      DestroyBlock(*block);
+      FreeBlock(block);
+    }
+  });
+  block_map.Clear();
+  links_to.Clear();
+  block_range_map.Clear();
 
   valid_block.ClearAll();
 
-  fast_block_map.fill(nullptr);
+  ClearFastBlockMap();
 }
 
 void JitBaseBlockCache::Reset()
@@ -83,50 +104,58 @@ void JitBaseBlockCache::Reset()
   Init();
 }
 
-JitBlock** JitBaseBlockCache::GetFastBlockMap()
+JitBlock*** JitBaseBlockCache::GetFastBlockMap()
+{
+  return fast_block_map.get();
+}
+
+JitBaseBlockCache::DispatchStats* JitBaseBlockCache::GetDispatchStats()
 {
-  return fast_block_map.data();
+  return &dispatch_stats;
 }
 
 void JitBaseBlockCache::RunOnBlocks(std::function<void(const JitBlock&)> f)
 {
-  for (const auto& e : block_map)
-    f(e.second);
+  block_map.ForEach([&f](u32, const std::vector<JitBlock*>& blocks) {
+    for (const JitBlock* block : blocks)
+      f(*block);
+  });
 }
 
 JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
   u32 physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
-  JitBlock& b = block_map.emplace(physicalAddress, JitBlock())->second;
+  JitBlock& b = *NewBlock();
+  block_map.Insert(physicalAddress, &b);
   b.effectiveAddress = em_address;
   b.physicalAddress = physicalAddress;
   b.msrBits = MSR & JIT_CACHE_MSR_MASK;
   b.linkData.clear();
-  b.fast_block_map_index = 0;
   return &b;
 }
 
 void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
                                       const std::set<u32>& physical_addresses)
 {
-  size_t index = FastLookupIndexForAddress(block.effectiveAddress);
-  fast_block_map[index] = &block;
-  block.fast_block_map_index = index;
+  FastBlockMapEntry(block.effectiveAddress) = &block;
 
   block.physical_addresses = physical_addresses;
 
   u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  for (u32 addr : physical_addresses)
+  for (auto it = physical_addresses.begin(); it != physical_addresses.end(); ++it)
   {
-    valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
+    valid_block.Set(*it / 32);
+
+    // The addresses are sorted, so each macro block only has to be added once.
+    if (it == physical_addresses.begin() || ((*it ^ *std::prev(it)) & range_mask))
+      block_range_map.Insert(*it & range_mask, &block);
   }
 
   if (block_link)
   {
     for (const auto& e : block.linkData)
     {
-      links_to.emplace(e.exitAddress, &block);
+      links_to.Insert(e.exitAddress, &block);
     }
 
     LinkBlock(block);
@@ -159,12 +188,14 @@ JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
     translated_addr = translated.address;
   }
 
-  auto iter = block_map.equal_range(translated_addr);
-  for (; iter.first != iter.second; iter.first++)
+  const std::vector<JitBlock*>* blocks = block_map.Find(translated_addr);
+  if (!blocks)
+    return nullptr;
+
+  for (JitBlock* b : *blocks)
   {
-    JitBlock& b = iter.first->second;
-    if (b.effectiveAddress == addr && b.msrBits == (msr & JIT_CACHE_MSR_MASK))
-      return &b;
+    if (b->effectiveAddress == addr && b->msrBits == (msr & JIT_CACHE_MSR_MASK))
+      return b;
   }
 
   return nullptr;
@@ -172,7 +203,10 @@ JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
 
 const u8* JitBaseBlockCache::Dispatch()
 {
-  JitBlock* block = fast_block_map[FastLookupIndexForAddress(PC)];
+  if (Profiler::g_ProfileBlocks)
+    dispatch_stats.fast_map_misses++;
+
+  JitBlock* block = FastBlockMapLookup(PC);
 
   if (!block || block->effectiveAddress != PC || block->msrBits != (MSR & JIT_CACHE_MSR_MASK))
     block = MoveBlockIntoFastCache(PC, MSR & JIT_CACHE_MSR_MASK);
@@ -222,51 +256,83 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
-  // Iterate over all macro blocks which overlap the given range.
+  // Collect all macro blocks which overlap the given range. For large ranges, scanning the
+  // whole index is cheaper than probing it once per macro block.
   u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
+  const u32 start = address & range_mask;
+  const u64 end = static_cast<u64>(address) + length;
+  std::vector<u32> ranges;
+  if ((end - start) / BLOCK_RANGE_MAP_ELEMENTS > block_range_map.Size())
+  {
+    block_range_map.ForEach([&](u32 range, const std::vector<JitBlock*>&) {
+      if (range >= start && range < end)
+        ranges.push_back(range);
+    });
+  }
+  else
+  {
+    for (u64 range = start; range < end; range += BLOCK_RANGE_MAP_ELEMENTS)
+    {
+      if (block_range_map.Find(static_cast<u32>(range)))
+        ranges.push_back(static_cast<u32>(range));
+    }
+  }
+
+  for (u32 range : ranges)
   {
-    // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    const std::vector<JitBlock*>* blocks = block_range_map.Find(range);
+    if (!blocks)
+      continue;
+
+    // Erasing a block modifies the macro blocks, so iterate over a copy.
+    const std::vector<JitBlock*> candidates = *blocks;
+    for (JitBlock* block : candidates)
     {
-      JitBlock* block = *iter;
       if (block->OverlapsPhysicalRange(address, length))
-      {
-        // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
-
-        // And remove the block.
-        DestroyBlock(*block);
-        auto block_map_iter = block_map.equal_range(block->physicalAddress);
-        while (block_map_iter.first != block_map_iter.second)
-        {
-          if (&block_map_iter.first->second == block)
-          {
-            block_map.erase(block_map_iter.first);
-            break;
-          }
-          block_map_iter.first++;
-        }
-        iter = start->second.erase(iter);
-      }
-      else
-      {
-        iter++;
-      }
+        EraseBlock(block);
     }
+  }
+}
 
-    // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+void JitBaseBlockCache::EraseBlock(JitBlock* block)
+{
+  // Remove the block from all macro blocks it occupies. Empty macro blocks are dropped.
+  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  const std::set<u32>& addresses = block->physical_addresses;
+  for (auto it = addresses.begin(); it != addresses.end(); ++it)
+  {
+    if (it == addresses.begin() || ((*it ^ *std::prev(it)) & range_mask))
+      block_range_map.Erase(*it & range_mask, block);
+  }
+
+  DestroyBlock(*block);
+  block_map.Erase(block->physicalAddress, block);
+  FreeBlock(block);
+}
+
+JitBlock* JitBaseBlockCache::NewBlock()
+{
+  if (free_blocks.empty())
+  {
+    block_slabs.emplace_back(std::make_unique<JitBlock[]>(BLOCK_SLAB_SIZE));
+    JitBlock* slab = block_slabs.back().get();
+    // Push in reverse so that blocks are handed out in address order.
+    for (size_t i = BLOCK_SLAB_SIZE; i-- > 0;)
+      free_blocks.push_back(&slab[i]);
   }
+
+  JitBlock* block = free_blocks.back();
+  free_blocks.pop_back();
+  return block;
+}
+
+void JitBaseBlockCache::FreeBlock(JitBlock* block)
+{
+  // Keep the allocations of the containers around for the next user of this block.
+  block->linkData.clear();
+  block->physical_addresses.clear();
+  block->profile_data = {};
+  free_blocks.push_back(block);
 }
 
 u32* JitBaseBlockCache::GetBlockBitSet() const
@@ -303,13 +369,14 @@ void JitBaseBlockCache::LinkBlockExits(JitBlock& block)
 void JitBaseBlockCache::LinkBlock(JitBlock& block)
 {
   LinkBlockExits(block);
-  auto ppp = links_to.equal_range(block.effectiveAddress);
+  const std::vector<JitBlock*>* sources = links_to.Find(block.effectiveAddress);
+  if (!sources)
+    return;
 
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
+  for (JitBlock* b2 : *sources)
   {
-    JitBlock& b2 = *iter->second;
-    if (block.msrBits == b2.msrBits)
-      LinkBlockExits(b2);
+    if (block.msrBits == b2->msrBits)
+      LinkBlockExits(*b2);
   }
 }
 
@@ -322,10 +389,13 @@ void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
   }
 
   // Unlink all exits of other blocks which points to this block
-  auto ppp = links_to.equal_range(block.effectiveAddress);
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
+  const std::vector<JitBlock*>* sources = links_to.Find(block.effectiveAddress);
+  if (!sources)
+    return;
+
+  for (JitBlock* source : *sources)
   {
-    JitBlock& sourceBlock = *iter->second;
+    JitBlock& sourceBlock = *source;
     if (sourceBlock.msrBits != block.msrBits)
       continue;
 
@@ -342,23 +412,14 @@ void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
 
 void JitBaseBlockCache::DestroyBlock(JitBlock& block)
 {
-  if (fast_block_map[block.fast_block_map_index] == &block)
-    fast_block_map[block.fast_block_map_index] = nullptr;
+  if (FastBlockMapLookup(block.effectiveAddress) == &block)
+    FastBlockMapEntry(block.effectiveAddress) = nullptr;
 
   UnlinkBlock(block);
 
   // Delete linking addresses
   for (const auto& e : block.linkData)
-  {
-    auto it = links_to.equal_range(e.exitAddress);
-    while (it.first != it.second)
-    {
-      if (it.first->second == &block)
-        it.first = links_to.erase(it.first);
-      else
-        it.first++;
-    }
-  }
+    links_to.Erase(e.exitAddress, &block);
 
   // Raise an signal if we are going to call this block again
   WriteDestroyBlock(block);
@@ -371,19 +432,37 @@ JitBlock* JitBaseBlockCache::MoveBlockIntoFastCache(u32 addr, u32 msr)
   if (!block)
     return nullptr;
 
-  // Drop old fast block map entry
-  if (fast_block_map[block->fast_block_map_index] == block)
-    fast_block_map[block->fast_block_map_index] = nullptr;
-
-  // And create a new one
-  size_t index = FastLookupIndexForAddress(addr);
-  fast_block_map[index] = block;
-  block->fast_block_map_index = index;
+  // Every address has its own entry, so this only replaces a block for another MSR.
+  FastBlockMapEntry(addr) = block;
 
   return block;
 }
 
-size_t JitBaseBlockCache::FastLookupIndexForAddress(u32 address)
+JitBlock* JitBaseBlockCache::FastBlockMapLookup(u32 address) const
+{
+  return fast_block_map[address >> FAST_BLOCK_MAP_PAGE_SHIFT][(address >> 2) &
+                                                               FAST_BLOCK_MAP_PAGE_MASK];
+}
+
+JitBlock*& JitBaseBlockCache::FastBlockMapEntry(u32 address)
 {
-  return (address >> 2) & FAST_BLOCK_MAP_MASK;
+  const u32 page_index = address >> FAST_BLOCK_MAP_PAGE_SHIFT;
+  if (fast_block_map[page_index] == empty_fast_block_page.data())
+  {
+    fast_block_pages.emplace_back(std::make_unique<FastBlockMapPage>());
+    fast_block_pages.back()->fill(nullptr);
+    fast_block_map[page_index] = fast_block_pages.back()->data();
+    fast_block_page_indices.push_back(page_index);
+  }
+
+  return fast_block_map[page_index][(address >> 2) & FAST_BLOCK_MAP_PAGE_MASK];
+}
+
+void JitBaseBlockCache::ClearFastBlockMap()
+{
+  for (u32 page_index : fast_block_page_indices)
+    fast_block_map[page_index] = empty_fast_block_page.data();
+
+  fast_block_pages.clear();
+  fast_block_page_indices.clear();
 }
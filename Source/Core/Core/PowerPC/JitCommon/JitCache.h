@@ -8,12 +8,12 @@
 #include <bitset>
 #include <cstring>
 #include <functional>
-#include <map>
 #include <memory>
 #include <set>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/FlatMultiMap.h"
 
 class JitBase;
 
@@ -73,10 +73,6 @@ struct JitBlock
     u64 ticStart;
     u64 ticStop;
   } profile_data = {};
-
-  // This tracks the position if this block within the fast block cache.
-  // We allow each block to have only one map entry.
-  size_t fast_block_map_index;
 };
 
 typedef void (*CompiledCode)();
@@ -118,8 +114,22 @@ public:
   // is valid (MSR.IR and MSR.DR, the address translation bits).
   static constexpr u32 JIT_CACHE_MSR_MASK = 0x30;
 
-  static constexpr u32 FAST_BLOCK_MAP_ELEMENTS = 0x10000;
-  static constexpr u32 FAST_BLOCK_MAP_MASK = FAST_BLOCK_MAP_ELEMENTS - 1;
+  // The fast block map covers the whole effective address space with a two-level table:
+  // a directory indexed by the page of the PC points to a table holding one block pointer
+  // per instruction of that page.
+  static constexpr u32 FAST_BLOCK_MAP_PAGE_SHIFT = 12;
+  static constexpr u32 FAST_BLOCK_MAP_PAGE_ELEMENTS = (1 << FAST_BLOCK_MAP_PAGE_SHIFT) / 4;
+  static constexpr u32 FAST_BLOCK_MAP_PAGE_MASK = FAST_BLOCK_MAP_PAGE_ELEMENTS - 1;
+  static constexpr u32 FAST_BLOCK_MAP_DIRECTORY_ELEMENTS = 1 << (32 - FAST_BLOCK_MAP_PAGE_SHIFT);
+
+  // Counters for the dispatcher, only counted while block profiling is enabled. dispatches is
+  // incremented by the assembly dispatchers, and fast_map_misses by Dispatch(), which they call
+  // when the fast block map lookup fails.
+  struct DispatchStats
+  {
+    u64 dispatches;
+    u64 fast_map_misses;
+  };
 
   explicit JitBaseBlockCache(JitBase& jit);
   virtual ~JitBaseBlockCache();
@@ -130,7 +140,8 @@ public:
   void Reset();
 
   // Code Cache
-  JitBlock** GetFastBlockMap();
+  JitBlock*** GetFastBlockMap();
+  DispatchStats* GetDispatchStats();
   void RunOnBlocks(std::function<void(const JitBlock&)> f);
 
   JitBlock* AllocateBlock(u32 em_address);
@@ -166,28 +177,52 @@ private:
 
   JitBlock* MoveBlockIntoFastCache(u32 em_address, u32 msr);
 
-  // Fast but risky block lookup based on fast_block_map.
-  size_t FastLookupIndexForAddress(u32 address);
+  // Returns the fast block map entry of the given address. The page table of the address is
+  // only allocated when the entry is about to be written.
+  JitBlock* FastBlockMapLookup(u32 address) const;
+  JitBlock*& FastBlockMapEntry(u32 address);
+  void ClearFastBlockMap();
+
+  // Takes a JitBlock from the slab allocator, and returns it to it.
+  JitBlock* NewBlock();
+  void FreeBlock(JitBlock* block);
+
+  // Removes a block from every index and returns it to the allocator.
+  void EraseBlock(JitBlock* block);
+
+  // JitBlocks are allocated in slabs of this many blocks and recycled through a free list,
+  // so their addresses stay stable while the indices below only store pointers.
+  static constexpr size_t BLOCK_SLAB_SIZE = 0x1000;
+  std::vector<std::unique_ptr<JitBlock[]>> block_slabs;
+  std::vector<JitBlock*> free_blocks;
 
   // links_to hold all exit points of all valid blocks in a reverse way.
   // It is used to query all blocks which links to an address.
-  std::multimap<u32, JitBlock*> links_to;  // destination_PC -> number
+  Common::FlatMultiMap<JitBlock*> links_to;  // destination_PC -> blocks
 
   // Map indexed by the physical address of the entry point.
   // This is used to query the block based on the current PC in a slow way.
-  std::multimap<u32, JitBlock> block_map;  // start_addr -> block
+  Common::FlatMultiMap<JitBlock*> block_map;  // start_addr -> blocks
 
   // Range of overlapping code indexed by a masked physical address.
   // This is used for invalidation of memory regions. The range is grouped
   // in macro blocks of each 0x100 bytes.
   static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  Common::FlatMultiMap<JitBlock*> block_range_map;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
   ValidBlockBitSet valid_block;
 
-  // This array is indexed with the masked PC and likely holds the correct block id.
+  // This table is indexed with the PC and holds the block most recently dispatched for it.
   // This is used as a fast cache of block_map used in the assembly dispatcher.
-  std::array<JitBlock*, FAST_BLOCK_MAP_ELEMENTS> fast_block_map;  // start_addr & mask -> number
+  // Directory entries of pages without any blocks point to the shared empty_fast_block_page,
+  // so a lookup is always exactly two loads and never collides with another address.
+  using FastBlockMapPage = std::array<JitBlock*, FAST_BLOCK_MAP_PAGE_ELEMENTS>;
+  std::unique_ptr<JitBlock**[]> fast_block_map;  // start_addr >> 12 -> page
+  FastBlockMapPage empty_fast_block_page{};
+  std::vector<std::unique_ptr<FastBlockMapPage>> fast_block_pages;
+  std::vector<u32> fast_block_page_indices;
+
+  DispatchStats dispatch_stats{};
 };
@@ -0,0 +1,195 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/PowerPC.h"
+
+class JitDiskCache::Reader final : public LinearDiskCacheReader<Key, u32>
+{
+public:
+  explicit Reader(JitDiskCache& cache) : m_cache(cache) {}
+  void Read(const Key& key, const u32* value, u32 value_size) override
+  {
+    if (m_cache.m_known_keys.size() >= MAX_ENTRIES || !m_cache.m_known_keys.insert(key).second)
+      return;
+
+    if (value_size != 0)
+      m_cache.AddPending(key, {value, value + value_size});
+  }
+
+private:
+  JitDiskCache& m_cache;
+};
+
+static bool IsRAMAddress(u32 address)
+{
+  address &= 0x3FFFFFFF;
+  if (address < Memory::REALRAM_SIZE)
+    return true;
+
+  return Memory::m_pEXRAM && (address >> 28) == 0x1 &&
+         (address & 0x0FFFFFFF) < Memory::EXRAM_SIZE;
+}
+
+JitDiskCache::~JitDiskCache()
+{
+  Close();
+}
+
+void JitDiskCache::Open(const std::string& game_id)
+{
+  if (m_is_open && m_game_id == game_id)
+    return;
+
+  Close();
+  if (game_id.empty())
+    return;
+
+  const std::string path = File::GetUserPath(D_CACHE_IDX) + "JIT" DIR_SEP;
+  if (!File::Exists(path))
+    File::CreateFullPath(path);
+
+  Reader reader(*this);
+  const u32 entries = m_file.OpenAndRead(path + game_id + ".cache", reader);
+  INFO_LOG(DYNA_REC, "Loaded %u JIT block entries for %s", entries, game_id.c_str());
+  m_game_id = game_id;
+  m_is_open = true;
+}
+
+void JitDiskCache::Close()
+{
+  if (!m_is_open)
+    return;
+
+  m_file.Sync();
+  m_file.Close();
+  m_known_keys.clear();
+  m_pending.clear();
+  m_pending_by_page.clear();
+  m_game_id.clear();
+  m_is_open = false;
+}
+
+std::set<u32> JitDiskCache::GetPages(const std::set<u32>& physical_addresses)
+{
+  std::set<u32> pages;
+  for (u32 address : physical_addresses)
+    pages.insert(address >> PAGE_SHIFT);
+  return pages;
+}
+
+void JitDiskCache::AddPending(const Key& key, std::set<u32> physical_addresses)
+{
+  for (u32 page : GetPages(physical_addresses))
+    m_pending_by_page[page].insert(key);
+  m_pending.emplace(key, std::move(physical_addresses));
+}
+
+void JitDiskCache::RemovePending(std::map<Key, std::set<u32>>::iterator it)
+{
+  for (u32 page : GetPages(it->second))
+  {
+    const auto page_it = m_pending_by_page.find(page);
+    page_it->second.erase(it->first);
+    if (page_it->second.empty())
+      m_pending_by_page.erase(page_it);
+  }
+  m_pending.erase(it);
+}
+
+void JitDiskCache::RecordBlock(const JitBlock& block)
+{
+  if (!m_is_open)
+    return;
+
+  // Blocks are keyed by their code hash as well, so there may be several for an entry point.
+  auto it = m_pending.lower_bound({block.effectiveAddress, block.msrBits, 0});
+  while (it != m_pending.end() && it->first.effective_address == block.effectiveAddress &&
+         it->first.msr_bits == block.msrBits)
+  {
+    RemovePending(it++);
+  }
+
+  if (m_known_keys.size() >= MAX_ENTRIES)
+    return;
+
+  Key key{block.effectiveAddress, block.msrBits, 0};
+  if (!HashGuestCode(block.physical_addresses, &key.code_hash))
+    return;
+
+  if (!m_known_keys.insert(key).second)
+    return;
+
+  const std::vector<u32> addresses(block.physical_addresses.begin(),
+                                   block.physical_addresses.end());
+  m_file.Append(key, addresses.data(), static_cast<u32>(addresses.size()));
+}
+
+bool JitDiskCache::IsPending(u32 effective_address, u32 msr_bits) const
+{
+  const auto it = m_pending.lower_bound({effective_address, msr_bits, 0});
+  return it != m_pending.end() && it->first.effective_address == effective_address &&
+         it->first.msr_bits == msr_bits;
+}
+
+std::vector<u32> JitDiskCache::GetValidEntryPoints(const std::set<u32>& physical_addresses,
+                                                    u32 msr_bits)
+{
+  std::set<Key> candidates;
+  for (u32 page : GetPages(physical_addresses))
+  {
+    const auto page_it = m_pending_by_page.find(page);
+    if (page_it != m_pending_by_page.end())
+      candidates.insert(page_it->second.begin(), page_it->second.end());
+  }
+
+  std::vector<u32> entry_points;
+  for (const Key& key : candidates)
+  {
+    const std::set<u32>& block_addresses = m_pending.at(key);
+    u64 hash;
+    if (key.msr_bits != msr_bits || !HashGuestCode(block_addresses, &hash) ||
+        hash != key.code_hash)
+    {
+      continue;
+    }
+
+    // The entry point must still translate to the code that was hashed.
+    const auto translated = PowerPC::JitCache_TranslateAddress(key.effective_address);
+    if (translated.valid && block_addresses.count(translated.address))
+      entry_points.push_back(key.effective_address);
+  }
+
+  return entry_points;
+}
+
+bool JitDiskCache::HashGuestCode(const std::set<u32>& physical_addresses, u64* hash)
+{
+  std::vector<u32> code;
+  code.reserve(physical_addresses.size() * 2);
+  for (u32 address : physical_addresses)
+  {
+    if (!IsRAMAddress(address))
+      return false;
+
+    code.push_back(address);
+    code.push_back(Memory::Read_U32(address));
+  }
+
+  *hash = GetHash64(reinterpret_cast<const u8*>(code.data()),
+                    static_cast<u32>(code.size() * sizeof(u32)), 0);
+  return true;
+}
@@ -0,0 +1,92 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+
+struct JitBlock;
+
+// Persistent record of the blocks a game has compiled in previous sessions.
+//
+// Every compiled block is stored on disk keyed by its entry point, the MSR bits it was
+// compiled for and a hash of the guest instructions it covers. The physical addresses of
+// those instructions are stored as the value, so that the hash can be re-validated against
+// emulated memory at any point.
+//
+// Host code is deliberately not stored: JIT code embeds absolute pointers to host functions,
+// the block cache and the far code/trampoline caches, none of which are stable across
+// sessions. Instead, once the game reaches code that was compiled in a previous session,
+// the other previously compiled blocks on the same pages are compiled in one batch if their
+// guest code is unchanged. This doesn't save any recompiler work, but moves it from the first
+// time each block runs to the first time its page runs.
+class JitDiskCache final
+{
+public:
+  struct Key
+  {
+    u32 effective_address;
+    u32 msr_bits;
+    u64 code_hash;
+
+    bool operator<(const Key& other) const
+    {
+      return std::tie(effective_address, msr_bits, code_hash) <
+             std::tie(other.effective_address, other.msr_bits, other.code_hash);
+    }
+  };
+
+  // Upper bound on the number of blocks that are tracked for a single game.
+  static constexpr size_t MAX_ENTRIES = 0x20000;
+
+  JitDiskCache() = default;
+  ~JitDiskCache();
+
+  // Loads the block list of the given game and starts recording new blocks to it.
+  // Does nothing if the block list of that game is already open.
+  void Open(const std::string& game_id);
+  void Close();
+  bool IsOpen() const { return m_is_open; }
+
+  // Records a block which has just been finalized in the block cache. Its entry point is no
+  // longer pending.
+  void RecordBlock(const JitBlock& block);
+
+  // Returns true if the given entry point was compiled in a previous session and has not
+  // been compiled yet in this one.
+  bool IsPending(u32 effective_address, u32 msr_bits) const;
+
+  // Returns the entry points of the pending blocks for the given MSR bits which have code on
+  // the same pages as the given physical addresses, and whose guest code is currently present
+  // in memory and unchanged. They stay pending until they are recorded.
+  std::vector<u32> GetValidEntryPoints(const std::set<u32>& physical_addresses, u32 msr_bits);
+
+  // Hashes the guest instructions at the given physical addresses. Returns false if any of
+  // the addresses is not backed by RAM.
+  static bool HashGuestCode(const std::set<u32>& physical_addresses, u64* hash);
+
+private:
+  class Reader;
+
+  static constexpr u32 PAGE_SHIFT = 12;
+
+  static std::set<u32> GetPages(const std::set<u32>& physical_addresses);
+  void AddPending(const Key& key, std::set<u32> physical_addresses);
+  void RemovePending(std::map<Key, std::set<u32>>::iterator it);
+
+  LinearDiskCache<Key, u32> m_file;
+  std::set<Key> m_known_keys;
+  // The physical addresses of each pending block, and the pending blocks on each page.
+  std::map<Key, std::set<u32>> m_pending;
+  std::map<u32, std::set<Key>> m_pending_by_page;
+  std::string m_game_id;
+  bool m_is_open = false;
+};
@@ -174,6 +174,19 @@ int GetHostCode(u32* address, const u8** code, u32* code_size)
   return 0;
 }
 
+bool GetDispatchStats(u64* dispatches, u64* fast_map_misses)
+{
+  if (!g_jit)
+    return false;
+
+  // The counters are only written by the CPU thread. Reading them while it is running may give
+  // slightly outdated numbers, which is fine for statistics.
+  const JitBaseBlockCache::DispatchStats* stats = g_jit->GetBlockCache()->GetDispatchStats();
+  *dispatches = stats->dispatches;
+  *fast_map_misses = stats->fast_map_misses;
+  return true;
+}
+
 bool HandleFault(uintptr_t access_address, SContext* ctx)
 {
   // Prevent nullptr dereference on a crash with no JIT present
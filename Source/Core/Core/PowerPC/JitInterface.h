@@ -31,6 +31,9 @@ CPUCoreBase* GetCore();
 void WriteProfileResults(const std::string& filename);
 void GetProfileResults(ProfileStats* prof_stats);
 int GetHostCode(u32* address, const u8** code, u32* code_size);
+// Gets how often the dispatcher ran and how often its fast block map lookup missed, both only
+// counted while block profiling is enabled. Returns false if no JIT is running.
+bool GetDispatchStats(u64* dispatches, u64* fast_map_misses);
 
 // Memory Utilities
 bool HandleFault(uintptr_t access_address, SContext* ctx);
@@ -0,0 +1,262 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/Rewind.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <lzo/lzo1x.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/ThreadPool.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/CPU.h"
+#include "Core/NetPlayClient.h"
+#include "Core/State.h"
+#include "VideoCommon/Fifo.h"
+
+namespace Rewind
+{
+// States are captured on the CPU thread, which only has to wait for the GPU thread to catch up
+// and for PointerWrap to serialize them. Compression happens on a worker thread afterwards.
+//
+// Every KEYFRAME_INTERVAL-th state is stored as a whole. The states in between are XORed with
+// the previous keyframe before being compressed, which leaves mostly zeroes behind since only
+// a small part of memory changes within a few seconds.
+static const u32 KEYFRAME_INTERVAL = 10;
+
+struct RewindState
+{
+  std::vector<u8> compressed;
+  size_t size;
+  bool is_keyframe;
+};
+
+static std::unique_ptr<Common::ThreadPool> s_worker;
+static std::future<void> s_pending_capture;
+static std::atomic<bool> s_capture_pending{false};
+static CoreTiming::EventType* s_event_capture;
+static u32 s_capture_interval;
+static u32 s_fields_since_capture = 0;
+static size_t s_memory_budget;
+
+// Guards s_states and s_states_size, which are filled by the worker.
+static std::mutex s_states_lock;
+static std::deque<RewindState> s_states;
+static size_t s_states_size = 0;
+
+// Only accessed by the worker, or while it is idle and the CPU thread is paused.
+static std::vector<u8> s_keyframe;
+static std::vector<u8> s_spare_buffer;
+static u32 s_states_since_keyframe = 0;
+
+static void XorBuffers(std::vector<u8>* data, const std::vector<u8>& keyframe)
+{
+  const size_t size = std::min(data->size(), keyframe.size());
+  for (size_t i = 0; i < size; ++i)
+    (*data)[i] ^= keyframe[i];
+}
+
+static void Compress(const std::vector<u8>& data, std::vector<u8>* compressed)
+{
+  std::vector<lzo_align_t> wrkmem((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) /
+                                  sizeof(lzo_align_t));
+  compressed->resize(data.size() + data.size() / 16 + 64 + 3);
+  lzo_uint compressed_size = 0;
+  lzo1x_1_compress(data.data(), static_cast<lzo_uint>(data.size()), compressed->data(),
+                   &compressed_size, wrkmem.data());
+  compressed->resize(compressed_size);
+  compressed->shrink_to_fit();
+}
+
+static bool Decompress(const RewindState& state, std::vector<u8>* data)
+{
+  data->resize(state.size);
+  lzo_uint size = static_cast<lzo_uint>(state.size);
+  const int res = lzo1x_decompress_safe(state.compressed.data(),
+                                        static_cast<lzo_uint>(state.compressed.size()),
+                                        data->data(), &size, nullptr);
+  return res == LZO_E_OK && size == state.size;
+}
+
+// Drops the oldest states until the budget is met. Deltas can't outlive their keyframe.
+static void EvictOldStates()
+{
+  while (!s_states.empty() && s_states_size > s_memory_budget)
+  {
+    do
+    {
+      s_states_size -= s_states.front().compressed.size();
+      s_states.pop_front();
+    } while (!s_states.empty() && !s_states.front().is_keyframe);
+  }
+}
+
+static void StoreState(std::vector<u8> data)
+{
+  RewindState state;
+  state.size = data.size();
+  state.is_keyframe = s_keyframe.empty() || s_states_since_keyframe == KEYFRAME_INTERVAL;
+
+  if (state.is_keyframe)
+    s_states_since_keyframe = 0;
+  else
+    XorBuffers(&data, s_keyframe);
+  s_states_since_keyframe++;
+
+  Compress(data, &state.compressed);
+
+  // Keep the uncompressed keyframe around for the following deltas,
+  // and recycle whichever buffer isn't needed anymore for the next capture.
+  if (state.is_keyframe)
+    s_keyframe.swap(data);
+  s_spare_buffer.swap(data);
+
+  std::lock_guard<std::mutex> lk(s_states_lock);
+  s_states_size += state.compressed.size();
+  s_states.push_back(std::move(state));
+  EvictOldStates();
+  if (s_states.empty())
+    s_keyframe.clear();
+}
+
+static void WaitForWorker()
+{
+  if (s_pending_capture.valid())
+    s_pending_capture.get();
+}
+
+static void CaptureCallback(u64 userdata, s64 cycles_late)
+{
+  if (!s_worker || NetPlay::IsNetPlayRunning())
+    return;
+
+  // Rather skip a capture than pile up uncompressed states if the worker falls behind.
+  if (s_capture_pending)
+    return;
+  WaitForWorker();
+
+  std::vector<u8> buffer;
+  buffer.swap(s_spare_buffer);
+  // Core::RunAsCPUThread doesn't pause anything when it is called on the CPU thread, but in dual
+  // core mode the GPU thread would keep changing the video state while it is being saved.
+  Fifo::PauseAndLock(true, false);
+  State::SaveToBuffer(buffer);
+  // Leave the GPU thread paused if the host paused emulation in the meantime
+  Fifo::PauseAndLock(false, !CPU::IsStepping());
+
+  s_capture_pending = true;
+  s_pending_capture = s_worker->Schedule([buffer = std::move(buffer)]() mutable {
+    StoreState(std::move(buffer));
+    s_capture_pending = false;
+  });
+}
+
+void Init()
+{
+  s_event_capture = CoreTiming::RegisterEvent("RewindCapture", CaptureCallback);
+  s_fields_since_capture = 0;
+
+  const SConfig& config = SConfig::GetInstance();
+  if (!config.bRewind)
+    return;
+
+  s_capture_interval = std::max(config.iRewindInterval, 1);
+  s_memory_budget = static_cast<size_t>(std::max(config.iRewindMemoryBudget, 1)) * 1024 * 1024;
+  s_worker = std::make_unique<Common::ThreadPool>(1, "Rewind thread");
+}
+
+void Shutdown()
+{
+  WaitForWorker();
+  s_worker.reset();
+
+  std::lock_guard<std::mutex> lk(s_states_lock);
+  s_states.clear();
+  s_states_size = 0;
+  std::vector<u8>().swap(s_keyframe);
+  std::vector<u8>().swap(s_spare_buffer);
+  s_states_since_keyframe = 0;
+}
+
+void FieldUpdate()
+{
+  if (!s_worker || ++s_fields_since_capture < s_capture_interval)
+    return;
+
+  // Capture at the next timing slice instead of from within VideoInterface's event,
+  // so that the state doesn't miss the rescheduled VI event.
+  s_fields_since_capture = 0;
+  CoreTiming::ScheduleEvent(0, s_event_capture);
+}
+
+bool StepBack(u32 steps)
+{
+  if (!s_worker || NetPlay::IsNetPlayRunning())
+    return false;
+
+  bool success = false;
+  Core::RunAsCPUThread([&] {
+    WaitForWorker();
+
+    std::vector<u8> buffer;
+    {
+      std::lock_guard<std::mutex> lk(s_states_lock);
+      if (steps == 0 || steps > s_states.size())
+        return;
+
+      const size_t index = s_states.size() - steps;
+      const RewindState& state = s_states[index];
+      if (!Decompress(state, &buffer))
+      {
+        ERROR_LOG(CORE, "Failed to decompress rewind state");
+        return;
+      }
+
+      if (!state.is_keyframe)
+      {
+        size_t keyframe_index = index;
+        while (!s_states[keyframe_index].is_keyframe)
+          --keyframe_index;
+
+        std::vector<u8> keyframe;
+        if (!Decompress(s_states[keyframe_index], &keyframe))
+        {
+          ERROR_LOG(CORE, "Failed to decompress rewind keyframe");
+          return;
+        }
+        XorBuffers(&buffer, keyframe);
+      }
+
+      for (size_t i = index; i < s_states.size(); ++i)
+        s_states_size -= s_states[i].compressed.size();
+      s_states.erase(s_states.begin() + index, s_states.end());
+
+      // The keyframe the next delta would refer to might just have been discarded.
+      s_keyframe.clear();
+    }
+
+    State::LoadFromBuffer(buffer);
+    s_fields_since_capture = 0;
+    success = true;
+  });
+
+  return success;
+}
+
+u32 GetNumStates()
+{
+  std::lock_guard<std::mutex> lk(s_states_lock);
+  return static_cast<u32>(s_states.size());
+}
+}  // namespace Rewind
@@ -0,0 +1,26 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Keeps a bounded in-memory history of recent savestates, so that emulation can be rewound.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace Rewind
+{
+void Init();
+void Shutdown();
+
+// Called by VideoInterface at the end of every field. Schedules a capture every
+// RewindInterval fields.
+void FieldUpdate();
+
+// Loads the state captured the given number of captures ago (1 being the latest one).
+// That state is discarded along with every state captured after it, so stepping back again
+// goes further back. Returns false if there is no such state.
+bool StepBack(u32 steps = 1);
+
+u32 GetNumStates();
+}
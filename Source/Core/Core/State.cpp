@@ -4,9 +4,16 @@
 
 #include "Core/State.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <deque>
+#include <future>
 #include <lzo/lzo1x.h>
 #include <map>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <utility>
@@ -16,11 +23,13 @@
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/File.h"
+#include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 #include "Common/Version.h"
 
@@ -29,6 +38,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/GeckoCode.h"
 #include "Core/HW/HW.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/Movie.h"
@@ -53,10 +63,28 @@ static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
 static unsigned char __LZO_MMODEL out[OUT_LEN];
 
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// Compressed savestates are split into chunks of this size which are compressed and
+// decompressed independently, so that all cores can work on them at the same time.
+//
+// A chunked state starts with an empty LZO block, which never occurs in the legacy format
+// (a single LZO stream of IN_LEN sized blocks), followed by the rest of ChunkedStateHeader.
+// Every chunk is then stored as its compressed size followed by the compressed data.
+static const u32 CHUNKED_STATE_MAGIC = 0x43534344;  // "DCSC"
+static const u32 CHUNKED_STATE_VERSION = 1;
+static const u32 CHUNK_SIZE = 1024 * 1024;
+
+struct ChunkedStateHeader
+{
+  u32 empty_block_size;
+  u32 magic;
+  u32 version;
+  u32 chunk_size;
+};
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+static constexpr size_t GetLZOCompressBound(size_t size)
+{
+  return size + (size / 16) + 64 + 3;
+}
 
 static std::string g_last_filename;
 
@@ -72,9 +100,11 @@ static std::mutex g_cs_current_buffer;
 static Common::Event g_compressAndDumpStateSyncEvent;
 
 static std::thread g_save_thread;
+static std::thread s_delta_cleanup_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 93;  // Last changed in PR 6389
+static const u32 STATE_VERSION = 94;  // Last changed in PR xxxx
+static const u32 STATE_COOKIE_BASE = 0xBAADBABE;
 
 // Maps savestate versions to Dolphin versions.
 // Versions after 42 don't need to be added to this list,
@@ -101,6 +131,16 @@ enum
 
 static bool g_use_compression = true;
 
+// The full state which delta states saved in this session refer to.
+struct DeltaBase
+{
+  std::string filename;
+  double time;
+};
+
+static DeltaBase s_delta_base;
+static bool s_saving_delta_state = false;
+
 void EnableCompression(bool compression)
 {
   g_use_compression = compression;
@@ -111,10 +151,9 @@ static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
 {
   u32 version = STATE_VERSION;
   {
-    static const u32 COOKIE_BASE = 0xBAADBABE;
-    u32 cookie = version + COOKIE_BASE;
+    u32 cookie = version + STATE_COOKIE_BASE;
     p.Do(cookie);
-    version = cookie - COOKIE_BASE;
+    version = cookie - STATE_COOKIE_BASE;
   }
 
   *version_created_by = Common::scm_rev_str;
@@ -146,6 +185,35 @@ static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
   return true;
 }
 
+static std::string DoState(PointerWrap& p);
+static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data);
+
+static bool LoadDeltaBase(const std::string& filename, double time)
+{
+  StateHeader header;
+  if (!File::Exists(filename) || !ReadHeader(filename, header) || header.time != time)
+  {
+    Core::DisplayMessage("Unable to load: The base state of this delta state is missing", 4000);
+    return false;
+  }
+
+  std::vector<u8> buffer;
+  LoadFileStateData(filename, buffer);
+  if (buffer.empty())
+    return false;
+
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  DoState(p);
+  if (p.GetMode() != PointerWrap::MODE_READ)
+    return false;
+
+  // Delta states saved from now on can refer to the same base.
+  s_delta_base = {filename, time};
+  Memory::CaptureDeltaBase();
+  return true;
+}
+
 static std::string DoState(PointerWrap& p)
 {
   std::string version_created_by;
@@ -171,6 +239,28 @@ static std::string DoState(PointerWrap& p)
     return version_created_by;
   }
 
+  // Delta states only contain the memory pages which changed since their base state,
+  // so the base state has to be loaded first.
+  std::string delta_base_filename = s_saving_delta_state ? s_delta_base.filename : "";
+  double delta_base_time = s_saving_delta_state ? s_delta_base.time : 0.0;
+  p.Do(delta_base_filename);
+  p.Do(delta_base_time);
+  if (p.GetMode() == PointerWrap::MODE_READ && !delta_base_filename.empty() &&
+      !LoadDeltaBase(delta_base_filename, delta_base_time))
+  {
+    p.SetMode(PointerWrap::MODE_MEASURE);
+    return version_created_by;
+  }
+  p.DoMarker("Delta base");
+  if (p.GetMode() == PointerWrap::MODE_READ && delta_base_filename.empty())
+  {
+    // Memory doesn't have anything to do with the last base anymore. The next delta state
+    // gets a new one.
+    s_delta_base = {};
+    Memory::ClearDeltaBase();
+  }
+  Memory::SetDeltaStatesEnabled(!delta_base_filename.empty());
+
   // Begin with video backend, so that it gets a chance to clear its caches and writeback modified
   // things to RAM
   g_video_backend->DoState(p);
@@ -197,6 +287,7 @@ static std::string DoState(PointerWrap& p)
   AVIDump::DoState();
 #endif
 
+  Memory::SetDeltaStatesEnabled(false);
   return version_created_by;
 }
 
@@ -287,12 +378,117 @@ static std::map<double, int> GetSavedStates()
   return m;
 }
 
+// Chunks are read and written in order while the workers process the ones in between.
+// Only a few chunks per worker are kept in flight, so no second full-size buffer is needed.
+struct StateChunk
+{
+  std::vector<u8> compressed;
+  std::future<void> done;
+};
+
+static void WriteCompressedChunks(File::IOFile& f, const u8* data, size_t size)
+{
+  const ChunkedStateHeader chunk_header{0, CHUNKED_STATE_MAGIC, CHUNKED_STATE_VERSION, CHUNK_SIZE};
+  f.WriteArray(&chunk_header, 1);
+
+  Common::ThreadPool pool(0, "SaveState compression");
+  const size_t max_chunks_in_flight = pool.GetThreadCount() * 2;
+  std::deque<StateChunk> chunks;
+
+  const auto write_oldest_chunk = [&] {
+    StateChunk& chunk = chunks.front();
+    chunk.done.get();
+    const u32 compressed_size = static_cast<u32>(chunk.compressed.size());
+    f.WriteArray(&compressed_size, 1);
+    f.WriteBytes(chunk.compressed.data(), chunk.compressed.size());
+    chunks.pop_front();
+  };
+
+  for (size_t offset = 0; offset < size; offset += CHUNK_SIZE)
+  {
+    if (chunks.size() == max_chunks_in_flight)
+      write_oldest_chunk();
+
+    const size_t length = std::min<size_t>(CHUNK_SIZE, size - offset);
+    chunks.emplace_back();
+    std::vector<u8>* compressed = &chunks.back().compressed;
+    chunks.back().done = pool.Schedule([data, offset, length, compressed] {
+      std::vector<lzo_align_t> wrkmem((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) /
+                                      sizeof(lzo_align_t));
+      compressed->resize(GetLZOCompressBound(length));
+      lzo_uint compressed_size = 0;
+      if (lzo1x_1_compress(data + offset, static_cast<lzo_uint>(length), compressed->data(),
+                           &compressed_size, wrkmem.data()) != LZO_E_OK)
+      {
+        PanicAlertT("Internal LZO Error - compression failed");
+      }
+      compressed->resize(compressed_size);
+    });
+  }
+
+  while (!chunks.empty())
+    write_oldest_chunk();
+}
+
+static bool ReadCompressedChunks(File::IOFile& f, u8* data, size_t size, u32 chunk_size)
+{
+  Common::ThreadPool pool(0, "SaveState decompression");
+  const size_t max_chunks_in_flight = pool.GetThreadCount() * 2;
+  std::deque<StateChunk> chunks;
+  std::atomic<bool> failed{false};
+
+  for (size_t offset = 0; offset < size && !failed; offset += chunk_size)
+  {
+    if (chunks.size() == max_chunks_in_flight)
+    {
+      chunks.front().done.get();
+      chunks.pop_front();
+    }
+
+    u32 compressed_size;
+    if (!f.ReadArray(&compressed_size, 1) || compressed_size > GetLZOCompressBound(chunk_size))
+    {
+      failed = true;
+      break;
+    }
+
+    chunks.emplace_back();
+    std::vector<u8>& compressed = chunks.back().compressed;
+    compressed.resize(compressed_size);
+    if (!f.ReadBytes(compressed.data(), compressed_size))
+    {
+      failed = true;
+      break;
+    }
+
+    const size_t length = std::min<size_t>(chunk_size, size - offset);
+    chunks.back().done = pool.Schedule([&compressed, &failed, data, offset, length] {
+      lzo_uint decompressed_size = static_cast<lzo_uint>(length);
+      const int res =
+          lzo1x_decompress_safe(compressed.data(), static_cast<lzo_uint>(compressed.size()),
+                                data + offset, &decompressed_size, nullptr);
+      if (res != LZO_E_OK || decompressed_size != length)
+        failed = true;
+    });
+  }
+
+  for (StateChunk& chunk : chunks)
+  {
+    if (chunk.done.valid())
+      chunk.done.get();
+  }
+
+  return !failed;
+}
+
 struct CompressAndDumpState_args
 {
   std::vector<u8>* buffer_vector;
   std::mutex* buffer_mutex;
   std::string filename;
+  double time;
   bool wait;
+  bool is_delta_base;
 };
 
 static void CompressAndDumpState(CompressAndDumpState_args save_args)
@@ -319,8 +515,11 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
   // For easy debugging
   Common::SetCurrentThreadName("SaveState thread");
 
+  // Copy whatever parts of RAM haven't been copied yet by the threads writing to them.
+  Memory::CompleteSnapshot();
+
   // Moving to last overwritten save-state
-  if (File::Exists(filename))
+  if (!save_args.is_delta_base && File::Exists(filename))
   {
     if (File::Exists(File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav"))
       File::Delete((File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav"));
@@ -333,10 +532,13 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
       File::Rename(filename + ".dtm", File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav.dtm");
   }
 
-  if ((Movie::IsMovieActive()) && !Movie::IsJustStartingRecordingInputFromSaveState())
-    Movie::SaveRecording(filename + ".dtm");
-  else if (!Movie::IsMovieActive())
-    File::Delete(filename + ".dtm");
+  if (!save_args.is_delta_base)
+  {
+    if ((Movie::IsMovieActive()) && !Movie::IsJustStartingRecordingInputFromSaveState())
+      Movie::SaveRecording(filename + ".dtm");
+    else if (!Movie::IsMovieActive())
+      File::Delete(filename + ".dtm");
+  }
 
   File::IOFile f(filename, "wb");
   if (!f)
@@ -349,39 +551,13 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
   StateHeader header;
   strncpy(header.gameID, SConfig::GetInstance().GetGameID().c_str(), 6);
   header.size = g_use_compression ? (u32)buffer_size : 0;
-  header.time = Common::Timer::GetDoubleTime();
+  header.time = save_args.time;
 
   f.WriteArray(&header, 1);
 
   if (header.size != 0)  // non-zero header size means the state is compressed
   {
-    lzo_uint i = 0;
-    while (true)
-    {
-      lzo_uint32 cur_len = 0;
-      lzo_uint out_len = 0;
-
-      if ((i + IN_LEN) >= buffer_size)
-      {
-        cur_len = (lzo_uint32)(buffer_size - i);
-      }
-      else
-      {
-        cur_len = IN_LEN;
-      }
-
-      if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-        PanicAlertT("Internal LZO Error - compression failed");
-
-      // The size of the data to write is 'out_len'
-      f.WriteArray((lzo_uint32*)&out_len, 1);
-      f.WriteBytes(out, out_len);
-
-      if (cur_len != IN_LEN)
-        break;
-
-      i += cur_len;
-    }
+    WriteCompressedChunks(f, buffer_data, buffer_size);
   }
   else  // uncompressed
   {
@@ -392,45 +568,187 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
   Host_UpdateMainFrame();
 }
 
-void SaveAs(const std::string& filename, bool wait)
+// Returns the base state which a delta state file refers to, or an empty string. Only the
+// beginning of the state is decompressed.
+static std::string ReadDeltaBaseFilename(const std::string& filename)
 {
-  Core::RunAsCPUThread([&] {
-    // Measure the size of the buffer.
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-    DoState(p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
+  File::IOFile f(filename, "rb");
+  StateHeader header;
+  if (!f.ReadArray(&header, 1))
+    return "";
 
-    // Then actually do the write.
+  std::vector<u8> data;
+  if (header.size != 0)
+  {
+    // The legacy format predates delta states
+    ChunkedStateHeader chunk_header;
+    if (!f.ReadArray(&chunk_header, 1) || chunk_header.empty_block_size != 0 ||
+        chunk_header.magic != CHUNKED_STATE_MAGIC ||
+        chunk_header.version != CHUNKED_STATE_VERSION || chunk_header.chunk_size == 0 ||
+        chunk_header.chunk_size > CHUNK_SIZE)
     {
-      std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-      g_current_buffer.resize(buffer_size);
-      ptr = &g_current_buffer[0];
-      p.SetMode(PointerWrap::MODE_WRITE);
-      DoState(p);
+      return "";
     }
 
-    if (p.GetMode() == PointerWrap::MODE_WRITE)
-    {
-      Core::DisplayMessage("Saving State...", 1000);
+    data.resize(std::min(chunk_header.chunk_size, header.size));
+    if (!ReadCompressedChunks(f, data.data(), data.size(), chunk_header.chunk_size))
+      return "";
+  }
+  else
+  {
+    data.resize(static_cast<size_t>(std::min<u64>(CHUNK_SIZE, f.GetSize() - sizeof(header))));
+    if (!f.ReadBytes(data.data(), data.size()))
+      return "";
+  }
 
-      CompressAndDumpState_args save_args;
-      save_args.buffer_vector = &g_current_buffer;
-      save_args.buffer_mutex = &g_cs_current_buffer;
-      save_args.filename = filename;
-      save_args.wait = wait;
+  // The start of DoState: the version cookie and string, is_wii and the delta base filename
+  size_t offset = 0;
+  const auto read = [&](void* value, size_t size) {
+    if (data.size() - offset < size)
+      return false;
+    std::memcpy(value, data.data() + offset, size);
+    offset += size;
+    return true;
+  };
+  const auto read_string = [&](std::string* str) {
+    u32 length;
+    if (!read(&length, sizeof(length)) || data.size() - offset < length)
+      return false;
+    str->assign(reinterpret_cast<const char*>(data.data() + offset), length);
+    offset += length;
+    return true;
+  };
+
+  u32 cookie;
+  std::string version_created_by;
+  u8 is_wii;
+  std::string delta_base_filename;
+  if (!read(&cookie, sizeof(cookie)) || cookie != STATE_VERSION + STATE_COOKIE_BASE ||
+      !read_string(&version_created_by) || !read(&is_wii, sizeof(is_wii)) ||
+      !read_string(&delta_base_filename))
+  {
+    return "";
+  }
 
-      Flush();
-      g_save_thread = std::thread(CompressAndDumpState, save_args);
-      g_compressAndDumpStateSyncEvent.Wait();
+  return delta_base_filename;
+}
 
-      g_last_filename = filename;
+// Every session creates a new base for its delta states. Bases which no state in the state
+// directory refers to any more are deleted, so that they don't pile up. This decompresses the
+// beginning of every state, so it runs on its own thread. States saved in the meantime can only
+// refer to the current base, which is never deleted.
+static void DeleteUnusedDeltaBases(const std::string& current_base_filename)
+{
+  Common::SetCurrentThreadName("Delta base cleanup thread");
+
+  const auto get_name = [](const std::string& path) {
+    std::string name, extension;
+    SplitPath(path, nullptr, &name, &extension);
+    return name + extension;
+  };
+
+  std::set<std::string> used_bases{get_name(current_base_filename)};
+  std::vector<std::string> bases;
+  for (const std::string& path :
+       Common::DoFileSearch({File::GetUserPath(D_STATESAVES_IDX)}, {}, false))
+  {
+    if (File::IsDirectory(path) || StringEndsWith(path, ".dtm"))
+      continue;
+
+    if (StringEndsWith(path, ".base"))
+    {
+      bases.push_back(path);
+      continue;
     }
-    else
+
+    const std::string delta_base_filename = ReadDeltaBaseFilename(path);
+    if (!delta_base_filename.empty())
+      used_bases.insert(get_name(delta_base_filename));
+  }
+
+  for (const std::string& path : bases)
+  {
+    if (!used_bases.count(get_name(path)))
+      File::Delete(path);
+  }
+}
+
+static std::string MakeDeltaBaseFilename(double time);
+
+// Must be called on the CPU thread.
+static bool SaveStateFile(const std::string& filename, double time, bool wait, bool is_delta_base)
+{
+  // Measure the size of the buffer.
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  DoState(p);
+  const size_t buffer_size = reinterpret_cast<size_t>(ptr);
+
+  // Then actually do the write. RAM can be left to the save thread, in which case emulation
+  // continues while it is still being copied.
+  const bool snapshot = SConfig::GetInstance().bAsyncSaveStates && !s_saving_delta_state &&
+                        Memory::CanSnapshotAsynchronously();
+  {
+    std::lock_guard<std::mutex> lk(g_cs_current_buffer);
+    g_current_buffer.resize(buffer_size);
+    ptr = &g_current_buffer[0];
+    p.SetMode(PointerWrap::MODE_WRITE);
+    Memory::SetSnapshotEnabled(snapshot);
+    DoState(p);
+    Memory::SetSnapshotEnabled(false);
+  }
+
+  if (p.GetMode() != PointerWrap::MODE_WRITE)
+  {
+    Memory::CompleteSnapshot();
+    // someone aborted the save by changing the mode?
+    Core::DisplayMessage("Unable to save: Internal DoState Error", 4000);
+    return false;
+  }
+
+  Core::DisplayMessage("Saving State...", 1000);
+
+  CompressAndDumpState_args save_args;
+  save_args.buffer_vector = &g_current_buffer;
+  save_args.buffer_mutex = &g_cs_current_buffer;
+  save_args.filename = filename;
+  save_args.time = time;
+  save_args.wait = wait;
+  save_args.is_delta_base = is_delta_base;
+
+  Flush();
+  g_save_thread = std::thread(CompressAndDumpState, save_args);
+  g_compressAndDumpStateSyncEvent.Wait();
+  return true;
+}
+
+void SaveAs(const std::string& filename, bool wait)
+{
+  Core::RunAsCPUThread([&] {
+    // Only states in the state directory can be delta states, since that's the only place
+    // DeleteUnusedDeltaBases looks for states which still need a base.
+    const bool delta = SConfig::GetInstance().bDeltaSaveStates && Memory::CanTrackWrites() &&
+                       StringBeginsWith(filename, File::GetUserPath(D_STATESAVES_IDX));
+    if (delta && s_delta_base.filename.empty())
     {
-      // someone aborted the save by changing the mode?
-      Core::DisplayMessage("Unable to save: Internal DoState Error", 4000);
+      // The first delta state of a session needs a full state to refer to. Every base gets
+      // its own file, so that delta states from earlier sessions stay loadable.
+      const double time = Common::Timer::GetDoubleTime();
+      const std::string base_filename = MakeDeltaBaseFilename(time);
+      if (SaveStateFile(base_filename, time, false, true))
+      {
+        s_delta_base = {base_filename, time};
+        Memory::CaptureDeltaBase();
+        if (s_delta_cleanup_thread.joinable())
+          s_delta_cleanup_thread.join();
+        s_delta_cleanup_thread = std::thread(DeleteUnusedDeltaBases, base_filename);
+      }
     }
+
+    s_saving_delta_state = delta && !s_delta_base.filename.empty();
+    if (SaveStateFile(filename, Common::Timer::GetDoubleTime(), wait, false))
+      g_last_filename = filename;
+    s_saving_delta_state = false;
   });
 }
 
@@ -489,6 +807,32 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
     buffer.resize(header.size);
 
+    ChunkedStateHeader chunk_header;
+    if (f.ReadArray(&chunk_header.empty_block_size, 1) && chunk_header.empty_block_size == 0)
+    {
+      if (!f.ReadArray(&chunk_header.magic, 1) || chunk_header.magic != CHUNKED_STATE_MAGIC ||
+          !f.ReadArray(&chunk_header.version, 1) ||
+          chunk_header.version != CHUNKED_STATE_VERSION ||
+          !f.ReadArray(&chunk_header.chunk_size, 1) || chunk_header.chunk_size == 0)
+      {
+        Core::DisplayMessage("Unable to load: Unknown savestate format", 4000);
+        return;
+      }
+
+      if (!ReadCompressedChunks(f, buffer.data(), buffer.size(), chunk_header.chunk_size))
+      {
+        PanicAlertT("Internal LZO Error - decompression failed\n"
+                    "Try loading the state again");
+        return;
+      }
+
+      ret_data.swap(buffer);
+      return;
+    }
+
+    // Legacy format: a single stream of LZO blocks.
+    f.Seek(sizeof(StateHeader), SEEK_SET);
+
     lzo_uint i = 0;
     while (true)
     {
@@ -639,6 +983,10 @@ void Shutdown()
 {
   Flush();
 
+  if (s_delta_cleanup_thread.joinable())
+    s_delta_cleanup_thread.join();
+  s_delta_base = {};
+
   // swapping with an empty vector, rather than clear()ing
   // this gives a better guarantee to free the allocated memory right NOW (as opposed to, actually,
   // never)
@@ -659,6 +1007,14 @@ static std::string MakeStateFilename(int number)
                           SConfig::GetInstance().GetGameID().c_str(), number);
 }
 
+static std::string MakeDeltaBaseFilename(double time)
+{
+  return StringFromFormat("%s%s.%016" PRIx64 ".base",
+                          File::GetUserPath(D_STATESAVES_IDX).c_str(),
+                          SConfig::GetInstance().GetGameID().c_str(),
+                          static_cast<u64>(time * 1000));
+}
+
 void Save(int slot, bool wait)
 {
   SaveAs(MakeStateFilename(slot), wait);
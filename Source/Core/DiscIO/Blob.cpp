@@ -3,19 +3,25 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Common/CDUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/ThreadPool.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
 #include "DiscIO/CompressedBlob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/DirectoryBlob.h"
 #include "DiscIO/DriveBlob.h"
 #include "DiscIO/FileBlob.h"
@@ -24,8 +30,26 @@
 
 namespace DiscIO
 {
+static std::atomic<u32> s_readahead_size{0};
+
+// Readahead only kicks in after this many reads in a row continued where the previous one ended.
+static constexpr u32 SEQUENTIAL_READS_THRESHOLD = 2;
+
+static Common::ThreadPool& GetReadaheadPool()
+{
+  static Common::ThreadPool pool(std::min<u32>(4, Common::ThreadPool::GetDefaultThreadCount()),
+                                 "Readahead worker");
+  return pool;
+}
+
+void SetReadaheadSize(u32 size)
+{
+  s_readahead_size = size;
+}
+
 void SectorReader::SetSectorSize(int blocksize)
 {
+  ClearPrefetches();
   m_block_size = std::max(blocksize, 0);
   for (auto& cache_entry : m_cache)
   {
@@ -82,7 +106,23 @@ const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
   Cache* cache = GetEmptyCacheLine();
   // We only read aligned chunks, this avoids duplicate overlapping entries.
   u64 chunk_idx = block_num / m_chunk_blocks;
-  u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
+  u32 blocks_read = 0;
+
+  auto prefetch = m_prefetches.find(chunk_idx);
+  if (prefetch != m_prefetches.end())
+  {
+    prefetch->second.done.get();
+    cache->data.swap(prefetch->second.data);
+    blocks_read = prefetch->second.num_blocks;
+    m_prefetches.erase(prefetch);
+  }
+
+  // Also retry failed prefetches, so that errors get reported from here
+  if (!blocks_read)
+  {
+    std::lock_guard<std::mutex> lk(m_read_lock);
+    blocks_read = ReadChunk(cache->data.data(), chunk_idx);
+  }
   if (!blocks_read)
     return nullptr;
   cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
@@ -96,6 +136,8 @@ const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
 
 bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
 {
+  UpdateReadahead(offset, size);
+
   u64 remain = size;
   u64 block = 0;
   u32 position_in_block = static_cast<u32>(offset % m_block_size);
@@ -136,6 +178,122 @@ bool SectorReader::ReadMultipleAlignedBlocks(u64 block_num, u64 cnt_blocks, u8*
   return true;
 }
 
+bool SectorReader::FetchBlock(u64 block_num, StoredBlock* block)
+{
+  block->data.resize(m_block_size);
+  block->is_decoded = true;
+  return GetBlock(block_num, block->data.data());
+}
+
+bool SectorReader::DecodeBlock(u64 block_num, const StoredBlock& block, u8* out_ptr) const
+{
+  std::copy(block.data.begin(), block.data.end(), out_ptr);
+  return true;
+}
+
+void SectorReader::StopReadahead()
+{
+  m_readahead_enabled = false;
+  ClearPrefetches();
+}
+
+void SectorReader::ClearPrefetches()
+{
+  for (auto& prefetch : m_prefetches)
+    prefetch.second.done.wait();
+  m_prefetches.clear();
+}
+
+u64 SectorReader::GetNumChunks() const
+{
+  const u64 chunk_size = static_cast<u64>(m_chunk_blocks) * m_block_size;
+  return (GetDataSize() + chunk_size - 1) / chunk_size;
+}
+
+void SectorReader::UpdateReadahead(u64 offset, u64 size)
+{
+  if (!m_readahead_enabled || size == 0)
+    return;
+
+  // Small skips forward still count as sequential, since games tend to skip over headers
+  // and padding while streaming.
+  const u64 chunk_size = static_cast<u64>(m_chunk_blocks) * m_block_size;
+  if (offset >= m_next_sequential_offset && offset - m_next_sequential_offset <= chunk_size)
+    ++m_sequential_reads;
+  else
+    m_sequential_reads = 0;
+  m_next_sequential_offset = offset + size;
+
+  const u32 readahead_size = s_readahead_size;
+  const u64 current_chunk = offset / chunk_size;
+  const u64 first_chunk = (offset + size - 1) / chunk_size + 1;
+  const u64 window = std::max<u64>(1, readahead_size / chunk_size);
+  const u64 last_chunk = std::min(first_chunk + window, GetNumChunks());
+
+  // Drop the chunks which the reads have moved away from. Prefetches that are still running
+  // can't be cancelled, so they are dropped later instead of waiting for them here.
+  for (auto it = m_prefetches.begin(); it != m_prefetches.end();)
+  {
+    const bool in_window = it->first >= current_chunk && it->first < last_chunk;
+    if (!in_window && it->second.done.wait_for(std::chrono::seconds(0)) ==
+                          std::future_status::ready)
+    {
+      it = m_prefetches.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  if (readahead_size == 0 || m_sequential_reads < SEQUENTIAL_READS_THRESHOLD)
+    return;
+
+  for (u64 chunk = first_chunk; chunk < last_chunk && m_prefetches.size() < window * 2; ++chunk)
+  {
+    const u64 block = chunk * m_chunk_blocks;
+    if (m_prefetches.count(chunk) ||
+        std::any_of(m_cache.begin(), m_cache.end(),
+                    [block](const Cache& line) { return line.Contains(block); }))
+    {
+      continue;
+    }
+
+    Prefetch& prefetch = m_prefetches[chunk];
+    prefetch.data.resize(chunk_size);
+    prefetch.done = GetReadaheadPool().Schedule([this, &prefetch, chunk] {
+      prefetch.num_blocks = PrefetchChunk(prefetch.data.data(), chunk);
+    });
+  }
+}
+
+u32 SectorReader::PrefetchChunk(u8* buffer, u64 chunk_num)
+{
+  const u64 block_num = chunk_num * m_chunk_blocks;
+  const u64 end_block = (GetDataSize() + m_block_size - 1) / m_block_size;
+  if (block_num >= end_block)
+    return 0;
+  const u32 cnt_blocks = static_cast<u32>(std::min<u64>(m_chunk_blocks, end_block - block_num));
+
+  std::vector<StoredBlock> blocks(cnt_blocks);
+  {
+    std::lock_guard<std::mutex> lk(m_read_lock);
+    for (u32 i = 0; i < cnt_blocks; ++i)
+    {
+      if (!FetchBlock(block_num + i, &blocks[i]))
+        return 0;
+    }
+  }
+
+  for (u32 i = 0; i < cnt_blocks; ++i)
+  {
+    if (!DecodeBlock(block_num + i, blocks[i], buffer + i * m_block_size))
+      return 0;
+  }
+  std::fill(buffer + cnt_blocks * m_block_size, buffer + m_chunk_blocks * m_block_size, 0u);
+  return cnt_blocks;
+}
+
 u32 SectorReader::ReadChunk(u8* buffer, u64 chunk_num)
 {
   u64 block_num = chunk_num * m_chunk_blocks;
@@ -196,6 +354,8 @@ std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename)
   {
   case CISO_MAGIC:
     return CISOFileReader::Create(std::move(file));
+  case DCZ_MAGIC:
+    return DCZFileReader::Create(std::move(file), filename);
   case GCZ_MAGIC:
     return CompressedBlobReader::Create(std::move(file), filename);
   case TGC_MAGIC:
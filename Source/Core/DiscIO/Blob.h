@@ -15,7 +15,10 @@
 // automatically do the right thing.
 
 #include <array>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
@@ -34,7 +37,8 @@ enum class BlobType
   GCZ,
   CISO,
   WBFS,
-  TGC
+  TGC,
+  DCZ
 };
 
 class BlobReader
@@ -94,6 +98,22 @@ protected:
   // overridden in derived classes where possible.
   virtual bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr);
 
+  // Readahead splits reading a block into two steps so that blocks can be decoded on several
+  // threads at once. FetchBlock does the file I/O and never runs concurrently with other reads,
+  // DecodeBlock must be thread-safe. By default, FetchBlock does all of the work.
+  struct StoredBlock
+  {
+    std::vector<u8> data;
+    bool is_decoded = false;
+  };
+  virtual bool FetchBlock(u64 block_num, StoredBlock* block);
+  virtual bool DecodeBlock(u64 block_num, const StoredBlock& block, u8* out_ptr) const;
+
+  // Readers that enable readahead must call StopReadahead in their destructor,
+  // since pending prefetches call into the functions above.
+  void EnableReadahead() { m_readahead_enabled = true; }
+  void StopReadahead();
+
 private:
   struct Cache
   {
@@ -148,15 +168,40 @@ private:
   // evenly divisible into chunks). Returns zero if it fails.
   u32 ReadChunk(u8* buffer, u64 chunk_num);
 
+  struct Prefetch
+  {
+    std::vector<u8> data;
+    u32 num_blocks = 0;
+    std::future<void> done;
+  };
+
+  // Watches for sequential reads and queues the following chunks on the readahead workers.
+  void UpdateReadahead(u64 offset, u64 size);
+  // Same as ReadChunk, but runs on a readahead worker.
+  u32 PrefetchChunk(u8* buffer, u64 chunk_num);
+  void ClearPrefetches();
+  u64 GetNumChunks() const;
+
   static constexpr int CACHE_LINES = 32;
   u32 m_block_size = 0;    // Bytes in a sector/block
   u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
   std::array<Cache, CACHE_LINES> m_cache;
+
+  // Serializes FetchBlock and all other file access between Read and the readahead workers.
+  std::mutex m_read_lock;
+  bool m_readahead_enabled = false;
+  std::map<u64, Prefetch> m_prefetches;
+  u64 m_next_sequential_offset = 0;
+  u32 m_sequential_reads = 0;
 };
 
 // Factory function - examines the path to choose the right type of BlobReader, and returns one.
 std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename);
 
+// How many bytes SectorReader based blobs decode ahead of time once they notice sequential
+// reads. 0 disables readahead.
+void SetReadaheadSize(u32 size);
+
 typedef bool (*CompressCB)(const std::string& text, float percent, void* arg);
 
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
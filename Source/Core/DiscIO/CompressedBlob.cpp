@@ -11,6 +11,8 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
+#include <deque>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,6 +26,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
@@ -56,6 +59,8 @@ CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string&
   // I still add some safety margin.
   const u32 zlib_buffer_size = m_header.block_size + 64;
   m_zlib_buffer.resize(zlib_buffer_size);
+
+  EnableReadahead();
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile file,
@@ -70,6 +75,7 @@ std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(File::IOFile
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+  StopReadahead();
 }
 
 // IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
@@ -87,7 +93,30 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-  bool uncompressed = false;
+  bool uncompressed;
+  return ReadCompressedBlock(block_num, &m_zlib_buffer, &uncompressed) &&
+         DecompressBlock(block_num, m_zlib_buffer, uncompressed, out_ptr);
+}
+
+bool CompressedBlobReader::FetchBlock(u64 block_num, StoredBlock* block)
+{
+  bool uncompressed;
+  if (!ReadCompressedBlock(block_num, &block->data, &uncompressed))
+    return false;
+  block->is_decoded = uncompressed;
+  return true;
+}
+
+bool CompressedBlobReader::DecodeBlock(u64 block_num, const StoredBlock& block,
+                                       u8* out_ptr) const
+{
+  return DecompressBlock(block_num, block.data, block.is_decoded, out_ptr);
+}
+
+bool CompressedBlobReader::ReadCompressedBlock(u64 block_num, std::vector<u8>* data,
+                                               bool* uncompressed)
+{
+  *uncompressed = false;
   u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
   u64 offset = m_block_pointers[block_num] + m_data_offset;
 
@@ -95,15 +124,13 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   {
     if (comp_block_size != m_header.block_size)
       PanicAlert("Uncompressed block with wrong size");
-    uncompressed = true;
+    *uncompressed = true;
     offset &= ~(1ULL << 63);
   }
 
-  // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
-
+  data->resize(comp_block_size);
   m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  if (!m_file.ReadBytes(data->data(), comp_block_size))
   {
     PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
                 m_file_name.c_str());
@@ -111,8 +138,16 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     return false;
   }
 
+  return true;
+}
+
+bool CompressedBlobReader::DecompressBlock(u64 block_num, const std::vector<u8>& data,
+                                           bool uncompressed, u8* out_ptr) const
+{
+  const u32 comp_block_size = static_cast<u32>(data.size());
+
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(data.data(), comp_block_size);
   if (block_hash != m_hashes[block_num])
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
@@ -120,12 +155,12 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 
   if (uncompressed)
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    std::copy(data.begin(), data.end(), out_ptr);
   }
   else
   {
     z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
+    z.next_in = const_cast<u8*>(data.data());
     z.avail_in = comp_block_size;
     if (z.avail_in > m_header.block_size)
     {
@@ -152,6 +187,79 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   return true;
 }
 
+// Blocks are (de)compressed in groups on a thread pool. The calling thread reads the input and
+// writes the finished groups in order, with only a few groups per worker in flight, so the
+// output is exactly the same as when processing one block after another.
+static u32 GetBlocksPerGroup(u32 block_size)
+{
+  return std::max<u32>(1, 0x100000 / block_size);
+}
+
+struct CompressionGroup
+{
+  std::vector<u8> input;
+  std::vector<u8> output;
+  std::vector<u32> sizes;
+  std::vector<bool> stored;
+  std::vector<u32> hashes;
+  bool success = false;
+  std::future<void> done;
+};
+
+static bool CompressGroup(CompressionGroup* group, u32 block_size)
+{
+  z_stream z = {};
+  if (deflateInit(&z, 9) != Z_OK)
+    return false;
+
+  std::vector<u8> out_buf(block_size);
+  const size_t num_blocks = group->input.size() / block_size;
+  for (size_t i = 0; i < num_blocks; ++i)
+  {
+    u8* in_buf = group->input.data() + i * block_size;
+
+    int retval = deflateReset(&z);
+    z.next_in = in_buf;
+    z.avail_in = block_size;
+    z.next_out = out_buf.data();
+    z.avail_out = block_size;
+
+    if (retval != Z_OK)
+    {
+      ERROR_LOG(DISCIO, "Deflate failed");
+      deflateEnd(&z);
+      return false;
+    }
+
+    int status = deflate(&z, Z_FINISH);
+    u32 comp_size = block_size - z.avail_out;
+
+    const u8* write_buf;
+    u32 write_size;
+    const bool store = (status != Z_STREAM_END) || (z.avail_out < 10);
+    if (store)
+    {
+      // let's store uncompressed
+      write_buf = in_buf;
+      write_size = block_size;
+    }
+    else
+    {
+      // let's store compressed
+      write_buf = out_buf.data();
+      write_size = comp_size;
+    }
+
+    group->output.insert(group->output.end(), write_buf, write_buf + write_size);
+    group->sizes.push_back(write_size);
+    group->stored.push_back(store);
+    group->hashes.push_back(HashAdler32(write_buf, write_size));
+  }
+
+  deflateEnd(&z);
+  return true;
+}
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type, int block_size, CompressCB callback, void* arg)
 {
@@ -193,10 +301,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
-
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
@@ -210,8 +314,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -222,19 +324,58 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   // Now we are ready to write compressed data!
   u64 position = 0;
-  int num_compressed = 0;
-  int num_stored = 0;
-  int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
+  u32 num_written = 0;
+  u32 progress_monitor = std::max<u32>(1, header.num_blocks / 1000);
+  u32 next_progress_update = 0;
   bool success = true;
 
-  for (u32 i = 0; i < header.num_blocks; i++)
+  Common::ThreadPool pool(0, "GCZ compression");
+  const size_t max_groups_in_flight = pool.GetThreadCount() * 2;
+  const u32 blocks_per_group = GetBlocksPerGroup(block_size);
+  std::deque<CompressionGroup> groups;
+
+  // Always removes the group, so that nothing waits for its future again after an error
+  const auto write_oldest_group = [&] {
+    groups.front().done.get();
+    const CompressionGroup group = std::move(groups.front());
+    groups.pop_front();
+    if (!group.success)
+      return false;
+
+    for (size_t i = 0; i < group.sizes.size(); ++i, ++num_written)
+    {
+      offsets[num_written] = position;
+      if (group.stored[i])
+        offsets[num_written] |= 0x8000000000000000ULL;
+      hashes[num_written] = group.hashes[i];
+      position += group.sizes[i];
+    }
+
+    if (!outfile.WriteBytes(group.output.data(), group.output.size()))
+    {
+      PanicAlertT("Failed to write the output file \"%s\".\n"
+                  "Check that you have enough space available on the target drive.",
+                  outfile_path.c_str());
+      return false;
+    }
+
+    return true;
+  };
+
+  for (u32 i = 0; i < header.num_blocks && success; i += blocks_per_group)
   {
-    if (i % progress_monitor == 0)
+    if (groups.size() == max_groups_in_flight && !write_oldest_group())
+    {
+      success = false;
+      break;
+    }
+
+    if (i >= next_progress_update)
     {
-      const u64 inpos = infile.Tell();
+      next_progress_update = i + progress_monitor;
       int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
+      if (num_written != 0)
+        ratio = (int)(100 * position / ((u64)num_written * block_size));
 
       std::string temp =
           StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
@@ -247,64 +388,39 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
       }
     }
 
-    offsets[i] = position;
-
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
+    const u32 num_blocks = std::min(blocks_per_group, header.num_blocks - i);
+    groups.emplace_back();
+    CompressionGroup& group = groups.back();
+    group.input.resize(static_cast<size_t>(num_blocks) * block_size);
+    for (u32 j = 0; j < num_blocks; ++j)
     {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
+      u8* in_buf = group.input.data() + static_cast<size_t>(j) * block_size;
+      size_t read_bytes;
+      if (scrubbing)
+        read_bytes = disc_scrubber.GetNextBlock(infile, in_buf);
+      else
+        infile.ReadArray(in_buf, header.block_size, &read_bytes);
+      if (read_bytes < header.block_size)
+        std::fill(in_buf + read_bytes, in_buf + header.block_size, 0);
     }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
+    group.done = pool.Schedule([&group, block_size] {
+      group.success = CompressGroup(&group, block_size);
+      std::vector<u8>().swap(group.input);
+    });
+  }
 
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
+  while (!groups.empty())
+  {
+    if (success)
     {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
+      success = write_oldest_group();
     }
     else
     {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
+      groups.front().done.get();
+      groups.pop_front();
     }
-
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
-
-    position += write_size;
-
-    hashes[i] = HashAdler32(write_buf, write_size);
   }
 
   header.compressed_data_size = position;
@@ -324,9 +440,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
@@ -334,6 +447,16 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   return success;
 }
 
+struct DecompressionGroup
+{
+  u64 first_block;
+  std::vector<std::vector<u8>> blocks;
+  std::vector<bool> uncompressed;
+  std::vector<u8> output;
+  bool success = false;
+  std::future<void> done;
+};
+
 bool DecompressBlobToFile(const std::string& infile_path, const std::string& outfile_path,
                           CompressCB callback, void* arg)
 {
@@ -366,35 +489,95 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
   }
 
   const CompressedBlobHeader& header = reader->GetHeader();
-  static const size_t BUFFER_BLOCKS = 32;
-  size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-  size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-  std::vector<u8> buffer(buffer_size);
-  u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
-  int progress_monitor = std::max<int>(1, num_buffers / 100);
+  const u32 blocks_per_group = GetBlocksPerGroup(header.block_size);
+  const u32 num_groups = (header.num_blocks + blocks_per_group - 1) / blocks_per_group;
+  u32 progress_monitor = std::max<u32>(1, num_groups / 100);
   bool success = true;
 
-  for (u64 i = 0; i < num_buffers; i++)
+  Common::ThreadPool pool(0, "GCZ decompression");
+  const size_t max_groups_in_flight = pool.GetThreadCount() * 2;
+  std::deque<DecompressionGroup> groups;
+
+  // Always removes the group, so that nothing waits for its future again after an error
+  const auto write_oldest_group = [&] {
+    groups.front().done.get();
+    const DecompressionGroup group = std::move(groups.front());
+    groups.pop_front();
+    if (!group.success)
+      return false;
+
+    if (!outfile.WriteBytes(group.output.data(), group.output.size()))
+    {
+      PanicAlertT("Failed to write the output file \"%s\".\n"
+                  "Check that you have enough space available on the target drive.",
+                  outfile_path.c_str());
+      return false;
+    }
+
+    return true;
+  };
+
+  for (u32 i = 0; i < num_groups; i++)
   {
+    if (groups.size() == max_groups_in_flight && !write_oldest_group())
+    {
+      success = false;
+      break;
+    }
+
     if (i % progress_monitor == 0)
     {
-      bool was_cancelled = !callback(GetStringT("Unpacking"), (float)i / (float)num_buffers, arg);
+      bool was_cancelled = !callback(GetStringT("Unpacking"), (float)i / (float)num_groups, arg);
       if (was_cancelled)
       {
         success = false;
         break;
       }
     }
-    const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-    reader->Read(i * buffer_size, sz, buffer.data());
-    if (!outfile.WriteBytes(buffer.data(), sz))
+
+    const u64 first_block = static_cast<u64>(i) * blocks_per_group;
+    const u32 num_blocks =
+        static_cast<u32>(std::min<u64>(blocks_per_group, header.num_blocks - first_block));
+    groups.emplace_back();
+    DecompressionGroup& group = groups.back();
+    group.first_block = first_block;
+    group.blocks.resize(num_blocks);
+    group.uncompressed.resize(num_blocks);
+    for (u32 j = 0; j < num_blocks && success; ++j)
     {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
+      bool uncompressed;
+      success = reader->ReadCompressedBlock(first_block + j, &group.blocks[j], &uncompressed);
+      group.uncompressed[j] = uncompressed;
+    }
+    if (!success)
+    {
+      groups.pop_back();
       break;
     }
+
+    group.output.resize(static_cast<size_t>(num_blocks) * header.block_size);
+    group.done = pool.Schedule([&group, &reader, &header] {
+      group.success = true;
+      for (size_t j = 0; j < group.blocks.size() && group.success; ++j)
+      {
+        group.success = reader->DecompressBlock(group.first_block + j, group.blocks[j],
+                                                group.uncompressed[j],
+                                                group.output.data() + j * header.block_size);
+      }
+    });
+  }
+
+  while (!groups.empty())
+  {
+    if (success)
+    {
+      success = write_oldest_group();
+    }
+    else
+    {
+      groups.front().done.get();
+      groups.pop_front();
+    }
   }
 
   if (!success)
@@ -54,6 +54,16 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+  // GetBlock split into its two steps. Only DecompressBlock may be called from several threads
+  // at once.
+  bool ReadCompressedBlock(u64 block_num, std::vector<u8>* data, bool* uncompressed);
+  bool DecompressBlock(u64 block_num, const std::vector<u8>& data, bool uncompressed,
+                       u8* out_ptr) const;
+
+protected:
+  bool FetchBlock(u64 block_num, StoredBlock* block) override;
+  bool DecodeBlock(u64 block_num, const StoredBlock& block, u8* out_ptr) const override;
+
 private:
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
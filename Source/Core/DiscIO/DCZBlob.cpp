@@ -0,0 +1,740 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/DCZBlob.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace DiscIO
+{
+static constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
+static constexpr u32 CLUSTER_HEADER_SIZE = VolumeWii::BLOCK_HEADER_SIZE;
+static constexpr u32 CLUSTER_DATA_SIZE = VolumeWii::BLOCK_DATA_SIZE;
+static constexpr u32 CLUSTER_SIZE = VolumeWii::BLOCK_TOTAL_SIZE;
+static constexpr u32 CLUSTERS_PER_SUBGROUP = 8;
+static constexpr u32 CLUSTERS_PER_GROUP = 64;
+static constexpr u32 SHA1_SIZE = 20;
+
+// Offsets within a decrypted hash block
+static constexpr u32 H0_OFFSET = 0x000;
+static constexpr u32 H0_SIZE = CLUSTER_DATA_SIZE / 0x400 * SHA1_SIZE;
+static constexpr u32 H1_OFFSET = 0x280;
+static constexpr u32 H1_SIZE = CLUSTERS_PER_SUBGROUP * SHA1_SIZE;
+static constexpr u32 H2_OFFSET = 0x340;
+static constexpr u32 H2_SIZE = CLUSTERS_PER_GROUP / CLUSTERS_PER_SUBGROUP * SHA1_SIZE;
+
+// Fills in the decrypted hash blocks of up to one group of clusters, given their decrypted data.
+// Hashes of clusters missing from an incomplete group are left as zeroes.
+static void GenerateHashBlocks(const u8* data, u32 num_clusters, u8* hash_blocks)
+{
+  std::fill(hash_blocks, hash_blocks + num_clusters * CLUSTER_HEADER_SIZE, 0);
+
+  u8 h1[CLUSTERS_PER_GROUP / CLUSTERS_PER_SUBGROUP][H1_SIZE] = {};
+  u8 h2[H2_SIZE] = {};
+
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    u8* hash_block = hash_blocks + i * CLUSTER_HEADER_SIZE;
+    for (u32 j = 0; j < H0_SIZE / SHA1_SIZE; ++j)
+    {
+      mbedtls_sha1(data + i * CLUSTER_DATA_SIZE + j * 0x400, 0x400,
+                   hash_block + H0_OFFSET + j * SHA1_SIZE);
+    }
+    mbedtls_sha1(hash_block + H0_OFFSET, H0_SIZE,
+                 h1[i / CLUSTERS_PER_SUBGROUP] + i % CLUSTERS_PER_SUBGROUP * SHA1_SIZE);
+  }
+
+  const u32 num_subgroups = (num_clusters + CLUSTERS_PER_SUBGROUP - 1) / CLUSTERS_PER_SUBGROUP;
+  for (u32 i = 0; i < num_subgroups; ++i)
+    mbedtls_sha1(h1[i], H1_SIZE, h2 + i * SHA1_SIZE);
+
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    u8* hash_block = hash_blocks + i * CLUSTER_HEADER_SIZE;
+    std::copy(std::begin(h1[i / CLUSTERS_PER_SUBGROUP]), std::end(h1[i / CLUSTERS_PER_SUBGROUP]),
+              hash_block + H1_OFFSET);
+    std::copy(std::begin(h2), std::end(h2), hash_block + H2_OFFSET);
+  }
+}
+
+static void EncryptCluster(mbedtls_aes_context* aes_context, const u8* hash_block, const u8* data,
+                           u8* out_ptr)
+{
+  u8 iv[16] = {};
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_ENCRYPT, CLUSTER_HEADER_SIZE, iv, hash_block,
+                        out_ptr);
+  std::copy(out_ptr + 0x3D0, out_ptr + 0x3E0, iv);
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_ENCRYPT, CLUSTER_DATA_SIZE, iv, data,
+                        out_ptr + CLUSTER_HEADER_SIZE);
+}
+
+static void DecryptCluster(mbedtls_aes_context* aes_context, const u8* in_ptr, u8* hash_block,
+                           u8* data)
+{
+  u8 iv[16] = {};
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, CLUSTER_HEADER_SIZE, iv, in_ptr,
+                        hash_block);
+  std::copy(in_ptr + 0x3D0, in_ptr + 0x3E0, iv);
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, CLUSTER_DATA_SIZE, iv,
+                        in_ptr + CLUSTER_HEADER_SIZE, data);
+}
+
+static u32 ReadNumExceptions(const std::vector<u8>& payload)
+{
+  u32 num_exceptions;
+  std::memcpy(&num_exceptions, payload.data(), sizeof(num_exceptions));
+  return num_exceptions;
+}
+
+static size_t GetPayloadDataOffset(u32 num_exceptions)
+{
+  return sizeof(u32) + static_cast<size_t>(num_exceptions) * sizeof(DCZHashException);
+}
+
+DCZFileReader::DCZFileReader(File::IOFile file, const std::string& filename)
+    : m_file(std::move(file)), m_file_name(filename)
+{
+  m_file_size = m_file.GetSize();
+}
+
+DCZFileReader::~DCZFileReader()
+{
+}
+
+std::unique_ptr<DCZFileReader> DCZFileReader::Create(File::IOFile file,
+                                                     const std::string& filename)
+{
+  std::unique_ptr<DCZFileReader> reader(new DCZFileReader(std::move(file), filename));
+  if (!reader->ReadHeader())
+    return nullptr;
+  return reader;
+}
+
+bool DCZFileReader::ReadHeader()
+{
+  if (!m_file.Seek(0, SEEK_SET) || !m_file.ReadArray(&m_header, 1))
+    return false;
+
+  if (m_header.magic != DCZ_MAGIC || m_header.version != DCZ_VERSION ||
+      m_header.chunk_size == 0 || m_header.chunk_size % DCZ_CHUNK_SIZE_ALIGNMENT != 0 ||
+      (m_header.compression != DCZCompression::None &&
+       m_header.compression != DCZCompression::Deflate))
+  {
+    ERROR_LOG(DISCIO, "DCZ: Unsupported header in %s", m_file_name.c_str());
+    return false;
+  }
+
+  m_regions.resize(m_header.num_regions);
+  m_chunks.resize(m_header.num_chunks);
+  if (!m_file.ReadArray(m_regions.data(), m_regions.size()) ||
+      !m_file.ReadArray(m_chunks.data(), m_chunks.size()))
+  {
+    ERROR_LOG(DISCIO, "DCZ: %s is truncated", m_file_name.c_str());
+    return false;
+  }
+
+  // The regions must cover the disc in order and refer to the chunks in order, so that
+  // FindRegion and the chunk lookups never have to deal with gaps.
+  u64 offset = 0;
+  u32 chunk = 0;
+  for (const DCZRegion& region : m_regions)
+  {
+    if (region.offset != offset || region.first_chunk != chunk ||
+        (region.type != DCZRegionType::Raw && region.type != DCZRegionType::Partition) ||
+        (region.type == DCZRegionType::Partition && region.size % CLUSTER_SIZE != 0))
+    {
+      ERROR_LOG(DISCIO, "DCZ: Invalid region table in %s", m_file_name.c_str());
+      return false;
+    }
+
+    offset += region.size;
+    chunk += static_cast<u32>((region.size + m_header.chunk_size - 1) / m_header.chunk_size);
+  }
+
+  if (offset != m_header.data_size || chunk != m_header.num_chunks)
+  {
+    ERROR_LOG(DISCIO, "DCZ: Invalid region table in %s", m_file_name.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+const DCZRegion* DCZFileReader::FindRegion(u64 offset) const
+{
+  auto it = std::upper_bound(m_regions.begin(), m_regions.end(), offset,
+                             [](u64 o, const DCZRegion& region) { return o < region.offset; });
+  if (it == m_regions.begin())
+    return nullptr;
+
+  --it;
+  return offset - it->offset < it->size ? &*it : nullptr;
+}
+
+u64 DCZFileReader::GetChunkDataSize(const DCZRegion& region, u32 chunk) const
+{
+  const u64 offset_in_region = static_cast<u64>(chunk - region.first_chunk) * m_header.chunk_size;
+  return std::min<u64>(m_header.chunk_size, region.size - offset_in_region);
+}
+
+bool DCZFileReader::LoadPayload(const DCZRegion& region, u32 chunk)
+{
+  if (m_payload_chunk == chunk)
+    return true;
+  m_payload_chunk = UINT32_MAX;
+
+  const DCZChunk& entry = m_chunks[chunk];
+  m_compressed.resize(entry.compressed_size);
+  if (!m_file.Seek(entry.file_offset, SEEK_SET) ||
+      !m_file.ReadBytes(m_compressed.data(), m_compressed.size()))
+  {
+    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                m_file_name.c_str());
+    m_file.Clear();
+    return false;
+  }
+
+  if (HashAdler32(m_compressed.data(), m_compressed.size()) != entry.hash)
+  {
+    PanicAlertT("The disc image \"%s\" is corrupt.", m_file_name.c_str());
+    return false;
+  }
+
+  if (entry.is_stored)
+  {
+    m_payload.swap(m_compressed);
+  }
+  else
+  {
+    m_payload.resize(entry.payload_size);
+    uLongf payload_size = entry.payload_size;
+    if (m_header.compression != DCZCompression::Deflate ||
+        uncompress(m_payload.data(), &payload_size, m_compressed.data(),
+                   static_cast<uLong>(m_compressed.size())) != Z_OK ||
+        payload_size != entry.payload_size)
+    {
+      PanicAlertT("The disc image \"%s\" is corrupt.", m_file_name.c_str());
+      return false;
+    }
+  }
+
+  const u64 data_size = GetChunkDataSize(region, chunk);
+  bool valid_size;
+  if (region.type == DCZRegionType::Partition)
+  {
+    const u64 num_clusters = data_size / CLUSTER_SIZE;
+    valid_size = m_payload.size() >= sizeof(u32) &&
+                 m_payload.size() == GetPayloadDataOffset(ReadNumExceptions(m_payload)) +
+                                         num_clusters * CLUSTER_DATA_SIZE;
+  }
+  else
+  {
+    valid_size = m_payload.size() == data_size;
+  }
+
+  if (!valid_size)
+  {
+    PanicAlertT("The disc image \"%s\" is corrupt.", m_file_name.c_str());
+    return false;
+  }
+
+  m_payload_chunk = chunk;
+  return true;
+}
+
+const std::vector<u8>* DCZFileReader::LoadData(const DCZRegion& region, u32 chunk)
+{
+  if (region.type == DCZRegionType::Raw)
+    return LoadPayload(region, chunk) ? &m_payload : nullptr;
+
+  if (m_data_chunk == chunk)
+    return &m_data;
+  if (!LoadPayload(region, chunk))
+    return nullptr;
+
+  const u32 num_exceptions = ReadNumExceptions(m_payload);
+  const u8* exceptions = m_payload.data() + sizeof(u32);
+  const u8* data = m_payload.data() + GetPayloadDataOffset(num_exceptions);
+  const u32 num_clusters = static_cast<u32>(GetChunkDataSize(region, chunk) / CLUSTER_SIZE);
+
+  mbedtls_aes_context aes_context;
+  mbedtls_aes_setkey_enc(&aes_context, region.title_key, 128);
+
+  m_data.resize(static_cast<size_t>(num_clusters) * CLUSTER_SIZE);
+  std::vector<u8> hash_blocks(CLUSTERS_PER_GROUP * CLUSTER_HEADER_SIZE);
+  for (u32 group = 0; group < num_clusters; group += CLUSTERS_PER_GROUP)
+  {
+    const u32 group_size = std::min(CLUSTERS_PER_GROUP, num_clusters - group);
+    GenerateHashBlocks(data + static_cast<size_t>(group) * CLUSTER_DATA_SIZE, group_size,
+                       hash_blocks.data());
+
+    for (u32 i = 0; i < num_exceptions; ++i)
+    {
+      DCZHashException exception;
+      std::memcpy(&exception, exceptions + i * sizeof(DCZHashException), sizeof(exception));
+      if (exception.cluster >= group && exception.cluster - group < group_size)
+      {
+        std::copy(std::begin(exception.hash_block), std::end(exception.hash_block),
+                  hash_blocks.data() + (exception.cluster - group) * CLUSTER_HEADER_SIZE);
+      }
+    }
+
+    for (u32 i = 0; i < group_size; ++i)
+    {
+      const size_t cluster = group + i;
+      EncryptCluster(&aes_context, hash_blocks.data() + i * CLUSTER_HEADER_SIZE,
+                     data + cluster * CLUSTER_DATA_SIZE, m_data.data() + cluster * CLUSTER_SIZE);
+    }
+  }
+
+  m_data_chunk = chunk;
+  return &m_data;
+}
+
+bool DCZFileReader::Read(u64 offset, u64 size, u8* out_ptr)
+{
+  while (size > 0)
+  {
+    const DCZRegion* region = FindRegion(offset);
+    if (!region)
+      return false;
+
+    const u64 offset_in_region = offset - region->offset;
+    const u32 chunk =
+        region->first_chunk + static_cast<u32>(offset_in_region / m_header.chunk_size);
+    const u64 offset_in_chunk = offset_in_region % m_header.chunk_size;
+
+    const std::vector<u8>* data = LoadData(*region, chunk);
+    if (!data)
+      return false;
+
+    const u64 copy_size = std::min(size, data->size() - offset_in_chunk);
+    std::copy_n(data->data() + offset_in_chunk, copy_size, out_ptr);
+
+    offset += copy_size;
+    size -= copy_size;
+    out_ptr += copy_size;
+  }
+
+  return true;
+}
+
+bool DCZFileReader::SupportsReadWiiDecrypted() const
+{
+  return std::any_of(m_regions.begin(), m_regions.end(), [](const DCZRegion& region) {
+    return region.type == DCZRegionType::Partition;
+  });
+}
+
+bool DCZFileReader::ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset)
+{
+  auto it = std::find_if(m_regions.begin(), m_regions.end(), [=](const DCZRegion& region) {
+    return region.type == DCZRegionType::Partition && region.partition_offset == partition_offset;
+  });
+  if (it == m_regions.end())
+    return false;
+
+  const DCZRegion& region = *it;
+  const u64 clusters_per_chunk = m_header.chunk_size / CLUSTER_SIZE;
+  const u64 num_clusters = region.size / CLUSTER_SIZE;
+  while (size > 0)
+  {
+    const u64 cluster = offset / CLUSTER_DATA_SIZE;
+    if (cluster >= num_clusters)
+      return false;
+
+    const u32 chunk = region.first_chunk + static_cast<u32>(cluster / clusters_per_chunk);
+    if (!LoadPayload(region, chunk))
+      return false;
+
+    const size_t data_offset = GetPayloadDataOffset(ReadNumExceptions(m_payload));
+    const u64 offset_in_chunk =
+        cluster % clusters_per_chunk * CLUSTER_DATA_SIZE + offset % CLUSTER_DATA_SIZE;
+    const u64 copy_size = std::min(size, m_payload.size() - data_offset - offset_in_chunk);
+    std::copy_n(m_payload.data() + data_offset + offset_in_chunk, copy_size, out_ptr);
+
+    offset += copy_size;
+    size -= copy_size;
+    out_ptr += copy_size;
+  }
+
+  return true;
+}
+
+// Partitions are only stored decrypted if that works for all of them. Otherwise the whole disc
+// is stored as is, since a reader which supports ReadWiiDecrypted has to support it for every
+// partition.
+static std::vector<DCZRegion> GetRegions(const Volume* volume, BlobReader* reader,
+                                         u32 chunk_size)
+{
+  const u64 data_size = reader->GetDataSize();
+
+  std::vector<DCZRegion> partitions;
+  if (volume && volume->GetVolumeType() == Platform::WII_DISC)
+  {
+    for (const Partition& partition : volume->GetPartitions())
+    {
+      const IOS::ES::TicketReader& ticket = volume->GetTicket(partition);
+      const std::optional<u32> size_div_4 = reader->ReadSwapped<u32>(partition.offset + 0x2BC);
+      if (!ticket.IsValid() || !size_div_4)
+      {
+        partitions.clear();
+        break;
+      }
+
+      DCZRegion region = {};
+      region.offset = partition.offset + PARTITION_DATA_OFFSET;
+      region.size = static_cast<u64>(*size_div_4) * 4 / CLUSTER_SIZE * CLUSTER_SIZE;
+      region.type = DCZRegionType::Partition;
+      region.partition_offset = partition.offset;
+      const std::array<u8, 16> title_key = ticket.GetTitleKey();
+      std::copy(title_key.begin(), title_key.end(), region.title_key);
+      if (region.size != 0)
+        partitions.push_back(region);
+    }
+
+    std::sort(partitions.begin(), partitions.end(),
+              [](const DCZRegion& a, const DCZRegion& b) { return a.offset < b.offset; });
+    for (size_t i = 0; i < partitions.size(); ++i)
+    {
+      const u64 end = partitions[i].offset + partitions[i].size;
+      const u64 limit = i + 1 < partitions.size() ? partitions[i + 1].offset : data_size;
+      if (end > limit)
+      {
+        WARN_LOG(DISCIO, "DCZ: Overlapping partitions, storing the disc without decrypting it");
+        partitions.clear();
+        break;
+      }
+    }
+  }
+
+  std::vector<DCZRegion> regions;
+  u64 offset = 0;
+  u32 num_chunks = 0;
+  const auto add_region = [&](DCZRegion region) {
+    region.first_chunk = num_chunks;
+    num_chunks += static_cast<u32>((region.size + chunk_size - 1) / chunk_size);
+    offset = region.offset + region.size;
+    regions.push_back(region);
+  };
+
+  for (const DCZRegion& partition : partitions)
+  {
+    if (partition.offset > offset)
+      add_region(DCZRegion{offset, partition.offset - offset, DCZRegionType::Raw});
+    add_region(partition);
+  }
+  if (data_size > offset)
+    add_region(DCZRegion{offset, data_size - offset, DCZRegionType::Raw});
+
+  return regions;
+}
+
+struct ConversionChunk
+{
+  const DCZRegion* region;
+  std::vector<u8> input;
+  bool input_is_encrypted = false;
+  u64 data_size;
+  std::vector<u8> output;
+  DCZChunk entry = {};
+  bool success = false;
+  std::future<void> done;
+};
+
+// Turns the encrypted clusters of a partition chunk into the stored payload.
+static std::vector<u8> BuildPartitionPayload(const DCZRegion& region, const std::vector<u8>& input)
+{
+  mbedtls_aes_context aes_context;
+  mbedtls_aes_setkey_dec(&aes_context, region.title_key, 128);
+
+  const u32 num_clusters = static_cast<u32>(input.size() / CLUSTER_SIZE);
+  std::vector<u8> data(static_cast<size_t>(num_clusters) * CLUSTER_DATA_SIZE);
+  std::vector<u8> hash_blocks(static_cast<size_t>(num_clusters) * CLUSTER_HEADER_SIZE);
+  for (size_t i = 0; i < num_clusters; ++i)
+  {
+    DecryptCluster(&aes_context, input.data() + i * CLUSTER_SIZE,
+                   hash_blocks.data() + i * CLUSTER_HEADER_SIZE,
+                   data.data() + i * CLUSTER_DATA_SIZE);
+  }
+
+  std::vector<u32> exceptions;
+  std::vector<u8> generated(CLUSTERS_PER_GROUP * CLUSTER_HEADER_SIZE);
+  for (u32 group = 0; group < num_clusters; group += CLUSTERS_PER_GROUP)
+  {
+    const u32 group_size = std::min(CLUSTERS_PER_GROUP, num_clusters - group);
+    GenerateHashBlocks(data.data() + static_cast<size_t>(group) * CLUSTER_DATA_SIZE, group_size,
+                       generated.data());
+    for (u32 i = 0; i < group_size; ++i)
+    {
+      if (!std::equal(generated.begin() + i * CLUSTER_HEADER_SIZE,
+                      generated.begin() + (i + 1) * CLUSTER_HEADER_SIZE,
+                      hash_blocks.begin() + (group + i) * CLUSTER_HEADER_SIZE))
+      {
+        exceptions.push_back(group + i);
+      }
+    }
+  }
+
+  const u32 num_exceptions = static_cast<u32>(exceptions.size());
+  std::vector<u8> payload(GetPayloadDataOffset(num_exceptions) + data.size());
+  std::memcpy(payload.data(), &num_exceptions, sizeof(num_exceptions));
+  for (size_t i = 0; i < exceptions.size(); ++i)
+  {
+    DCZHashException exception;
+    exception.cluster = exceptions[i];
+    std::copy_n(hash_blocks.data() + exceptions[i] * CLUSTER_HEADER_SIZE, CLUSTER_HEADER_SIZE,
+                exception.hash_block);
+    std::memcpy(payload.data() + sizeof(u32) + i * sizeof(DCZHashException), &exception,
+                sizeof(exception));
+  }
+  std::copy(data.begin(), data.end(), payload.begin() + GetPayloadDataOffset(num_exceptions));
+
+  return payload;
+}
+
+static bool CompressChunk(ConversionChunk* chunk)
+{
+  std::vector<u8> payload = chunk->input_is_encrypted ?
+                                BuildPartitionPayload(*chunk->region, chunk->input) :
+                                std::move(chunk->input);
+  std::vector<u8>().swap(chunk->input);
+
+  uLongf compressed_size = compressBound(static_cast<uLong>(payload.size()));
+  chunk->output.resize(compressed_size);
+  if (compress2(chunk->output.data(), &compressed_size, payload.data(),
+                static_cast<uLong>(payload.size()), 9) != Z_OK)
+  {
+    ERROR_LOG(DISCIO, "Deflate failed");
+    return false;
+  }
+
+  chunk->entry.payload_size = static_cast<u32>(payload.size());
+  if (compressed_size < payload.size())
+  {
+    chunk->output.resize(compressed_size);
+  }
+  else
+  {
+    chunk->output = std::move(payload);
+    chunk->entry.is_stored = 1;
+  }
+  chunk->entry.compressed_size = static_cast<u32>(chunk->output.size());
+  chunk->entry.hash = HashAdler32(chunk->output.data(), chunk->output.size());
+  return true;
+}
+
+bool ConvertToDCZ(const std::string& infile_path, const std::string& outfile_path, u32 chunk_size,
+                  CompressCB callback, void* arg)
+{
+  if (chunk_size == 0 || chunk_size % DCZ_CHUNK_SIZE_ALIGNMENT != 0)
+  {
+    PanicAlert("Invalid DCZ chunk size %u", chunk_size);
+    return false;
+  }
+
+  std::unique_ptr<BlobReader> reader = CreateBlobReader(infile_path);
+  if (!reader)
+  {
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  if (reader->GetBlobType() == BlobType::DCZ)
+  {
+    PanicAlertT("\"%s\" is already compressed! Cannot compress it further.", infile_path.c_str());
+    return false;
+  }
+
+  File::IOFile outfile(outfile_path, "wb");
+  if (!outfile)
+  {
+    PanicAlertT("Failed to open the output file \"%s\".\n"
+                "Check that you have permissions to write the target folder and that the media can "
+                "be written.",
+                outfile_path.c_str());
+    return false;
+  }
+
+  const std::unique_ptr<Volume> volume = CreateVolumeFromFilename(infile_path);
+  const std::vector<DCZRegion> regions = GetRegions(volume.get(), reader.get(), chunk_size);
+  const bool read_decrypted = reader->SupportsReadWiiDecrypted();
+
+  DCZHeader header = {};
+  header.magic = DCZ_MAGIC;
+  header.version = DCZ_VERSION;
+  header.data_size = reader->GetDataSize();
+  header.chunk_size = chunk_size;
+  header.compression = DCZCompression::Deflate;
+  header.num_regions = static_cast<u32>(regions.size());
+  for (const DCZRegion& region : regions)
+    header.num_chunks += static_cast<u32>((region.size + chunk_size - 1) / chunk_size);
+
+  std::vector<DCZChunk> entries;
+  entries.reserve(header.num_chunks);
+
+  // Seek past the header and tables, they are written at the end
+  u64 position = sizeof(DCZHeader) + sizeof(DCZRegion) * regions.size() +
+                 sizeof(DCZChunk) * static_cast<u64>(header.num_chunks);
+  outfile.Seek(position, SEEK_SET);
+
+  if (callback)
+    callback(GetStringT("Files opened, ready to compress."), 0, arg);
+
+  Common::ThreadPool pool(0, "DCZ compression");
+  const size_t max_chunks_in_flight = pool.GetThreadCount() * 2;
+  std::deque<ConversionChunk> chunks;
+  u64 data_written = 0;
+  u64 compressed_written = 0;
+  bool success = true;
+
+  // Always removes the chunk, so that nothing waits for its future again after an error
+  const auto write_oldest_chunk = [&] {
+    chunks.front().done.get();
+    ConversionChunk chunk = std::move(chunks.front());
+    chunks.pop_front();
+    if (!chunk.success)
+      return false;
+
+    chunk.entry.file_offset = position;
+    position += chunk.output.size();
+    entries.push_back(chunk.entry);
+    data_written += chunk.data_size;
+    compressed_written += chunk.output.size();
+
+    if (!outfile.WriteBytes(chunk.output.data(), chunk.output.size()))
+    {
+      PanicAlertT("Failed to write the output file \"%s\".\n"
+                  "Check that you have enough space available on the target drive.",
+                  outfile_path.c_str());
+      return false;
+    }
+
+    return true;
+  };
+
+  u32 chunk_index = 0;
+  for (const DCZRegion& region : regions)
+  {
+    for (u64 offset = 0; offset < region.size && success; offset += chunk_size, ++chunk_index)
+    {
+      if (chunks.size() == max_chunks_in_flight && !write_oldest_chunk())
+      {
+        success = false;
+        break;
+      }
+
+      if (callback)
+      {
+        int ratio = 0;
+        if (data_written != 0)
+          ratio = static_cast<int>(100 * compressed_written / data_written);
+        const std::string text =
+            StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(),
+                             chunk_index, header.num_chunks, ratio);
+        if (!callback(text, static_cast<float>(chunk_index) / header.num_chunks, arg))
+        {
+          success = false;
+          break;
+        }
+      }
+
+      const u64 size = std::min<u64>(chunk_size, region.size - offset);
+      chunks.emplace_back();
+      ConversionChunk& chunk = chunks.back();
+      chunk.region = &region;
+      chunk.data_size = size;
+      if (region.type == DCZRegionType::Partition && read_decrypted)
+      {
+        // Readers which can provide decrypted data don't have meaningful hash blocks anyway,
+        // so this directly becomes a payload without exceptions.
+        const u64 num_clusters = size / CLUSTER_SIZE;
+        chunk.input.resize(sizeof(u32) + num_clusters * CLUSTER_DATA_SIZE);
+        success = reader->ReadWiiDecrypted(offset / CLUSTER_SIZE * CLUSTER_DATA_SIZE,
+                                           num_clusters * CLUSTER_DATA_SIZE,
+                                           chunk.input.data() + sizeof(u32),
+                                           region.partition_offset);
+      }
+      else
+      {
+        chunk.input.resize(size);
+        chunk.input_is_encrypted = region.type == DCZRegionType::Partition;
+        success = reader->Read(region.offset + offset, size, chunk.input.data());
+      }
+
+      if (!success)
+      {
+        PanicAlertT("Failed to read from the input file \"%s\".", infile_path.c_str());
+        chunks.pop_back();
+        break;
+      }
+
+      chunk.done = pool.Schedule([&chunk] { chunk.success = CompressChunk(&chunk); });
+    }
+
+    if (!success)
+      break;
+  }
+
+  while (!chunks.empty())
+  {
+    if (success)
+    {
+      success = write_oldest_chunk();
+    }
+    else
+    {
+      chunks.front().done.get();
+      chunks.pop_front();
+    }
+  }
+
+  if (success)
+  {
+    outfile.Seek(0, SEEK_SET);
+    success = outfile.WriteArray(&header, 1) &&
+              outfile.WriteArray(regions.data(), regions.size()) &&
+              outfile.WriteArray(entries.data(), entries.size());
+  }
+
+  if (!success)
+  {
+    // Remove the incomplete output file.
+    outfile.Close();
+    File::Delete(outfile_path);
+    return false;
+  }
+
+  if (callback)
+    callback(GetStringT("Done compressing disc image."), 1.0f, arg);
+  return true;
+}
+
+}  // namespace
@@ -0,0 +1,145 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// WARNING Code not big-endian safe.
+
+// To create new DCZ files, use ConvertToDCZ.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+static constexpr u32 DCZ_MAGIC = 0x015A4344;  // "DCZ\x01" (byteswapped to little endian)
+static constexpr u32 DCZ_VERSION = 1;
+
+// One group of Wii clusters shares a H2 hash table, so chunks of partition data must never
+// split a group.
+static constexpr u32 DCZ_CHUNK_SIZE_ALIGNMENT = 0x200000;
+static constexpr u32 DCZ_DEFAULT_CHUNK_SIZE = 0x200000;
+
+// DCZ file structure:
+// DCZHeader
+// DCZRegion regions[num_regions]
+// DCZChunk chunks[num_chunks]
+// compressed chunk data
+//
+// The disc is split into regions, which cover the whole disc without any gaps, and every region
+// is split into chunks of chunk_size disc bytes (the last chunk of a region may be smaller).
+// Chunks are compressed independently, so any part of the disc can be read by decompressing a
+// single chunk.
+//
+// Raw regions store the disc bytes as they are. Partition regions cover the encrypted data of a
+// Wii partition and only store the decrypted 0x7C00 data bytes of every 0x8000 byte cluster,
+// which compress a lot better than encrypted data. The hash blocks are regenerated and all of it
+// is encrypted again when reading. Clusters whose hash block doesn't match the regenerated one
+// (unused clusters filled with garbage, for instance) keep their decrypted hash block:
+//   u32 num_exceptions
+//   DCZHashException exceptions[num_exceptions]
+//   u8 data[num_clusters][0x7C00]
+
+enum class DCZCompression : u32
+{
+  None = 0,
+  Deflate = 1,
+};
+
+enum class DCZRegionType : u32
+{
+  Raw = 0,
+  Partition = 1,
+};
+
+struct DCZHeader  // 32 bytes
+{
+  u32 magic;
+  u32 version;
+  u64 data_size;
+  u32 chunk_size;
+  DCZCompression compression;
+  u32 num_regions;
+  u32 num_chunks;
+};
+
+struct DCZRegion  // 48 bytes
+{
+  u64 offset;
+  u64 size;
+  DCZRegionType type;
+  u32 first_chunk;
+  // Only used for partition regions
+  u64 partition_offset;
+  u8 title_key[16];  // Decrypted
+};
+
+struct DCZChunk  // 24 bytes
+{
+  u64 file_offset;
+  u32 compressed_size;
+  u32 payload_size;  // After decompression
+  u32 is_stored;     // Chunks which don't get smaller are stored without compression
+  u32 hash;          // Adler-32 of the stored bytes
+};
+
+struct DCZHashException
+{
+  u32 cluster;  // Relative to the start of the chunk
+  u8 hash_block[0x400];
+};
+
+class DCZFileReader : public BlobReader
+{
+public:
+  static std::unique_ptr<DCZFileReader> Create(File::IOFile file, const std::string& filename);
+  ~DCZFileReader();
+
+  BlobType GetBlobType() const override { return BlobType::DCZ; }
+  u64 GetDataSize() const override { return m_header.data_size; }
+  u64 GetRawSize() const override { return m_file_size; }
+  bool Read(u64 offset, u64 size, u8* out_ptr) override;
+
+  // Partition data is stored decrypted, so this skips the hashing and encryption entirely.
+  bool SupportsReadWiiDecrypted() const override;
+  bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset) override;
+
+private:
+  DCZFileReader(File::IOFile file, const std::string& filename);
+  bool ReadHeader();
+
+  const DCZRegion* FindRegion(u64 offset) const;
+  u64 GetChunkDataSize(const DCZRegion& region, u32 chunk) const;
+
+  // Decompresses a chunk's stored contents into m_payload.
+  bool LoadPayload(const DCZRegion& region, u32 chunk);
+  // Returns a chunk's disc bytes, which for partition regions get rebuilt into m_data.
+  const std::vector<u8>* LoadData(const DCZRegion& region, u32 chunk);
+
+  DCZHeader m_header;
+  std::vector<DCZRegion> m_regions;
+  std::vector<DCZChunk> m_chunks;
+  File::IOFile m_file;
+  u64 m_file_size;
+  std::string m_file_name;
+
+  std::vector<u8> m_compressed;
+  std::vector<u8> m_payload;
+  u32 m_payload_chunk = UINT32_MAX;
+  std::vector<u8> m_data;
+  u32 m_data_chunk = UINT32_MAX;
+};
+
+// Converts any disc image that CreateBlobReader can read. chunk_size must be a multiple of
+// DCZ_CHUNK_SIZE_ALIGNMENT.
+bool ConvertToDCZ(const std::string& infile_path, const std::string& outfile_path,
+                  u32 chunk_size = DCZ_DEFAULT_CHUNK_SIZE, CompressCB callback = nullptr,
+                  void* arg = nullptr);
+
+}  // namespace
@@ -62,6 +62,8 @@ void AdvancedWidget::CreateWidgets()
   m_load_custom_textures = new GraphicsBool(tr("Load Custom Textures"), Config::GFX_HIRES_TEXTURES);
   m_prefetch_custom_textures =
       new GraphicsBool(tr("Prefetch Custom Textures"), Config::GFX_CACHE_HIRES_TEXTURES);
+  m_cache_decoded_textures =
+      new GraphicsBool(tr("Cache Decoded Textures"), Config::GFX_CACHE_DECODED_TEXTURES);
   m_use_fullres_framedumps = new GraphicsBool(tr("Internal Resolution Frame Dumps"),
                                               Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS);
   m_dump_efb_target = new GraphicsBool(tr("Dump EFB Target"), Config::GFX_DUMP_EFB_TARGET);
@@ -74,8 +76,9 @@ void AdvancedWidget::CreateWidgets()
   utility_layout->addWidget(m_use_fullres_framedumps, 1, 1);
   utility_layout->addWidget(m_dump_efb_target, 2, 0);
   utility_layout->addWidget(m_enable_freelook, 2, 1);
+  utility_layout->addWidget(m_cache_decoded_textures, 3, 0);
 #if defined(HAVE_FFMPEG)
-  utility_layout->addWidget(m_dump_use_ffv1, 3, 0);
+  utility_layout->addWidget(m_dump_use_ffv1, 3, 1);
 #endif
 
   // Misc.
@@ -151,6 +154,10 @@ void AdvancedWidget::AddDescriptions()
   static const char* TR_CACHE_CUSTOM_TEXTURE_DESCRIPTION =
       QT_TR_NOOP("Cache custom textures to system RAM on startup.\nThis can require exponentially "
                  "more RAM but fixes possible stuttering.\n\nIf unsure, leave this unchecked.");
+  static const char* TR_CACHE_DECODED_TEXTURES_DESCRIPTION = QT_TR_NOOP(
+      "Keep the decoded data of textures which are slow to decode in User/Cache/, so that the "
+      "next run of the game doesn't have to decode them again.\nThe cache file can grow up to "
+      "512 MiB per game.\n\nIf unsure, leave this unchecked.");
   static const char* TR_DUMP_EFB_DESCRIPTION =
       QT_TR_NOOP("Dump the contents of EFB copies to User/Dump/Textures/.\n\nIf unsure, leave this "
                  "unchecked.");
@@ -195,6 +202,7 @@ void AdvancedWidget::AddDescriptions()
   AddDescription(m_dump_textures, TR_DUMP_TEXTURE_DESCRIPTION);
   AddDescription(m_load_custom_textures, TR_LOAD_CUSTOM_TEXTURE_DESCRIPTION);
   AddDescription(m_prefetch_custom_textures, TR_CACHE_CUSTOM_TEXTURE_DESCRIPTION);
+  AddDescription(m_cache_decoded_textures, TR_CACHE_DECODED_TEXTURES_DESCRIPTION);
   AddDescription(m_dump_efb_target, TR_DUMP_EFB_DESCRIPTION);
   AddDescription(m_use_fullres_framedumps, TR_INTERNAL_RESOLUTION_FRAME_DUMPING_DESCRIPTION);
 #ifdef HAVE_FFMPEG
@@ -34,6 +34,7 @@ private:
   // Utility
   QCheckBox* m_dump_textures;
   QCheckBox* m_prefetch_custom_textures;
+  QCheckBox* m_cache_decoded_textures;
   QCheckBox* m_dump_efb_target;
   QCheckBox* m_dump_use_ffv1;
   QCheckBox* m_load_custom_textures;
@@ -22,6 +22,7 @@
 #include "Core/Core.h"
 #include "Core/HW/DVD/DVDInterface.h"
 #include "DiscIO/Blob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/Enums.h"
 
 #include "DolphinQt2/Config/PropertiesDialog.h"
@@ -275,7 +276,24 @@ void GameList::CompressISO()
 
   const bool compressed = (file->GetBlobType() == DiscIO::BlobType::GCZ);
 
-  if (!compressed && file->GetPlatformID() == DiscIO::Platform::WII_DISC)
+  QString dst_path = QFileDialog::getSaveFileName(
+      this, compressed ? tr("Select where you want to save the decompressed image") :
+                         tr("Select where you want to save the compressed image"),
+      QFileInfo(GetSelectedGame()->GetFilePath())
+          .dir()
+          .absoluteFilePath(file->GetGameID())
+          .append(compressed ? QStringLiteral(".gcm") : QStringLiteral(".gcz")),
+      compressed ? tr("Uncompressed GC/Wii images (*.iso *.gcm)") :
+                   tr("Compressed GC/Wii images (*.gcz);;DCZ compressed GC/Wii images (*.dcz)"));
+
+  if (dst_path.isEmpty())
+    return;
+
+  // DCZ keeps all of the disc's data, so only GCZ needs the warning about scrubbing
+  const QString suffix = QFileInfo(dst_path).suffix().toLower();
+  const bool to_dcz = !compressed && suffix == QStringLiteral("dcz");
+
+  if (!compressed && !to_dcz && file->GetPlatformID() == DiscIO::Platform::WII_DISC)
   {
     QMessageBox wii_warning(this);
     wii_warning.setIcon(QMessageBox::Warning);
@@ -289,19 +307,6 @@ void GameList::CompressISO()
       return;
   }
 
-  QString dst_path = QFileDialog::getSaveFileName(
-      this, compressed ? tr("Select where you want to save the decompressed image") :
-                         tr("Select where you want to save the compressed image"),
-      QFileInfo(GetSelectedGame()->GetFilePath())
-          .dir()
-          .absoluteFilePath(file->GetGameID())
-          .append(compressed ? QStringLiteral(".gcm") : QStringLiteral(".gcz")),
-      compressed ? tr("Uncompressed GC/Wii images (*.iso *.gcm)") :
-                   tr("Compressed GC/Wii images (*.gcz)"));
-
-  if (dst_path.isEmpty())
-    return;
-
   QProgressDialog progress_dialog(compressed ? tr("Decompressing...") : tr("Compressing..."),
                                   tr("Abort"), 0, 100, this);
   progress_dialog.setWindowModality(Qt::WindowModal);
@@ -313,6 +318,11 @@ void GameList::CompressISO()
     good = DiscIO::DecompressBlobToFile(original_path.toStdString(), dst_path.toStdString(),
                                         &CompressCB, &progress_dialog);
   }
+  else if (to_dcz)
+  {
+    good = DiscIO::ConvertToDCZ(original_path.toStdString(), dst_path.toStdString(),
+                                DiscIO::DCZ_DEFAULT_CHUNK_SIZE, &CompressCB, &progress_dialog);
+  }
   else
   {
     good = DiscIO::CompressFileToBlob(original_path.toStdString(), dst_path.toStdString(),
@@ -38,6 +38,7 @@
 #include "Core/NetPlayClient.h"
 #include "Core/NetPlayProto.h"
 #include "Core/NetPlayServer.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "DiscIO/NANDImporter.h"
@@ -232,6 +233,7 @@ void MainWindow::ConnectMenuBar()
   connect(m_menu_bar, &MenuBar::Reset, this, &MainWindow::Reset);
   connect(m_menu_bar, &MenuBar::Fullscreen, this, &MainWindow::FullScreen);
   connect(m_menu_bar, &MenuBar::FrameAdvance, this, &MainWindow::FrameAdvance);
+  connect(m_menu_bar, &MenuBar::Rewind, this, &MainWindow::Rewind);
   connect(m_menu_bar, &MenuBar::Screenshot, this, &MainWindow::ScreenShot);
   connect(m_menu_bar, &MenuBar::StateLoad, this, &MainWindow::StateLoad);
   connect(m_menu_bar, &MenuBar::StateSave, this, &MainWindow::StateSave);
@@ -366,7 +368,7 @@ void MainWindow::Open()
 {
   QString file = QFileDialog::getOpenFileName(
       this, tr("Select a File"), QDir::currentPath(),
-      tr("All GC/Wii files (*.elf *.dol *.gcm *.iso *.tgc *.wbfs *.ciso *.gcz *.wad);;"
+      tr("All GC/Wii files (*.elf *.dol *.gcm *.iso *.tgc *.wbfs *.ciso *.gcz *.dcz *.wad);;"
          "All Files (*)"));
   if (!file.isEmpty())
     StartGame(file);
@@ -516,6 +518,11 @@ void MainWindow::FrameAdvance()
   Core::DoFrameStep();
 }
 
+void MainWindow::Rewind()
+{
+  Rewind::StepBack();
+}
+
 void MainWindow::FullScreen()
 {
   // If the render widget is fullscreen we want to reset it to whatever is in
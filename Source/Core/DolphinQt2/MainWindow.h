@@ -62,6 +62,7 @@ private:
   void ForceStop();
   void Reset();
   void FrameAdvance();
+  void Rewind();
   void StateLoad();
   void StateSave();
   void StateLoadSlot();
@@ -38,6 +38,8 @@
 #include "DolphinQt2/QtUtils/ActionHelper.h"
 #include "DolphinQt2/Settings.h"
 
+#include "VideoCommon/HiresTextures.h"
+
 MenuBar::MenuBar(QWidget* parent) : QMenuBar(parent)
 {
   AddFileMenu();
@@ -73,6 +75,7 @@ void MenuBar::OnEmulationStateChanged(Core::State state)
   m_reset_action->setEnabled(running);
   m_fullscreen_action->setEnabled(running);
   m_frame_advance_action->setEnabled(running);
+  m_rewind_action->setEnabled(running);
   m_screenshot_action->setEnabled(running);
   m_state_load_menu->setEnabled(running);
   m_state_save_menu->setEnabled(running);
@@ -133,6 +136,7 @@ void MenuBar::AddToolsMenu()
 
   AddAction(tools_menu, tr("Start &NetPlay..."), this, &MenuBar::StartNetPlay);
   AddAction(tools_menu, tr("FIFO Player"), this, &MenuBar::ShowFIFOPlayer);
+  AddAction(tools_menu, tr("Create Custom Texture Pack..."), this, &MenuBar::CreateTexturePack);
 
   tools_menu->addSeparator();
 
@@ -191,6 +195,7 @@ void MenuBar::AddEmulationMenu()
   m_reset_action = AddAction(emu_menu, tr("&Reset"), this, &MenuBar::Reset);
   m_fullscreen_action = AddAction(emu_menu, tr("Toggle &Fullscreen"), this, &MenuBar::Fullscreen);
   m_frame_advance_action = AddAction(emu_menu, tr("&Frame Advance"), this, &MenuBar::FrameAdvance);
+  m_rewind_action = AddAction(emu_menu, tr("Re&wind"), this, &MenuBar::Rewind);
 
   m_screenshot_action = AddAction(emu_menu, tr("Take Screenshot"), this, &MenuBar::Screenshot);
 
@@ -698,6 +703,34 @@ void MenuBar::NANDExtractCertificates()
   }
 }
 
+void MenuBar::CreateTexturePack()
+{
+  const QString directory = QFileDialog::getExistingDirectory(
+      this, tr("Select the custom texture directory"),
+      QString::fromStdString(File::GetUserPath(D_HIRESTEXTURES_IDX)));
+  if (directory.isEmpty())
+    return;
+
+  const QString path =
+      QFileDialog::getSaveFileName(this, tr("Save Texture Pack"),
+                                   directory + QStringLiteral("/textures.dtp"),
+                                   tr("Texture packs (*.dtp);;All Files (*)"));
+  if (path.isEmpty())
+    return;
+
+  if (HiresTexture::CreateTexturePack(directory.toStdString(), path.toStdString()))
+  {
+    QMessageBox::information(this, tr("Create Custom Texture Pack"),
+                             tr("The texture pack has been created. Loose texture files in the "
+                                "game's texture folder take precedence over the textures in it."));
+  }
+  else
+  {
+    QMessageBox::critical(this, tr("Create Custom Texture Pack"),
+                          tr("Failed to create the texture pack."));
+  }
+}
+
 void MenuBar::OnSelectionChanged(QSharedPointer<GameFile> game_file)
 {
   bool is_null = game_file.isNull();
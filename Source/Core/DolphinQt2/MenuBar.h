@@ -44,6 +44,7 @@ signals:
   void Reset();
   void Fullscreen();
   void FrameAdvance();
+  void Rewind();
   void Screenshot();
   void StartNetPlay();
   void StateLoad();
@@ -119,6 +120,7 @@ private:
   void ExportWiiSaves();
   void CheckNAND();
   void NANDExtractCertificates();
+  void CreateTexturePack();
 
   void OnSelectionChanged(QSharedPointer<GameFile> game_file);
   void OnRecordingStatusChanged(bool recording);
@@ -148,6 +150,7 @@ private:
   QAction* m_reset_action;
   QAction* m_fullscreen_action;
   QAction* m_frame_advance_action;
+  QAction* m_rewind_action;
   QAction* m_screenshot_action;
   QAction* m_boot_sysmenu;
   QMenu* m_state_load_menu;
@@ -57,6 +57,7 @@
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/USB/Bluetooth/BTBase.h"
 #include "Core/Movie.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 
 #include "DolphinWX/Config/ConfigMain.h"
@@ -1030,6 +1031,8 @@ static int GetMenuIDFromHotkey(unsigned int key)
     return IDM_LOAD_STATE_FILE;
   case HK_SAVE_STATE_FILE:
     return IDM_SAVE_STATE_FILE;
+  case HK_REWIND:
+    return IDM_REWIND;
 
   case HK_SELECT_STATE_SLOT_1:
     return IDM_SELECT_SLOT_1;
@@ -1639,6 +1642,8 @@ void CFrame::ParseHotkeys()
     State::UndoLoadState();
   if (IsHotkey(HK_UNDO_SAVE_STATE))
     State::UndoSaveState();
+  if (IsHotkey(HK_REWIND))
+    Rewind::StepBack();
 }
 
 void CFrame::HandleFrameSkipHotkeys()
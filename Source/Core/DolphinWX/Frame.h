@@ -299,6 +299,7 @@ private:
   void OnLoadLastState(wxCommandEvent& event);
   void OnSaveFirstState(wxCommandEvent& event);
   void OnUndoLoadState(wxCommandEvent& event);
+  void OnRewind(wxCommandEvent& event);
   void OnUndoSaveState(wxCommandEvent& event);
 
   void OnFrameStep(wxCommandEvent& event);
@@ -342,6 +343,7 @@ private:
   void OnPerformOnlineWiiUpdate(wxCommandEvent& event);
   void OnPerformDiscWiiUpdate(wxCommandEvent& event);
   void OnFifoPlayer(wxCommandEvent& event);
+  void OnCreateTexturePack(wxCommandEvent& event);
   void OnConnectWiimote(wxCommandEvent& event);
   void GameListChanged(wxCommandEvent& event);
 
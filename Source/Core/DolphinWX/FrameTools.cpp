@@ -57,6 +57,7 @@
 #include "Core/Movie.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/Rewind.h"
 #include "Core/State.h"
 #include "Core/TitleDatabase.h"
 #include "Core/WiiUtils.h"
@@ -94,6 +95,7 @@
 
 #include "UICommon/UICommon.h"
 
+#include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoConfig.h"
@@ -144,6 +146,7 @@ void CFrame::BindMenuBarEvents()
   Bind(wxEVT_MENU, &CFrame::OnLoadStateFromFile, this, IDM_LOAD_STATE_FILE);
   Bind(wxEVT_MENU, &CFrame::OnLoadCurrentSlot, this, IDM_LOAD_SELECTED_SLOT);
   Bind(wxEVT_MENU, &CFrame::OnUndoLoadState, this, IDM_UNDO_LOAD_STATE);
+  Bind(wxEVT_MENU, &CFrame::OnRewind, this, IDM_REWIND);
   Bind(wxEVT_MENU, &CFrame::OnLoadState, this, IDM_LOAD_SLOT_1, IDM_LOAD_SLOT_10);
   Bind(wxEVT_MENU, &CFrame::OnLoadLastState, this, IDM_LOAD_LAST_1, IDM_LOAD_LAST_10);
   Bind(wxEVT_MENU, &CFrame::OnSaveStateToFile, this, IDM_SAVE_STATE_FILE);
@@ -196,6 +199,7 @@ void CFrame::BindMenuBarEvents()
     Bind(wxEVT_MENU, &CFrame::OnPerformOnlineWiiUpdate, this, idm);
   }
   Bind(wxEVT_MENU, &CFrame::OnFifoPlayer, this, IDM_FIFOPLAYER);
+  Bind(wxEVT_MENU, &CFrame::OnCreateTexturePack, this, IDM_CREATE_TEXTURE_PACK);
   Bind(wxEVT_MENU, &CFrame::OnConnectWiimote, this, IDM_CONNECT_WIIMOTE1, IDM_CONNECT_BALANCEBOARD);
 
   // View menu
@@ -349,9 +353,10 @@ void CFrame::DoOpen(bool Boot)
 
   wxString path = wxFileSelector(
       _("Select the file to load"), wxEmptyString, wxEmptyString, wxEmptyString,
-      _("All GC/Wii files (elf, dol, gcm, iso, tgc, wbfs, ciso, gcz, wad, dff)") +
-          wxString::Format("|*.elf;*.dol;*.gcm;*.iso;*.tgc;*.wbfs;*.ciso;*.gcz;*.wad;*.dff|%s",
-                           wxGetTranslation(wxALL_FILES)),
+      _("All GC/Wii files (elf, dol, gcm, iso, tgc, wbfs, ciso, gcz, dcz, wad, dff)") +
+          wxString::Format(
+              "|*.elf;*.dol;*.gcm;*.iso;*.tgc;*.wbfs;*.ciso;*.gcz;*.dcz;*.wad;*.dff|%s",
+              wxGetTranslation(wxALL_FILES)),
       wxFD_OPEN | wxFD_FILE_MUST_EXIST, this);
 
   if (path.IsEmpty())
@@ -1514,6 +1519,41 @@ void CFrame::OnFifoPlayer(wxCommandEvent& WXUNUSED(event))
   }
 }
 
+void CFrame::OnCreateTexturePack(wxCommandEvent& WXUNUSED(event))
+{
+  const wxString directory =
+      wxDirSelector(_("Select the custom texture directory"),
+                    StrToWxStr(File::GetUserPath(D_HIRESTEXTURES_IDX)), wxDD_DIR_MUST_EXIST,
+                    wxDefaultPosition, this);
+  if (directory.IsEmpty())
+    return;
+
+  const wxString path = wxFileSelector(
+      _("Save Texture Pack"), directory, "textures.dtp", "dtp",
+      _("Texture packs (*.dtp)") + "|*.dtp|" + wxGetTranslation(wxALL_FILES),
+      wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+  if (path.IsEmpty())
+    return;
+
+  bool success;
+  {
+    wxBusyCursor hourglass;
+    success = HiresTexture::CreateTexturePack(WxStrToStr(directory), WxStrToStr(path));
+  }
+
+  if (success)
+  {
+    wxMessageBox(_("The texture pack has been created. Loose texture files in the game's texture "
+                   "folder take precedence over the textures in it."),
+                 _("Create Custom Texture Pack"), wxOK | wxICON_INFORMATION, this);
+  }
+  else
+  {
+    wxMessageBox(_("Failed to create the texture pack."), _("Create Custom Texture Pack"),
+                 wxOK | wxICON_ERROR, this);
+  }
+}
+
 void CFrame::OnConnectWiimote(wxCommandEvent& event)
 {
   const auto ios = IOS::HLE::GetIOS();
@@ -1587,6 +1627,12 @@ void CFrame::OnUndoSaveState(wxCommandEvent& WXUNUSED(event))
     State::UndoSaveState();
 }
 
+void CFrame::OnRewind(wxCommandEvent& WXUNUSED(event))
+{
+  if (Core::IsRunningAndStarted())
+    Rewind::StepBack();
+}
+
 void CFrame::OnLoadState(wxCommandEvent& event)
 {
   if (Core::IsRunningAndStarted())
@@ -1659,6 +1705,7 @@ void CFrame::UpdateGUI()
   GetMenuBar()->FindItem(IDM_STOP_RECORD)->Enable(Movie::IsMovieActive());
   GetMenuBar()->FindItem(IDM_RECORD_EXPORT)->Enable(Movie::IsMovieActive());
   GetMenuBar()->FindItem(IDM_FRAMESTEP)->Enable(Running || Paused);
+  GetMenuBar()->FindItem(IDM_REWIND)->Enable(Running || Paused);
   GetMenuBar()->FindItem(IDM_SCREENSHOT)->Enable(Running || Paused);
   GetMenuBar()->FindItem(IDM_TOGGLE_FULLSCREEN)->Enable(Running || Paused);
   GetMenuBar()->FindItem(IDM_LOAD_STATE)->Enable(Initialized);
@@ -54,6 +54,7 @@
 #include "Core/Movie.h"
 #include "Core/TitleDatabase.h"
 #include "DiscIO/Blob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/DirectoryBlob.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Volume.h"
@@ -82,7 +83,7 @@ public:
   wxProgressDialog* dialog;
 };
 
-static constexpr u32 CACHE_REVISION = 6;  // Last changed in PR 6109
+static constexpr u32 CACHE_REVISION = 7;  // Last changed for BlobType::DCZ
 
 static bool sorted = false;
 
@@ -757,8 +758,8 @@ void GameListCtrl::RescanList()
 
   post_status(_("Scanning..."));
 
-  const std::vector<std::string> search_extensions = {".gcm",  ".tgc", ".iso", ".ciso", ".gcz",
-                                                      ".wbfs", ".wad", ".dol", ".elf"};
+  const std::vector<std::string> search_extensions = {".gcm", ".tgc", ".iso", ".ciso", ".gcz",
+                                                      ".dcz", ".wbfs", ".wad", ".dol", ".elf"};
   // TODO This could process paths iteratively as they are found
   const std::vector<std::string> search_results_vector =
       Common::DoFileSearch(SConfig::GetInstance().m_ISOFolder, search_extensions,
@@ -1516,13 +1517,11 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
     }
     else
     {
-      if (iso->GetPlatform() == DiscIO::Platform::WII_DISC && !WiiCompressWarning())
-        return;
-
       path = wxFileSelector(_("Save compressed GCM/ISO"), StrToWxStr(FilePath),
                             StrToWxStr(FileName) + ".gcz", wxEmptyString,
-                            _("All compressed GC/Wii ISO files (gcz)") +
-                                wxString::Format("|*.gcz|%s", wxGetTranslation(wxALL_FILES)),
+                            _("All compressed GC/Wii ISO files (gcz)") + "|*.gcz|" +
+                                _("All DCZ compressed GC/Wii ISO files (dcz)") +
+                                wxString::Format("|*.dcz|%s", wxGetTranslation(wxALL_FILES)),
                             wxFD_SAVE, this);
     }
     if (!path)
@@ -1533,6 +1532,14 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
                                     path.c_str()),
                    _("Confirm File Overwrite"), wxYES_NO) == wxNO);
 
+  // DCZ keeps all of the disc's data, so only GCZ needs the warning about scrubbing
+  const bool to_dcz = !is_compressed && wxFileName(path).GetExt().Lower() == "dcz";
+  if (!is_compressed && !to_dcz && iso->GetPlatform() == DiscIO::Platform::WII_DISC &&
+      !WiiCompressWarning())
+  {
+    return;
+  }
+
   bool all_good = false;
 
   {
@@ -1544,6 +1551,9 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
     if (is_compressed)
       all_good =
           DiscIO::DecompressBlobToFile(iso->GetFileName(), WxStrToStr(path), &CompressCB, &dialog);
+    else if (to_dcz)
+      all_good = DiscIO::ConvertToDCZ(iso->GetFileName(), WxStrToStr(path),
+                                      DiscIO::DCZ_DEFAULT_CHUNK_SIZE, &CompressCB, &dialog);
     else
       all_good = DiscIO::CompressFileToBlob(
           iso->GetFileName(), WxStrToStr(path),
@@ -20,6 +20,7 @@ enum
   IDM_UNDO_SAVE_STATE,
   IDM_LOAD_STATE_FILE,
   IDM_SAVE_STATE_FILE,
+  IDM_REWIND,
   IDM_SAVE_SLOT_1,
   IDM_SAVE_SLOT_2,
   IDM_SAVE_SLOT_3,
@@ -113,6 +114,7 @@ enum
   IDM_PERFORM_ONLINE_UPDATE_KOR,
   IDM_PERFORM_ONLINE_UPDATE_USA,
   IDM_FIFOPLAYER,
+  IDM_CREATE_TEXTURE_PACK,
   IDM_LOAD_GC_IPL_JAP,
   IDM_LOAD_GC_IPL_USA,
   IDM_LOAD_GC_IPL_EUR,
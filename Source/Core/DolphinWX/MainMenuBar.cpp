@@ -128,6 +128,7 @@ wxMenu* MainMenuBar::CreateEmulationMenu() const
   emulation_menu->AppendSeparator();
   emulation_menu->Append(IDM_TOGGLE_FULLSCREEN, _("Toggle &Fullscreen"));
   emulation_menu->Append(IDM_FRAMESTEP, _("&Frame Advance"));
+  emulation_menu->Append(IDM_REWIND, _("Re&wind"));
   emulation_menu->AppendSeparator();
   emulation_menu->Append(IDM_SCREENSHOT, _("Take Screenshot"));
   emulation_menu->AppendSeparator();
@@ -235,6 +236,7 @@ wxMenu* MainMenuBar::CreateToolsMenu() const
   tools_menu->Append(IDM_CHEATS, _("&Cheat Manager"));
   tools_menu->Append(IDM_NETPLAY, _("Start &NetPlay..."));
   tools_menu->Append(IDM_FIFOPLAYER, _("FIFO Player"));
+  tools_menu->Append(IDM_CREATE_TEXTURE_PACK, _("Create Custom Texture Pack..."));
   tools_menu->AppendSeparator();
   tools_menu->Append(IDM_MENU_INSTALL_WAD, _("Install WAD..."));
   tools_menu->Append(IDM_LOAD_WII_MENU, dummy_string);
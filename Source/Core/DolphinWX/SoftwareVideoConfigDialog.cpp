@@ -72,10 +72,30 @@ SoftwareVideoConfigDialog::SoftwareVideoConfigDialog(wxWindow* parent, const std
       szr_rendering->Add(label_backend, 0, wxALIGN_CENTER_VERTICAL);
       szr_rendering->Add(choice_backend, 0, wxALIGN_CENTER_VERTICAL);
 
+      // rasterizer threads
+      wxStaticText* const label_threads =
+          new wxStaticText(page_general, wxID_ANY, _("Rasterizer Threads:"));
+      IntegerSetting* const spin_threads = new IntegerSetting(
+          page_general, _("Rasterizer Threads"), Config::GFX_SW_RASTERIZER_THREADS, 0, 64);
+      spin_threads->SetToolTip(_("Number of threads drawing triangles. 0 uses one thread per "
+                                 "CPU core.\n\nIf unsure, leave this at 1."));
+
+      szr_rendering->Add(label_threads, 0, wxALIGN_CENTER_VERTICAL);
+      szr_rendering->Add(spin_threads, 0, wxALIGN_CENTER_VERTICAL);
+
+      // quads
+      szr_rendering->Add(new SettingCheckBox(
+          page_general, _("Draw Pixels in Quads"),
+          _("Runs the TEV for the pixels of a 2x2 quad at once, which is faster than drawing "
+            "one pixel at a time and gives the same output.\n\nIf unsure, leave this checked."),
+          Config::GFX_SW_DRAW_QUADS));
+
       if (Core::GetState() != Core::State::Uninitialized)
       {
         label_backend->Disable();
         choice_backend->Disable();
+        label_threads->Disable();
+        spin_threads->Disable();
       }
     }
 
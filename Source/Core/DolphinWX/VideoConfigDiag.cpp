@@ -234,6 +234,9 @@ static wxString log_render_time_to_file_desc =
                 "unsure, leave this unchecked.");
 static wxString show_stats_desc =
     wxTRANSLATE("Show various rendering statistics.\n\nIf unsure, leave this unchecked.");
+static wxString log_video_profile_desc =
+    wxTRANSLATE("Log how the video thread time of every frame is spent, and why draws are "
+                "split, to User/Logs/video_profile.json.\n\nIf unsure, leave this unchecked.");
 static wxString show_netplay_messages_desc =
     wxTRANSLATE("When playing on NetPlay, show chat messages, buffer changes and "
                 "desync alerts.\n\nIf unsure, leave this unchecked.");
@@ -248,6 +251,10 @@ static wxString load_hires_textures_desc = wxTRANSLATE(
 static wxString cache_hires_textures_desc =
     wxTRANSLATE("Cache custom textures to system RAM on startup.\nThis can require exponentially "
                 "more RAM but fixes possible stuttering.\n\nIf unsure, leave this unchecked.");
+static wxString cache_decoded_textures_desc = wxTRANSLATE(
+    "Keep the decoded data of textures which are slow to decode in User/Cache/, so that the next "
+    "run of the game doesn't have to decode them again.\nThe cache file can grow up to 512 MiB per "
+    "game.\n\nIf unsure, leave this unchecked.");
 static wxString dump_efb_desc = wxTRANSLATE(
     "Dump the contents of EFB copies to User/Dump/Textures/.\n\nIf unsure, leave this unchecked.");
 static wxString dump_xfb_desc = wxTRANSLATE(
@@ -818,6 +825,9 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string& title)
       szr_debug->Add(CreateCheckBox(page_advanced, _("Enable API Validation Layers"),
                                     wxGetTranslation(validation_layer_desc),
                                     Config::GFX_ENABLE_VALIDATION_LAYER));
+      szr_debug->Add(CreateCheckBox(page_advanced, _("Log Video Thread Profile"),
+                                    wxGetTranslation(log_video_profile_desc),
+                                    Config::GFX_LOG_VIDEO_PROFILE_TO_FILE));
 
       wxStaticBoxSizer* const group_debug =
           new wxStaticBoxSizer(wxVERTICAL, page_advanced, _("Debugging"));
@@ -842,6 +852,9 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string& title)
                                             wxGetTranslation(cache_hires_textures_desc),
                                             Config::GFX_CACHE_HIRES_TEXTURES);
       szr_utility->Add(cache_hires_textures);
+      szr_utility->Add(CreateCheckBox(page_advanced, _("Cache Decoded Textures"),
+                                      wxGetTranslation(cache_decoded_textures_desc),
+                                      Config::GFX_CACHE_DECODED_TEXTURES));
 
       szr_utility->Add(CreateCheckBox(page_advanced, _("Internal Resolution Frame Dumps"),
                                       wxGetTranslation(internal_resolution_frame_dumping_desc),
@@ -84,10 +84,12 @@ void StateManager::Apply()
       m_current.vertexBufferOffset = m_pending.vertexBufferOffset;
     }
 
-    if (m_current.indexBuffer != m_pending.indexBuffer)
+    if (m_current.indexBuffer != m_pending.indexBuffer ||
+        m_current.indexFormat != m_pending.indexFormat)
     {
-      D3D::context->IASetIndexBuffer(m_pending.indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+      D3D::context->IASetIndexBuffer(m_pending.indexBuffer, m_pending.indexFormat, 0);
       m_current.indexBuffer = m_pending.indexBuffer;
+      m_current.indexFormat = m_pending.indexFormat;
     }
 
     if (m_current.topology != m_pending.topology)
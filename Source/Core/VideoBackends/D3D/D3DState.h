@@ -129,12 +129,13 @@ public:
     m_pending.vertexBufferOffset = offset;
   }
 
-  void SetIndexBuffer(ID3D11Buffer* buffer)
+  void SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format)
   {
-    if (m_current.indexBuffer != buffer)
+    if (m_current.indexBuffer != buffer || m_current.indexFormat != format)
       m_dirtyFlags |= DirtyFlag_IndexBuffer;
 
     m_pending.indexBuffer = buffer;
+    m_pending.indexFormat = format;
   }
 
   void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
@@ -253,6 +254,7 @@ private:
     ID3D11Buffer* computeConstants;
     ID3D11Buffer* vertexBuffer;
     ID3D11Buffer* indexBuffer;
+    DXGI_FORMAT indexFormat;
     u32 vertexBufferStride;
     u32 vertexBufferOffset;
     D3D11_PRIMITIVE_TOPOLOGY topology;
@@ -24,11 +24,12 @@
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 
 namespace DX11
 {
 // TODO: Find sensible values for these two
-const u32 MAX_IBUFFER_SIZE = VertexManager::MAXIBUFFERSIZE * sizeof(u16) * 8;
+const u32 MAX_IBUFFER_SIZE = VertexManager::MAXIBUFFERSIZE * sizeof(u32) * 8;
 const u32 MAX_VBUFFER_SIZE = VertexManager::MAXVBUFFERSIZE;
 const u32 MAX_BUFFER_SIZE = MAX_IBUFFER_SIZE + MAX_VBUFFER_SIZE;
 
@@ -62,6 +63,7 @@ void VertexManager::DestroyDeviceObjects()
 }
 
 VertexManager::VertexManager()
+    : m_index_size(g_ActiveConfig.bUse32BitIndices ? sizeof(u32) : sizeof(u16))
 {
   LocalVBuffer.resize(MAXVBUFFERSIZE);
 
@@ -83,7 +85,7 @@ void VertexManager::PrepareDrawBuffers(u32 stride)
   D3D11_MAPPED_SUBRESOURCE map;
 
   u32 vertexBufferSize = u32(m_cur_buffer_pointer - m_base_buffer_pointer);
-  u32 indexBufferSize = IndexGenerator::GetIndexLen() * sizeof(u16);
+  u32 indexBufferSize = IndexGenerator::GetIndexLen() * m_index_size;
   u32 totalBufferSize = vertexBufferSize + indexBufferSize;
 
   u32 cursor = m_bufferCursor;
@@ -122,10 +124,12 @@ void VertexManager::Draw(u32 stride)
   u32 indices = IndexGenerator::GetIndexLen();
 
   D3D::stateman->SetVertexBuffer(m_buffers[m_currentBuffer], stride, 0);
-  D3D::stateman->SetIndexBuffer(m_buffers[m_currentBuffer]);
+  const DXGI_FORMAT index_format =
+      m_index_size == sizeof(u32) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+  D3D::stateman->SetIndexBuffer(m_buffers[m_currentBuffer], index_format);
 
   u32 baseVertex = m_vertexDrawOffset / stride;
-  u32 startIndex = m_indexDrawOffset / sizeof(u16);
+  u32 startIndex = m_indexDrawOffset / m_index_size;
 
   D3D::stateman->Apply();
   D3D::context->DrawIndexed(indices, startIndex, baseVertex);
@@ -135,24 +139,27 @@ void VertexManager::Draw(u32 stride)
 
 void VertexManager::vFlush()
 {
-  if (!PixelShaderCache::SetShader())
   {
-    GFX_DEBUGGER_PAUSE_LOG_AT(NEXT_ERROR, true, { printf("Fail to set pixel shader\n"); });
-    return;
-  }
-
-  D3DVertexFormat* vertex_format =
-      static_cast<D3DVertexFormat*>(VertexLoaderManager::GetCurrentVertexFormat());
-  if (!VertexShaderCache::SetShader(vertex_format))
-  {
-    GFX_DEBUGGER_PAUSE_LOG_AT(NEXT_ERROR, true, { printf("Fail to set pixel shader\n"); });
-    return;
-  }
-
-  if (!GeometryShaderCache::SetShader(m_current_primitive_type))
-  {
-    GFX_DEBUGGER_PAUSE_LOG_AT(NEXT_ERROR, true, { printf("Fail to set pixel shader\n"); });
-    return;
+    VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::ShaderLookup);
+    if (!PixelShaderCache::SetShader())
+    {
+      GFX_DEBUGGER_PAUSE_LOG_AT(NEXT_ERROR, true, { printf("Fail to set pixel shader\n"); });
+      return;
+    }
+
+    D3DVertexFormat* vertex_format =
+        static_cast<D3DVertexFormat*>(VertexLoaderManager::GetCurrentVertexFormat());
+    if (!VertexShaderCache::SetShader(vertex_format))
+    {
+      GFX_DEBUGGER_PAUSE_LOG_AT(NEXT_ERROR, true, { printf("Fail to set pixel shader\n"); });
+      return;
+    }
+
+    if (!GeometryShaderCache::SetShader(m_current_primitive_type))
+    {
+      GFX_DEBUGGER_PAUSE_LOG_AT(NEXT_ERROR, true, { printf("Fail to set pixel shader\n"); });
+      return;
+    }
   }
 
   if (g_ActiveConfig.backend_info.bSupportsBBox && BoundingBox::active)
@@ -176,7 +183,10 @@ void VertexManager::vFlush()
 void VertexManager::ResetBuffer(u32 stride)
 {
   m_cur_buffer_pointer = m_base_buffer_pointer;
-  IndexGenerator::Start(GetIndexBuffer());
+  if (m_index_size == sizeof(u32))
+    IndexGenerator::Start(GetIndexBuffer());
+  else
+    IndexGenerator::Start(reinterpret_cast<u16*>(GetIndexBuffer()));
 }
 
 }  // namespace
@@ -46,13 +46,16 @@ public:
 
 protected:
   void ResetBuffer(u32 stride) override;
-  u16* GetIndexBuffer() { return &LocalIBuffer[0]; }
+  u32* GetIndexBuffer() { return &LocalIBuffer[0]; }
 private:
   void PrepareDrawBuffers(u32 stride);
   void Draw(u32 stride);
   // temp
   void vFlush() override;
 
+  // Latched from the config at startup, in bytes
+  const u32 m_index_size;
+
   u32 m_vertexDrawOffset;
   u32 m_indexDrawOffset;
   u32 m_currentBuffer;
@@ -65,7 +68,8 @@ private:
   ID3D11Buffer* m_buffers[MAX_BUFFER_COUNT];
 
   std::vector<u8> LocalVBuffer;
-  std::vector<u16> LocalIBuffer;
+  // Large enough for 32-bit indices, and also used for 16-bit ones
+  std::vector<u32> LocalIBuffer;
 };
 
 }  // namespace
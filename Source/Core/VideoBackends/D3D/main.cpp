@@ -68,6 +68,7 @@ void VideoBackend::InitBackendInfo()
   g_Config.backend_info.bSupportsBitfield = false;
   g_Config.backend_info.bSupportsDynamicSamplerIndexing = false;
   g_Config.backend_info.bSupportsBPTCTextures = false;
+  g_Config.backend_info.bSupportsPerDrawConstants = false;
   g_Config.backend_info.bSupportsFramebufferFetch = false;
 
   IDXGIFactory2* factory;
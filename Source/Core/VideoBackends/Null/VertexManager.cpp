@@ -9,6 +9,7 @@
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoProfiler.h"
 
 namespace Null
 {
@@ -41,6 +42,7 @@ void VertexManager::ResetBuffer(u32 stride)
 
 void VertexManager::vFlush()
 {
+  VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::ShaderLookup);
   VertexShaderCache::s_instance->SetShader(m_current_primitive_type);
   GeometryShaderCache::s_instance->SetShader(m_current_primitive_type);
   PixelShaderCache::s_instance->SetShader(m_current_primitive_type);
@@ -4,6 +4,7 @@
 
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <string>
@@ -47,6 +48,8 @@ std::unique_ptr<ProgramShaderCache::SharedContextAsyncShaderCompiler>
     ProgramShaderCache::s_async_compiler;
 u32 ProgramShaderCache::s_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
+s32 ProgramShaderCache::s_draw_constants_align;
+u32 ProgramShaderCache::s_last_draw_count;
 GLuint ProgramShaderCache::s_attributeless_VBO = 0;
 GLuint ProgramShaderCache::s_attributeless_VAO = 0;
 GLuint ProgramShaderCache::s_last_VAO = 0;
@@ -266,6 +269,42 @@ void ProgramShaderCache::UploadConstants()
   }
 }
 
+void ProgramShaderCache::UploadDrawConstants(u32 base_vertex)
+{
+  // Only the vertex ranges of the draws depend on the base vertex, a single draw covers them all.
+  const u32 draw_count = g_vertex_manager->GetDrawCount();
+  if (draw_count == 1 && s_last_draw_count == 1 && !PixelShaderManager::dirty &&
+      !VertexShaderManager::dirty && !GeometryShaderManager::dirty)
+  {
+    return;
+  }
+
+  const u32 ps_size = draw_count * PS_DRAW_CONSTANTS_STRIDE;
+  const u32 vs_size = draw_count * VS_DRAW_CONSTANTS_STRIDE;
+  const u32 vs_offset = Common::AlignUp(ps_size, s_draw_constants_align);
+  const u32 gs_offset = vs_offset + Common::AlignUp(vs_size, s_draw_constants_align);
+  const u32 size = gs_offset + sizeof(GeometryShaderConstants);
+
+  auto buffer = s_buffer->Map(size, s_draw_constants_align);
+  g_vertex_manager->WriteDrawConstants(buffer.first, buffer.first + vs_offset, base_vertex);
+  memcpy(buffer.first + gs_offset, &GeometryShaderManager::constants,
+         sizeof(GeometryShaderConstants));
+  s_buffer->Unmap(size);
+
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, s_buffer->m_buffer, buffer.second, ps_size);
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, s_buffer->m_buffer, buffer.second + vs_offset,
+                    vs_size);
+  glBindBufferRange(GL_UNIFORM_BUFFER, 3, s_buffer->m_buffer, buffer.second + gs_offset,
+                    sizeof(GeometryShaderConstants));
+
+  PixelShaderManager::dirty = false;
+  VertexShaderManager::dirty = false;
+  GeometryShaderManager::dirty = false;
+  s_last_draw_count = draw_count;
+
+  ADDSTAT(stats.thisFrame.bytesUniformStreamed, size);
+}
+
 SHADER* ProgramShaderCache::SetShader(PrimitiveType primitive_type,
                                       const GLVertexFormat* vertex_format)
 {
@@ -628,6 +667,16 @@ void ProgramShaderCache::Init()
   // then the UBO will fail.
   glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &s_ubo_align);
 
+  // The per-draw constants are bound as storage buffers, the geometry shader ones as uniforms.
+  s_draw_constants_align = s_ubo_align;
+  s_last_draw_count = 0;
+  if (g_ActiveConfig.backend_info.bSupportsPerDrawConstants)
+  {
+    GLint ssbo_align;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssbo_align);
+    s_draw_constants_align = std::max(s_ubo_align, ssbo_align);
+  }
+
   s_ubo_buffer_size =
       static_cast<u32>(Common::AlignUp(sizeof(PixelShaderConstants), s_ubo_align) +
                        Common::AlignUp(sizeof(VertexShaderConstants), s_ubo_align) +
@@ -1392,12 +1441,12 @@ void ProgramShaderCache::CreatePrerenderArrays(SharedContextData* data)
       if (GLExtensions::Version() >= 310)
       {
         glEnable(GL_PRIMITIVE_RESTART);
-        glPrimitiveRestartIndex(65535);
+        glPrimitiveRestartIndex(g_ogl_config.bUse32BitIndices ? UINT32_MAX : UINT16_MAX);
       }
       else
       {
         glEnableClientState(GL_PRIMITIVE_RESTART_NV);
-        glPrimitiveRestartIndexNV(65535);
+        glPrimitiveRestartIndexNV(g_ogl_config.bUse32BitIndices ? UINT32_MAX : UINT16_MAX);
       }
     }
   }
@@ -138,6 +138,7 @@ public:
   static u32 GetUniformBufferAlignment();
   static void InvalidateConstants();
   static void UploadConstants();
+  static void UploadDrawConstants(u32 base_vertex);
 
   static void Init();
   static void Reload();
@@ -250,6 +251,8 @@ private:
   static std::unique_ptr<SharedContextAsyncShaderCompiler> s_async_compiler;
   static u32 s_ubo_buffer_size;
   static s32 s_ubo_align;
+  static s32 s_draw_constants_align;
+  static u32 s_last_draw_count;
 
   static GLuint s_attributeless_VBO;
   static GLuint s_attributeless_VAO;
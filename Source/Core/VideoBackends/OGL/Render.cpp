@@ -677,6 +677,20 @@ Renderer::Renderer()
       g_Config.backend_info.bSupportsPaletteConversion &&
       g_Config.backend_info.bSupportsComputeShaders && g_ogl_config.bSupportsImageLoadStore;
 
+  // Per-draw constants are read from storage buffers in the vertex and pixel shaders, and the draw
+  // index is passed through the geometry shader interface blocks.
+  GLint max_vertex_ssbos = 0, max_fragment_ssbos = 0;
+  if (GLExtensions::Supports("GL_ARB_shader_storage_buffer_object"))
+  {
+    glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &max_vertex_ssbos);
+    glGetIntegerv(GL_MAX_FRAGMENT_SHADER_STORAGE_BLOCKS, &max_fragment_ssbos);
+  }
+  g_Config.backend_info.bSupportsPerDrawConstants =
+      GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGL &&
+      g_Config.backend_info.bSupportsBindingLayout &&
+      g_Config.backend_info.bSupportsGeometryShaders && g_ogl_config.bSupportsGLBaseVertex &&
+      max_vertex_ssbos >= 1 && max_fragment_ssbos >= 3;
+
   if (g_ogl_config.bSupportsDebug)
   {
     if (GLExtensions::Supports("GL_KHR_debug"))
@@ -783,6 +797,7 @@ Renderer::Renderer()
   glBlendColor(0, 0, 0, 0.5f);
   glClearDepthf(1.0f);
 
+  g_ogl_config.bUse32BitIndices = g_ActiveConfig.bUse32BitIndices;
   if (g_ActiveConfig.backend_info.bSupportsPrimitiveRestart)
   {
     if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
@@ -794,12 +809,12 @@ Renderer::Renderer()
       if (GLExtensions::Version() >= 310)
       {
         glEnable(GL_PRIMITIVE_RESTART);
-        glPrimitiveRestartIndex(65535);
+        glPrimitiveRestartIndex(g_ogl_config.bUse32BitIndices ? UINT32_MAX : UINT16_MAX);
       }
       else
       {
         glEnableClientState(GL_PRIMITIVE_RESTART_NV);
-        glPrimitiveRestartIndexNV(65535);
+        glPrimitiveRestartIndexNV(g_ogl_config.bUse32BitIndices ? UINT32_MAX : UINT16_MAX);
       }
     }
   }
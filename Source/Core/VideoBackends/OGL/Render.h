@@ -69,6 +69,8 @@ struct VideoConfig
   bool bSupportsBitfield;
   bool bSupportsTextureSubImage;
   EsFbFetchType SupportedFramebufferFetch;
+  // Latched at startup, since the primitive restart index depends on it
+  bool bUse32BitIndices;
 
   const char* gl_vendor;
   const char* gl_renderer;
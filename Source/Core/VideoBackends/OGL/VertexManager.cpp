@@ -24,11 +24,12 @@
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 
 namespace OGL
 {
 // This are the initially requested size for the buffers expressed in bytes
-const u32 MAX_IBUFFER_SIZE = 2 * 1024 * 1024;
+const u32 MAX_IBUFFER_SIZE = 4 * 1024 * 1024;
 const u32 MAX_VBUFFER_SIZE = 32 * 1024 * 1024;
 
 static std::unique_ptr<StreamBuffer> s_vertexBuffer;
@@ -84,7 +85,7 @@ GLuint VertexManager::GetIndexBufferHandle() const
 void VertexManager::PrepareDrawBuffers(u32 stride)
 {
   u32 vertex_data_size = IndexGenerator::GetNumVerts() * stride;
-  u32 index_data_size = IndexGenerator::GetIndexLen() * sizeof(u16);
+  u32 index_data_size = IndexGenerator::GetIndexLen() * IndexGenerator::GetIndexSize();
 
   s_vertexBuffer->Unmap(vertex_data_size);
   s_indexBuffer->Unmap(index_data_size);
@@ -101,7 +102,10 @@ void VertexManager::ResetBuffer(u32 stride)
     m_cur_buffer_pointer = m_base_buffer_pointer = m_cpu_v_buffer.data();
     m_end_buffer_pointer = m_base_buffer_pointer + m_cpu_v_buffer.size();
 
-    IndexGenerator::Start((u16*)m_cpu_i_buffer.data());
+    if (g_ogl_config.bUse32BitIndices)
+      IndexGenerator::Start(m_cpu_i_buffer.data());
+    else
+      IndexGenerator::Start(reinterpret_cast<u16*>(m_cpu_i_buffer.data()));
   }
   else
   {
@@ -115,8 +119,16 @@ void VertexManager::ResetBuffer(u32 stride)
     m_end_buffer_pointer = buffer.first + MAXVBUFFERSIZE;
     s_baseVertex = buffer.second / stride;
 
-    buffer = s_indexBuffer->Map(MAXIBUFFERSIZE * sizeof(u16));
-    IndexGenerator::Start((u16*)buffer.first);
+    if (g_ogl_config.bUse32BitIndices)
+    {
+      buffer = s_indexBuffer->Map(MAXIBUFFERSIZE * sizeof(u32));
+      IndexGenerator::Start(reinterpret_cast<u32*>(buffer.first));
+    }
+    else
+    {
+      buffer = s_indexBuffer->Map(MAXIBUFFERSIZE * sizeof(u16));
+      IndexGenerator::Start(reinterpret_cast<u16*>(buffer.first));
+    }
     s_index_offset = buffer.second;
   }
 }
@@ -125,6 +137,8 @@ void VertexManager::Draw(u32 stride)
 {
   u32 index_size = IndexGenerator::GetIndexLen();
   u32 max_index = IndexGenerator::GetNumVerts();
+  GLenum index_type =
+      IndexGenerator::GetIndexSize() == sizeof(u32) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
   GLenum primitive_mode = 0;
 
   switch (m_current_primitive_type)
@@ -145,12 +159,12 @@ void VertexManager::Draw(u32 stride)
 
   if (g_ogl_config.bSupportsGLBaseVertex)
   {
-    glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT,
+    glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, index_type,
                                   (u8*)nullptr + s_index_offset, (GLint)s_baseVertex);
   }
   else
   {
-    glDrawRangeElements(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT,
+    glDrawRangeElements(primitive_mode, 0, max_index, index_size, index_type,
                         (u8*)nullptr + s_index_offset);
   }
 
@@ -162,12 +176,18 @@ void VertexManager::vFlush()
   GLVertexFormat* nativeVertexFmt = (GLVertexFormat*)VertexLoaderManager::GetCurrentVertexFormat();
   u32 stride = nativeVertexFmt->GetVertexStride();
 
-  ProgramShaderCache::SetShader(m_current_primitive_type, nativeVertexFmt);
+  {
+    VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::ShaderLookup);
+    ProgramShaderCache::SetShader(m_current_primitive_type, nativeVertexFmt);
+  }
 
   PrepareDrawBuffers(stride);
 
   // upload global constants
-  ProgramShaderCache::UploadConstants();
+  if (g_ActiveConfig.backend_info.bSupportsPerDrawConstants)
+    ProgramShaderCache::UploadDrawConstants(static_cast<u32>(s_baseVertex));
+  else
+    ProgramShaderCache::UploadConstants();
 
   if (::BoundingBox::active && !g_Config.BBoxUseFragmentShaderImplementation())
   {
@@ -56,6 +56,7 @@ private:
 
   // Alternative buffers in CPU memory for primatives we are going to discard.
   std::vector<u8> m_cpu_v_buffer;
-  std::vector<u16> m_cpu_i_buffer;
+  // Large enough for 32-bit indices, and also used for 16-bit ones
+  std::vector<u32> m_cpu_i_buffer;
 };
 }
@@ -60,16 +60,15 @@ u8* GetPixelPointer(u16 x, u16 y, bool depth);
 void EncodeXFB(u8* xfb_in_ram, u32 memory_stride, const EFBRectangle& source_rect, float y_scale);
 
 extern u32 perf_values[PQ_NUM_MEMBERS];
-inline void IncPerfCounterQuadCount(PerfQueryType type)
+inline void IncPerfCounterQuadCount(PerfQueryType type, u32 num_pixels = 1)
 {
   // NOTE: hardware doesn't process individual pixels but quads instead.
   // Current software renderer architecture works on pixels though, so
   // we have this "quad" hack here to only increment the registers on
   // every fourth rendered pixel
   static u32 quad[PQ_NUM_MEMBERS];
-  if (++quad[type] != 3)
-    return;
-  quad[type] = 0;
-  ++perf_values[type];
+  quad[type] += num_pixels;
+  perf_values[type] += quad[type] / 3;
+  quad[type] %= 3;
 }
 }
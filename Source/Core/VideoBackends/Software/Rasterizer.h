@@ -11,11 +11,18 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
 
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2);
 
+// Draws the triangles which are still waiting for the rasterizer threads. Must be called before
+// changing any state the rasterizer depends on.
+void Flush();
+
 void SetTevReg(int reg, int comp, s16 color);
+// Picks the compiled pixel pipeline for the current BP state. Must not be called while drawing.
+void UpdatePixelJit();
 
 struct Slope
 {
@@ -4,6 +4,7 @@
 
 #include "VideoBackends/Software/SWVertexLoader.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 
@@ -86,37 +87,54 @@ void SWVertexLoader::vFlush()
     Rasterizer::SetTevReg(i, Tev::BLU_C, PixelShaderManager::constants.kcolors[i][2]);
     Rasterizer::SetTevReg(i, Tev::ALP_C, PixelShaderManager::constants.kcolors[i][3]);
   }
-
-  for (u32 i = 0; i < IndexGenerator::GetIndexLen(); i++)
+  Rasterizer::UpdatePixelJit();
+
+  const PortableVertexDeclaration& vdec =
+      VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration();
+  const u32 components = VertexLoaderManager::g_current_components;
+  const u32 num_indices = IndexGenerator::GetIndexLen();
+
+  // XF state can't change within a flush, so every vertex only needs to be transformed once, no
+  // matter how many primitives share it.
+  u32 num_vertices = 0;
+  for (u32 i = 0; i < num_indices; i++)
+    num_vertices = std::max<u32>(num_vertices, m_local_index_buffer[i] + 1);
+  if (m_transformed_vertices.size() < num_vertices)
+    m_transformed_vertices.resize(num_vertices);
+
+  for (u32 first = 0; first < num_vertices; first += TransformUnit::VERTEX_BATCH_SIZE)
   {
-    const u16 index = m_local_index_buffer[i];
-    memset(&m_vertex, 0, sizeof(m_vertex));
-
-    // Super Mario Sunshine requires those to be zero for those debug boxes.
-    m_vertex.color = {};
+    const u32 count = std::min(num_vertices - first, TransformUnit::VERTEX_BATCH_SIZE);
+    for (u32 i = 0; i < count; i++)
+    {
+      memset(&m_vertex, 0, sizeof(m_vertex));
 
-    // parse the videocommon format to our own struct format (m_vertex)
-    SetFormat(g_main_cp_state.last_id, primitiveType);
-    ParseVertex(VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration(), index);
+      // Super Mario Sunshine requires those to be zero for those debug boxes.
+      m_vertex.color = {};
 
-    // transform this vertex so that it can be used for rasterization (outVertex)
-    OutputVertexData* outVertex = m_setup_unit.GetVertex();
-    TransformUnit::TransformPosition(&m_vertex, outVertex);
-    outVertex->normal = {};
-    if (VertexLoaderManager::g_current_components & VB_HAS_NRM0)
-    {
-      TransformUnit::TransformNormal(
-          &m_vertex, (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0, outVertex);
+      // parse the videocommon format to our own struct format (m_vertex)
+      SetFormat(g_main_cp_state.last_id, primitiveType);
+      ParseVertex(vdec, first + i);
+      m_vertex_batch[i] = m_vertex;
     }
-    TransformUnit::TransformColor(&m_vertex, outVertex);
-    TransformUnit::TransformTexCoord(&m_vertex, outVertex, m_tex_gen_special_case);
 
+    // transform the vertices so that they can be used for rasterization
+    TransformUnit::TransformVertices(m_vertex_batch.data(), &m_transformed_vertices[first], count,
+                                     (components & VB_HAS_NRM0) != 0,
+                                     (components & VB_HAS_NRM2) != 0, m_tex_gen_special_case);
+  }
+
+  for (u32 i = 0; i < num_indices; i++)
+  {
     // assemble and rasterize the primitive
+    *m_setup_unit.GetVertex() = m_transformed_vertices[m_local_index_buffer[i]];
     m_setup_unit.SetupVertex();
 
     INCSTAT(stats.thisFrame.numVerticesLoaded)
   }
 
+  Rasterizer::Flush();
+
   DebugUtil::OnObjectEnd();
 }
 
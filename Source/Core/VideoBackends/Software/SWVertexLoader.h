@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -11,6 +12,7 @@
 
 #include "VideoBackends/Software/NativeVertexFormat.h"
 #include "VideoBackends/Software/SetupUnit.h"
+#include "VideoBackends/Software/TransformUnit.h"
 
 #include "VideoCommon/VertexManagerBase.h"
 
@@ -34,6 +36,8 @@ private:
   std::vector<u16> m_local_index_buffer;
 
   InputVertexData m_vertex;
+  std::array<InputVertexData, TransformUnit::VERTEX_BATCH_SIZE> m_vertex_batch;
+  std::vector<OutputVertexData> m_transformed_vertices;
   SetupUnit m_setup_unit;
 
   bool m_tex_gen_special_case;
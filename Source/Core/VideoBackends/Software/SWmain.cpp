@@ -73,6 +73,7 @@ void VideoSoftware::InitBackendInfo()
   g_Config.backend_info.bSupportsBPTCTextures = false;
   g_Config.backend_info.bSupportsCopyToVram = false;
   g_Config.backend_info.bSupportsFramebufferFetch = false;
+  g_Config.backend_info.bSupportsPerDrawConstants = false;
 
   // aamodes
   g_Config.backend_info.AAModes = {1};
@@ -105,6 +106,7 @@ void VideoSoftware::Shutdown()
     g_renderer->Shutdown();
 
   DebugUtil::Shutdown();
+  Rasterizer::Shutdown();
   SWOGLWindow::Shutdown();
   g_framebuffer_manager.reset();
   g_texture_cache.reset();
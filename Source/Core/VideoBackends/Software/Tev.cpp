@@ -2,10 +2,13 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Tev.h"
@@ -99,6 +102,39 @@ void Tev::Init()
   m_AlphaInputLUT[6] = &StageKonst[ALP_C];  // konst
   m_AlphaInputLUT[7] = &Zero16[ALP_C];      // zero
 
+  // The same inputs for the quad, every value points to the channel of all four pixels
+  for (int pixel = 0; pixel < 4; pixel++)
+  {
+    m_QuadConstants[0][pixel] = FixedConstants[0];
+    m_QuadConstants[1][pixel] = FixedConstants[4];
+    m_QuadConstants[2][pixel] = FixedConstants[8];
+  }
+
+  for (int i = BLU_INP; i <= RED_INP; i++)
+  {
+    const int comp = BLU_C + i;
+    for (int reg = 0; reg < 4; reg++)
+    {
+      m_QuadColorInputLUT[reg * 2][i] = m_QuadReg[reg][comp];       // reg.rgb
+      m_QuadColorInputLUT[reg * 2 + 1][i] = m_QuadReg[reg][ALP_C];  // reg.aaa
+    }
+    m_QuadColorInputLUT[8][i] = m_QuadStage.tex[comp];     // tex.rgb
+    m_QuadColorInputLUT[9][i] = m_QuadStage.tex[ALP_C];    // tex.aaa
+    m_QuadColorInputLUT[10][i] = m_QuadStage.ras[comp];    // ras.rgb
+    m_QuadColorInputLUT[11][i] = m_QuadStage.ras[ALP_C];   // ras.aaa
+    m_QuadColorInputLUT[12][i] = m_QuadConstants[2];       // one
+    m_QuadColorInputLUT[13][i] = m_QuadConstants[1];       // half
+    m_QuadColorInputLUT[14][i] = m_QuadStage.konst[comp];  // konst
+    m_QuadColorInputLUT[15][i] = m_QuadConstants[0];       // zero
+  }
+
+  for (int reg = 0; reg < 4; reg++)
+    m_QuadAlphaInputLUT[reg] = m_QuadReg[reg][ALP_C];
+  m_QuadAlphaInputLUT[4] = m_QuadStage.tex[ALP_C];
+  m_QuadAlphaInputLUT[5] = m_QuadStage.ras[ALP_C];
+  m_QuadAlphaInputLUT[6] = m_QuadStage.konst[ALP_C];
+  m_QuadAlphaInputLUT[7] = m_QuadConstants[0];
+
   for (int comp = 0; comp < 4; comp++)
   {
     m_KonstLUT[0][comp] = &FixedConstants[8];
@@ -157,6 +193,40 @@ void Tev::Init()
   m_ScaleRShiftLUT[1] = 0;
   m_ScaleRShiftLUT[2] = 0;
   m_ScaleRShiftLUT[3] = 1;
+
+  ResetCounters();
+}
+
+void Tev::ResetCounters()
+{
+  counters = {};
+  counters.bounding_box[BoundingBox::LEFT] = 0xffff;
+  counters.bounding_box[BoundingBox::TOP] = 0xffff;
+}
+
+void Tev::FlushCounters()
+{
+  ADDSTAT(stats.thisFrame.rasterizedPixels, counters.rasterized_pixels);
+  ADDSTAT(stats.thisFrame.tevPixelsIn, counters.tev_pixels_in);
+  ADDSTAT(stats.thisFrame.tevPixelsOut, counters.tev_pixels_out);
+
+  for (int i = 0; i < PQ_NUM_MEMBERS; ++i)
+  {
+    if (counters.perf_pixels[i])
+      EfbInterface::IncPerfCounterQuadCount(static_cast<PerfQueryType>(i),
+                                            counters.perf_pixels[i]);
+  }
+
+  BoundingBox::coords[BoundingBox::LEFT] =
+      std::min(counters.bounding_box[BoundingBox::LEFT], BoundingBox::coords[BoundingBox::LEFT]);
+  BoundingBox::coords[BoundingBox::RIGHT] =
+      std::max(counters.bounding_box[BoundingBox::RIGHT], BoundingBox::coords[BoundingBox::RIGHT]);
+  BoundingBox::coords[BoundingBox::TOP] =
+      std::min(counters.bounding_box[BoundingBox::TOP], BoundingBox::coords[BoundingBox::TOP]);
+  BoundingBox::coords[BoundingBox::BOTTOM] = std::max(
+      counters.bounding_box[BoundingBox::BOTTOM], BoundingBox::coords[BoundingBox::BOTTOM]);
+
+  ResetCounters();
 }
 
 static inline s16 Clamp255(s16 in)
@@ -374,6 +444,119 @@ void Tev::DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const Inpu
   }
 }
 
+void Tev::DrawRegular(const TevStageCombiner::ColorCombiner& cc,
+                      const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
+{
+#ifdef _M_X86
+  // One 32 bit lane per channel, in the ABGR order of Reg. The alpha lane uses the parameters of
+  // the alpha combiner and the others those of the color combiner, otherwise this is the same
+  // math as in DrawColorRegular and DrawAlphaRegular.
+  const u32 color_lshift = m_ScaleLShiftLUT[cc.shift];
+  const u32 alpha_lshift = m_ScaleLShiftLUT[ac.shift];
+  const s16 color_round = (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+  const s16 alpha_round = (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+
+  // a * (256 - c) + b * c, with the scale folded into the factors
+  s16 c[4];
+  for (int i = 0; i < 4; i++)
+    c[i] = inputs[i].c + (inputs[i].c >> 7);
+  const __m128i ab = _mm_setr_epi16(inputs[ALP_C].a, inputs[ALP_C].b, inputs[BLU_C].a,
+                                    inputs[BLU_C].b, inputs[GRN_C].a, inputs[GRN_C].b,
+                                    inputs[RED_C].a, inputs[RED_C].b);
+  const __m128i factors =
+      _mm_setr_epi16((256 - c[ALP_C]) << alpha_lshift, c[ALP_C] << alpha_lshift,
+                     (256 - c[BLU_C]) << color_lshift, c[BLU_C] << color_lshift,
+                     (256 - c[GRN_C]) << color_lshift, c[GRN_C] << color_lshift,
+                     (256 - c[RED_C]) << color_lshift, c[RED_C] << color_lshift);
+  __m128i temp = _mm_madd_epi16(ab, factors);
+  temp = _mm_add_epi32(temp, _mm_setr_epi32(alpha_round, color_round, color_round, color_round));
+
+  // The alpha combiner negates before dividing by 256, the color combiner afterwards
+  const __m128i negate_before = _mm_setr_epi32(ac.op ? -1 : 0, 0, 0, 0);
+  const __m128i negate_after = _mm_setr_epi32(0, cc.op ? -1 : 0, cc.op ? -1 : 0, cc.op ? -1 : 0);
+  temp = _mm_sub_epi32(_mm_xor_si128(temp, negate_before), negate_before);
+  temp = _mm_srai_epi32(temp, 8);
+  temp = _mm_sub_epi32(_mm_xor_si128(temp, negate_after), negate_after);
+
+  // (d + bias) << lshift
+  const s16 color_bias = m_BiasLUT[cc.bias];
+  const s16 alpha_bias = m_BiasLUT[ac.bias];
+  __m128i d = _mm_setr_epi16(inputs[ALP_C].d + alpha_bias, inputs[BLU_C].d + color_bias,
+                             inputs[GRN_C].d + color_bias, inputs[RED_C].d + color_bias, 0, 0, 0,
+                             0);
+  d = _mm_mullo_epi16(d, _mm_setr_epi16(1 << alpha_lshift, 1 << color_lshift, 1 << color_lshift,
+                                        1 << color_lshift, 0, 0, 0, 0));
+  d = _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16);
+
+  __m128i result = _mm_add_epi32(d, temp);
+  const __m128i rshift = _mm_setr_epi32(m_ScaleRShiftLUT[ac.shift] ? -1 : 0,
+                                        m_ScaleRShiftLUT[cc.shift] ? -1 : 0,
+                                        m_ScaleRShiftLUT[cc.shift] ? -1 : 0,
+                                        m_ScaleRShiftLUT[cc.shift] ? -1 : 0);
+  result = _mm_or_si128(_mm_and_si128(rshift, _mm_srai_epi32(result, 1)),
+                        _mm_andnot_si128(rshift, result));
+
+  // The results always fit into 16 bits, so saturating doesn't change anything
+  alignas(16) s16 output[8];
+  _mm_store_si128(reinterpret_cast<__m128i*>(output), _mm_packs_epi32(result, result));
+
+  Reg[cc.dest][BLU_C] = output[BLU_C];
+  Reg[cc.dest][GRN_C] = output[GRN_C];
+  Reg[cc.dest][RED_C] = output[RED_C];
+  Reg[ac.dest][ALP_C] = output[ALP_C];
+#else
+  DrawColorRegular(cc, inputs);
+  DrawAlphaRegular(ac, inputs);
+#endif
+}
+
+#ifdef _M_X86
+static __m128i LoadQuadChannel(const s16* values)
+{
+  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+}
+
+// The math of DrawColorRegular or DrawAlphaRegular for one channel of the four pixels of a quad,
+// returns a 32 bit result for every pixel. The alpha combiner negates before dividing by 256, the
+// color combiner afterwards.
+static __m128i CombineQuadChannel(const s16* a, const s16* b, const s16* c, const s16* d, s32 bias,
+                                  u32 lshift, u32 rshift, s32 round, bool negate_before,
+                                  bool negate_after)
+{
+  // Like InputRegType, a, b and c are truncated to 8 bits and d to 11 bits
+  const __m128i mask = _mm_set1_epi16(0xFF);
+  const __m128i va = _mm_and_si128(LoadQuadChannel(a), mask);
+  const __m128i vb = _mm_and_si128(LoadQuadChannel(b), mask);
+  __m128i vc = _mm_and_si128(LoadQuadChannel(c), mask);
+  __m128i vd = _mm_srai_epi16(_mm_slli_epi16(LoadQuadChannel(d), 5), 5);
+
+  // a * (256 - c) + b * c, with the scale folded into the factors
+  const __m128i shift = _mm_cvtsi32_si128(lshift);
+  vc = _mm_add_epi16(vc, _mm_srli_epi16(vc, 7));
+  const __m128i factors = _mm_unpacklo_epi16(
+      _mm_sll_epi16(_mm_sub_epi16(_mm_set1_epi16(256), vc), shift), _mm_sll_epi16(vc, shift));
+  __m128i temp = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), factors);
+  temp = _mm_add_epi32(temp, _mm_set1_epi32(round));
+  if (negate_before)
+    temp = _mm_sub_epi32(_mm_setzero_si128(), temp);
+  temp = _mm_srai_epi32(temp, 8);
+  if (negate_after)
+    temp = _mm_sub_epi32(_mm_setzero_si128(), temp);
+
+  // (d + bias) << lshift
+  vd = _mm_srai_epi32(_mm_unpacklo_epi16(vd, vd), 16);
+  vd = _mm_sll_epi32(_mm_add_epi32(vd, _mm_set1_epi32(bias)), shift);
+
+  return _mm_sra_epi32(_mm_add_epi32(vd, temp), _mm_cvtsi32_si128(rshift));
+}
+
+static __m128i ClampQuad(__m128i values, bool clamp)
+{
+  return clamp ? _mm_min_epi16(_mm_max_epi16(values, _mm_setzero_si128()), _mm_set1_epi16(255)) :
+                 _mm_min_epi16(_mm_max_epi16(values, _mm_set1_epi16(-1024)), _mm_set1_epi16(1023));
+}
+#endif
+
 static bool AlphaCompare(int alpha, int ref, AlphaTest::CompareMode comp)
 {
   switch (comp)
@@ -419,6 +602,76 @@ static bool TevAlphaTest(int alpha)
   }
 }
 
+#ifdef _M_X86
+static __m128i AlphaCompareQuad(__m128i alpha, int ref, AlphaTest::CompareMode comp)
+{
+  const __m128i vref = _mm_set1_epi16(ref);
+  const __m128i all = _mm_set1_epi16(-1);
+  switch (comp)
+  {
+  case AlphaTest::ALWAYS:
+    return all;
+  case AlphaTest::NEVER:
+    return _mm_setzero_si128();
+  case AlphaTest::LEQUAL:
+    return _mm_xor_si128(_mm_cmpgt_epi16(alpha, vref), all);
+  case AlphaTest::LESS:
+    return _mm_cmplt_epi16(alpha, vref);
+  case AlphaTest::GEQUAL:
+    return _mm_xor_si128(_mm_cmplt_epi16(alpha, vref), all);
+  case AlphaTest::GREATER:
+    return _mm_cmpgt_epi16(alpha, vref);
+  case AlphaTest::EQUAL:
+    return _mm_cmpeq_epi16(alpha, vref);
+  case AlphaTest::NEQUAL:
+    return _mm_xor_si128(_mm_cmpeq_epi16(alpha, vref), all);
+  default:
+    return all;
+  }
+}
+#endif
+
+// Same as TevAlphaTest for the alpha channel of the four pixels of a quad, returns a bit for
+// every pixel which passes
+static int TevAlphaTestQuad(const s16 alpha[4])
+{
+#ifdef _M_X86
+  const __m128i values = _mm_and_si128(LoadQuadChannel(alpha), _mm_set1_epi16(0xFF));
+  const __m128i comp0 = AlphaCompareQuad(values, bpmem.alpha_test.ref0, bpmem.alpha_test.comp0);
+  const __m128i comp1 = AlphaCompareQuad(values, bpmem.alpha_test.ref1, bpmem.alpha_test.comp1);
+
+  __m128i result;
+  switch (bpmem.alpha_test.logic)
+  {
+  case 0:
+    result = _mm_and_si128(comp0, comp1);  // and
+    break;
+  case 1:
+    result = _mm_or_si128(comp0, comp1);  // or
+    break;
+  case 2:
+    result = _mm_xor_si128(comp0, comp1);  // xor
+    break;
+  case 3:
+    result = _mm_xor_si128(_mm_xor_si128(comp0, comp1), _mm_set1_epi16(-1));  // xnor
+    break;
+  default:
+    result = _mm_set1_epi16(-1);
+    break;
+  }
+
+  return _mm_movemask_epi8(_mm_packs_epi16(result, result)) & 0xF;
+#else
+  int passed = 0;
+  for (int pixel = 0; pixel < 4; pixel++)
+  {
+    if (TevAlphaTest(static_cast<u8>(alpha[pixel])))
+      passed |= 1 << pixel;
+  }
+  return passed;
+#endif
+}
+
 static inline s32 WrapIndirectCoord(s32 coord, int wrapMode)
 {
   switch (wrapMode)
@@ -562,14 +815,56 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
   }
 }
 
-void Tev::Draw()
+void Tev::SetupStage(unsigned int stageNum)
 {
-  _assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
-  _assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+  const int stageNum2 = stageNum >> 1;
+  const int stageOdd = stageNum & 1;
+  const TwoTevStageOrders& order = bpmem.tevorders[stageNum2];
+  const TevKSel& kSel = bpmem.tevksel[stageNum2];
+  const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
 
-  INCSTAT(stats.thisFrame.tevPixelsIn);
+  const int texcoordSel = order.getTexCoord(stageOdd);
+  const int texmap = order.getTexMap(stageOdd);
 
-  // initial color values
+  Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+
+  // sample texture
+  if (order.getEnable(stageOdd))
+  {
+    // RGBA
+    u8 texel[4];
+
+    TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum],
+                           texmap, texel);
+
+#if ALLOW_TEV_DUMPS
+    if (g_ActiveConfig.bDumpTevTextureFetches)
+      DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
+#endif
+
+    int swaptable = ac.tswap * 2;
+
+    TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
+    TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
+    swaptable++;
+    TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
+    TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+  }
+
+  // set konst for this stage
+  const int kc = kSel.getKC(stageOdd);
+  const int ka = kSel.getKA(stageOdd);
+  StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
+  StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
+  StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
+  StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+
+  // set color
+  SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+}
+
+void Tev::InitRegisters()
+{
   for (int i = 0; i < 4; i++)
   {
     Reg[i][RED_C] = PixelShaderManager::constants.colors[i][0];
@@ -577,7 +872,10 @@ void Tev::Draw()
     Reg[i][BLU_C] = PixelShaderManager::constants.colors[i][2];
     Reg[i][ALP_C] = PixelShaderManager::constants.colors[i][3];
   }
+}
 
+void Tev::SampleIndirectStages()
+{
   for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
   {
     const int stageNum2 = stageNum >> 1;
@@ -604,106 +902,264 @@ void Tev::Draw()
     }
 #endif
   }
+}
 
-  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+static s32 GetZTexture(const s16 tex_color[4], s32 z)
+{
+  u32 ztex = bpmem.ztex1.bias;
+  switch (bpmem.ztex2.type)
   {
-    const int stageNum2 = stageNum >> 1;
-    const int stageOdd = stageNum & 1;
-    const TwoTevStageOrders& order = bpmem.tevorders[stageNum2];
-    const TevKSel& kSel = bpmem.tevksel[stageNum2];
+  case 0:  // 8 bit
+    ztex += tex_color[Tev::ALP_C];
+    break;
+  case 1:  // 16 bit
+    ztex += tex_color[Tev::ALP_C] << 8 | tex_color[Tev::RED_C];
+    break;
+  case 2:  // 24 bit
+    ztex += tex_color[Tev::RED_C] << 16 | tex_color[Tev::GRN_C] << 8 | tex_color[Tev::BLU_C];
+    break;
+  }
 
-    // stage combiners
-    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
-    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+  if (bpmem.ztex2.op == ZTEXTURE_ADD)
+    ztex += z;
 
-    const int texcoordSel = order.getTexCoord(stageOdd);
-    const int texmap = order.getTexMap(stageOdd);
+  return ztex & 0x00ffffff;
+}
 
-    Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+static float GetFogRangeAdjustment(s32 x)
+{
+  // TODO: This is untested and should definitely be checked against real hw.
+  // - No idea if offset is really normalized against the viewport width or against the
+  // projection matrix or yet something else
+  // - scaling of the "k" coefficient isn't clear either.
+
+  // First, calculate the offset from the viewport center (normalized to 0..1)
+  const float offset = (x - (static_cast<s32>(bpmem.fogRange.Base.Center.Value()) - 342)) /
+                       static_cast<float>(xfmem.viewport.wd);
+
+  // Based on that, choose the index such that points which are far away from the z-axis use the
+  // 10th "k" value and such that central points use the first value.
+  float floatindex = 9.f - std::abs(offset) * 9.f;
+  floatindex = (floatindex < 0.f) ? 0.f : (floatindex > 9.f) ?
+                                    9.f :
+                                    floatindex;  // TODO: This shouldn't be necessary!
+
+  // Get the two closest integer indices, look up the corresponding samples
+  const int indexlower = (int)floor(floatindex);
+  const int indexupper = indexlower + 1;
+  // Look up coefficient... Seems like multiplying by 4 makes Fortune Street work properly (fog
+  // is too strong without the factor)
+  const float klower = bpmem.fogRange.K[indexlower / 2].GetValue(indexlower % 2) * 4.f;
+  const float kupper = bpmem.fogRange.K[indexupper / 2].GetValue(indexupper % 2) * 4.f;
+
+  // linearly interpolate the samples, ze gets multiplied by the resulting adjustment factor
+  // NOTE: This is basically dividing by a cosine (hidden behind GXInitFogAdjTable):
+  // 1/cos = c/b = sqrt(a^2+b^2)/b
+  const float factor = indexupper - floatindex;
+  const float k = klower * factor + kupper * (1.f - factor);
+  const float x_adjust = sqrt(offset * offset + k * k) / k;
+  return x_adjust;
+}
 
-    // sample texture
-    if (order.getEnable(stageOdd))
-    {
-      // RGBA
-      u8 texel[4];
+// Applies the fog function to the clamped fog value and converts it to 8.8 fixed point
+static u32 GetFogFactor(float fog)
+{
+  switch (bpmem.fog.c_proj_fsel.fsel)
+  {
+  case 4:  // exp
+    fog = 1.0f - pow(2.0f, -8.0f * fog);
+    break;
+  case 5:  // exp2
+    fog = 1.0f - pow(2.0f, -8.0f * fog * fog);
+    break;
+  case 6:  // backward exp
+    fog = 1.0f - fog;
+    fog = pow(2.0f, -8.0f * fog);
+    break;
+  case 7:  // backward exp2
+    fog = 1.0f - fog;
+    fog = pow(2.0f, -8.0f * fog * fog);
+    break;
+  }
 
-      TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum],
-                             texmap, texel);
+  return (u32)(fog * 256);
+}
 
-#if ALLOW_TEV_DUMPS
-      if (g_ActiveConfig.bDumpTevTextureFetches)
-        DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
-#endif
+void Tev::ApplyFog(s32 x, s32 z, u8 output[4]) const
+{
+  float ze;
 
-      int swaptable = ac.tswap * 2;
+  if (bpmem.fog.c_proj_fsel.proj == 0)
+  {
+    // perspective
+    // ze = A/(B - (Zs >> B_SHF))
+    const s32 denom = bpmem.fog.b_magnitude - (z >> bpmem.fog.b_shift);
+    // in addition downscale magnitude and zs to 0.24 bits
+    ze = (bpmem.fog.GetA() * 16777215.0f) / static_cast<float>(denom);
+  }
+  else
+  {
+    // orthographic
+    // ze = a*Zs
+    // in addition downscale zs to 0.24 bits
+    ze = bpmem.fog.GetA() * (static_cast<float>(z) / 16777215.0f);
+  }
 
-      TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-      TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-      swaptable++;
-      TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-      TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
-    }
+  if (bpmem.fogRange.Base.Enabled)
+    ze *= GetFogRangeAdjustment(x);
 
-    // set konst for this stage
-    const int kc = kSel.getKC(stageOdd);
-    const int ka = kSel.getKA(stageOdd);
-    StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-    StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-    StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-    StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+  ze -= bpmem.fog.GetC();
 
-    // set color
-    SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+  // clamp 0 to 1
+  const float fog = (ze < 0.0f) ? 0.0f : ((ze > 1.0f) ? 1.0f : ze);
 
-    // combine inputs
-    InputRegType inputs[4];
-    for (int i = 0; i < 3; i++)
-    {
-      inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-      inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-      inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-      inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
-    }
-    inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-    inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-    inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-    inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+  // lerp from output to fog color
+  const u32 fogInt = GetFogFactor(fog);
+  const u32 invFog = 256 - fogInt;
 
-    if (cc.bias != 3)
-      DrawColorRegular(cc, inputs);
-    else
-      DrawColorCompare(cc, inputs);
+  output[RED_C] = (output[RED_C] * invFog + fogInt * bpmem.fog.color.r) >> 8;
+  output[GRN_C] = (output[GRN_C] * invFog + fogInt * bpmem.fog.color.g) >> 8;
+  output[BLU_C] = (output[BLU_C] * invFog + fogInt * bpmem.fog.color.b) >> 8;
+}
 
-    if (cc.clamp)
-    {
-      Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-    }
-    else
+void Tev::WritePixel(s32 x, s32 y, s32 z, u8 output[4])
+{
+  const bool late_ztest = !bpmem.zcontrol.early_ztest || !g_ActiveConfig.bZComploc;
+  if (late_ztest && bpmem.zmode.testenable)
+  {
+    // TODO: Check against hw if these values get incremented even if depth testing is disabled
+    counters.perf_pixels[PQ_ZCOMP_INPUT]++;
+
+    if (!ZCompare(x, y, z))
+      return;
+
+    counters.perf_pixels[PQ_ZCOMP_OUTPUT]++;
+  }
+
+  // branchless bounding box update
+  u16* bbox = counters.bounding_box;
+  bbox[BoundingBox::LEFT] = std::min((u16)x, bbox[BoundingBox::LEFT]);
+  bbox[BoundingBox::RIGHT] = std::max((u16)x, bbox[BoundingBox::RIGHT]);
+  bbox[BoundingBox::TOP] = std::min((u16)y, bbox[BoundingBox::TOP]);
+  bbox[BoundingBox::BOTTOM] = std::max((u16)y, bbox[BoundingBox::BOTTOM]);
+
+#if ALLOW_TEV_DUMPS
+  if (g_ActiveConfig.bDumpTevStages)
+  {
+    for (u32 i = 0; i < bpmem.genMode.numindstages; ++i)
+      DebugUtil::CopyTempBuffer(x, y, INDIRECT, i, "Indirect");
+    for (u32 i = 0; i <= bpmem.genMode.numtevstages; ++i)
+      DebugUtil::CopyTempBuffer(x, y, DIRECT, i, "Stage");
+  }
+
+  if (g_ActiveConfig.bDumpTevTextureFetches)
+  {
+    for (u32 i = 0; i <= bpmem.genMode.numtevstages; ++i)
     {
-      Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+      TwoTevStageOrders& order = bpmem.tevorders[i >> 1];
+      if (order.getEnable(i & 1))
+        DebugUtil::CopyTempBuffer(x, y, DIRECT_TFETCH, i, "TFetch");
     }
+  }
+#endif
 
-    if (ac.bias != 3)
-      DrawAlphaRegular(ac, inputs);
-    else
-      DrawAlphaCompare(ac, inputs);
+  counters.tev_pixels_out++;
+  counters.perf_pixels[PQ_BLEND_INPUT]++;
 
-    if (ac.clamp)
-      Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-    else
-      Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+  m_BlendTev(x, y, output);
+}
 
-#if ALLOW_TEV_DUMPS
-    if (g_ActiveConfig.bDumpTevStages)
+void Tev::Draw()
+{
+  _assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
+  _assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+
+  counters.tev_pixels_in++;
+
+  // initial color values
+  InitRegisters();
+
+  SampleIndirectStages();
+
+  const bool use_combiners_jit =
+      m_CombinersJit && !(ALLOW_TEV_DUMPS && g_ActiveConfig.bDumpTevStages);
+  if (use_combiners_jit)
+  {
+    for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
     {
-      u8 stage[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
-      DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
+      SetupStage(stageNum);
+
+      TevJit::StageInputs& inputs = m_StageInputs[stageNum];
+      std::memcpy(inputs.tex, TexColor, sizeof(TexColor));
+      std::memcpy(inputs.ras, RasColor, sizeof(RasColor));
+      std::memcpy(inputs.konst, StageKonst, sizeof(StageKonst));
     }
+
+    // The compiled combiners include the alpha test
+    if (!m_CombinersJit(Reg, m_StageInputs))
+      return;
+  }
+  else
+  {
+    for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+    {
+      SetupStage(stageNum);
+
+      const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+      const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+
+      // combine inputs
+      InputRegType inputs[4];
+      for (int i = 0; i < 3; i++)
+      {
+        inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
+        inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
+        inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
+        inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+      }
+      inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
+      inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
+      inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
+      inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+
+      if (cc.bias != 3 && ac.bias != 3)
+        DrawRegular(cc, ac, inputs);
+      else if (cc.bias != 3)
+        DrawColorRegular(cc, inputs);
+      else
+        DrawColorCompare(cc, inputs);
+
+      if (cc.clamp)
+      {
+        Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+        Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+        Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+      }
+      else
+      {
+        Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+        Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+        Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+      }
+
+      if (ac.bias == 3)
+        DrawAlphaCompare(ac, inputs);
+      else if (cc.bias == 3)
+        DrawAlphaRegular(ac, inputs);
+
+      if (ac.clamp)
+        Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+      else
+        Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+
+#if ALLOW_TEV_DUMPS
+      if (g_ActiveConfig.bDumpTevStages)
+      {
+        u8 stage[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
+        DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
+      }
 #endif
+    }
   }
 
   // convert to 8 bits per component
@@ -714,169 +1170,299 @@ void Tev::Draw()
   u8 output[4] = {(u8)Reg[alpha_index][ALP_C], (u8)Reg[color_index][BLU_C],
                   (u8)Reg[color_index][GRN_C], (u8)Reg[color_index][RED_C]};
 
-  if (!TevAlphaTest(output[ALP_C]))
+  if (!use_combiners_jit && !TevAlphaTest(output[ALP_C]))
     return;
 
   // z texture
   if (bpmem.ztex2.op)
+    Position[2] = GetZTexture(TexColor, Position[2]);
+
+  // fog
+  if (bpmem.fog.c_proj_fsel.fsel)
+    ApplyFog(Position[0], Position[2], output);
+
+  WritePixel(Position[0], Position[1], Position[2], output);
+}
+
+void Tev::AddPixel()
+{
+  // The compiled combiners work on one pixel at a time, and drawing quads with them was measured
+  // to be no faster than drawing each pixel right away
+  if (m_CombinersJit)
+  {
+    Draw();
+    return;
+  }
+
+  _assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
+  _assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+  _assert_(m_QuadSize < 4);
+
+  counters.tev_pixels_in++;
+
+  SampleIndirectStages();
+
+  const int pixel = m_QuadSize++;
+  QuadPixel& quad_pixel = m_Quad[pixel];
+  std::memcpy(quad_pixel.position, Position, sizeof(Position));
+
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
   {
-    u32 ztex = bpmem.ztex1.bias;
-    switch (bpmem.ztex2.type)
+    SetupStage(stageNum);
+
+    QuadStageInputs& inputs = m_QuadStages[stageNum];
+    for (int comp = 0; comp < 4; comp++)
     {
-    case 0:  // 8 bit
-      ztex += TexColor[ALP_C];
-      break;
-    case 1:  // 16 bit
-      ztex += TexColor[ALP_C] << 8 | TexColor[RED_C];
-      break;
-    case 2:  // 24 bit
-      ztex += TexColor[RED_C] << 16 | TexColor[GRN_C] << 8 | TexColor[BLU_C];
-      break;
+      inputs.tex[comp][pixel] = TexColor[comp];
+      inputs.ras[comp][pixel] = RasColor[comp];
+      inputs.konst[comp][pixel] = StageKonst[comp];
     }
+  }
 
-    if (bpmem.ztex2.op == ZTEXTURE_ADD)
-      ztex += Position[2];
+  std::memcpy(quad_pixel.tex_color, TexColor, sizeof(TexColor));
+}
 
-    Position[2] = ztex & 0x00ffffff;
+void Tev::DrawQuadPixel(int pixel, const TevStageCombiner::ColorCombiner& cc,
+                        const TevStageCombiner::AlphaCombiner& ac, bool color, bool alpha,
+                        s16 results[4][4])
+{
+  InputRegType inputs[4];
+  for (int i = 0; i < 3; i++)
+  {
+    inputs[BLU_C + i].a = m_QuadColorInputLUT[cc.a][i][pixel];
+    inputs[BLU_C + i].b = m_QuadColorInputLUT[cc.b][i][pixel];
+    inputs[BLU_C + i].c = m_QuadColorInputLUT[cc.c][i][pixel];
+    inputs[BLU_C + i].d = m_QuadColorInputLUT[cc.d][i][pixel];
   }
+  inputs[ALP_C].a = m_QuadAlphaInputLUT[ac.a][pixel];
+  inputs[ALP_C].b = m_QuadAlphaInputLUT[ac.b][pixel];
+  inputs[ALP_C].c = m_QuadAlphaInputLUT[ac.c][pixel];
+  inputs[ALP_C].d = m_QuadAlphaInputLUT[ac.d][pixel];
 
-  // fog
-  if (bpmem.fog.c_proj_fsel.fsel)
+  // Reg only holds the results until they are clamped
+  if (color)
   {
-    float ze;
+    if (cc.bias != 3)
+      DrawColorRegular(cc, inputs);
+    else
+      DrawColorCompare(cc, inputs);
 
-    if (bpmem.fog.c_proj_fsel.proj == 0)
-    {
-      // perspective
-      // ze = A/(B - (Zs >> B_SHF))
-      const s32 denom = bpmem.fog.b_magnitude - (Position[2] >> bpmem.fog.b_shift);
-      // in addition downscale magnitude and zs to 0.24 bits
-      ze = (bpmem.fog.GetA() * 16777215.0f) / static_cast<float>(denom);
-    }
+    for (int i = BLU_C; i <= RED_C; i++)
+      results[i][pixel] = cc.clamp ? Clamp255(Reg[cc.dest][i]) : Clamp1024(Reg[cc.dest][i]);
+  }
+
+  if (alpha)
+  {
+    if (ac.bias != 3)
+      DrawAlphaRegular(ac, inputs);
     else
+      DrawAlphaCompare(ac, inputs);
+
+    results[ALP_C][pixel] =
+        ac.clamp ? Clamp255(Reg[ac.dest][ALP_C]) : Clamp1024(Reg[ac.dest][ALP_C]);
+  }
+}
+
+void Tev::DrawQuadCombiners(int num_pixels)
+{
+  // initial color values
+  for (int i = 0; i < 4; i++)
+  {
+    for (int pixel = 0; pixel < 4; pixel++)
     {
-      // orthographic
-      // ze = a*Zs
-      // in addition downscale zs to 0.24 bits
-      ze = bpmem.fog.GetA() * (static_cast<float>(Position[2]) / 16777215.0f);
+      m_QuadReg[i][RED_C][pixel] = PixelShaderManager::constants.colors[i][0];
+      m_QuadReg[i][GRN_C][pixel] = PixelShaderManager::constants.colors[i][1];
+      m_QuadReg[i][BLU_C][pixel] = PixelShaderManager::constants.colors[i][2];
+      m_QuadReg[i][ALP_C][pixel] = PixelShaderManager::constants.colors[i][3];
     }
+  }
+
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+  {
+    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+
+    std::memcpy(&m_QuadStage, &m_QuadStages[stageNum], sizeof(m_QuadStage));
 
-    if (bpmem.fogRange.Base.Enabled)
+    // Every input is read before the results are written to the registers
+    alignas(16) s16 results[4][4] = {};
+
+#ifdef _M_X86
+    // The regular combiners run on all pixels at once, the compare modes on every pixel alone
+    if (cc.bias != 3)
     {
-      // TODO: This is untested and should definitely be checked against real hw.
-      // - No idea if offset is really normalized against the viewport width or against the
-      // projection matrix or yet something else
-      // - scaling of the "k" coefficient isn't clear either.
-
-      // First, calculate the offset from the viewport center (normalized to 0..1)
-      const float offset =
-          (Position[0] - (static_cast<s32>(bpmem.fogRange.Base.Center.Value()) - 342)) /
-          static_cast<float>(xfmem.viewport.wd);
-
-      // Based on that, choose the index such that points which are far away from the z-axis use the
-      // 10th "k" value and such that central points use the first value.
-      float floatindex = 9.f - std::abs(offset) * 9.f;
-      floatindex = (floatindex < 0.f) ? 0.f : (floatindex > 9.f) ?
-                                        9.f :
-                                        floatindex;  // TODO: This shouldn't be necessary!
-
-      // Get the two closest integer indices, look up the corresponding samples
-      const int indexlower = (int)floor(floatindex);
-      const int indexupper = indexlower + 1;
-      // Look up coefficient... Seems like multiplying by 4 makes Fortune Street work properly (fog
-      // is too strong without the factor)
-      const float klower = bpmem.fogRange.K[indexlower / 2].GetValue(indexlower % 2) * 4.f;
-      const float kupper = bpmem.fogRange.K[indexupper / 2].GetValue(indexupper % 2) * 4.f;
-
-      // linearly interpolate the samples and multiple ze by the resulting adjustment factor
-      const float factor = indexupper - floatindex;
-      const float k = klower * factor + kupper * (1.f - factor);
-      const float x_adjust = sqrt(offset * offset + k * k) / k;
-      ze *= x_adjust;  // NOTE: This is basically dividing by a cosine (hidden behind
-                       // GXInitFogAdjTable): 1/cos = c/b = sqrt(a^2+b^2)/b
+      const s32 round = (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+      __m128i channels[3];
+      for (int i = BLU_INP; i <= RED_INP; i++)
+      {
+        channels[i] = CombineQuadChannel(
+            m_QuadColorInputLUT[cc.a][i], m_QuadColorInputLUT[cc.b][i],
+            m_QuadColorInputLUT[cc.c][i], m_QuadColorInputLUT[cc.d][i], m_BiasLUT[cc.bias],
+            m_ScaleLShiftLUT[cc.shift], m_ScaleRShiftLUT[cc.shift], round, false, cc.op != 0);
+      }
+
+      // The results always fit into 16 bits, so saturating doesn't change anything
+      const __m128i blue_green = ClampQuad(_mm_packs_epi32(channels[0], channels[1]), cc.clamp);
+      const __m128i red = ClampQuad(_mm_packs_epi32(channels[2], channels[2]), cc.clamp);
+      _mm_store_si128(reinterpret_cast<__m128i*>(results[BLU_C]), blue_green);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(results[RED_C]), red);
     }
 
-    ze -= bpmem.fog.GetC();
+    if (ac.bias != 3)
+    {
+      const s32 round = (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+      const __m128i alpha = CombineQuadChannel(
+          m_QuadAlphaInputLUT[ac.a], m_QuadAlphaInputLUT[ac.b], m_QuadAlphaInputLUT[ac.c],
+          m_QuadAlphaInputLUT[ac.d], m_BiasLUT[ac.bias], m_ScaleLShiftLUT[ac.shift],
+          m_ScaleRShiftLUT[ac.shift], round, ac.op != 0, false);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(results[ALP_C]),
+                       ClampQuad(_mm_packs_epi32(alpha, alpha), ac.clamp));
+    }
 
-    // clamp 0 to 1
-    float fog = (ze < 0.0f) ? 0.0f : ((ze > 1.0f) ? 1.0f : ze);
+    const bool color_per_pixel = cc.bias == 3;
+    const bool alpha_per_pixel = ac.bias == 3;
+#else
+    const bool color_per_pixel = true;
+    const bool alpha_per_pixel = true;
+#endif
 
-    switch (bpmem.fog.c_proj_fsel.fsel)
+    if (color_per_pixel || alpha_per_pixel)
     {
-    case 4:  // exp
-      fog = 1.0f - pow(2.0f, -8.0f * fog);
-      break;
-    case 5:  // exp2
-      fog = 1.0f - pow(2.0f, -8.0f * fog * fog);
-      break;
-    case 6:  // backward exp
-      fog = 1.0f - fog;
-      fog = pow(2.0f, -8.0f * fog);
-      break;
-    case 7:  // backward exp2
-      fog = 1.0f - fog;
-      fog = pow(2.0f, -8.0f * fog * fog);
-      break;
+      for (int pixel = 0; pixel < num_pixels; pixel++)
+        DrawQuadPixel(pixel, cc, ac, color_per_pixel, alpha_per_pixel, results);
     }
 
-    // lerp from output to fog color
-    const u32 fogInt = (u32)(fog * 256);
-    const u32 invFog = 256 - fogInt;
-
-    output[RED_C] = (output[RED_C] * invFog + fogInt * bpmem.fog.color.r) >> 8;
-    output[GRN_C] = (output[GRN_C] * invFog + fogInt * bpmem.fog.color.g) >> 8;
-    output[BLU_C] = (output[BLU_C] * invFog + fogInt * bpmem.fog.color.b) >> 8;
+    std::memcpy(m_QuadReg[cc.dest][BLU_C], results[BLU_C], sizeof(results[BLU_C]) * 3);
+    std::memcpy(m_QuadReg[ac.dest][ALP_C], results[ALP_C], sizeof(results[ALP_C]));
   }
+}
 
-  const bool late_ztest = !bpmem.zcontrol.early_ztest || !g_ActiveConfig.bZComploc;
-  if (late_ztest && bpmem.zmode.testenable)
+void Tev::ApplyFogQuad(int num_pixels, const s32 x[4], const s32 z[4], u8 output[4][4]) const
+{
+#ifdef _M_X86
+  // The same math as ApplyFog, only the fog function runs for every pixel on its own
+  const __m128i vz = _mm_loadu_si128(reinterpret_cast<const __m128i*>(z));
+  __m128 ze;
+  if (bpmem.fog.c_proj_fsel.proj == 0)
   {
-    // TODO: Check against hw if these values get incremented even if depth testing is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+    // Shifts by the low 5 bits like x86 does in ApplyFog
+    const __m128i shift = _mm_cvtsi32_si128(bpmem.fog.b_shift & 31);
+    const __m128i denom =
+        _mm_sub_epi32(_mm_set1_epi32(bpmem.fog.b_magnitude), _mm_sra_epi32(vz, shift));
+    ze = _mm_div_ps(_mm_set1_ps(bpmem.fog.GetA() * 16777215.0f), _mm_cvtepi32_ps(denom));
+  }
+  else
+  {
+    ze = _mm_mul_ps(_mm_set1_ps(bpmem.fog.GetA()),
+                    _mm_div_ps(_mm_cvtepi32_ps(vz), _mm_set1_ps(16777215.0f)));
+  }
 
-    if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
-      return;
+  if (bpmem.fogRange.Base.Enabled)
+  {
+    alignas(16) float adjust[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int pixel = 0; pixel < num_pixels; pixel++)
+      adjust[pixel] = GetFogRangeAdjustment(x[pixel]);
+    ze = _mm_mul_ps(ze, _mm_load_ps(adjust));
+  }
 
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+  ze = _mm_sub_ps(ze, _mm_set1_ps(bpmem.fog.GetC()));
+
+  // clamp 0 to 1, with the operands in the order which keeps NaNs like ApplyFog does
+  alignas(16) float fog[4];
+  _mm_store_ps(fog, _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_setzero_ps(), ze)));
+
+  u32 fog_int[4] = {};
+  for (int pixel = 0; pixel < num_pixels; pixel++)
+    fog_int[pixel] = GetFogFactor(fog[pixel]);
+
+  // lerp from output to fog color. Only bits 8 to 15 of the sum end up in the result, so 16 bit
+  // math gives the same result even for factors outside of 0 to 256.
+  const s16 fog_r = static_cast<s16>(bpmem.fog.color.r.Value());
+  const s16 fog_g = static_cast<s16>(bpmem.fog.color.g.Value());
+  const s16 fog_b = static_cast<s16>(bpmem.fog.color.b.Value());
+  const __m128i fog_color = _mm_setr_epi16(0, fog_b, fog_g, fog_r, 0, fog_b, fog_g, fog_r);
+  const __m128i colors = _mm_load_si128(reinterpret_cast<const __m128i*>(output));
+  __m128i results[2];
+  for (int i = 0; i < 2; i++)
+  {
+    // The alpha channel is kept by a factor of 0
+    const s16 factor0 = static_cast<s16>(fog_int[i * 2]);
+    const s16 factor1 = static_cast<s16>(fog_int[i * 2 + 1]);
+    const __m128i factor =
+        _mm_setr_epi16(0, factor0, factor0, factor0, 0, factor1, factor1, factor1);
+    const __m128i inv_factor = _mm_sub_epi16(_mm_set1_epi16(256), factor);
+    const __m128i color = i == 0 ? _mm_unpacklo_epi8(colors, _mm_setzero_si128()) :
+                                   _mm_unpackhi_epi8(colors, _mm_setzero_si128());
+    results[i] = _mm_srli_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(color, inv_factor), _mm_mullo_epi16(fog_color, factor)), 8);
   }
+  _mm_store_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(results[0], results[1]));
+#else
+  for (int pixel = 0; pixel < num_pixels; pixel++)
+    ApplyFog(x[pixel], z[pixel], output[pixel]);
+#endif
+}
 
-  // branchless bounding box update
-  BoundingBox::coords[BoundingBox::LEFT] =
-      std::min((u16)Position[0], BoundingBox::coords[BoundingBox::LEFT]);
-  BoundingBox::coords[BoundingBox::RIGHT] =
-      std::max((u16)Position[0], BoundingBox::coords[BoundingBox::RIGHT]);
-  BoundingBox::coords[BoundingBox::TOP] =
-      std::min((u16)Position[1], BoundingBox::coords[BoundingBox::TOP]);
-  BoundingBox::coords[BoundingBox::BOTTOM] =
-      std::max((u16)Position[1], BoundingBox::coords[BoundingBox::BOTTOM]);
+void Tev::DrawQuad()
+{
+  const int num_pixels = m_QuadSize;
+  m_QuadSize = 0;
 
-#if ALLOW_TEV_DUMPS
-  if (g_ActiveConfig.bDumpTevStages)
+  if (num_pixels == 0)
+    return;
+
+  DrawQuadCombiners(num_pixels);
+
+  // convert to 8 bits per component, like in Draw. Pixels missing from the quad are masked out
+  // of passed below.
+  alignas(16) u8 output[4][4];
+  const u32 color_index = bpmem.combiners[bpmem.genMode.numtevstages].colorC.dest;
+  const u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
+  for (int pixel = 0; pixel < 4; pixel++)
   {
-    for (u32 i = 0; i < bpmem.genMode.numindstages; ++i)
-      DebugUtil::CopyTempBuffer(Position[0], Position[1], INDIRECT, i, "Indirect");
-    for (u32 i = 0; i <= bpmem.genMode.numtevstages; ++i)
-      DebugUtil::CopyTempBuffer(Position[0], Position[1], DIRECT, i, "Stage");
+    output[pixel][ALP_C] = (u8)m_QuadReg[alpha_index][ALP_C][pixel];
+    output[pixel][BLU_C] = (u8)m_QuadReg[color_index][BLU_C][pixel];
+    output[pixel][GRN_C] = (u8)m_QuadReg[color_index][GRN_C][pixel];
+    output[pixel][RED_C] = (u8)m_QuadReg[color_index][RED_C][pixel];
   }
 
-  if (g_ActiveConfig.bDumpTevTextureFetches)
+  const int passed = TevAlphaTestQuad(m_QuadReg[alpha_index][ALP_C]) & ((1 << num_pixels) - 1);
+  if (!passed)
+    return;
+
+  s32 x[4] = {};
+  s32 y[4] = {};
+  s32 z[4] = {};
+  for (int pixel = 0; pixel < num_pixels; pixel++)
   {
-    for (u32 i = 0; i <= bpmem.genMode.numtevstages; ++i)
-    {
-      TwoTevStageOrders& order = bpmem.tevorders[i >> 1];
-      if (order.getEnable(i & 1))
-        DebugUtil::CopyTempBuffer(Position[0], Position[1], DIRECT_TFETCH, i, "TFetch");
-    }
+    x[pixel] = m_Quad[pixel].position[0];
+    y[pixel] = m_Quad[pixel].position[1];
+    z[pixel] = m_Quad[pixel].position[2];
+
+    // z texture
+    if (bpmem.ztex2.op)
+      z[pixel] = GetZTexture(m_Quad[pixel].tex_color, z[pixel]);
   }
-#endif
 
-  INCSTAT(stats.thisFrame.tevPixelsOut);
-  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+  // fog
+  if (bpmem.fog.c_proj_fsel.fsel)
+    ApplyFogQuad(num_pixels, x, z, output);
 
-  EfbInterface::BlendTev(Position[0], Position[1], output);
+  for (int pixel = 0; pixel < num_pixels; pixel++)
+  {
+    if (passed & (1 << pixel))
+      WritePixel(x[pixel], y[pixel], z[pixel], output[pixel]);
+  }
 }
 
 void Tev::SetRegColor(int reg, int comp, s16 color)
 {
   KonstantColors[reg][comp] = color;
 }
+
+void Tev::SetPixelJit(const TevJit::PixelFunctions& functions)
+{
+  m_CombinersJit = functions.combiners;
+  m_ZCompare = functions.depth ? functions.depth : EfbInterface::ZCompare;
+  m_BlendTev = functions.blend ? functions.blend : EfbInterface::BlendTev;
+}
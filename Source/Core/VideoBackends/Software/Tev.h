@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/TevJit.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class Tev
 {
@@ -35,9 +39,38 @@ class Tev
   u8 IndirectTex[4][4];
   TextureCoordinateType TexCoord;
 
+  TevJit::StageInputs m_StageInputs[16];
+
+  // The pixels added to the current quad, see AddPixel
+  struct QuadPixel
+  {
+    s32 position[3];
+    s16 tex_color[4];  // of the last stage, for the z texture
+  };
+  QuadPixel m_Quad[4];
+  int m_QuadSize = 0;
+
+  // The interpreted combiners draw the quad a channel at a time, so the registers and the stage
+  // inputs are stored with one value for every pixel of the quad: [reg][comp][pixel]
+  struct QuadStageInputs
+  {
+    s16 tex[4][4];
+    s16 ras[4][4];
+    s16 konst[4][4];
+  };
+  s16 m_QuadReg[4][4][4];
+  QuadStageInputs m_QuadStage;  // of the stage being drawn
+  QuadStageInputs m_QuadStages[16];
+  s16 m_QuadConstants[3][4];  // zero, half and one for every pixel
+  TevJit::CombinerFunction m_CombinersJit = nullptr;
+  TevJit::DepthFunction m_ZCompare = EfbInterface::ZCompare;
+  TevJit::BlendFunction m_BlendTev = EfbInterface::BlendTev;
+
   s16* m_ColorInputLUT[16][3];
   s16* m_AlphaInputLUT[8];  // values must point to ABGR color
   s16* m_KonstLUT[32][4];
+  const s16* m_QuadColorInputLUT[16][3];  // values point to the four pixels of a channel
+  const s16* m_QuadAlphaInputLUT[8];
   s16 m_BiasLUT[4];
   u8 m_ScaleLShiftLUT[4];
   u8 m_ScaleRShiftLUT[4];
@@ -63,9 +96,32 @@ class Tev
   void DrawColorCompare(const TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
   void DrawAlphaRegular(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
   void DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+  // Same as DrawColorRegular and DrawAlphaRegular, but combines all four channels at once
+  void DrawRegular(const TevStageCombiner::ColorCombiner& cc,
+                   const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+
+  // Draws all stages of the interpreted combiners for the pixels of the quad
+  void DrawQuadCombiners(int num_pixels);
+  // The parts of a stage which can't be drawn for the whole quad at once, results are [comp][pixel]
+  void DrawQuadPixel(int pixel, const TevStageCombiner::ColorCombiner& cc,
+                     const TevStageCombiner::AlphaCombiner& ac, bool color, bool alpha,
+                     s16 results[4][4]);
 
   void Indirect(unsigned int stageNum, s32 s, s32 t);
 
+  void InitRegisters();
+  void SampleIndirectStages();
+
+  // Samples the texture and sets up the konst and rasterized color of a stage
+  void SetupStage(unsigned int stageNum);
+
+  void ApplyFog(s32 x, s32 z, u8 output[4]) const;
+  void ApplyFogQuad(int num_pixels, const s32 x[4], const s32 z[4], u8 output[4][4]) const;
+  // Everything after the fog: the late depth test, the bounding box and blending
+  void WritePixel(s32 x, s32 y, s32 z, u8 output[4]);
+
+  void ResetCounters();
+
 public:
   s32 Position[3];
   u8 Color[2][4];  // must be RGBA for correct swap table ordering
@@ -75,6 +131,18 @@ public:
   s32 TextureLod[16];
   bool TextureLinear[16];
 
+  // Statistics of the pixels drawn through this Tev. Every Tev counts on its own so that
+  // several of them can draw at once, FlushCounters adds them to the global statistics.
+  struct Counters
+  {
+    u32 rasterized_pixels;
+    u32 tev_pixels_in;
+    u32 tev_pixels_out;
+    u32 perf_pixels[PQ_NUM_MEMBERS];
+    u16 bounding_box[4];
+  };
+  Counters counters;
+
   enum
   {
     ALP_C,
@@ -87,5 +155,20 @@ public:
 
   void Draw();
 
+  // Draws the pixels of a 2x2 quad, with the combiners, the alpha test and the fog of all pixels
+  // computed together. Set the inputs above and call AddPixel for every covered pixel of the quad,
+  // then call DrawQuad. The result is the same as calling Draw for every pixel, which is what
+  // AddPixel does when the combiners are compiled.
+  void AddPixel();
+  void DrawQuad();
+
   void SetRegColor(int reg, int comp, s16 color);
+
+  // Uses the functions compiled for the current BP state, interpreting the parts which are nullptr
+  void SetPixelJit(const TevJit::PixelFunctions& functions);
+
+  // Same as EfbInterface::ZCompare, but compiled for the current BP state if possible
+  bool ZCompare(u16 x, u16 y, u32 z) const { return m_ZCompare(x, y, z); }
+
+  void FlushCounters();
 };
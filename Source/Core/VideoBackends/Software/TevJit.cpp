@@ -0,0 +1,987 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Software/TevJit.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "Common/Assert.h"
+#include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
+#include "Common/MemoryUtil.h"
+#include "Common/x64ABI.h"
+#include "Common/x64Emitter.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoCommon/BPMemory.h"
+
+using namespace Gen;
+
+namespace TevJit
+{
+// Register order of Tev
+enum
+{
+  ALP_C,
+  BLU_C,
+  GRN_C,
+  RED_C
+};
+
+// Combiners
+static const X64Reg reg_ptr = ABI_PARAM1;
+static const X64Reg stages_ptr = ABI_PARAM2;
+static const X64Reg scratch = R10;
+
+// Depth test and blending, which take the pixel position in ABI_PARAM1 and ABI_PARAM2
+static const X64Reg pixel_ptr = R10;
+static const X64Reg color_ptr = R11;
+
+// Only XMM0 to XMM5 are caller-saved in every ABI
+static const X64Reg input_a = XMM0;
+static const X64Reg input_b = XMM1;
+static const X64Reg input_c = XMM2;
+static const X64Reg input_d = XMM3;
+static const X64Reg temp1 = XMM4;
+static const X64Reg temp2 = XMM5;
+
+static const size_t MAX_CONSTANTS = 128;
+// When more programs than this have been compiled, all of them are freed
+static const size_t MAX_PROGRAMS = 1024;
+
+// The alpha and depth tests use the same compare modes
+static_assert(static_cast<u32>(AlphaTest::LESS) == ZMode::LESS &&
+                  static_cast<u32>(AlphaTest::GEQUAL) == ZMode::GEQUAL,
+              "Compare modes differ");
+
+// The flags for which "a mode b" holds after comparing a to b
+static CCFlags GetCompareFlags(u32 mode)
+{
+  switch (mode)
+  {
+  case ZMode::LESS:
+    return CC_B;
+  case ZMode::EQUAL:
+    return CC_E;
+  case ZMode::LEQUAL:
+    return CC_BE;
+  case ZMode::GREATER:
+    return CC_A;
+  case ZMode::NEQUAL:
+    return CC_NE;
+  case ZMode::GEQUAL:
+    return CC_AE;
+  default:
+    _assert_msg_(VIDEO, false, "Compare mode %u has no flags", mode);
+    return CC_E;
+  }
+}
+
+static bool IsSupportedPixelFormat(u32 format)
+{
+  return format <= PEControl::Z24;
+}
+
+struct CombinerUid
+{
+  u32 num_stages;
+  // Only the compare modes and the logic, the references are read when running
+  u32 alpha_test;
+  u32 color[16];
+  u32 alpha[16];
+};
+
+struct DepthUid
+{
+  u32 pixel_format;
+  u32 func;
+  u32 update_enable;
+};
+
+struct BlendUid
+{
+  u32 pixel_format;
+  u32 blend_mode;
+  // The alpha itself is read when running
+  u32 dst_alpha_enable;
+};
+
+// All UIDs only consist of u32s, so they can be compared bytewise
+template <typename Uid>
+struct UidLess
+{
+  bool operator()(const Uid& a, const Uid& b) const
+  {
+    return std::memcmp(&a, &b, sizeof(Uid)) < 0;
+  }
+};
+
+static CombinerUid GetCurrentCombinerUid()
+{
+  CombinerUid uid = {};
+  uid.num_stages = bpmem.genMode.numtevstages + 1;
+  uid.alpha_test = bpmem.alpha_test.hex & 0xFF0000;
+  for (u32 i = 0; i < uid.num_stages; i++)
+  {
+    uid.color[i] = bpmem.combiners[i].colorC.hex & 0xFFFFFF;
+    // The swap table selection only matters when gathering the inputs
+    uid.alpha[i] = bpmem.combiners[i].alphaC.hex & 0xFFFFF0;
+  }
+  return uid;
+}
+
+static DepthUid GetCurrentDepthUid()
+{
+  DepthUid uid = {};
+  uid.pixel_format = bpmem.zcontrol.pixel_format;
+  uid.func = bpmem.zmode.func;
+  uid.update_enable = bpmem.zmode.updateenable;
+  return uid;
+}
+
+static BlendUid GetCurrentBlendUid()
+{
+  BlendUid uid = {};
+  uid.pixel_format = bpmem.zcontrol.pixel_format;
+  uid.blend_mode = bpmem.blendmode.hex & 0xFFFF;
+  uid.dst_alpha_enable = bpmem.dstalpha.enable;
+  return uid;
+}
+
+static bool CanCompile(const CombinerUid& uid)
+{
+  for (u32 i = 0; i < uid.num_stages; i++)
+  {
+    TevStageCombiner::ColorCombiner cc;
+    TevStageCombiner::AlphaCombiner ac;
+    cc.hex = uid.color[i];
+    ac.hex = uid.alpha[i];
+
+    // Compare modes are left to the interpreter
+    if (cc.bias == 3 || ac.bias == 3)
+      return false;
+  }
+  return true;
+}
+
+static bool CanCompile(const DepthUid& uid)
+{
+  return IsSupportedPixelFormat(uid.pixel_format);
+}
+
+static bool CanCompile(const BlendUid& uid)
+{
+  return IsSupportedPixelFormat(uid.pixel_format);
+}
+
+// A function with its own code space and pool of SSE constants
+class PixelJit : public X64CodeBlock
+{
+public:
+  ~PixelJit();
+
+protected:
+  using Constant = std::array<u32, 4>;
+
+  explicit PixelJit(X64Reg constants_ptr);
+
+  void LoadConstantsPointer();
+  OpArg GetConstant(const Constant& values);
+  OpArg GetConstant16(s16 alpha, s16 color);
+  OpArg GetConstant32(s32 alpha, s32 color);
+
+  // Points pixel_ptr at the pixel of the EFB buffer which is given by ABI_PARAM1 and ABI_PARAM2.
+  // Clobbers R9.
+  void LoadPixelPointer(const u8* buffer);
+  // Pixels are 3 bytes wide, see EfbInterface. Reading clobbers R9, writing clobbers the source.
+  void ReadPixel(X64Reg dest);
+  void WritePixel(X64Reg src);
+
+  void Finish(const char* name);
+
+  const u8* m_entry;
+
+private:
+  // Allocated up front, since the generated code refers to it by address
+  Constant* m_constants;
+  size_t m_num_constants = 0;
+  X64Reg m_constants_ptr;
+};
+
+PixelJit::PixelJit(X64Reg constants_ptr) : m_constants_ptr(constants_ptr)
+{
+  m_constants = static_cast<Constant*>(
+      Common::AllocateAlignedMemory(MAX_CONSTANTS * sizeof(Constant), sizeof(Constant)));
+
+  AllocCodeSpace(8192);
+  ClearCodeSpace();
+  m_entry = GetCodePtr();
+}
+
+PixelJit::~PixelJit()
+{
+  Common::FreeAlignedMemory(m_constants);
+}
+
+void PixelJit::LoadConstantsPointer()
+{
+  MOV(64, R(m_constants_ptr), ImmPtr(m_constants));
+}
+
+OpArg PixelJit::GetConstant(const Constant& values)
+{
+  size_t index = 0;
+  while (index < m_num_constants && m_constants[index] != values)
+    index++;
+
+  if (index == m_num_constants)
+  {
+    _assert_msg_(VIDEO, m_num_constants < MAX_CONSTANTS, "Too many TEV JIT constants");
+    m_constants[m_num_constants++] = values;
+  }
+
+  return MDisp(m_constants_ptr, static_cast<int>(index * sizeof(Constant)));
+}
+
+// Four 16 bit lanes in the order of Tev, and zero in the upper half
+OpArg PixelJit::GetConstant16(s16 alpha, s16 color)
+{
+  const u32 a = static_cast<u16>(alpha);
+  const u32 c = static_cast<u16>(color);
+  return GetConstant({{a | (c << 16), c | (c << 16), 0, 0}});
+}
+
+// Four 32 bit lanes in the order of Tev
+OpArg PixelJit::GetConstant32(s32 alpha, s32 color)
+{
+  const u32 a = static_cast<u32>(alpha);
+  const u32 c = static_cast<u32>(color);
+  return GetConstant({{a, c, c, c}});
+}
+
+void PixelJit::LoadPixelPointer(const u8* buffer)
+{
+  MOVZX(32, 16, R9, R(ABI_PARAM2));
+  IMUL(32, R9, R(R9), Imm32(EFB_WIDTH));
+  MOVZX(32, 16, pixel_ptr, R(ABI_PARAM1));
+  ADD(32, R(pixel_ptr), R(R9));
+  LEA(32, pixel_ptr, MComplex(pixel_ptr, pixel_ptr, SCALE_2, 0));
+  MOV(64, R(R9), ImmPtr(buffer));
+  ADD(64, R(pixel_ptr), R(R9));
+}
+
+void PixelJit::ReadPixel(X64Reg dest)
+{
+  MOVZX(32, 16, dest, MatR(pixel_ptr));
+  MOVZX(32, 8, R9, MDisp(pixel_ptr, 2));
+  SHL(32, R(R9), Imm8(16));
+  OR(32, R(dest), R(R9));
+}
+
+void PixelJit::WritePixel(X64Reg src)
+{
+  MOV(16, MatR(pixel_ptr), R(src));
+  SHR(32, R(src), Imm8(16));
+  MOV(8, MDisp(pixel_ptr, 2), R(src));
+}
+
+void PixelJit::Finish(const char* name)
+{
+  WriteProtect();
+  JitRegister::Register(m_entry, GetCodePtr(), "%s", name);
+}
+
+class CombinerJit : public PixelJit
+{
+public:
+  explicit CombinerJit(const CombinerUid& uid);
+
+  CombinerFunction GetFunction() const { return m_function; }
+
+private:
+  void LoadInput(X64Reg dest, u32 stage, u32 color_input, u32 alpha_input);
+  void ShiftLanes(X64Reg reg, void (XEmitter::*shift)(X64Reg, int), int alpha_shift,
+                  int color_shift);
+  void GenerateStage(u32 stage, const TevStageCombiner::ColorCombiner& cc,
+                     const TevStageCombiner::AlphaCombiner& ac);
+  void GenerateAlphaCompare(X64Reg dest, AlphaTest::CompareMode mode, int ref_offset);
+  void GenerateAlphaTest(u32 alpha_dest, const AlphaTest& test);
+
+  CombinerFunction m_function;
+};
+
+CombinerJit::CombinerJit(const CombinerUid& uid) : PixelJit(RAX)
+{
+  m_function = reinterpret_cast<CombinerFunction>(const_cast<u8*>(m_entry));
+  LoadConstantsPointer();
+  for (u32 i = 0; i < uid.num_stages; i++)
+  {
+    TevStageCombiner::ColorCombiner cc;
+    TevStageCombiner::AlphaCombiner ac;
+    cc.hex = uid.color[i];
+    ac.hex = uid.alpha[i];
+    GenerateStage(i, cc, ac);
+  }
+
+  // Like the interpreter, use the alpha of the last stage's destination
+  TevStageCombiner::AlphaCombiner last_ac;
+  last_ac.hex = uid.alpha[uid.num_stages - 1];
+  AlphaTest test;
+  test.hex = uid.alpha_test;
+  GenerateAlphaTest(last_ac.dest, test);
+  RET();
+
+  Finish("TevCombiners");
+}
+
+// Gathers one of the four combiner inputs into the lower four 16 bit lanes of dest
+void CombinerJit::LoadInput(X64Reg dest, u32 stage, u32 color_input, u32 alpha_input)
+{
+  const int stage_offset = static_cast<int>(stage * sizeof(StageInputs));
+  const OpArg tex = MDisp(stages_ptr, stage_offset + offsetof(StageInputs, tex));
+  const OpArg ras = MDisp(stages_ptr, stage_offset + offsetof(StageInputs, ras));
+  const OpArg konst = MDisp(stages_ptr, stage_offset + offsetof(StageInputs, konst));
+
+  // Color inputs come in pairs of a vector and its broadcast alpha, except for the constants
+  OpArg color_source;
+  s16 color_constant = 0;
+  bool is_constant = false;
+  if (color_input < 8)
+  {
+    color_source = MDisp(reg_ptr, static_cast<int>((color_input / 2) * sizeof(s16) * 4));
+  }
+  else if (color_input < 10)
+  {
+    color_source = tex;
+  }
+  else if (color_input < 12)
+  {
+    color_source = ras;
+  }
+  else if (color_input == 14)
+  {
+    color_source = konst;
+  }
+  else
+  {
+    is_constant = true;
+    color_constant = color_input == 12 ? 255 : color_input == 13 ? 128 : 0;
+  }
+  const bool broadcast = !is_constant && color_input < 12 && (color_input & 1);
+
+  OpArg alpha_source;
+  if (alpha_input < 4)
+    alpha_source = MDisp(reg_ptr, static_cast<int>(alpha_input * sizeof(s16) * 4));
+  else if (alpha_input == 4)
+    alpha_source = tex;
+  else if (alpha_input == 5)
+    alpha_source = ras;
+  else if (alpha_input == 6)
+    alpha_source = konst;
+  const bool alpha_is_zero = alpha_input == 7;
+
+  if (is_constant)
+  {
+    MOVDQA(dest, GetConstant16(0, color_constant));
+    if (!alpha_is_zero)
+      PINSRW(dest, alpha_source, ALP_C);
+    return;
+  }
+
+  MOVQ_xmm(dest, color_source);
+  if (broadcast)
+    PSHUFLW(dest, R(dest), 0);
+
+  // The alpha lane of a color source already is the right one if both use the same vector
+  if (alpha_is_zero)
+    PAND(dest, GetConstant16(0, -1));
+  else if (!(alpha_source == color_source))
+    PINSRW(dest, alpha_source, ALP_C);
+}
+
+// Shifts the alpha and the color lanes by different amounts
+void CombinerJit::ShiftLanes(X64Reg reg, void (XEmitter::*shift)(X64Reg, int), int alpha_shift,
+                             int color_shift)
+{
+  if (alpha_shift == color_shift)
+  {
+    if (alpha_shift != 0)
+      (this->*shift)(reg, alpha_shift);
+    return;
+  }
+
+  // The alpha lane is the lowest 32 bits, also when holding pairs of 16 bit values
+  MOVDQA(temp2, R(reg));
+  if (alpha_shift != 0)
+    (this->*shift)(reg, alpha_shift);
+  if (color_shift != 0)
+    (this->*shift)(temp2, color_shift);
+  PAND(reg, GetConstant({{0xFFFFFFFF, 0, 0, 0}}));
+  PAND(temp2, GetConstant({{0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}}));
+  POR(reg, R(temp2));
+}
+
+// Does the same as Tev::DrawColorRegular and Tev::DrawAlphaRegular and the clamping afterwards,
+// with one lane per channel.
+void CombinerJit::GenerateStage(u32 stage, const TevStageCombiner::ColorCombiner& cc,
+                                const TevStageCombiner::AlphaCombiner& ac)
+{
+  static const s16 bias_lut[4] = {0, 128, -128, 0};
+  static const u8 lshift_lut[4] = {0, 1, 2, 0};
+  static const u8 rshift_lut[4] = {0, 0, 0, 1};
+
+  LoadInput(input_a, stage, cc.a, ac.a);
+  LoadInput(input_b, stage, cc.b, ac.b);
+  LoadInput(input_c, stage, cc.c, ac.c);
+  LoadInput(input_d, stage, cc.d, ac.d);
+
+  // a, b and c are unsigned 8 bit, d is signed 11 bit
+  const OpArg low_byte = GetConstant16(0xFF, 0xFF);
+  PAND(input_a, low_byte);
+  PAND(input_b, low_byte);
+  PAND(input_c, low_byte);
+  PSLLW(input_d, 5);
+  PSRAW(input_d, 5);
+
+  // c += c >> 7
+  MOVDQA(temp1, R(input_c));
+  PSRLW(temp1, 7);
+  PADDW(input_c, R(temp1));
+
+  // a * (256 - c) + b * c, scaled up
+  MOVDQA(temp1, GetConstant16(256, 256));
+  PSUBW(temp1, R(input_c));
+  PUNPCKLWD(temp1, R(input_c));
+  ShiftLanes(temp1, &XEmitter::PSLLW, lshift_lut[ac.shift], lshift_lut[cc.shift]);
+  PUNPCKLWD(input_a, R(input_b));
+  PMADDWD(input_a, R(temp1));
+
+  const s32 color_round = (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+  const s32 alpha_round = (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+  if (color_round != 0 || alpha_round != 0)
+    PADDD(input_a, GetConstant32(alpha_round, color_round));
+
+  // The alpha combiner negates before dividing by 256, the color combiner afterwards
+  if (ac.op)
+  {
+    const OpArg negate = GetConstant32(-1, 0);
+    PXOR(input_a, negate);
+    PSUBD(input_a, negate);
+  }
+  PSRAD(input_a, 8);
+  if (cc.op)
+  {
+    const OpArg negate = GetConstant32(0, -1);
+    PXOR(input_a, negate);
+    PSUBD(input_a, negate);
+  }
+
+  // (d + bias) << lshift
+  if (bias_lut[cc.bias] != 0 || bias_lut[ac.bias] != 0)
+    PADDW(input_d, GetConstant16(bias_lut[ac.bias], bias_lut[cc.bias]));
+  PUNPCKLWD(input_d, R(input_d));
+  PSRAD(input_d, 16);
+  ShiftLanes(input_d, &XEmitter::PSLLD, lshift_lut[ac.shift], lshift_lut[cc.shift]);
+
+  PADDD(input_a, R(input_d));
+  ShiftLanes(input_a, &XEmitter::PSRAD, rshift_lut[ac.shift], rshift_lut[cc.shift]);
+
+  // The results always fit into 16 bits, so saturating doesn't change anything
+  PACKSSDW(input_a, R(input_a));
+
+  PMINSW(input_a, GetConstant16(ac.clamp ? 255 : 1023, cc.clamp ? 255 : 1023));
+  PMAXSW(input_a, GetConstant16(ac.clamp ? 0 : -1024, cc.clamp ? 0 : -1024));
+
+  const OpArg color_dest = MDisp(reg_ptr, static_cast<int>(cc.dest * sizeof(s16) * 4));
+  const OpArg alpha_dest = MDisp(reg_ptr, static_cast<int>(ac.dest * sizeof(s16) * 4));
+  if (cc.dest != ac.dest)
+  {
+    MOVD_xmm(R(scratch), input_a);
+    MOV(16, alpha_dest, R(scratch));
+    PINSRW(input_a, color_dest, ALP_C);
+  }
+  MOVQ_xmm(color_dest, input_a);
+}
+
+// Sets the lowest byte of dest to the result of comparing the alpha in R8 to a reference value
+void CombinerJit::GenerateAlphaCompare(X64Reg dest, AlphaTest::CompareMode mode, int ref_offset)
+{
+  if (mode == AlphaTest::ALWAYS)
+  {
+    MOV(32, R(dest), Imm32(1));
+  }
+  else if (mode == AlphaTest::NEVER)
+  {
+    XOR(32, R(dest), R(dest));
+  }
+  else
+  {
+    CMP(8, R(R8), MDisp(R11, ref_offset));
+    SETcc(GetCompareFlags(mode), R(dest));
+  }
+}
+
+// Does the same as TevAlphaTest in Tev.cpp, on the lower 8 bits of the final alpha
+void CombinerJit::GenerateAlphaTest(u32 alpha_dest, const AlphaTest& test)
+{
+  MOVZX(32, 8, R8, MDisp(reg_ptr, static_cast<int>(alpha_dest * sizeof(s16) * 4)));
+  MOV(64, R(R11), ImmPtr(&bpmem.alpha_test));
+  GenerateAlphaCompare(R9, test.comp0, 0);
+  GenerateAlphaCompare(R10, test.comp1, 1);
+
+  switch (test.logic)
+  {
+  case AlphaTest::AND:
+    AND(8, R(R9), R(R10));
+    break;
+  case AlphaTest::OR:
+    OR(8, R(R9), R(R10));
+    break;
+  case AlphaTest::XOR:
+    XOR(8, R(R9), R(R10));
+    break;
+  case AlphaTest::XNOR:
+    XOR(8, R(R9), R(R10));
+    XOR(8, R(R9), Imm8(1));
+    break;
+  }
+  MOVZX(32, 8, ABI_RETURN, R(R9));
+}
+
+// Does the same as EfbInterface::ZCompare
+class DepthJit : public PixelJit
+{
+public:
+  explicit DepthJit(const DepthUid& uid);
+
+  DepthFunction GetFunction() const { return m_function; }
+
+private:
+  DepthFunction m_function;
+};
+
+DepthJit::DepthJit(const DepthUid& uid) : PixelJit(RAX)
+{
+  m_function = reinterpret_cast<DepthFunction>(const_cast<u8*>(m_entry));
+
+  if (uid.func == ZMode::NEVER)
+  {
+    XOR(32, R(ABI_RETURN), R(ABI_RETURN));
+    RET();
+    Finish("TevDepth");
+    return;
+  }
+
+  const bool always = uid.func == ZMode::ALWAYS;
+  if (!always || uid.update_enable)
+    LoadPixelPointer(EfbInterface::GetPixelPointer(0, 0, true));
+
+  if (!always)
+  {
+    ReadPixel(RAX);
+    CMP(32, R(ABI_PARAM3), R(RAX));
+  }
+
+  if (!uid.update_enable)
+  {
+    if (always)
+    {
+      MOV(32, R(ABI_RETURN), Imm32(1));
+    }
+    else
+    {
+      SETcc(GetCompareFlags(uid.func), R(ABI_RETURN));
+      MOVZX(32, 8, ABI_RETURN, R(ABI_RETURN));
+    }
+    RET();
+    Finish("TevDepth");
+    return;
+  }
+
+  FixupBranch fail;
+  if (!always)
+    fail = J_CC(static_cast<CCFlags>(GetCompareFlags(uid.func) ^ 1));
+  WritePixel(ABI_PARAM3);
+  MOV(32, R(ABI_RETURN), Imm32(1));
+  RET();
+  if (!always)
+  {
+    SetJumpTarget(fail);
+    XOR(32, R(ABI_RETURN), R(ABI_RETURN));
+    RET();
+  }
+
+  Finish("TevDepth");
+}
+
+// Does the same as EfbInterface::BlendTev. The color is kept in EAX in the ABGR order of Tev.
+class BlendJit : public PixelJit
+{
+public:
+  explicit BlendJit(const BlendUid& uid);
+
+  BlendFunction GetFunction() const { return m_function; }
+
+private:
+  void DecodeColor(bool rgba6);
+  void LoadBlendFactor(X64Reg dest, BlendMode::BlendFactor factor, X64Reg color);
+  void GenerateBlend(const BlendMode& mode);
+  void GenerateLogicOp(BlendMode::LogicOp op);
+
+  BlendFunction m_function;
+};
+
+static const X64Reg src_color = XMM0;
+static const X64Reg dst_color = XMM1;
+static const X64Reg src_factor = XMM2;
+static const X64Reg dst_factor = XMM3;
+static const X64Reg blend_temp = XMM4;
+static const X64Reg dither_value = XMM5;
+
+// The raw pixel is kept in EDX, and ECX, R9 and R8 are free for temporary values
+static const X64Reg raw_pixel = RDX;
+static const X64Reg blend_scratch = RCX;
+
+// Flipper uses a standard 2x2 Bayer Matrix for 6 bit dithering, indexed by y * 2 + x
+static const u8 s_dither_matrix[4] = {0, 2, 3, 1};
+
+static bool LogicOpUsesDestination(BlendMode::LogicOp op)
+{
+  return op != BlendMode::CLEAR && op != BlendMode::COPY && op != BlendMode::COPY_INVERTED &&
+         op != BlendMode::SET;
+}
+
+BlendJit::BlendJit(const BlendUid& uid) : PixelJit(R8)
+{
+  m_function = reinterpret_cast<BlendFunction>(const_cast<u8*>(m_entry));
+
+  BlendMode mode;
+  mode.hex = uid.blend_mode;
+  const bool rgba6 = uid.pixel_format == PEControl::RGBA6_Z24;
+  const bool color_update = mode.colorupdate;
+  // The other formats don't store alpha
+  const bool alpha_update = mode.alphaupdate && rgba6;
+  if (!color_update && !alpha_update)
+  {
+    RET();
+    Finish("TevBlend");
+    return;
+  }
+
+  // On Windows, ABI_PARAM3 is R8
+  MOV(64, R(color_ptr), R(ABI_PARAM3));
+  LoadConstantsPointer();
+
+  const bool dither = color_update && mode.dither && rgba6;
+  if (dither)
+  {
+    MOV(32, R(R9), R(ABI_PARAM2));
+    AND(32, R(R9), Imm32(1));
+    MOV(32, R(pixel_ptr), R(ABI_PARAM1));
+    AND(32, R(pixel_ptr), Imm32(1));
+    LEA(32, R9, MComplex(pixel_ptr, R9, SCALE_2, 0));
+    MOV(64, R(pixel_ptr), ImmPtr(s_dither_matrix));
+    MOVZX(32, 8, R9, MRegSum(pixel_ptr, R9));
+
+    // Only the color channels are dithered
+    MOVD_xmm(dither_value, R(R9));
+    PUNPCKLBW(dither_value, R(dither_value));
+    PSHUFLW(dither_value, R(dither_value), 0);
+    PAND(dither_value, GetConstant({{0xFFFFFF00, 0, 0, 0}}));
+  }
+
+  LoadPixelPointer(EfbInterface::GetPixelPointer(0, 0, false));
+
+  const bool logic_op = !mode.blendenable && mode.logicopenable;
+  const bool read_dst =
+      mode.blendenable || (logic_op && LogicOpUsesDestination(mode.logicmode));
+  // Updating only the color or the alpha keeps the other bits of the pixel
+  const bool partial_update = rgba6 && color_update != alpha_update;
+  if (read_dst || partial_update)
+    ReadPixel(raw_pixel);
+  if (read_dst)
+    DecodeColor(rgba6);
+
+  if (mode.blendenable)
+    GenerateBlend(mode);
+  else if (logic_op)
+    GenerateLogicOp(mode.logicmode);
+  else
+    MOV(32, R(RAX), MatR(color_ptr));
+
+  if (uid.dst_alpha_enable)
+  {
+    MOV(64, R(R9), ImmPtr(&bpmem.dstalpha));
+    MOV(8, R(RAX), MatR(R9));
+  }
+
+  if (dither)
+  {
+    // (c - (c >> 6) + dither) & 0xfc for each color byte
+    MOVD_xmm(src_color, R(RAX));
+    MOVDQA(blend_temp, R(src_color));
+    PSRLW(blend_temp, 6);
+    PAND(blend_temp, GetConstant({{0x03030300, 0, 0, 0}}));
+    PSUBB(src_color, R(blend_temp));
+    PADDB(src_color, R(dither_value));
+    PAND(src_color, GetConstant({{0xFCFCFCFF, 0, 0, 0}}));
+    MOVD_xmm(R(RAX), src_color);
+  }
+
+  if (rgba6)
+  {
+    // Pack to 6 bits per channel, keeping the bits which aren't updated
+    if (alpha_update)
+    {
+      MOV(32, R(R9), R(RAX));
+      SHR(32, R(R9), Imm8(2));
+      AND(32, R(R9), Imm32(0x3F));
+    }
+    else
+    {
+      MOV(32, R(R9), R(raw_pixel));
+      AND(32, R(R9), Imm32(0x3F));
+    }
+
+    if (color_update)
+    {
+      static const int shifts[3] = {4, 6, 8};
+      static const u32 masks[3] = {0xFC0, 0x3F000, 0xFC0000};
+      for (int i = 0; i < 3; i++)
+      {
+        MOV(32, R(blend_scratch), R(RAX));
+        SHR(32, R(blend_scratch), Imm8(shifts[i]));
+        AND(32, R(blend_scratch), Imm32(masks[i]));
+        OR(32, R(R9), R(blend_scratch));
+      }
+    }
+    else
+    {
+      MOV(32, R(blend_scratch), R(raw_pixel));
+      AND(32, R(blend_scratch), Imm32(0xFFFFC0));
+      OR(32, R(R9), R(blend_scratch));
+    }
+    WritePixel(R9);
+  }
+  else
+  {
+    SHR(32, R(RAX), Imm8(8));
+    WritePixel(RAX);
+  }
+  RET();
+
+  Finish("TevBlend");
+}
+
+// Converts the raw pixel to the destination color in EAX, like GetPixelColor in EfbInterface
+void BlendJit::DecodeColor(bool rgba6)
+{
+  if (!rgba6)
+  {
+    MOV(32, R(RAX), R(raw_pixel));
+    SHL(32, R(RAX), Imm8(8));
+    OR(32, R(RAX), Imm32(0xFF));
+    return;
+  }
+
+  // Convert6To8 on every channel
+  XOR(32, R(RAX), R(RAX));
+  for (int i = 0; i < 4; i++)
+  {
+    MOV(32, R(R9), R(raw_pixel));
+    if (i != 0)
+      SHR(32, R(R9), Imm8(6 * i));
+    AND(32, R(R9), Imm32(0x3F));
+    MOV(32, R(blend_scratch), R(R9));
+    SHR(32, R(blend_scratch), Imm8(4));
+    SHL(32, R(R9), Imm8(2 + 8 * i));
+    if (i != 0)
+      SHL(32, R(blend_scratch), Imm8(8 * i));
+    OR(32, R(RAX), R(R9));
+    OR(32, R(RAX), R(blend_scratch));
+  }
+}
+
+// Loads a factor from 0 to 256 for each channel into the lower four 16 bit lanes of dest. color
+// is the color which SRCCLR refers to, which is the destination color for the source factor.
+void BlendJit::LoadBlendFactor(X64Reg dest, BlendMode::BlendFactor factor, X64Reg color)
+{
+  switch (factor)
+  {
+  case BlendMode::ZERO:
+    PXOR(dest, R(dest));
+    return;
+  case BlendMode::ONE:
+    MOVDQA(dest, GetConstant16(256, 256));
+    return;
+  case BlendMode::SRCCLR:
+  case BlendMode::INVSRCCLR:
+    MOVDQA(dest, R(color));
+    break;
+  case BlendMode::SRCALPHA:
+  case BlendMode::INVSRCALPHA:
+    PSHUFLW(dest, R(src_color), 0);
+    break;
+  case BlendMode::DSTALPHA:
+  case BlendMode::INVDSTALPHA:
+    PSHUFLW(dest, R(dst_color), 0);
+    break;
+  }
+
+  if (factor == BlendMode::INVSRCCLR || factor == BlendMode::INVSRCALPHA ||
+      factor == BlendMode::INVDSTALPHA)
+  {
+    PXOR(dest, GetConstant16(0xFF, 0xFF));
+  }
+
+  // Add the MSB to make the range 0 to 256
+  MOVDQA(blend_temp, R(dest));
+  PSRLW(blend_temp, 7);
+  PADDW(dest, R(blend_temp));
+}
+
+void BlendJit::GenerateBlend(const BlendMode& mode)
+{
+  if (mode.subtract)
+  {
+    MOVD_xmm(dst_color, R(RAX));
+    MOVD_xmm(src_color, MatR(color_ptr));
+    PSUBUSB(dst_color, R(src_color));
+    MOVD_xmm(R(RAX), dst_color);
+    return;
+  }
+
+  PXOR(blend_temp, R(blend_temp));
+  MOVD_xmm(src_color, MatR(color_ptr));
+  PUNPCKLBW(src_color, R(blend_temp));
+  MOVD_xmm(dst_color, R(RAX));
+  PUNPCKLBW(dst_color, R(blend_temp));
+
+  LoadBlendFactor(src_factor, mode.srcfactor, dst_color);
+  LoadBlendFactor(dst_factor, mode.dstfactor, src_color);
+
+  // (src * src_factor + dst * dst_factor) >> 8, saturated to 8 bits
+  PUNPCKLWD(src_color, R(dst_color));
+  PUNPCKLWD(src_factor, R(dst_factor));
+  PMADDWD(src_color, R(src_factor));
+  PSRLD(src_color, 8);
+  PACKSSDW(src_color, R(src_color));
+  PACKUSWB(src_color, R(src_color));
+  MOVD_xmm(R(RAX), src_color);
+}
+
+// Applies the logic op to the destination color in EAX
+void BlendJit::GenerateLogicOp(BlendMode::LogicOp op)
+{
+  MOV(32, R(R9), MatR(color_ptr));
+  switch (op)
+  {
+  case BlendMode::CLEAR:
+    XOR(32, R(RAX), R(RAX));
+    break;
+  case BlendMode::AND:
+    AND(32, R(RAX), R(R9));
+    break;
+  case BlendMode::AND_REVERSE:
+    NOT(32, R(RAX));
+    AND(32, R(RAX), R(R9));
+    break;
+  case BlendMode::COPY:
+    MOV(32, R(RAX), R(R9));
+    break;
+  case BlendMode::AND_INVERTED:
+    NOT(32, R(R9));
+    AND(32, R(RAX), R(R9));
+    break;
+  case BlendMode::NOOP:
+    break;
+  case BlendMode::XOR:
+    XOR(32, R(RAX), R(R9));
+    break;
+  case BlendMode::OR:
+    OR(32, R(RAX), R(R9));
+    break;
+  case BlendMode::NOR:
+    OR(32, R(RAX), R(R9));
+    NOT(32, R(RAX));
+    break;
+  case BlendMode::EQUIV:
+    XOR(32, R(RAX), R(R9));
+    NOT(32, R(RAX));
+    break;
+  case BlendMode::INVERT:
+    NOT(32, R(RAX));
+    break;
+  case BlendMode::OR_REVERSE:
+    NOT(32, R(RAX));
+    OR(32, R(RAX), R(R9));
+    break;
+  case BlendMode::COPY_INVERTED:
+    MOV(32, R(RAX), R(R9));
+    NOT(32, R(RAX));
+    break;
+  case BlendMode::OR_INVERTED:
+    NOT(32, R(R9));
+    OR(32, R(RAX), R(R9));
+    break;
+  case BlendMode::NAND:
+    AND(32, R(RAX), R(R9));
+    NOT(32, R(RAX));
+    break;
+  case BlendMode::SET:
+    MOV(32, R(RAX), Imm32(0xFFFFFFFF));
+    break;
+  }
+}
+
+template <typename Uid, typename Jit>
+using ProgramCache = std::map<Uid, std::unique_ptr<Jit>, UidLess<Uid>>;
+
+static ProgramCache<CombinerUid, CombinerJit> s_combiners;
+static ProgramCache<DepthUid, DepthJit> s_depth;
+static ProgramCache<BlendUid, BlendJit> s_blend;
+
+// States which can't be compiled are cached as nullptr
+template <typename Uid, typename Jit>
+static const Jit* GetProgram(ProgramCache<Uid, Jit>* cache, const Uid& uid)
+{
+  auto it = cache->find(uid);
+  if (it == cache->end())
+  {
+    std::unique_ptr<Jit> jit;
+    if (CanCompile(uid))
+      jit = std::make_unique<Jit>(uid);
+    it = cache->emplace(uid, std::move(jit)).first;
+  }
+  return it->second.get();
+}
+
+PixelFunctions GetPixelFunctions()
+{
+  // Like the JIT block cache, start over instead of keeping track of which programs are still
+  // used. Nothing is drawing while the state changes, so none of them are running.
+  if (s_combiners.size() + s_depth.size() + s_blend.size() >= MAX_PROGRAMS)
+    Shutdown();
+
+  const CombinerJit* combiners = GetProgram(&s_combiners, GetCurrentCombinerUid());
+  const DepthJit* depth = GetProgram(&s_depth, GetCurrentDepthUid());
+  const BlendJit* blend = GetProgram(&s_blend, GetCurrentBlendUid());
+
+  PixelFunctions functions;
+  functions.combiners = combiners ? combiners->GetFunction() : nullptr;
+  functions.depth = depth ? depth->GetFunction() : nullptr;
+  functions.blend = blend ? blend->GetFunction() : nullptr;
+  return functions;
+}
+
+void Shutdown()
+{
+  s_combiners.clear();
+  s_depth.clear();
+  s_blend.clear();
+}
+}
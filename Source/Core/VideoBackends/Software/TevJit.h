@@ -0,0 +1,45 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Compiles the per-pixel pipeline into x86-64 code, specialized for the current BP state: the
+// color and alpha combiners of all TEV stages together with the alpha test, the depth test and
+// the blending and writing of the EFB color.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace TevJit
+{
+// The inputs of a stage which don't come from the TEV registers, in the ABGR order of Tev
+struct StageInputs
+{
+  s16 tex[4];
+  s16 ras[4];
+  s16 konst[4];
+};
+
+// Runs the combiners of all stages, including clamping, on the given registers. Returns whether
+// the output of the last stage passes the alpha test.
+using CombinerFunction = bool (*)(s16 (*reg)[4], const StageInputs* stages);
+// Same as EfbInterface::ZCompare
+using DepthFunction = bool (*)(u16 x, u16 y, u32 z);
+// Same as EfbInterface::BlendTev
+using BlendFunction = void (*)(u16 x, u16 y, u8* color);
+
+// Each function is nullptr if the state uses a mode which isn't supported by the JIT
+struct PixelFunctions
+{
+  CombinerFunction combiners;
+  DepthFunction depth;
+  BlendFunction blend;
+};
+
+// Returns the functions for the current BP state, compiling them if they haven't been used
+// before. Frees the functions of other states when too many have been compiled, so it must not
+// be called while the rasterizer is drawing.
+PixelFunctions GetPixelFunctions();
+
+void Shutdown();
+}
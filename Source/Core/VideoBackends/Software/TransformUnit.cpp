@@ -11,6 +11,7 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
@@ -319,38 +320,95 @@ static void LightAlpha(const Vec3& pos, const Vec3& normal, u8 lightNum, const L
   }
 }
 
+static Vec3 GetAmbientColor(const InputVertexData* src, u32 chan)
+{
+  Vec3 lightCol;
+  if (xfmem.color[chan].ambsource)
+  {
+    // vertex
+    lightCol.x = src->color[chan][1];
+    lightCol.y = src->color[chan][2];
+    lightCol.z = src->color[chan][3];
+  }
+  else
+  {
+    const u8* ambColor = reinterpret_cast<u8*>(&xfmem.ambColor[chan]);
+    lightCol.x = ambColor[1];
+    lightCol.y = ambColor[2];
+    lightCol.z = ambColor[3];
+  }
+  return lightCol;
+}
+
+static float GetAmbientAlpha(const InputVertexData* src, u32 chan)
+{
+  if (xfmem.alpha[chan].ambsource)
+    return src->color[chan][0];  // vertex
+  else
+    return static_cast<float>(xfmem.ambColor[chan] & 0xff);
+}
+
+// Applies the summed up lights of a channel to its material color. The light values are ignored
+// if lighting is disabled for the color or alpha part of the channel.
+static void ApplyLighting(const InputVertexData* src, u32 chan, const Vec3& lightCol,
+                          float lightAlpha, OutputVertexData* dst)
+{
+  // abgr
+  std::array<u8, 4> matcolor;
+  std::array<u8, 4> chancolor;
+
+  // color
+  const LitChannel& colorchan = xfmem.color[chan];
+  if (colorchan.matsource)
+    matcolor = src->color[chan];  // vertex
+  else
+    std::memcpy(matcolor.data(), &xfmem.matColor[chan], sizeof(u32));
+
+  if (colorchan.enablelighting)
+  {
+    int light_x = MathUtil::Clamp(static_cast<int>(lightCol.x), 0, 255);
+    int light_y = MathUtil::Clamp(static_cast<int>(lightCol.y), 0, 255);
+    int light_z = MathUtil::Clamp(static_cast<int>(lightCol.z), 0, 255);
+    chancolor[1] = (matcolor[1] * (light_x + (light_x >> 7))) >> 8;
+    chancolor[2] = (matcolor[2] * (light_y + (light_y >> 7))) >> 8;
+    chancolor[3] = (matcolor[3] * (light_z + (light_z >> 7))) >> 8;
+  }
+  else
+  {
+    chancolor = matcolor;
+  }
+
+  // alpha
+  const LitChannel& alphachan = xfmem.alpha[chan];
+  if (alphachan.matsource)
+    matcolor[0] = src->color[chan][0];  // vertex
+  else
+    matcolor[0] = xfmem.matColor[chan] & 0xff;
+
+  if (alphachan.enablelighting)
+  {
+    int light_a = MathUtil::Clamp(static_cast<int>(lightAlpha), 0, 255);
+    chancolor[0] = (matcolor[0] * (light_a + (light_a >> 7))) >> 8;
+  }
+  else
+  {
+    chancolor[0] = matcolor[0];
+  }
+
+  // abgr -> rgba
+  const u32 rgba_color = Common::swap32(chancolor.data());
+  std::memcpy(dst->color[chan].data(), &rgba_color, sizeof(u32));
+}
+
 void TransformColor(const InputVertexData* src, OutputVertexData* dst)
 {
   for (u32 chan = 0; chan < NUM_XF_COLOR_CHANNELS; chan++)
   {
-    // abgr
-    std::array<u8, 4> matcolor;
-    std::array<u8, 4> chancolor;
-
-    // color
+    Vec3 lightCol(0.0f);
     const LitChannel& colorchan = xfmem.color[chan];
-    if (colorchan.matsource)
-      matcolor = src->color[chan];  // vertex
-    else
-      std::memcpy(matcolor.data(), &xfmem.matColor[chan], sizeof(u32));
-
     if (colorchan.enablelighting)
     {
-      Vec3 lightCol;
-      if (colorchan.ambsource)
-      {
-        // vertex
-        lightCol.x = src->color[chan][1];
-        lightCol.y = src->color[chan][2];
-        lightCol.z = src->color[chan][3];
-      }
-      else
-      {
-        const u8* ambColor = reinterpret_cast<u8*>(&xfmem.ambColor[chan]);
-        lightCol.x = ambColor[1];
-        lightCol.y = ambColor[2];
-        lightCol.z = ambColor[3];
-      }
+      lightCol = GetAmbientColor(src, chan);
 
       u8 mask = colorchan.GetFullLightMask();
       for (int i = 0; i < 8; ++i)
@@ -358,52 +416,23 @@ void TransformColor(const InputVertexData* src, OutputVertexData* dst)
         if (mask & (1 << i))
           LightColor(dst->mvPosition, dst->normal[0], i, colorchan, lightCol);
       }
-
-      int light_x = MathUtil::Clamp(static_cast<int>(lightCol.x), 0, 255);
-      int light_y = MathUtil::Clamp(static_cast<int>(lightCol.y), 0, 255);
-      int light_z = MathUtil::Clamp(static_cast<int>(lightCol.z), 0, 255);
-      chancolor[1] = (matcolor[1] * (light_x + (light_x >> 7))) >> 8;
-      chancolor[2] = (matcolor[2] * (light_y + (light_y >> 7))) >> 8;
-      chancolor[3] = (matcolor[3] * (light_z + (light_z >> 7))) >> 8;
-    }
-    else
-    {
-      chancolor = matcolor;
     }
 
-    // alpha
+    float lightAlpha = 0.0f;
     const LitChannel& alphachan = xfmem.alpha[chan];
-    if (alphachan.matsource)
-      matcolor[0] = src->color[chan][0];  // vertex
-    else
-      matcolor[0] = xfmem.matColor[chan] & 0xff;
-
-    if (xfmem.alpha[chan].enablelighting)
+    if (alphachan.enablelighting)
     {
-      float lightCol;
-      if (alphachan.ambsource)
-        lightCol = src->color[chan][0];  // vertex
-      else
-        lightCol = static_cast<float>(xfmem.ambColor[chan] & 0xff);
+      lightAlpha = GetAmbientAlpha(src, chan);
 
       u8 mask = alphachan.GetFullLightMask();
       for (int i = 0; i < 8; ++i)
       {
         if (mask & (1 << i))
-          LightAlpha(dst->mvPosition, dst->normal[0], i, alphachan, lightCol);
+          LightAlpha(dst->mvPosition, dst->normal[0], i, alphachan, lightAlpha);
       }
-
-      int light_a = MathUtil::Clamp(static_cast<int>(lightCol), 0, 255);
-      chancolor[0] = (matcolor[0] * (light_a + (light_a >> 7))) >> 8;
-    }
-    else
-    {
-      chancolor[0] = matcolor[0];
     }
 
-    // abgr -> rgba
-    const u32 rgba_color = Common::swap32(chancolor.data());
-    std::memcpy(dst->color[chan].data(), &rgba_color, sizeof(u32));
+    ApplyLighting(src, chan, lightCol, lightAlpha, dst);
   }
 }
 
@@ -456,4 +485,357 @@ void TransformTexCoord(const InputVertexData* src, OutputVertexData* dst, bool s
     dst->texCoords[coordNum][1] *= (bpmem.texcoords[coordNum].t.scale_minus_1 + 1);
   }
 }
+
+#ifdef _M_X86
+// Four vertices in SoA layout, one per lane. The batched functions below do exactly the same
+// floating point operations in the same order as the scalar ones, so both produce the same
+// results.
+struct Vec3x4
+{
+  __m128 x, y, z;
+};
+
+static __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 Dot(const Vec3x4& a, const Vec3x4& b)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+static __m128 Dot(const Vec3x4& a, const Vec3& b)
+{
+  return Dot(a, {_mm_set1_ps(b.x), _mm_set1_ps(b.y), _mm_set1_ps(b.z)});
+}
+
+static Vec3x4 Normalized(const Vec3x4& v)
+{
+  const __m128 invf = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(Dot(v, v)));
+  return {_mm_mul_ps(v.x, invf), _mm_mul_ps(v.y, invf), _mm_mul_ps(v.z, invf)};
+}
+
+static __m128 SafeDivide(__m128 n, __m128 d)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 special = _mm_and_ps(_mm_cmpgt_ps(n, zero), _mm_set1_ps(1.0f));
+  return Select(_mm_cmpeq_ps(d, zero), special, _mm_div_ps(n, d));
+}
+
+static Vec3x4 Load(const Vec3* v)
+{
+  return {_mm_setr_ps(v[0].x, v[1].x, v[2].x, v[3].x), _mm_setr_ps(v[0].y, v[1].y, v[2].y, v[3].y),
+          _mm_setr_ps(v[0].z, v[1].z, v[2].z, v[3].z)};
+}
+
+// Loads element k of the matrix of every lane
+static __m128 GatherMatrix(const float* const* mats, int k)
+{
+  return _mm_setr_ps(mats[0][k], mats[1][k], mats[2][k], mats[3][k]);
+}
+
+static Vec3x4 MultiplyVec3Mat33(const Vec3x4& vec, const float* const* mats)
+{
+  Vec3x4 result;
+  __m128* out[] = {&result.x, &result.y, &result.z};
+  for (int row = 0; row < 3; row++)
+  {
+    const __m128 x = _mm_mul_ps(GatherMatrix(mats, row * 3 + 0), vec.x);
+    const __m128 y = _mm_mul_ps(GatherMatrix(mats, row * 3 + 1), vec.y);
+    const __m128 z = _mm_mul_ps(GatherMatrix(mats, row * 3 + 2), vec.z);
+    *out[row] = _mm_add_ps(_mm_add_ps(x, y), z);
+  }
+  return result;
+}
+
+static Vec3x4 MultiplyVec3Mat34(const Vec3x4& vec, const float* const* mats)
+{
+  Vec3x4 result;
+  __m128* out[] = {&result.x, &result.y, &result.z};
+  for (int row = 0; row < 3; row++)
+  {
+    const __m128 x = _mm_mul_ps(GatherMatrix(mats, row * 4 + 0), vec.x);
+    const __m128 y = _mm_mul_ps(GatherMatrix(mats, row * 4 + 1), vec.y);
+    const __m128 z = _mm_mul_ps(GatherMatrix(mats, row * 4 + 2), vec.z);
+    *out[row] = _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), GatherMatrix(mats, row * 4 + 3));
+  }
+  return result;
+}
+
+static __m128 CalculateLightAttn(const LightPointer* light, Vec3x4* _ldir, const Vec3x4& normal,
+                                 const LitChannel& chan)
+{
+  const __m128 zero = _mm_setzero_ps();
+  __m128 attn = _mm_set1_ps(1.0f);
+  Vec3x4& ldir = *_ldir;
+
+  switch (chan.attnfunc)
+  {
+  case LIGHTATTN_NONE:
+  case LIGHTATTN_DIR:
+  {
+    ldir = Normalized(ldir);
+    const __m128 is_zero = _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(ldir.x, zero),
+                                                 _mm_cmpeq_ps(ldir.y, zero)),
+                                      _mm_cmpeq_ps(ldir.z, zero));
+    ldir.x = Select(is_zero, normal.x, ldir.x);
+    ldir.y = Select(is_zero, normal.y, ldir.y);
+    ldir.z = Select(is_zero, normal.z, ldir.z);
+    break;
+  }
+  case LIGHTATTN_SPEC:
+  {
+    ldir = Normalized(ldir);
+    attn = _mm_and_ps(_mm_cmpge_ps(Dot(ldir, normal), zero),
+                      _mm_max_ps(Dot(normal, light->dir), zero));
+    Vec3 distAttn = light->distatt;
+    if (chan.diffusefunc != LIGHTDIF_NONE)
+      distAttn = distAttn.Normalized();
+
+    const Vec3x4 attLen = {_mm_set1_ps(1.0f), attn, _mm_mul_ps(attn, attn)};
+    attn = SafeDivide(_mm_max_ps(Dot(attLen, light->cosatt), zero), Dot(attLen, distAttn));
+    break;
+  }
+  case LIGHTATTN_SPOT:
+  {
+    const __m128 dist2 = Dot(ldir, ldir);
+    const __m128 dist = _mm_sqrt_ps(dist2);
+    const __m128 invf = _mm_div_ps(_mm_set1_ps(1.0f), dist);
+    ldir = {_mm_mul_ps(ldir.x, invf), _mm_mul_ps(ldir.y, invf), _mm_mul_ps(ldir.z, invf)};
+    attn = _mm_max_ps(Dot(ldir, light->dir), zero);
+
+    const __m128 cosAtt =
+        _mm_add_ps(_mm_add_ps(_mm_set1_ps(light->cosatt.x),
+                              _mm_mul_ps(_mm_set1_ps(light->cosatt.y), attn)),
+                   _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(light->cosatt.z), attn), attn));
+    const __m128 distAtt =
+        _mm_add_ps(_mm_add_ps(_mm_set1_ps(light->distatt.x),
+                              _mm_mul_ps(_mm_set1_ps(light->distatt.y), dist)),
+                   _mm_mul_ps(_mm_set1_ps(light->distatt.z), dist2));
+    attn = SafeDivide(_mm_max_ps(cosAtt, zero), distAtt);
+    break;
+  }
+  default:
+    PanicAlert("LightColor");
+  }
+
+  return attn;
+}
+
+// Computes the attenuation and diffuse factor of a light. Returns false if the diffuse factor
+// isn't used (LIGHTDIF_NONE).
+static bool CalculateLightDiffuse(const LightPointer* light, const Vec3x4& pos,
+                                  const Vec3x4& normal, const LitChannel& chan, __m128* attn,
+                                  __m128* difAttn)
+{
+  const __m128 zero = _mm_setzero_ps();
+  Vec3x4 ldir = {_mm_sub_ps(_mm_set1_ps(light->pos.x), pos.x),
+                 _mm_sub_ps(_mm_set1_ps(light->pos.y), pos.y),
+                 _mm_sub_ps(_mm_set1_ps(light->pos.z), pos.z)};
+  *attn = CalculateLightAttn(light, &ldir, normal, chan);
+
+  *difAttn = Dot(ldir, normal);
+  switch (chan.diffusefunc)
+  {
+  case LIGHTDIF_NONE:
+    return false;
+  case LIGHTDIF_SIGN:
+    return true;
+  case LIGHTDIF_CLAMP:
+    *difAttn = _mm_max_ps(*difAttn, zero);
+    return true;
+  default:
+    _assert_(0);
+    return false;
+  }
+}
+
+static void LightColor(const Vec3x4& pos, const Vec3x4& normal, u8 lightNum,
+                       const LitChannel& chan, Vec3x4& lightCol)
+{
+  const LightPointer* light = (const LightPointer*)&xfmem.lights[lightNum];
+
+  __m128 attn, difAttn;
+  __m128 scale;
+  if (CalculateLightDiffuse(light, pos, normal, chan, &attn, &difAttn))
+    scale = _mm_mul_ps(attn, difAttn);
+  else
+    scale = attn;
+
+  lightCol.x = _mm_add_ps(lightCol.x, _mm_mul_ps(_mm_set1_ps(light->color[1]), scale));
+  lightCol.y = _mm_add_ps(lightCol.y, _mm_mul_ps(_mm_set1_ps(light->color[2]), scale));
+  lightCol.z = _mm_add_ps(lightCol.z, _mm_mul_ps(_mm_set1_ps(light->color[3]), scale));
+}
+
+static void LightAlpha(const Vec3x4& pos, const Vec3x4& normal, u8 lightNum,
+                       const LitChannel& chan, __m128& lightCol)
+{
+  const LightPointer* light = (const LightPointer*)&xfmem.lights[lightNum];
+
+  __m128 attn, difAttn;
+  __m128 value;
+  if (CalculateLightDiffuse(light, pos, normal, chan, &attn, &difAttn))
+    value = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(light->color[0]), attn), difAttn);
+  else
+    value = _mm_mul_ps(_mm_set1_ps(light->color[0]), attn);
+
+  lightCol = _mm_add_ps(lightCol, value);
+}
+
+template <typename F>
+static void StoreLanes(const Vec3x4& v, u32 count, F get_dst)
+{
+  alignas(16) float x[4], y[4], z[4];
+  _mm_store_ps(x, v.x);
+  _mm_store_ps(y, v.y);
+  _mm_store_ps(z, v.z);
+  for (u32 i = 0; i < count; i++)
+    get_dst(i) = Vec3(x[i], y[i], z[i]);
+}
+
+void TransformVertices(const InputVertexData* src, OutputVertexData* dst, u32 count,
+                       bool has_normals, bool nbt, bool tex_gen_special_case)
+{
+  _assert_(count > 0 && count <= VERTEX_BATCH_SIZE);
+
+  // Unused lanes repeat the last vertex
+  const InputVertexData* lanes[4];
+  for (u32 i = 0; i < 4; i++)
+    lanes[i] = &src[std::min(i, count - 1)];
+
+  const float* pos_mats[4];
+  const float* normal_mats[4];
+  for (u32 i = 0; i < 4; i++)
+  {
+    pos_mats[i] = &xfmem.posMatrices[lanes[i]->posMtx * 4];
+    normal_mats[i] = &xfmem.normalMatrices[(lanes[i]->posMtx & 31) * 3];
+  }
+
+  Vec3 input[4];
+
+  // Position
+  for (u32 i = 0; i < 4; i++)
+    input[i] = lanes[i]->position;
+  const Vec3x4 mvPosition = MultiplyVec3Mat34(Load(input), pos_mats);
+
+  const float* proj = xfmem.projection.rawProjection;
+  alignas(16) float projected[4][4];
+  if (xfmem.projection.type == GX_PERSPECTIVE)
+  {
+    _mm_store_ps(projected[0], _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mvPosition.x),
+                                          _mm_mul_ps(_mm_set1_ps(proj[1]), mvPosition.z)));
+    _mm_store_ps(projected[1], _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mvPosition.y),
+                                          _mm_mul_ps(_mm_set1_ps(proj[3]), mvPosition.z)));
+    const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mvPosition.z),
+                                _mm_set1_ps(proj[5]));
+    _mm_store_ps(projected[2], _mm_mul_ps(z, _mm_set1_ps(1.0f - (float)1e-7)));
+    _mm_store_ps(projected[3], _mm_xor_ps(mvPosition.z, _mm_set1_ps(-0.0f)));
+  }
+  else
+  {
+    _mm_store_ps(projected[0],
+                 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mvPosition.x), _mm_set1_ps(proj[1])));
+    _mm_store_ps(projected[1],
+                 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mvPosition.y), _mm_set1_ps(proj[3])));
+    _mm_store_ps(projected[2],
+                 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mvPosition.z), _mm_set1_ps(proj[5])));
+    _mm_store_ps(projected[3], _mm_set1_ps(1.0f));
+  }
+
+  StoreLanes(mvPosition, count, [dst](u32 i) -> Vec3& { return dst[i].mvPosition; });
+  for (u32 i = 0; i < count; i++)
+  {
+    dst[i].projectedPosition = {projected[0][i], projected[1][i], projected[2][i], projected[3][i]};
+  }
+
+  // Normals
+  Vec3x4 normal = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+  for (u32 i = 0; i < count; i++)
+    dst[i].normal = {};
+  if (has_normals)
+  {
+    for (u32 i = 0; i < 4; i++)
+      input[i] = lanes[i]->normal[0];
+    normal = Normalized(MultiplyVec3Mat33(Load(input), normal_mats));
+    StoreLanes(normal, count, [dst](u32 i) -> Vec3& { return dst[i].normal[0]; });
+    if (nbt)
+    {
+      for (int n = 1; n < 3; n++)
+      {
+        for (u32 i = 0; i < 4; i++)
+          input[i] = lanes[i]->normal[n];
+        StoreLanes(MultiplyVec3Mat33(Load(input), normal_mats), count,
+                   [dst, n](u32 i) -> Vec3& { return dst[i].normal[n]; });
+      }
+    }
+  }
+
+  // Lighting
+  for (u32 chan = 0; chan < NUM_XF_COLOR_CHANNELS; chan++)
+  {
+    alignas(16) float light[4][4] = {};
+
+    const LitChannel& colorchan = xfmem.color[chan];
+    if (colorchan.enablelighting)
+    {
+      for (u32 i = 0; i < 4; i++)
+        input[i] = GetAmbientColor(lanes[i], chan);
+      Vec3x4 lightCol = Load(input);
+
+      u8 mask = colorchan.GetFullLightMask();
+      for (int i = 0; i < 8; ++i)
+      {
+        if (mask & (1 << i))
+          LightColor(mvPosition, normal, i, colorchan, lightCol);
+      }
+
+      _mm_store_ps(light[0], lightCol.x);
+      _mm_store_ps(light[1], lightCol.y);
+      _mm_store_ps(light[2], lightCol.z);
+    }
+
+    const LitChannel& alphachan = xfmem.alpha[chan];
+    if (alphachan.enablelighting)
+    {
+      __m128 lightAlpha =
+          _mm_setr_ps(GetAmbientAlpha(lanes[0], chan), GetAmbientAlpha(lanes[1], chan),
+                      GetAmbientAlpha(lanes[2], chan), GetAmbientAlpha(lanes[3], chan));
+
+      u8 mask = alphachan.GetFullLightMask();
+      for (int i = 0; i < 8; ++i)
+      {
+        if (mask & (1 << i))
+          LightAlpha(mvPosition, normal, i, alphachan, lightAlpha);
+      }
+
+      _mm_store_ps(light[3], lightAlpha);
+    }
+
+    for (u32 i = 0; i < count; i++)
+    {
+      ApplyLighting(&src[i], chan, Vec3(light[0][i], light[1][i], light[2][i]), light[3][i],
+                    &dst[i]);
+    }
+  }
+
+  // Texture coordinates are generated per vertex, since every texgen mode takes its own path
+  for (u32 i = 0; i < count; i++)
+    TransformTexCoord(&src[i], &dst[i], tex_gen_special_case);
+}
+#else
+void TransformVertices(const InputVertexData* src, OutputVertexData* dst, u32 count,
+                       bool has_normals, bool nbt, bool tex_gen_special_case)
+{
+  for (u32 i = 0; i < count; i++)
+  {
+    TransformPosition(&src[i], &dst[i]);
+    dst[i].normal = {};
+    if (has_normals)
+      TransformNormal(&src[i], nbt, &dst[i]);
+    TransformColor(&src[i], &dst[i]);
+    TransformTexCoord(&src[i], &dst[i], tex_gen_special_case);
+  }
+}
+#endif
 }
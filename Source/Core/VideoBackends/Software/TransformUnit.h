@@ -4,13 +4,21 @@
 
 #pragma once
 
+#include "Common/CommonTypes.h"
+
 struct InputVertexData;
 struct OutputVertexData;
 
 namespace TransformUnit
 {
+constexpr u32 VERTEX_BATCH_SIZE = 4;
+
 void TransformPosition(const InputVertexData* src, OutputVertexData* dst);
 void TransformNormal(const InputVertexData* src, bool nbt, OutputVertexData* dst);
 void TransformColor(const InputVertexData* src, OutputVertexData* dst);
 void TransformTexCoord(const InputVertexData* src, OutputVertexData* dst, bool specialCase);
+
+// Does all of the above for up to VERTEX_BATCH_SIZE vertices at once, with the same results.
+void TransformVertices(const InputVertexData* src, OutputVertexData* dst, u32 count,
+                       bool has_normals, bool nbt, bool tex_gen_special_case);
 }
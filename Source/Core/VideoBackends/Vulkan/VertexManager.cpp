@@ -23,17 +23,19 @@
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 
 namespace Vulkan
 {
 // TODO: Clean up this mess
 constexpr size_t INITIAL_VERTEX_BUFFER_SIZE = VertexManager::MAXVBUFFERSIZE * 2;
 constexpr size_t MAX_VERTEX_BUFFER_SIZE = VertexManager::MAXVBUFFERSIZE * 16;
-constexpr size_t INITIAL_INDEX_BUFFER_SIZE = VertexManager::MAXIBUFFERSIZE * sizeof(u16) * 2;
-constexpr size_t MAX_INDEX_BUFFER_SIZE = VertexManager::MAXIBUFFERSIZE * sizeof(u16) * 16;
+constexpr size_t INITIAL_INDEX_BUFFER_SIZE = VertexManager::MAXIBUFFERSIZE * sizeof(u32) * 2;
+constexpr size_t MAX_INDEX_BUFFER_SIZE = VertexManager::MAXIBUFFERSIZE * sizeof(u32) * 16;
 
 VertexManager::VertexManager()
-    : m_cpu_vertex_buffer(MAXVBUFFERSIZE), m_cpu_index_buffer(MAXIBUFFERSIZE)
+    : m_index_size(g_ActiveConfig.bUse32BitIndices ? sizeof(u32) : sizeof(u16)),
+      m_cpu_vertex_buffer(MAXVBUFFERSIZE), m_cpu_index_buffer(MAXIBUFFERSIZE)
 {
 }
 
@@ -72,7 +74,7 @@ VertexManager::CreateNativeVertexFormat(const PortableVertexDeclaration& vtx_dec
 void VertexManager::PrepareDrawBuffers(u32 stride)
 {
   size_t vertex_data_size = IndexGenerator::GetNumVerts() * stride;
-  size_t index_data_size = IndexGenerator::GetIndexLen() * sizeof(u16);
+  size_t index_data_size = IndexGenerator::GetIndexLen() * m_index_size;
 
   m_vertex_stream_buffer->CommitMemory(vertex_data_size);
   m_index_stream_buffer->CommitMemory(index_data_size);
@@ -81,8 +83,17 @@ void VertexManager::PrepareDrawBuffers(u32 stride)
   ADDSTAT(stats.thisFrame.bytesIndexStreamed, static_cast<int>(index_data_size));
 
   StateTracker::GetInstance()->SetVertexBuffer(m_vertex_stream_buffer->GetBuffer(), 0);
-  StateTracker::GetInstance()->SetIndexBuffer(m_index_stream_buffer->GetBuffer(), 0,
-                                              VK_INDEX_TYPE_UINT16);
+  StateTracker::GetInstance()->SetIndexBuffer(
+      m_index_stream_buffer->GetBuffer(), 0,
+      m_index_size == sizeof(u32) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16);
+}
+
+void VertexManager::StartIndices(void* buffer) const
+{
+  if (m_index_size == sizeof(u32))
+    IndexGenerator::Start(static_cast<u32*>(buffer));
+  else
+    IndexGenerator::Start(static_cast<u16*>(buffer));
 }
 
 void VertexManager::ResetBuffer(u32 stride)
@@ -92,13 +103,14 @@ void VertexManager::ResetBuffer(u32 stride)
     // Not drawing on the gpu, so store in a heap buffer instead
     m_cur_buffer_pointer = m_base_buffer_pointer = m_cpu_vertex_buffer.data();
     m_end_buffer_pointer = m_base_buffer_pointer + m_cpu_vertex_buffer.size();
-    IndexGenerator::Start(m_cpu_index_buffer.data());
+    StartIndices(m_cpu_index_buffer.data());
     return;
   }
 
   // Attempt to allocate from buffers
   bool has_vbuffer_allocation = m_vertex_stream_buffer->ReserveMemory(MAXVBUFFERSIZE, stride);
-  bool has_ibuffer_allocation = m_index_stream_buffer->ReserveMemory(MAXIBUFFERSIZE, sizeof(u16));
+  bool has_ibuffer_allocation =
+      m_index_stream_buffer->ReserveMemory(MAXIBUFFERSIZE * m_index_size, m_index_size);
   if (!has_vbuffer_allocation || !has_ibuffer_allocation)
   {
     // Flush any pending commands first, so that we can wait on the fences
@@ -109,7 +121,8 @@ void VertexManager::ResetBuffer(u32 stride)
     if (!has_vbuffer_allocation)
       has_vbuffer_allocation = m_vertex_stream_buffer->ReserveMemory(MAXVBUFFERSIZE, stride);
     if (!has_ibuffer_allocation)
-      has_ibuffer_allocation = m_index_stream_buffer->ReserveMemory(MAXIBUFFERSIZE, sizeof(u16));
+      has_ibuffer_allocation =
+          m_index_stream_buffer->ReserveMemory(MAXIBUFFERSIZE * m_index_size, m_index_size);
 
     // If we still failed, that means the allocation was too large and will never succeed, so panic
     if (!has_vbuffer_allocation || !has_ibuffer_allocation)
@@ -120,13 +133,13 @@ void VertexManager::ResetBuffer(u32 stride)
   m_base_buffer_pointer = m_vertex_stream_buffer->GetHostPointer();
   m_end_buffer_pointer = m_vertex_stream_buffer->GetCurrentHostPointer() + MAXVBUFFERSIZE;
   m_cur_buffer_pointer = m_vertex_stream_buffer->GetCurrentHostPointer();
-  IndexGenerator::Start(reinterpret_cast<u16*>(m_index_stream_buffer->GetCurrentHostPointer()));
+  StartIndices(m_index_stream_buffer->GetCurrentHostPointer());
 
   // Update base indices
   m_current_draw_base_vertex =
       static_cast<u32>(m_vertex_stream_buffer->GetCurrentOffset() / stride);
   m_current_draw_base_index =
-      static_cast<u32>(m_index_stream_buffer->GetCurrentOffset() / sizeof(u16));
+      static_cast<u32>(m_index_stream_buffer->GetCurrentOffset() / m_index_size);
 }
 
 void VertexManager::vFlush()
@@ -140,7 +153,10 @@ void VertexManager::vFlush()
 
   // Update tracked state
   StateTracker::GetInstance()->SetVertexFormat(vertex_format);
-  StateTracker::GetInstance()->CheckForShaderChanges();
+  {
+    VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::ShaderLookup);
+    StateTracker::GetInstance()->CheckForShaderChanges();
+  }
   StateTracker::GetInstance()->UpdateVertexShaderConstants();
   StateTracker::GetInstance()->UpdateGeometryShaderConstants();
   StateTracker::GetInstance()->UpdatePixelShaderConstants();
@@ -33,9 +33,14 @@ protected:
 
 private:
   void vFlush() override;
+  void StartIndices(void* buffer) const;
+
+  // Latched from the config at startup, in bytes
+  const u32 m_index_size;
 
   std::vector<u8> m_cpu_vertex_buffer;
-  std::vector<u16> m_cpu_index_buffer;
+  // Large enough for 32-bit indices, and also used for 16-bit ones
+  std::vector<u32> m_cpu_index_buffer;
 
   std::unique_ptr<StreamBuffer> m_vertex_stream_buffer;
   std::unique_ptr<StreamBuffer> m_index_stream_buffer;
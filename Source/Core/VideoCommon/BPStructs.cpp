@@ -29,10 +29,12 @@
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 
 using namespace BPFunctions;
 
@@ -44,6 +46,129 @@ void BPInit()
   bpmem.bpMask = 0xFFFFFF;
 }
 
+// Registers which are only read when an EFB copy, a TMEM preload or a TLUT load is triggered,
+// or which aren't emulated at all. The triggering writes flush, so writes to these registers don't
+// need to end the current batch.
+static bool IsBatchCompatible(u32 address)
+{
+  switch (address)
+  {
+  case BPMEM_DISPLAYCOPYFILTER:
+  case BPMEM_DISPLAYCOPYFILTER + 1:
+  case BPMEM_DISPLAYCOPYFILTER + 2:
+  case BPMEM_DISPLAYCOPYFILTER + 3:
+  case BPMEM_IND_IMASK:
+  case BPMEM_PERF0_TRI:
+  case BPMEM_PERF0_QUAD:
+  case BPMEM_BUSCLOCK0:
+  case BPMEM_EFB_TL:
+  case BPMEM_EFB_BR:
+  case BPMEM_EFB_ADDR:
+  case BPMEM_MIPMAP_STRIDE:
+  case BPMEM_COPYYSCALE:
+  case BPMEM_CLEAR_AR:
+  case BPMEM_CLEAR_GB:
+  case BPMEM_CLEAR_Z:
+  case BPMEM_COPYFILTER0:
+  case BPMEM_COPYFILTER1:
+  case BPMEM_REVBITS:
+  case BPMEM_PRELOAD_ADDR:
+  case BPMEM_PRELOAD_TMEMEVEN:
+  case BPMEM_PRELOAD_TMEMODD:
+  case BPMEM_LOADTLUT0:
+  case BPMEM_PERF1:
+  case BPMEM_BUSCLOCK1:
+  case BPMEM_BP_MASK:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Registers which only set shader constants, while the current state doesn't read them. The
+// pending batch uses the current state, so it doesn't need to end. Writes which change whether a
+// constant is read still flush.
+static bool IsUnusedConstant(u32 address)
+{
+  switch (address)
+  {
+  case BPMEM_IND_MTXA:
+  case BPMEM_IND_MTXB:
+  case BPMEM_IND_MTXC:
+  case BPMEM_IND_MTXA + 3:
+  case BPMEM_IND_MTXB + 3:
+  case BPMEM_IND_MTXC + 3:
+  case BPMEM_IND_MTXA + 6:
+  case BPMEM_IND_MTXB + 6:
+  case BPMEM_IND_MTXC + 6:
+    for (u32 i = 0; i <= bpmem.genMode.numtevstages; ++i)
+    {
+      if (bpmem.tevind[i].mid != 0)
+        return false;
+    }
+    return true;
+  case BPMEM_RAS1_SS0:
+  case BPMEM_RAS1_SS1:
+    return bpmem.genMode.numindstages == 0;
+  case BPMEM_FOGRANGE + 1:
+  case BPMEM_FOGRANGE + 2:
+  case BPMEM_FOGRANGE + 3:
+  case BPMEM_FOGRANGE + 4:
+  case BPMEM_FOGRANGE + 5:
+    return bpmem.fog.c_proj_fsel.fsel == 0 || !bpmem.fogRange.Base.Enabled;
+  case BPMEM_FOGPARAM0:
+  case BPMEM_FOGBMAGNITUDE:
+  case BPMEM_FOGBEXPONENT:
+  case BPMEM_FOGCOLOR:
+    return bpmem.fog.c_proj_fsel.fsel == 0;
+  case BPMEM_BIAS:
+    return bpmem.ztex2.op == ZTEXTURE_DISABLE;
+  default:
+    return false;
+  }
+}
+
+// Registers which only set pixel shader constants. Backends with per-draw constants can keep
+// drawing the current batch with the new values for the following vertices.
+static bool IsShaderConstant(u32 address)
+{
+  switch (address)
+  {
+  case BPMEM_IND_MTXA:
+  case BPMEM_IND_MTXB:
+  case BPMEM_IND_MTXC:
+  case BPMEM_IND_MTXA + 3:
+  case BPMEM_IND_MTXB + 3:
+  case BPMEM_IND_MTXC + 3:
+  case BPMEM_IND_MTXA + 6:
+  case BPMEM_IND_MTXB + 6:
+  case BPMEM_IND_MTXC + 6:
+  case BPMEM_RAS1_SS0:
+  case BPMEM_RAS1_SS1:
+  case BPMEM_FOGRANGE + 1:
+  case BPMEM_FOGRANGE + 2:
+  case BPMEM_FOGRANGE + 3:
+  case BPMEM_FOGRANGE + 4:
+  case BPMEM_FOGRANGE + 5:
+  case BPMEM_FOGPARAM0:
+  case BPMEM_FOGBMAGNITUDE:
+  case BPMEM_FOGBEXPONENT:
+  case BPMEM_FOGCOLOR:
+  case BPMEM_BIAS:
+  case BPMEM_TEV_COLOR_RA:
+  case BPMEM_TEV_COLOR_RA + 2:
+  case BPMEM_TEV_COLOR_RA + 4:
+  case BPMEM_TEV_COLOR_RA + 6:
+  case BPMEM_TEV_COLOR_BG:
+  case BPMEM_TEV_COLOR_BG + 2:
+  case BPMEM_TEV_COLOR_BG + 4:
+  case BPMEM_TEV_COLOR_BG + 6:
+    return true;
+  default:
+    return false;
+  }
+}
+
 static void BPWritten(const BPCmd& bp)
 {
   /*
@@ -83,7 +208,15 @@ static void BPWritten(const BPCmd& bp)
     }
   }
 
-  FlushPipeline();
+  if (IsBatchCompatible(bp.address) || IsUnusedConstant(bp.address))
+    g_vertex_manager->MergeStateChange();
+  else if (IsShaderConstant(bp.address))
+    g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::BPRegister, bp.address);
+  else
+  {
+    VideoProfiler::SetFlushReason(VideoProfiler::FlushReason::BPRegister, bp.address);
+    FlushPipeline();
+  }
 
   ((u32*)&bpmem)[bp.address] = bp.newvalue;
 
@@ -6,6 +6,7 @@
 
 #include <array>
 
+#include "Common/Align.h"
 #include "Common/CommonTypes.h"
 
 // all constant buffer attributes must be 16 bytes aligned, so this are the only allowed components:
@@ -13,6 +14,10 @@ using float4 = std::array<float, 4>;
 using uint4 = std::array<u32, 4>;
 using int4 = std::array<s32, 4>;
 
+// Number of draws with their own pixel and vertex shader constants which a batch can hold on
+// backends with per-draw constants
+constexpr u32 MAX_DRAWS_PER_BATCH = 32;
+
 struct PixelShaderConstants
 {
   std::array<int4, 4> colors;
@@ -78,7 +83,8 @@ struct VertexShaderConstants
   std::array<float4, 64> posttransformmatrices;
   float4 pixelcentercorrection;
   std::array<float, 2> viewport;  // .xy
-  std::array<float, 2> pad2;      // .zw
+  u32 draw_end;                   // .z, only used with per-draw constants
+  u32 pad2;                       // .w
 
   // .x - texMtxInfo, .y - postMtxInfo, [0..1].z = color, [0..1].w = alpha
   std::array<uint4, 8> xfmem_pack1;
@@ -90,3 +96,9 @@ struct GeometryShaderConstants
   float4 lineptparams;
   int4 texoffset;
 };
+
+// Strides of the arrays of per-draw constants, in the std140 layout of the shaders
+constexpr u32 PS_DRAW_CONSTANTS_STRIDE =
+    Common::AlignUp(static_cast<u32>(sizeof(PixelShaderConstants)), 16);
+constexpr u32 VS_DRAW_CONSTANTS_STRIDE =
+    Common::AlignUp(static_cast<u32>(sizeof(VertexShaderConstants)), 16);
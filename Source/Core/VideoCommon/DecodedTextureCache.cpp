@@ -0,0 +1,136 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/DecodedTextureCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include <xxhash.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Align.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "VideoCommon/TextureDecoder.h"
+
+// All entries are kept in memory, so stop adding new ones once they take up this much.
+static constexpr size_t MAX_CACHE_SIZE = 512 * 1024 * 1024;
+
+class DecodedTextureCache::Reader : public LinearDiskCacheReader<Key, u8>
+{
+public:
+  explicit Reader(DecodedTextureCache* cache) : m_cache(cache) {}
+  void Read(const Key& key, const u8* value, u32 value_size) override
+  {
+    if (m_cache->m_size + value_size > MAX_CACHE_SIZE)
+      return;
+
+    if (m_cache->m_entries.emplace(key, std::vector<u8>(value, value + value_size)).second)
+      m_cache->m_size += value_size;
+  }
+
+private:
+  DecodedTextureCache* m_cache;
+};
+
+bool DecodedTextureCache::Key::operator==(const Key& other) const
+{
+  return std::memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+DecodedTextureCache::~DecodedTextureCache()
+{
+  Close();
+}
+
+bool DecodedTextureCache::IsWorthCaching(TextureFormat format)
+{
+  // The other formats decode about as fast as the data can be copied
+  return format == TextureFormat::CMPR || IsColorIndexed(format);
+}
+
+size_t DecodedTextureCache::GetDecodedSize(u32 width, u32 height, u32 levels, TextureFormat format)
+{
+  const u32 block_width = TexDecoder_GetBlockWidthInTexels(format);
+  const u32 block_height = TexDecoder_GetBlockHeightInTexels(format);
+
+  size_t size = 0;
+  for (u32 level = 0; level < levels; ++level)
+  {
+    const u32 level_width = Common::AlignUp(std::max(width >> level, 1u), block_width);
+    const u32 level_height = Common::AlignUp(std::max(height >> level, 1u), block_height);
+    size += static_cast<size_t>(level_width) * level_height * sizeof(u32);
+  }
+  return size;
+}
+
+DecodedTextureCache::Key DecodedTextureCache::MakeKey(const u8* src, size_t size, const u8* tlut,
+                                                      size_t tlut_size, u32 width, u32 height,
+                                                      u32 levels, TextureFormat format,
+                                                      TLUTFormat tlut_format)
+{
+  Key key = {};
+  key.hash = XXH64(src, size, 0);
+  if (tlut_size)
+    key.hash = XXH64(tlut, tlut_size, key.hash);
+  key.width = width;
+  key.height = height;
+  key.levels = levels;
+  key.format = static_cast<u32>(format);
+  key.tlut_format = IsColorIndexed(format) ? static_cast<u32>(tlut_format) : 0;
+  return key;
+}
+
+void DecodedTextureCache::Open(const std::string& game_id)
+{
+  Close();
+
+  const std::string cache_dir = File::GetUserPath(D_CACHE_IDX);
+  if (!File::Exists(cache_dir))
+    File::CreateDir(cache_dir);
+
+  const std::string filename = cache_dir + "DecodedTextures-" + game_id + ".cache";
+  Reader reader(this);
+  const u32 num_entries = m_file.OpenAndRead(filename, reader);
+  INFO_LOG(VIDEO, "Loaded %u decoded textures (%zu bytes) from %s", num_entries, m_size,
+           filename.c_str());
+  m_open = true;
+}
+
+void DecodedTextureCache::Close()
+{
+  if (!m_open)
+    return;
+
+  m_file.Sync();
+  m_file.Close();
+  m_entries.clear();
+  m_size = 0;
+  m_open = false;
+}
+
+bool DecodedTextureCache::Lookup(const Key& key, u8* dst, size_t size) const
+{
+  auto iter = m_entries.find(key);
+  if (iter == m_entries.end() || iter->second.size() != size)
+    return false;
+
+  std::memcpy(dst, iter->second.data(), size);
+  return true;
+}
+
+void DecodedTextureCache::Insert(const Key& key, const u8* data, size_t size)
+{
+  if (m_size + size > MAX_CACHE_SIZE)
+    return;
+
+  if (!m_entries.emplace(key, std::vector<u8>(data, data + size)).second)
+    return;
+
+  m_size += size;
+  m_file.Append(key, data, static_cast<u32>(size));
+}
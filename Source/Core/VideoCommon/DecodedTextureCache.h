@@ -0,0 +1,63 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+#include "VideoCommon/TextureDecoder.h"
+
+// Keeps the decoded RGBA8 data of textures which are slow to decode on disk, so that the next run
+// of the same game can skip decoding them. All levels of a texture are stored as one value.
+class DecodedTextureCache
+{
+public:
+  struct Key
+  {
+    // XXH64 of all levels and the palette, since a collision would show the wrong texture
+    u64 hash;
+    u32 width;
+    u32 height;
+    u32 levels;
+    u32 format;
+    u32 tlut_format;
+    u32 padding;
+
+    bool operator==(const Key& other) const;
+  };
+
+  DecodedTextureCache() = default;
+  ~DecodedTextureCache();
+
+  static bool IsWorthCaching(TextureFormat format);
+  // Size of all decoded levels, each padded to whole blocks the way the decoder writes them
+  static size_t GetDecodedSize(u32 width, u32 height, u32 levels, TextureFormat format);
+  static Key MakeKey(const u8* src, size_t size, const u8* tlut, size_t tlut_size, u32 width,
+                     u32 height, u32 levels, TextureFormat format, TLUTFormat tlut_format);
+
+  void Open(const std::string& game_id);
+  void Close();
+  bool IsOpen() const { return m_open; }
+  // Copies the decoded levels to dst. Returns false if the texture isn't cached.
+  bool Lookup(const Key& key, u8* dst, size_t size) const;
+  void Insert(const Key& key, const u8* data, size_t size);
+
+private:
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+  };
+
+  class Reader;
+
+  LinearDiskCache<Key, u8> m_file;
+  std::unordered_map<Key, std::vector<u8>, KeyHash> m_entries;
+  size_t m_size = 0;
+  bool m_open = false;
+};
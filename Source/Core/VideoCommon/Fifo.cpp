@@ -5,6 +5,7 @@
 #include "VideoCommon/Fifo.h"
 
 #include <atomic>
+#include <cstddef>
 #include <cstring>
 
 #include "Common/Assert.h"
@@ -17,6 +18,7 @@
 #include "Common/MsgHandler.h"
 
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/Memmap.h"
 #include "Core/Host.h"
@@ -29,11 +31,15 @@
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoProfiler.h"
 
 namespace Fifo
 {
 static constexpr u32 FIFO_SIZE = 2 * 1024 * 1024;
 static constexpr int GPU_TIME_SLOT_SIZE = 1000;
+// In deterministic GPU thread mode, preprocessed commands are handed to the GPU thread once this
+// many bytes have accumulated, and at the end of every GPU time slot.
+static constexpr ptrdiff_t GPU_BATCH_SIZE = 16 * 1024;
 
 static Common::BlockingLoop s_gpu_mainloop;
 
@@ -56,24 +62,50 @@ static u8* s_video_buffer_read_ptr;
 static std::atomic<u8*> s_video_buffer_write_ptr;
 static std::atomic<u8*> s_video_buffer_seen_ptr;
 static u8* s_video_buffer_pp_read_ptr;
+static std::atomic<u8*> s_video_buffer_batch_ptr;
+static std::atomic<u8*> s_video_buffer_wrap_ptr;
 // The read_ptr is always owned by the GPU thread.  In normal mode, so is the
 // write_ptr, despite it being atomic.  In deterministic GPU thread mode,
-// things get a bit more complicated:
-// - The seen_ptr is written by the GPU thread, and points to what it's already
-// processed as much of as possible - in the case of a partial command which
-// caused it to stop, not the same as the read ptr.  It's written by the GPU,
-// under the lock, and updating the cond.
+// the video buffer is a ring shared by both threads:
 // - The write_ptr is written by the CPU thread after it copies data from the
-// FIFO.  Maybe someday it will be under the lock.  For now, because RunGpuLoop
-// polls, it's just atomic.
-// - The pp_read_ptr is the CPU preprocessing version of the read_ptr.
+// FIFO, and the pp_read_ptr is the CPU preprocessing version of the read_ptr.
+// The preprocessing always stops at the start of an incomplete command.
+// - The batch_ptr is written by the CPU thread, and is the pp_read_ptr it has
+// handed to the GPU thread.  So the GPU thread only ever sees complete
+// commands, and is woken up once per batch instead of once per 32 bytes.
+// - The wrap_ptr is set by the CPU thread when it has moved the incomplete
+// command at the end of the buffer to its start.  The GPU thread processes
+// everything up to it, continues at the start and clears it.  The CPU thread
+// publishes the new batch_ptr before the wrap_ptr, so the GPU thread never
+// sees a wraparound together with a batch_ptr from before it.
+// - The seen_ptr is written by the GPU thread, and points to what it has
+// processed.  While a wraparound is pending, the CPU thread may only write
+// up to it.
 
 static std::atomic<int> s_sync_ticks;
 static bool s_syncing_suspended;
 static Common::Event s_sync_wakeup_event;
 
+// Applies a wraparound the GPU thread hasn't followed yet. This is only valid while the GPU thread
+// is paused after a SyncGPU, so that it has processed everything before the wraparound.
+static void ApplyPendingWraparound()
+{
+  if (!s_video_buffer_wrap_ptr.load())
+    return;
+
+  s_video_buffer_read_ptr = s_video_buffer;
+  s_video_buffer_seen_ptr = s_video_buffer;
+  s_video_buffer_wrap_ptr = nullptr;
+}
+
 void DoState(PointerWrap& p)
 {
+  _assert_msg_(COMMANDPROCESSOR,
+               !SConfig::GetInstance().bCPUThread || !s_emu_running_state.IsSet(),
+               "The GPU thread has to be paused with PauseAndLock before its state is accessed");
+
+  ApplyPendingWraparound();
+
   p.DoArray(s_video_buffer, FIFO_SIZE);
   u8* write_ptr = s_video_buffer_write_ptr;
   p.DoPointer(write_ptr, s_video_buffer);
@@ -83,6 +115,7 @@ void DoState(PointerWrap& p)
   {
     // We're good and paused, right?
     s_video_buffer_seen_ptr = s_video_buffer_pp_read_ptr = s_video_buffer_read_ptr;
+    s_video_buffer_batch_ptr = s_video_buffer_read_ptr;
   }
 
   p.Do(s_sync_ticks);
@@ -101,7 +134,12 @@ void PauseAndLock(bool doLock, bool unpauseOnUnlock)
     if (!param.bCPUThread || s_use_deterministic_gpu_thread)
       return;
 
-    s_gpu_mainloop.WaitYield(std::chrono::milliseconds(100), Host_YieldToUI);
+    // Only the host thread can keep the UI responsive, the CPU thread pauses the GPU thread for
+    // the savestates it captures itself.
+    s_gpu_mainloop.WaitYield(std::chrono::milliseconds(100), [] {
+      if (!Core::IsCPUThread())
+        Host_YieldToUI();
+    });
   }
   else
   {
@@ -131,6 +169,8 @@ void Shutdown()
   s_video_buffer_pp_read_ptr = nullptr;
   s_video_buffer_read_ptr = nullptr;
   s_video_buffer_seen_ptr = nullptr;
+  s_video_buffer_batch_ptr = nullptr;
+  s_video_buffer_wrap_ptr = nullptr;
   s_fifo_aux_write_ptr = nullptr;
   s_fifo_aux_read_ptr = nullptr;
 }
@@ -157,10 +197,48 @@ void EmulatorState(bool running)
     s_gpu_mainloop.AllowSleep();
 }
 
+// Hands the complete commands preprocessed so far to the GPU thread.
+static void PublishBatch()
+{
+  if (s_video_buffer_batch_ptr.load() == s_video_buffer_pp_read_ptr)
+    return;
+
+  s_video_buffer_batch_ptr = s_video_buffer_pp_read_ptr;
+  s_gpu_mainloop.Wakeup();
+}
+
+// Moves the incomplete command at the end of the video buffer to its start, so the CPU thread can
+// continue writing there. Everything before it must have been published, and the GPU thread must
+// not be working on the start of the buffer.
+static void WrapVideoBuffer()
+{
+  u8* const wrap_ptr = s_video_buffer_pp_read_ptr;
+  const size_t size = s_video_buffer_write_ptr - wrap_ptr;
+
+  memmove(s_video_buffer, wrap_ptr, size);
+  s_video_buffer_pp_read_ptr = s_video_buffer;
+  s_video_buffer_write_ptr = s_video_buffer + size;
+  s_video_buffer_batch_ptr = s_video_buffer;
+  s_video_buffer_wrap_ptr = wrap_ptr;
+  s_gpu_mainloop.Wakeup();
+}
+
+// Returns how far the CPU thread may write without overwriting data the GPU thread hasn't
+// processed yet. One byte is kept free behind the GPU thread, so the CPU thread never catches up
+// with it from behind.
+static u8* GetVideoBufferWriteLimit()
+{
+  if (s_video_buffer_wrap_ptr.load())
+    return s_video_buffer_seen_ptr.load() - 1;
+
+  return s_video_buffer + FIFO_SIZE;
+}
+
 void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
   if (s_use_deterministic_gpu_thread)
   {
+    PublishBatch();
     s_gpu_mainloop.Wait();
     if (!s_gpu_mainloop.IsRunning())
       return;
@@ -173,22 +251,11 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
     s_fifo_aux_write_ptr -= (s_fifo_aux_read_ptr - s_fifo_aux_data);
     s_fifo_aux_read_ptr = s_fifo_aux_data;
 
-    if (may_move_read_ptr)
-    {
-      u8* write_ptr = s_video_buffer_write_ptr;
-
-      // what's left over in the buffer
-      size_t size = write_ptr - s_video_buffer_pp_read_ptr;
-
-      memmove(s_video_buffer, s_video_buffer_pp_read_ptr, size);
-      // This change always decreases the pointers.  We write seen_ptr
-      // after write_ptr here, and read it before in RunGpuLoop, so
-      // 'write_ptr > seen_ptr' there cannot become spuriously true.
-      s_video_buffer_write_ptr = write_ptr = s_video_buffer + size;
-      s_video_buffer_pp_read_ptr = s_video_buffer;
-      s_video_buffer_read_ptr = s_video_buffer;
-      s_video_buffer_seen_ptr = write_ptr;
-    }
+    // The GPU thread has caught up, so what's left over in the buffer can be moved to the start.
+    // It may still be polling, which is why it is left to follow the wraparound on its own
+    // instead of resetting its read_ptr here.
+    if (may_move_read_ptr && s_video_buffer_pp_read_ptr != s_video_buffer)
+      WrapVideoBuffer();
   }
 }
 
@@ -247,29 +314,42 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 {
   size_t len = 32;
   u8* write_ptr = s_video_buffer_write_ptr;
-  if (len > (size_t)(s_video_buffer + FIFO_SIZE - write_ptr))
+  if (write_ptr + len > GetVideoBufferWriteLimit())
   {
-    // We can't wrap around while the GPU is working on the data.
-    // This should be very rare due to the reset in SyncGPU.
-    SyncGPU(SyncGPUReason::Wraparound);
-    if (!s_gpu_mainloop.IsRunning())
-    {
-      // GPU is shutting down, so the next asserts may fail
-      return;
-    }
+    PublishBatch();
+    size_t existing_len = write_ptr - s_video_buffer_pp_read_ptr;
 
-    if (s_video_buffer_pp_read_ptr != s_video_buffer_read_ptr)
+    // Wrap around without waiting if the GPU is already past the space needed at the start.
+    if (!s_video_buffer_wrap_ptr.load() &&
+        s_video_buffer + existing_len + len < s_video_buffer_seen_ptr.load())
     {
-      PanicAlert("desynced read pointers");
-      return;
+      WrapVideoBuffer();
     }
-    write_ptr = s_video_buffer_write_ptr;
-    size_t existing_len = write_ptr - s_video_buffer_pp_read_ptr;
-    if (len > (size_t)(FIFO_SIZE - existing_len))
+    else
     {
-      PanicAlert("FIFO out of bounds (existing %zu + new %zu > %u)", existing_len, len, FIFO_SIZE);
-      return;
+      // Otherwise let the GPU catch up, and then wait until it has followed the wraparound.
+      SyncGPU(SyncGPUReason::Wraparound);
+      s_gpu_mainloop.Wait();
+      if (!s_gpu_mainloop.IsRunning())
+      {
+        // GPU is shutting down, so the next asserts may fail
+        return;
+      }
+
+      if (s_video_buffer_pp_read_ptr != s_video_buffer_read_ptr)
+      {
+        PanicAlert("desynced read pointers");
+        return;
+      }
+      existing_len = s_video_buffer_write_ptr - s_video_buffer_pp_read_ptr;
+      if (len > (size_t)(FIFO_SIZE - existing_len))
+      {
+        PanicAlert("FIFO out of bounds (existing %zu + new %zu > %u)", existing_len, len,
+                   FIFO_SIZE);
+        return;
+      }
     }
+    write_ptr = s_video_buffer_write_ptr;
   }
   Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
   s_video_buffer_pp_read_ptr = OpcodeDecoder::Run<true>(
@@ -284,6 +364,8 @@ void ResetVideoBuffer()
   s_video_buffer_write_ptr = s_video_buffer;
   s_video_buffer_seen_ptr = s_video_buffer;
   s_video_buffer_pp_read_ptr = s_video_buffer;
+  s_video_buffer_batch_ptr = s_video_buffer;
+  s_video_buffer_wrap_ptr = nullptr;
   s_fifo_aux_write_ptr = s_fifo_aux_data;
   s_fifo_aux_read_ptr = s_fifo_aux_data;
 }
@@ -307,15 +389,25 @@ void RunGpuLoop()
         {
           AsyncRequests::GetInstance()->PullEvents();
 
-          // All the fifo/CP stuff is on the CPU.  We just need to run the opcode decoder.
-          u8* seen_ptr = s_video_buffer_seen_ptr;
-          u8* write_ptr = s_video_buffer_write_ptr;
-          // See comment in SyncGPU
-          if (write_ptr > seen_ptr)
+          // All the fifo/CP stuff is on the CPU.  We just need to run the opcode decoder on the
+          // batches it has published.  The wrap_ptr has to be read before the batch_ptr, see the
+          // comment at their declaration.
+          u8* wrap_ptr = s_video_buffer_wrap_ptr;
+          u8* batch_ptr = s_video_buffer_batch_ptr;
+          if (wrap_ptr)
+          {
+            OpcodeDecoder::Run(DataReader(s_video_buffer_read_ptr, wrap_ptr), nullptr, false);
+            s_video_buffer_read_ptr = s_video_buffer;
+            s_video_buffer_seen_ptr = s_video_buffer;
+            s_video_buffer_wrap_ptr = nullptr;
+          }
+
+          // A batch_ptr below the read_ptr belongs to a wraparound that isn't visible yet.
+          if (batch_ptr > s_video_buffer_read_ptr)
           {
             s_video_buffer_read_ptr =
-                OpcodeDecoder::Run(DataReader(s_video_buffer_read_ptr, write_ptr), nullptr, false);
-            s_video_buffer_seen_ptr = write_ptr;
+                OpcodeDecoder::Run(DataReader(s_video_buffer_read_ptr, batch_ptr), nullptr, false);
+            s_video_buffer_seen_ptr = s_video_buffer_read_ptr;
           }
         }
         else
@@ -384,6 +476,7 @@ void RunGpuLoop()
 
           // The fifo is empty and it's unlikely we will get any more work in the near future.
           // Make sure VertexManager finishes drawing any primitives it has stored in it's buffer.
+          VideoProfiler::SetFlushReason(VideoProfiler::FlushReason::FifoIdle);
           g_vertex_manager->Flush();
         }
       },
@@ -447,7 +540,8 @@ static int RunGpuOnCpu(int ticks)
     if (s_use_deterministic_gpu_thread)
     {
       ReadDataFromFifoOnCPU(fifo.CPReadPointer);
-      s_gpu_mainloop.Wakeup();
+      if (s_video_buffer_pp_read_ptr - s_video_buffer_batch_ptr.load() >= GPU_BATCH_SIZE)
+        PublishBatch();
     }
     else
     {
@@ -472,6 +566,10 @@ static int RunGpuOnCpu(int ticks)
     fifo.CPReadWriteDistance -= 32;
   }
 
+  // Don't hold back any commands past the end of this time slot
+  if (s_use_deterministic_gpu_thread)
+    PublishBatch();
+
   CommandProcessor::SetCPStatusFromGPU();
 
   if (reset_simd_state)
@@ -513,11 +611,13 @@ void UpdateWantDeterminism(bool want)
 
   if (s_use_deterministic_gpu_thread != gpu_thread)
   {
+    ApplyPendingWraparound();
     s_use_deterministic_gpu_thread = gpu_thread;
     if (gpu_thread)
     {
       // These haven't been updated in non-deterministic mode.
       s_video_buffer_seen_ptr = s_video_buffer_pp_read_ptr = s_video_buffer_read_ptr;
+      s_video_buffer_batch_ptr = s_video_buffer_read_ptr;
       CopyPreprocessCPStateFromMain();
       VertexLoaderManager::MarkAllDirty();
     }
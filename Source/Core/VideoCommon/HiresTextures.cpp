@@ -6,13 +6,20 @@
 
 #include <SOIL/SOIL.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <cstring>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xxhash.h>
@@ -27,25 +34,58 @@
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 #include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/TexturePack.h"
 #include "VideoCommon/VideoConfig.h"
 
 struct DiskTexture
 {
   std::string path;
   bool has_arbitrary_mipmaps;
+  // Set for textures from texture packs, which are streamed in instead of loaded from files
+  TexturePack* pack = nullptr;
+  u32 pack_index = 0;
+};
+
+struct StreamedTexture
+{
+  std::list<std::string>::iterator lru_position;
+  size_t size;
+};
+
+struct TextureRequest
+{
+  std::string base_filename;
+  u32 width;
+  u32 height;
 };
 
 static std::unordered_map<std::string, DiskTexture> s_textureMap;
 static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
 static std::mutex s_textureCacheMutex;
-static std::mutex s_textureCacheAquireMutex;  // for high priority access
 static Common::Flag s_textureCacheAbortLoading;
 
 static std::thread s_prefetcher;
+static Common::Flag s_prefetching;
+
+// Textures which were searched for before they were loaded are requested from the loader threads,
+// which handle them before continuing with the prefetching. Guarded by s_textureCacheMutex.
+static std::unique_ptr<Common::ThreadPool> s_texture_loader;
+static std::deque<TextureRequest> s_texture_requests;
+static std::unordered_set<std::string> s_pending_textures;
+
+// Textures streamed in from texture packs are kept in s_textureCache until they exceed the memory
+// budget, then the least recently used ones are dropped again. Guarded by s_textureCacheMutex.
+static std::vector<std::unique_ptr<TexturePack>> s_texture_packs;
+static std::unordered_map<std::string, StreamedTexture> s_streamed_textures;
+static std::list<std::string> s_streamed_textures_lru;
+static size_t s_streamed_textures_size = 0;
+static size_t s_streamed_textures_budget = 0;
+static std::atomic<u32> s_streamed_texture_count{0};
 
 static const std::string s_format_prefix = "tex1_";
 
@@ -58,29 +98,71 @@ void HiresTexture::Init()
   Update();
 }
 
-void HiresTexture::Shutdown()
+static void FindTextureFiles(const std::string& directory,
+                             std::unordered_map<std::string, DiskTexture>* texture_map)
 {
-  if (s_prefetcher.joinable())
+  std::vector<std::string> extensions{
+      ".png", ".bmp", ".tga", ".dds",
+      ".jpg"  // Why not? Could be useful for large photo-like textures
+  };
+
+  const std::vector<std::string> texture_paths =
+      Common::DoFileSearch({directory}, extensions, /*recursive*/ true);
+
+  for (auto& path : texture_paths)
   {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
+    std::string filename;
+    SplitPath(path, nullptr, &filename, nullptr);
+
+    if (filename.substr(0, s_format_prefix.length()) == s_format_prefix)
+    {
+      const size_t arb_index = filename.rfind("_arb");
+      const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
+      if (has_arbitrary_mipmaps)
+        filename.erase(arb_index, 4);
+      (*texture_map)[filename] = {path, has_arbitrary_mipmaps};
+    }
   }
+}
 
+static void StopLoading()
+{
+  s_textureCacheAbortLoading.Set();
+  if (s_prefetcher.joinable())
+    s_prefetcher.join();
+
+  // Textures which are still queued return right away
+  s_texture_loader.reset();
+  s_textureCacheAbortLoading.Clear();
+  s_prefetching.Clear();
+
+  // The packs might change, so all streamed textures get loaded again when they are needed
+  for (const auto& streamed : s_streamed_textures)
+    s_textureCache.erase(streamed.first);
+  for (auto iter = s_textureCache.begin(); iter != s_textureCache.end();)
+    iter = iter->second ? std::next(iter) : s_textureCache.erase(iter);
+  s_texture_requests.clear();
+  s_pending_textures.clear();
+  s_streamed_textures.clear();
+  s_streamed_textures_lru.clear();
+  s_streamed_textures_size = 0;
   s_textureMap.clear();
+  s_texture_packs.clear();
+}
+
+void HiresTexture::Shutdown()
+{
+  StopLoading();
+
   s_textureCache.clear();
 }
 
 void HiresTexture::Update()
 {
-  if (s_prefetcher.joinable())
-  {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
-  }
+  StopLoading();
 
   if (!g_ActiveConfig.bHiresTextures)
   {
-    s_textureMap.clear();
     s_textureCache.clear();
     return;
   }
@@ -92,31 +174,31 @@ void HiresTexture::Update()
 
   const std::string& game_id = SConfig::GetInstance().GetGameID();
   const std::string texture_directory = GetTextureDirectory(game_id);
-  std::vector<std::string> extensions{
-      ".png", ".bmp", ".tga", ".dds",
-      ".jpg"  // Why not? Could be useful for large photo-like textures
-  };
 
-  const std::vector<std::string> texture_paths =
-      Common::DoFileSearch({texture_directory}, extensions, /*recursive*/ true);
+  for (const std::string& path : Common::DoFileSearch({texture_directory}, {".dtp"}, true))
+  {
+    std::unique_ptr<TexturePack> pack = TexturePack::Open(path);
+    if (!pack)
+      continue;
 
-  const std::string code = game_id + "_";
+    for (u32 i = 0; i < pack->GetTextureCount(); i++)
+      s_textureMap[pack->GetTextureName(i)] = {path, pack->HasArbitraryMipmaps(i), pack.get(), i};
+    s_texture_packs.push_back(std::move(pack));
+  }
 
-  for (auto& path : texture_paths)
-  {
-    std::string filename;
-    SplitPath(path, nullptr, &filename, nullptr);
+  s_streamed_textures_budget =
+      static_cast<size_t>(std::max(g_ActiveConfig.iHiresTexturesMemoryBudget, 0)) * 1024 * 1024;
 
-    if (filename.substr(0, s_format_prefix.length()) == s_format_prefix)
-    {
-      const size_t arb_index = filename.rfind("_arb");
-      const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
-      if (has_arbitrary_mipmaps)
-        filename.erase(arb_index, 4);
-      s_textureMap[filename] = {path, has_arbitrary_mipmaps};
-    }
+  // Half of the cores are left to the emulation, which keeps running while textures are loaded
+  if (!s_texture_packs.empty() || g_ActiveConfig.bCacheHiresTextures)
+  {
+    s_texture_loader = std::make_unique<Common::ThreadPool>(
+        std::max(Common::ThreadPool::GetDefaultThreadCount() / 2, 1u), "Texture loader");
   }
 
+  // Loose files take precedence over the textures in packs, so single textures can be replaced
+  FindTextureFiles(texture_directory, &s_textureMap);
+
   if (g_ActiveConfig.bCacheHiresTextures)
   {
     // remove cached but deleted textures
@@ -133,83 +215,118 @@ void HiresTexture::Update()
       }
     }
 
-    s_textureCacheAbortLoading.Clear();
+    s_prefetching.Set();
     s_prefetcher = std::thread(Prefetch);
   }
 }
 
+static size_t GetLevelsSize(const std::vector<HiresTexture::Level>& levels)
+{
+  size_t size = 0;
+  for (const HiresTexture::Level& level : levels)
+    size += level.data_size;
+  return size;
+}
+
 void HiresTexture::Prefetch()
 {
   Common::SetCurrentThreadName("Prefetcher");
 
-  size_t size_sum = 0;
   size_t sys_mem = Common::MemPhysical();
   size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
   // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
   size_t max_mem =
       (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
   u32 starttime = Common::Timer::GetTimeMs();
+
+  std::vector<std::string> base_filenames;
   for (const auto& entry : s_textureMap)
   {
-    const std::string& base_filename = entry.first;
-
-    if (base_filename.find("_mip") == std::string::npos)
-    {
-      {
-        // try to get this mutex first, so the video thread is allow to get the real mutex faster
-        std::unique_lock<std::mutex> lk(s_textureCacheAquireMutex);
-      }
-      std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+    // Textures from texture packs are only streamed in when they are used
+    if (entry.first.find("_mip") == std::string::npos && !entry.second.pack)
+      base_filenames.push_back(entry.first);
+  }
 
-      auto iter = s_textureCache.find(base_filename);
-      if (iter == s_textureCache.end())
-      {
-        // unlock while loading a texture. This may result in a race condition where we'll load a
-        // texture twice,
-        // but it reduces the stuttering a lot. Notice: The loading library _must_ be thread safe
-        // now.
-        // But bad luck, SOIL isn't, so TODO: remove SOIL usage here and use libpng directly
-        // Also TODO: remove s_textureCacheAquireMutex afterwards. It won't be needed as the main
-        // mutex will be locked rarely
-        // lk.unlock();
-        std::unique_ptr<HiresTexture> texture = Load(base_filename, 0, 0);
-        // lk.lock();
-        if (texture)
-        {
-          std::shared_ptr<HiresTexture> ptr(std::move(texture));
-          iter = s_textureCache.insert(iter, std::make_pair(base_filename, ptr));
-        }
-      }
-      if (iter != s_textureCache.end())
-      {
-        for (const Level& l : iter->second->m_levels)
-        {
-          size_sum += l.data_size;
-        }
-      }
-    }
+  // The images are decoded in parallel on the loader threads. Each task first handles the textures
+  // the emulation is waiting for, so those don't have to wait for the whole directory.
+  std::atomic<size_t> size_sum{0};
+  std::atomic<u32> num_loaded{0};
+  Common::Flag out_of_memory;
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(base_filenames.size());
+  for (const std::string& base_filename : base_filenames)
+  {
+    tasks.push_back(s_texture_loader->Schedule([&, base_filename] {
+      LoadRequestedTexture();
+      if (s_textureCacheAbortLoading.IsSet() || out_of_memory.IsSet())
+        return;
+
+      if ((size_sum += PrefetchTexture(base_filename)) > max_mem)
+        out_of_memory.Set();
+      num_loaded++;
+    }));
+  }
 
-    if (s_textureCacheAbortLoading.IsSet())
+  for (std::future<void>& task : tasks)
+  {
+    while (task.wait_for(std::chrono::milliseconds(500)) != std::future_status::ready)
     {
-      return;
+      OSD::AddTypedMessage(OSD::MessageType::CustomTextureLoading,
+                           StringFromFormat("Loading Custom Textures: %u of %zu, %.1f MB",
+                                            num_loaded.load(), base_filenames.size(),
+                                            size_sum / (1024.0 * 1024.0)),
+                           1000);
     }
+  }
+  s_prefetching.Clear();
 
-    if (size_sum > max_mem)
-    {
-      Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
+  if (s_textureCacheAbortLoading.IsSet())
+  {
+    return;
+  }
 
-      OSD::AddMessage(
-          StringFromFormat(
-              "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-      return;
-    }
+  if (out_of_memory.IsSet())
+  {
+    Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
+
+    OSD::AddTypedMessage(
+        OSD::MessageType::CustomTextureLoading,
+        StringFromFormat(
+            "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
+            size_sum / (1024.0 * 1024.0)),
+        10000);
+    return;
   }
+
   u32 stoptime = Common::Timer::GetTimeMs();
-  OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
-                                   size_sum / (1024.0 * 1024.0), (stoptime - starttime) / 1000.0),
-                  10000);
+  OSD::AddTypedMessage(OSD::MessageType::CustomTextureLoading,
+                       StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
+                                        size_sum / (1024.0 * 1024.0),
+                                        (stoptime - starttime) / 1000.0),
+                       10000);
+}
+
+size_t HiresTexture::PrefetchTexture(const std::string& base_filename)
+{
+  {
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    auto iter = s_textureCache.find(base_filename);
+    if (iter != s_textureCache.end())
+      return iter->second ? GetLevelsSize(iter->second->m_levels) : 0;
+  }
+
+  // The lock isn't held while decoding, so a texture which was requested in the meantime might
+  // get loaded twice. The first one wins.
+  std::unique_ptr<HiresTexture> texture = Load(s_textureMap, base_filename, 0, 0);
+  if (!texture)
+    return 0;
+
+  const size_t size = GetLevelsSize(texture->m_levels);
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  if (s_pending_textures.erase(base_filename))
+    s_streamed_texture_count++;
+  s_textureCache.emplace(base_filename, std::move(texture));
+  return size;
 }
 
 std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
@@ -294,21 +411,39 @@ u32 HiresTexture::CalculateMipCount(u32 width, u32 height)
 std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t texture_size,
                                                    const u8* tlut, size_t tlut_size, u32 width,
                                                    u32 height, TextureFormat format,
-                                                   bool has_mipmaps)
+                                                   bool has_mipmaps, bool* is_pending)
 {
   std::string base_filename =
       GenBaseName(texture, texture_size, tlut, tlut_size, width, height, format, has_mipmaps);
 
-  std::lock_guard<std::mutex> lk2(s_textureCacheAquireMutex);
   std::lock_guard<std::mutex> lk(s_textureCacheMutex);
 
   auto iter = s_textureCache.find(base_filename);
   if (iter != s_textureCache.end())
   {
+    auto streamed = s_streamed_textures.find(base_filename);
+    if (streamed != s_streamed_textures.end())
+    {
+      s_streamed_textures_lru.splice(s_streamed_textures_lru.end(), s_streamed_textures_lru,
+                                     streamed->second.lru_position);
+    }
     return iter->second;
   }
 
-  std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+  auto disk_iter = s_textureMap.find(base_filename);
+  if (disk_iter != s_textureMap.end() && (disk_iter->second.pack || s_prefetching.IsSet()))
+  {
+    if (s_pending_textures.insert(base_filename).second)
+    {
+      s_texture_requests.push_back({base_filename, width, height});
+      s_texture_loader->Schedule(LoadRequestedTexture);
+    }
+    if (is_pending)
+      *is_pending = true;
+    return nullptr;
+  }
+
+  std::shared_ptr<HiresTexture> ptr(Load(s_textureMap, base_filename, width, height));
 
   if (ptr && g_ActiveConfig.bCacheHiresTextures)
   {
@@ -318,12 +453,112 @@ std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t tex
   return ptr;
 }
 
-std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filename, u32 width,
+u32 HiresTexture::GetStreamedTextureCount()
+{
+  return s_streamed_texture_count.load();
+}
+
+void HiresTexture::LoadRequestedTexture()
+{
+  TextureRequest request;
+  {
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    if (s_texture_requests.empty() || s_textureCacheAbortLoading.IsSet())
+      return;
+
+    request = std::move(s_texture_requests.front());
+    s_texture_requests.pop_front();
+
+    // The prefetcher might have loaded the texture while the request was queued,
+    // and has already removed it from the pending textures then
+    if (s_textureCache.count(request.base_filename))
+      return;
+  }
+
+  const DiskTexture& disk_texture = s_textureMap.at(request.base_filename);
+  std::unique_ptr<HiresTexture> texture;
+  if (TexturePack* pack = disk_texture.pack)
+  {
+    // Can't use make_unique due to private constructor.
+    texture = std::unique_ptr<HiresTexture>(new HiresTexture());
+    texture->m_has_arbitrary_mipmaps = pack->HasArbitraryMipmaps(disk_texture.pack_index);
+    if (!pack->LoadLevels(disk_texture.pack_index, &texture->m_levels))
+      texture.reset();
+  }
+  else
+  {
+    texture = Load(s_textureMap, request.base_filename, request.width, request.height);
+  }
+
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+
+  // The prefetcher might have been faster while this one was decoding
+  if (!s_pending_textures.erase(request.base_filename))
+    return;
+  s_streamed_texture_count++;
+
+  // Textures which failed to load are cached as nullptr, so the native texture gets used
+  if (!texture || !disk_texture.pack)
+  {
+    s_textureCache.emplace(request.base_filename, std::move(texture));
+    return;
+  }
+
+  const size_t size = GetLevelsSize(texture->m_levels);
+  s_textureCache.emplace(request.base_filename, std::move(texture));
+  s_streamed_textures_lru.push_back(request.base_filename);
+  s_streamed_textures[request.base_filename] = {std::prev(s_streamed_textures_lru.end()), size};
+  s_streamed_textures_size += size;
+
+  // The texture that was just loaded is kept even if it exceeds the budget on its own
+  while (s_streamed_textures_size > s_streamed_textures_budget &&
+         s_streamed_textures_lru.size() > 1)
+  {
+    auto oldest = s_streamed_textures.find(s_streamed_textures_lru.front());
+    s_streamed_textures_size -= oldest->second.size;
+    s_textureCache.erase(oldest->first);
+    s_streamed_textures.erase(oldest);
+    s_streamed_textures_lru.pop_front();
+  }
+}
+
+bool HiresTexture::CreateTexturePack(const std::string& directory, const std::string& pack_path)
+{
+  TextureMap texture_map;
+  FindTextureFiles(directory, &texture_map);
+
+  TexturePackWriter writer;
+  if (!writer.Open(pack_path))
+  {
+    ERROR_LOG(VIDEO, "Failed to create texture pack %s", pack_path.c_str());
+    return false;
+  }
+
+  for (const auto& entry : texture_map)
+  {
+    // Mipmaps are stored together with their first level
+    if (entry.first.find("_mip") != std::string::npos)
+      continue;
+
+    std::unique_ptr<HiresTexture> texture = Load(texture_map, entry.first, 0, 0);
+    if (texture && !writer.AddTexture(entry.first, texture->m_has_arbitrary_mipmaps,
+                                      texture->m_levels))
+    {
+      ERROR_LOG(VIDEO, "Failed to write texture pack %s", pack_path.c_str());
+      return false;
+    }
+  }
+
+  return writer.Finish();
+}
+
+std::unique_ptr<HiresTexture> HiresTexture::Load(const TextureMap& texture_map,
+                                                 const std::string& base_filename, u32 width,
                                                  u32 height)
 {
   // We need to have a level 0 custom texture to even consider loading.
-  auto filename_iter = s_textureMap.find(base_filename);
-  if (filename_iter == s_textureMap.end())
+  auto filename_iter = texture_map.find(base_filename);
+  if (filename_iter == texture_map.end())
     return nullptr;
 
   // Try to load level 0 (and any mipmaps) from a DDS file.
@@ -341,8 +576,8 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
     if (mip_level != 0)
       filename += StringFromFormat("_mip%u", mip_level);
 
-    filename_iter = s_textureMap.find(filename);
-    if (filename_iter == s_textureMap.end())
+    filename_iter = texture_map.find(filename);
+    if (filename_iter == texture_map.end())
       break;
 
     // Try loading DDS textures first, that way we maintain compression of DXT formats.
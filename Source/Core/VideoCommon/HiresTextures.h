@@ -6,12 +6,15 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoCommon/TextureConfig.h"
 
 enum class TextureFormat;
+struct DiskTexture;
+class TexturePack;
 
 class HiresTexture
 {
@@ -22,9 +25,19 @@ public:
   static void Update();
   static void Shutdown();
 
+  // Textures from texture packs, and loose textures while they are being prefetched, are loaded
+  // on worker threads. Until they are loaded, this returns nullptr and sets is_pending.
   static std::shared_ptr<HiresTexture> Search(const u8* texture, size_t texture_size,
                                               const u8* tlut, size_t tlut_size, u32 width,
-                                              u32 height, TextureFormat format, bool has_mipmaps);
+                                              u32 height, TextureFormat format, bool has_mipmaps,
+                                              bool* is_pending = nullptr);
+
+  // The number of requested textures which have finished loading. Pending textures should be
+  // looked up again once this has changed.
+  static u32 GetStreamedTextureCount();
+
+  // Bundles the custom textures of a directory into a texture pack, see TexturePack.h.
+  static bool CreateTexturePack(const std::string& directory, const std::string& pack_path);
 
   static std::string GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                  size_t tlut_size, u32 width, u32 height, TextureFormat format,
@@ -51,8 +64,13 @@ public:
   std::vector<Level> m_levels;
 
 private:
-  static std::unique_ptr<HiresTexture> Load(const std::string& base_filename, u32 width,
+  using TextureMap = std::unordered_map<std::string, DiskTexture>;
+
+  static std::unique_ptr<HiresTexture> Load(const TextureMap& texture_map,
+                                            const std::string& base_filename, u32 width,
                                             u32 height);
+  static void LoadRequestedTexture();
+  static size_t PrefetchTexture(const std::string& base_filename);
   static bool LoadDDSTexture(HiresTexture* tex, const std::string& filename);
   static bool LoadDDSTexture(Level& level, const std::string& filename);
   static bool LoadTexture(Level& level, const std::vector<u8>& buffer);
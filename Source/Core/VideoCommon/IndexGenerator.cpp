@@ -2,102 +2,201 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 #include "Common/Common.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
 
 // Init
-u16* IndexGenerator::index_buffer_current;
-u16* IndexGenerator::BASEIptr;
+u8* IndexGenerator::index_buffer_current;
+u8* IndexGenerator::BASEIptr;
 u32 IndexGenerator::base_index;
+u32 IndexGenerator::index_size = sizeof(u16);
 
-static const u16 s_primitive_restart = UINT16_MAX;
+namespace
+{
+using PrimitiveTable = std::array<u8* (*)(u8*, u32, u32), 8>;
 
-static u16* (*primitive_table[8])(u16*, u32, u32);
+PrimitiveTable s_primitive_table_16;
+PrimitiveTable s_primitive_table_32;
+// The table for the index size of the current buffer
+const PrimitiveTable* s_primitive_table = &s_primitive_table_16;
 
-void IndexGenerator::Init()
+template <typename T>
+constexpr T PrimitiveRestart()
 {
-  if (g_Config.backend_info.bSupportsPrimitiveRestart)
-  {
-    primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuads<true>;
-    primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuads_nonstandard<true>;
-    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddList<true>;
-    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddStrip<true>;
-    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddFan<true>;
-  }
-  else
+  return static_cast<T>(-1);
+}
+
+// Pattern entries which aren't an offset from the first vertex of the group
+constexpr int RESTART = -1;  // A primitive restart index
+constexpr int FIRST = -2;    // The first vertex of the whole primitive, used by fans
+
+// The indices of a primitive are written as groups with the same layout, each referring to the
+// vertices Step after the previous group. The layout is known at compile time, so that the
+// groups are written without any branches, and the common cases with SIMD.
+template <u32 Step, int... Entries>
+struct IndexPattern
+{
+};
+
+template <typename T>
+constexpr T GetPatternIndex(int entry, u32 index, u32 first)
+{
+  return entry == RESTART ? PrimitiveRestart<T>() :
+                            static_cast<T>(entry == FIRST ? first : index + entry);
+}
+
+template <typename T, u32 Step, int... Entries>
+__forceinline T* WriteGroupsScalar(T* Iptr, u32 groups, u32 index, u32 first)
+{
+  for (u32 i = 0; i < groups; ++i, index += Step)
   {
-    primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuads<false>;
-    primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuads_nonstandard<false>;
-    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddList<false>;
-    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddStrip<false>;
-    primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddFan<false>;
+    // Expands to one store per entry
+    using expand = int[];
+    (void)expand{0, (*Iptr++ = GetPatternIndex<T>(Entries, index, first), 0)...};
   }
-  primitive_table[OpcodeDecoder::GX_DRAW_LINES] = &AddLineList;
-  primitive_table[OpcodeDecoder::GX_DRAW_LINE_STRIP] = &AddLineStrip;
-  primitive_table[OpcodeDecoder::GX_DRAW_POINTS] = &AddPoints;
+  return Iptr;
 }
 
-void IndexGenerator::Start(u16* Indexptr)
+#ifdef _M_X86
+template <typename T>
+__m128i AddLanes(__m128i a, __m128i b)
 {
-  index_buffer_current = Indexptr;
-  BASEIptr = Indexptr;
-  base_index = 0;
+  return sizeof(T) == sizeof(u16) ? _mm_add_epi16(a, b) : _mm_add_epi32(a, b);
 }
 
-void IndexGenerator::AddIndices(int primitive, u32 numVerts)
+// As many groups as fit are stored as one vector. If that leaves lanes at the end, they are
+// overwritten by the following groups. The last few groups are left to the scalar loop, so that
+// nothing is stored past the end of the primitive.
+template <typename T, u32 Step, int... Entries>
+T* WriteGroupsSIMD(std::true_type, T* Iptr, u32* groups, u32* index, u32 first)
 {
-  index_buffer_current = primitive_table[primitive](index_buffer_current, numVerts, base_index);
-  base_index += numVerts;
+  constexpr u32 lanes = 16 / sizeof(T);
+  constexpr u32 size = sizeof...(Entries);
+  constexpr u32 groups_per_vector = lanes / size;
+  constexpr int entries[] = {Entries...};
+  if (*groups * size < 4 * lanes)
+    return Iptr;
+
+  alignas(16) T values[lanes] = {};
+  alignas(16) T steps[lanes] = {};
+  for (u32 i = 0; i < groups_per_vector; ++i)
+  {
+    for (u32 j = 0; j < size; ++j)
+    {
+      values[i * size + j] = GetPatternIndex<T>(entries[j], *index + i * Step, first);
+      steps[i * size + j] = entries[j] < 0 ? 0 : static_cast<T>(groups_per_vector * Step);
+    }
+  }
+
+  __m128i vector = _mm_load_si128(reinterpret_cast<const __m128i*>(values));
+  const __m128i step = _mm_load_si128(reinterpret_cast<const __m128i*>(steps));
+  const T* const vector_end = Iptr + *groups * size - lanes;
+  for (; Iptr <= vector_end; Iptr += groups_per_vector * size)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(Iptr), vector);
+    vector = AddLanes<T>(vector, step);
+    *groups -= groups_per_vector;
+    *index += groups_per_vector * Step;
+  }
+  return Iptr;
 }
 
-// Triangles
-template <bool pr>
-__forceinline u16* IndexGenerator::WriteTriangle(u16* Iptr, u32 index1, u32 index2, u32 index3)
+// Groups which don't fit into a vector
+template <typename T, u32 Step, int... Entries>
+T* WriteGroupsSIMD(std::false_type, T* Iptr, u32*, u32*, u32)
 {
-  *Iptr++ = index1;
-  *Iptr++ = index2;
-  *Iptr++ = index3;
-  if (pr)
-    *Iptr++ = s_primitive_restart;
   return Iptr;
 }
+#endif
+
+template <typename T, u32 Step, int... Entries>
+__forceinline T* WriteGroups(IndexPattern<Step, Entries...>, T* Iptr, u32 groups, u32 index,
+                             u32 first)
+{
+#ifdef _M_X86
+  using fits_vector = std::integral_constant<bool, sizeof...(Entries) * sizeof(T) <= 16>;
+  Iptr = WriteGroupsSIMD<T, Step, Entries...>(fits_vector(), Iptr, &groups, &index, first);
+#endif
+
+  return WriteGroupsScalar<T, Step, Entries...>(Iptr, groups, index, first);
+}
 
-template <bool pr>
-u16* IndexGenerator::AddList(u16* Iptr, u32 const numVerts, u32 index)
+// Writes index, index + 1, ..., index + count - 1
+template <typename T>
+__forceinline T* WriteSequence(T* Iptr, u32 count, u32 index)
 {
-  for (u32 i = 2; i < numVerts; i += 3)
+  u32 i = 0;
+#ifdef _M_X86
+  constexpr u32 lanes = 16 / sizeof(T);
+  if (count >= 4 * lanes)
   {
-    Iptr = WriteTriangle<pr>(Iptr, index + i - 2, index + i - 1, index + i);
+    alignas(16) T values[lanes];
+    alignas(16) T steps[lanes];
+    for (u32 j = 0; j < lanes; ++j)
+    {
+      values[j] = static_cast<T>(index + j);
+      steps[j] = static_cast<T>(lanes);
+    }
+
+    __m128i vector = _mm_load_si128(reinterpret_cast<const __m128i*>(values));
+    const __m128i step = _mm_load_si128(reinterpret_cast<const __m128i*>(steps));
+    for (; i + lanes <= count; i += lanes)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(Iptr + i), vector);
+      vector = AddLanes<T>(vector, step);
+    }
   }
-  return Iptr;
+#endif
+
+  for (; i < count; ++i)
+    Iptr[i] = static_cast<T>(index + i);
+  return Iptr + count;
 }
 
-template <bool pr>
-u16* IndexGenerator::AddStrip(u16* Iptr, u32 const numVerts, u32 index)
+// Triangles
+using Triangle = IndexPattern<3, 0, 1, 2>;
+using TrianglePR = IndexPattern<3, 0, 1, 2, RESTART>;
+// Every other triangle of a strip is wound the other way round
+using StripTrianglePair = IndexPattern<2, 0, 1, 2, 1, 3, 2>;
+using FanTriangle = IndexPattern<1, FIRST, 1, 2>;
+using FanTrianglePR = IndexPattern<1, FIRST, 1, 2, RESTART>;
+using FanThreeTrianglesPR = IndexPattern<3, 1, 2, FIRST, 3, 4, RESTART>;
+using Quad = IndexPattern<4, 0, 1, 2, 0, 2, 3>;
+using QuadPR = IndexPattern<4, 1, 2, 0, 3, RESTART>;
+
+template <typename T, bool pr>
+T* AddList(T* Iptr, u32 const numVerts, u32 index)
+{
+  if (pr)
+    return WriteGroups(TrianglePR(), Iptr, numVerts / 3, index, index);
+  return WriteSequence(Iptr, numVerts / 3 * 3, index);
+}
+
+template <typename T, bool pr>
+T* AddStrip(T* Iptr, u32 const numVerts, u32 index)
 {
   if (pr)
   {
-    for (u32 i = 0; i < numVerts; ++i)
-    {
-      *Iptr++ = index + i;
-    }
-    *Iptr++ = s_primitive_restart;
+    Iptr = WriteSequence(Iptr, numVerts, index);
+    *Iptr++ = PrimitiveRestart<T>();
   }
-  else
+  else if (numVerts >= 3)
   {
-    bool wind = false;
-    for (u32 i = 2; i < numVerts; ++i)
-    {
-      Iptr = WriteTriangle<pr>(Iptr, index + i - 2, index + i - !wind, index + i - wind);
-
-      wind ^= true;
-    }
+    const u32 num_pairs = (numVerts - 2) / 2;
+    Iptr = WriteGroups(StripTrianglePair(), Iptr, num_pairs, index, index);
+    if ((numVerts - 2) % 2)
+      Iptr = WriteGroups(Triangle(), Iptr, 1, index + num_pairs * 2, index);
   }
   return Iptr;
 }
@@ -121,22 +220,16 @@ u16* IndexGenerator::AddStrip(u16* Iptr, u32 const numVerts, u32 index)
  * so we use 6 indices for 3 triangles
  */
 
-template <bool pr>
-u16* IndexGenerator::AddFan(u16* Iptr, u32 numVerts, u32 index)
+template <typename T, bool pr>
+T* AddFan(T* Iptr, u32 numVerts, u32 index)
 {
   u32 i = 2;
 
   if (pr)
   {
-    for (; i + 3 <= numVerts; i += 3)
-    {
-      *Iptr++ = index + i - 1;
-      *Iptr++ = index + i + 0;
-      *Iptr++ = index;
-      *Iptr++ = index + i + 1;
-      *Iptr++ = index + i + 2;
-      *Iptr++ = s_primitive_restart;
-    }
+    const u32 num_groups = numVerts >= 5 ? (numVerts - 2) / 3 : 0;
+    Iptr = WriteGroups(FanThreeTrianglesPR(), Iptr, num_groups, index, index);
+    i += num_groups * 3;
 
     for (; i + 2 <= numVerts; i += 2)
     {
@@ -144,13 +237,17 @@ u16* IndexGenerator::AddFan(u16* Iptr, u32 numVerts, u32 index)
       *Iptr++ = index + i + 0;
       *Iptr++ = index;
       *Iptr++ = index + i + 1;
-      *Iptr++ = s_primitive_restart;
+      *Iptr++ = PrimitiveRestart<T>();
     }
   }
 
-  for (; i < numVerts; ++i)
+  if (i < numVerts)
   {
-    Iptr = WriteTriangle<pr>(Iptr, index, index + i - 1, index + i);
+    const u32 num_triangles = numVerts - i;
+    if (pr)
+      Iptr = WriteGroups(FanTrianglePR(), Iptr, num_triangles, index + i - 2, index);
+    else
+      Iptr = WriteGroups(FanTriangle(), Iptr, num_triangles, index + i - 2, index);
   }
   return Iptr;
 }
@@ -172,78 +269,120 @@ u16* IndexGenerator::AddFan(u16* Iptr, u32 numVerts, u32 index)
  * A simple triangle has to be rendered for three vertices.
  * ZWW do this for sun rays
  */
-template <bool pr>
-u16* IndexGenerator::AddQuads(u16* Iptr, u32 numVerts, u32 index)
+template <typename T, bool pr>
+T* AddQuads(T* Iptr, u32 numVerts, u32 index)
 {
-  u32 i = 3;
-  for (; i < numVerts; i += 4)
-  {
-    if (pr)
-    {
-      *Iptr++ = index + i - 2;
-      *Iptr++ = index + i - 1;
-      *Iptr++ = index + i - 3;
-      *Iptr++ = index + i - 0;
-      *Iptr++ = s_primitive_restart;
-    }
-    else
-    {
-      Iptr = WriteTriangle<pr>(Iptr, index + i - 3, index + i - 2, index + i - 1);
-      Iptr = WriteTriangle<pr>(Iptr, index + i - 3, index + i - 1, index + i - 0);
-    }
-  }
+  const u32 num_quads = numVerts / 4;
+  if (pr)
+    Iptr = WriteGroups(QuadPR(), Iptr, num_quads, index, index);
+  else
+    Iptr = WriteGroups(Quad(), Iptr, num_quads, index, index);
 
   // three vertices remaining, so render a triangle
-  if (i == numVerts)
+  if (numVerts % 4 == 3)
   {
-    Iptr =
-        WriteTriangle<pr>(Iptr, index + numVerts - 3, index + numVerts - 2, index + numVerts - 1);
+    const u32 first = index + numVerts - 3;
+    if (pr)
+      Iptr = WriteGroups(TrianglePR(), Iptr, 1, first, first);
+    else
+      Iptr = WriteGroups(Triangle(), Iptr, 1, first, first);
   }
   return Iptr;
 }
 
-template <bool pr>
-u16* IndexGenerator::AddQuads_nonstandard(u16* Iptr, u32 numVerts, u32 index)
+template <typename T, bool pr>
+T* AddQuads_nonstandard(T* Iptr, u32 numVerts, u32 index)
 {
   WARN_LOG(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
-  return AddQuads<pr>(Iptr, numVerts, index);
+  return AddQuads<T, pr>(Iptr, numVerts, index);
 }
 
 // Lines
-u16* IndexGenerator::AddLineList(u16* Iptr, u32 numVerts, u32 index)
+using Line = IndexPattern<1, 0, 1>;
+
+template <typename T>
+T* AddLineList(T* Iptr, u32 numVerts, u32 index)
 {
-  for (u32 i = 1; i < numVerts; i += 2)
-  {
-    *Iptr++ = index + i - 1;
-    *Iptr++ = index + i;
-  }
-  return Iptr;
+  return WriteSequence(Iptr, numVerts / 2 * 2, index);
 }
 
 // shouldn't be used as strips as LineLists are much more common
 // so converting them to lists
-u16* IndexGenerator::AddLineStrip(u16* Iptr, u32 numVerts, u32 index)
+template <typename T>
+T* AddLineStrip(T* Iptr, u32 numVerts, u32 index)
 {
-  for (u32 i = 1; i < numVerts; ++i)
-  {
-    *Iptr++ = index + i - 1;
-    *Iptr++ = index + i;
-  }
-  return Iptr;
+  return WriteGroups(Line(), Iptr, numVerts >= 2 ? numVerts - 1 : 0, index, index);
 }
 
 // Points
-u16* IndexGenerator::AddPoints(u16* Iptr, u32 numVerts, u32 index)
+template <typename T>
+T* AddPoints(T* Iptr, u32 numVerts, u32 index)
 {
-  for (u32 i = 0; i != numVerts; ++i)
+  return WriteSequence(Iptr, numVerts, index);
+}
+
+template <typename T, T* (*AddFunction)(T*, u32, u32)>
+u8* AddIndicesOfType(u8* Iptr, u32 numVerts, u32 index)
+{
+  return reinterpret_cast<u8*>(AddFunction(reinterpret_cast<T*>(Iptr), numVerts, index));
+}
+
+template <typename T, bool pr>
+void InitPrimitiveTable(PrimitiveTable* table)
+{
+  (*table)[OpcodeDecoder::GX_DRAW_QUADS] = AddIndicesOfType<T, AddQuads<T, pr>>;
+  (*table)[OpcodeDecoder::GX_DRAW_QUADS_2] = AddIndicesOfType<T, AddQuads_nonstandard<T, pr>>;
+  (*table)[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddIndicesOfType<T, AddList<T, pr>>;
+  (*table)[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddIndicesOfType<T, AddStrip<T, pr>>;
+  (*table)[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddIndicesOfType<T, AddFan<T, pr>>;
+  (*table)[OpcodeDecoder::GX_DRAW_LINES] = AddIndicesOfType<T, AddLineList<T>>;
+  (*table)[OpcodeDecoder::GX_DRAW_LINE_STRIP] = AddIndicesOfType<T, AddLineStrip<T>>;
+  (*table)[OpcodeDecoder::GX_DRAW_POINTS] = AddIndicesOfType<T, AddPoints<T>>;
+}
+}  // Anonymous namespace
+
+void IndexGenerator::Init()
+{
+  if (g_Config.backend_info.bSupportsPrimitiveRestart)
   {
-    *Iptr++ = index + i;
+    InitPrimitiveTable<u16, true>(&s_primitive_table_16);
+    InitPrimitiveTable<u32, true>(&s_primitive_table_32);
   }
-  return Iptr;
+  else
+  {
+    InitPrimitiveTable<u16, false>(&s_primitive_table_16);
+    InitPrimitiveTable<u32, false>(&s_primitive_table_32);
+  }
+}
+
+void IndexGenerator::Start(u16* Indexptr)
+{
+  index_buffer_current = reinterpret_cast<u8*>(Indexptr);
+  BASEIptr = reinterpret_cast<u8*>(Indexptr);
+  base_index = 0;
+  index_size = sizeof(u16);
+  s_primitive_table = &s_primitive_table_16;
+}
+
+void IndexGenerator::Start(u32* Indexptr)
+{
+  index_buffer_current = reinterpret_cast<u8*>(Indexptr);
+  BASEIptr = reinterpret_cast<u8*>(Indexptr);
+  base_index = 0;
+  index_size = sizeof(u32);
+  s_primitive_table = &s_primitive_table_32;
+}
+
+void IndexGenerator::AddIndices(int primitive, u32 numVerts)
+{
+  index_buffer_current =
+      (*s_primitive_table)[primitive](index_buffer_current, numVerts, base_index);
+  base_index += numVerts;
 }
 
 u32 IndexGenerator::GetRemainingIndices()
 {
-  u32 max_index = 65534;  // -1 is reserved for primitive restart (ogl + dx11)
+  // -1 is reserved for primitive restart (ogl + dx11)
+  u32 max_index = index_size == sizeof(u32) ? UINT32_MAX - 1 : 65534;
   return max_index - base_index;
 }
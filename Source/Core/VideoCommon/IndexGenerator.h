@@ -14,39 +14,23 @@ class IndexGenerator
 public:
   // Init
   static void Init();
+  // The type of the buffer selects the index size until the next call. 32-bit indices let a
+  // batch reference more than 65535 vertices, so fewer flushes are needed.
   static void Start(u16* Indexptr);
+  static void Start(u32* Indexptr);
 
   static void AddIndices(int primitive, u32 numVertices);
 
   // returns numprimitives
   static u32 GetNumVerts() { return base_index; }
-  static u32 GetIndexLen() { return (u32)(index_buffer_current - BASEIptr); }
+  static u32 GetIndexLen() { return (u32)(index_buffer_current - BASEIptr) / index_size; }
+  // Size of an index in bytes
+  static u32 GetIndexSize() { return index_size; }
   static u32 GetRemainingIndices();
 
 private:
-  // Triangles
-  template <bool pr>
-  static u16* AddList(u16* Iptr, u32 numVerts, u32 index);
-  template <bool pr>
-  static u16* AddStrip(u16* Iptr, u32 numVerts, u32 index);
-  template <bool pr>
-  static u16* AddFan(u16* Iptr, u32 numVerts, u32 index);
-  template <bool pr>
-  static u16* AddQuads(u16* Iptr, u32 numVerts, u32 index);
-  template <bool pr>
-  static u16* AddQuads_nonstandard(u16* Iptr, u32 numVerts, u32 index);
-
-  // Lines
-  static u16* AddLineList(u16* Iptr, u32 numVerts, u32 index);
-  static u16* AddLineStrip(u16* Iptr, u32 numVerts, u32 index);
-
-  // Points
-  static u16* AddPoints(u16* Iptr, u32 numVerts, u32 index);
-
-  template <bool pr>
-  static u16* WriteTriangle(u16* Iptr, u32 index1, u32 index2, u32 index3);
-
-  static u16* index_buffer_current;
-  static u16* BASEIptr;
+  static u8* index_buffer_current;
+  static u8* BASEIptr;
   static u32 base_index;
+  static u32 index_size;
 };
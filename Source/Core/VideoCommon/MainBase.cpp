@@ -27,6 +27,7 @@
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 #include "VideoCommon/VideoState.h"
 
 static Common::Flag s_FifoShuttingDown;
@@ -203,6 +204,7 @@ void VideoBackendBase::ShutdownShared()
   m_initialized = false;
 
   VertexLoaderManager::Clear();
+  VideoProfiler::Shutdown();
   Fifo::Shutdown();
 }
 
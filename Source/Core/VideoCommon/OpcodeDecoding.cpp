@@ -28,6 +28,7 @@
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoProfiler.h"
 #include "VideoCommon/XFMemory.h"
 
 bool g_bRecordFifoData = false;
@@ -83,6 +84,8 @@ void Init()
 template <bool is_preprocess>
 u8* Run(DataReader src, u32* cycles, bool in_display_list)
 {
+  VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::OpcodeDecoding, !is_preprocess);
+
   u32 totalCycles = 0;
   u8* opcodeStart;
   while (true)
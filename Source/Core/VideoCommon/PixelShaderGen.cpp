@@ -348,8 +348,45 @@ void ClearUnusedPixelShaderUidBits(APIType ApiType, PixelShaderUid* uid)
     uid_data->uint_output = 0;
 }
 
+static const char s_pixel_shader_uniforms[] = "\tint4 " I_COLORS "[4];\n"
+                                              "\tint4 " I_KCOLORS "[4];\n"
+                                              "\tint4 " I_ALPHA ";\n"
+                                              "\tfloat4 " I_TEXDIMS "[8];\n"
+                                              "\tint4 " I_ZBIAS "[2];\n"
+                                              "\tint4 " I_INDTEXSCALE "[2];\n"
+                                              "\tint4 " I_INDTEXMTX "[6];\n"
+                                              "\tint4 " I_FOGCOLOR ";\n"
+                                              "\tint4 " I_FOGI ";\n"
+                                              "\tfloat4 " I_FOGF ";\n"
+                                              "\tfloat4 " I_FOGRANGE "[3];\n"
+                                              "\tfloat4 " I_ZSLOPE ";\n"
+                                              "\tfloat2 " I_EFBSCALE ";\n"
+                                              "\tuint  bpmem_genmode;\n"
+                                              "\tuint  bpmem_alphaTest;\n"
+                                              "\tuint  bpmem_fogParam3;\n"
+                                              "\tuint  bpmem_fogRangeBase;\n"
+                                              "\tuint  bpmem_dstalpha;\n"
+                                              "\tuint  bpmem_ztex_op;\n"
+                                              "\tbool  bpmem_late_ztest;\n"
+                                              "\tbool  bpmem_rgba6_format;\n"
+                                              "\tbool  bpmem_dither;\n"
+                                              "\tbool  bpmem_bounding_box;\n"
+                                              // .xy - combiners, .z - tevind
+                                              "\tuint4 bpmem_pack1[16];\n"
+                                              // .x - tevorder, .y - tevksel
+                                              "\tuint4 bpmem_pack2[8];\n"
+                                              "\tint4  konstLookup[32];\n"
+                                              "\tbool  blend_enable;\n"
+                                              "\tuint  blend_src_factor;\n"
+                                              "\tuint  blend_src_factor_alpha;\n"
+                                              "\tuint  blend_dst_factor;\n"
+                                              "\tuint  blend_dst_factor_alpha;\n"
+                                              "\tbool  blend_subtract;\n"
+                                              "\tbool  blend_subtract_alpha;\n";
+
 void WritePixelShaderCommonHeader(ShaderCode& out, APIType ApiType, u32 num_texgens,
-                                  bool per_pixel_lighting, bool bounding_box)
+                                  bool per_pixel_lighting, bool bounding_box,
+                                  bool per_draw_constants)
 {
   // dot product for integer vectors
   out.Write("int idot(int3 x, int3 y)\n"
@@ -383,45 +420,21 @@ void WritePixelShaderCommonHeader(ShaderCode& out, APIType ApiType, u32 num_texg
   }
   out.Write("\n");
 
-  if (ApiType == APIType::OpenGL || ApiType == APIType::Vulkan)
-    out.Write("UBO_BINDING(std140, 1) uniform PSBlock {\n");
+  if (per_draw_constants)
+  {
+    out.Write("uint draw_index;\n");
+    WritePerDrawConstantBlock(out, "PS", 1, s_pixel_shader_uniforms);
+  }
   else
-    out.Write("cbuffer PSBlock : register(b0) {\n");
-
-  out.Write("\tint4 " I_COLORS "[4];\n"
-            "\tint4 " I_KCOLORS "[4];\n"
-            "\tint4 " I_ALPHA ";\n"
-            "\tfloat4 " I_TEXDIMS "[8];\n"
-            "\tint4 " I_ZBIAS "[2];\n"
-            "\tint4 " I_INDTEXSCALE "[2];\n"
-            "\tint4 " I_INDTEXMTX "[6];\n"
-            "\tint4 " I_FOGCOLOR ";\n"
-            "\tint4 " I_FOGI ";\n"
-            "\tfloat4 " I_FOGF ";\n"
-            "\tfloat4 " I_FOGRANGE "[3];\n"
-            "\tfloat4 " I_ZSLOPE ";\n"
-            "\tfloat2 " I_EFBSCALE ";\n"
-            "\tuint  bpmem_genmode;\n"
-            "\tuint  bpmem_alphaTest;\n"
-            "\tuint  bpmem_fogParam3;\n"
-            "\tuint  bpmem_fogRangeBase;\n"
-            "\tuint  bpmem_dstalpha;\n"
-            "\tuint  bpmem_ztex_op;\n"
-            "\tbool  bpmem_late_ztest;\n"
-            "\tbool  bpmem_rgba6_format;\n"
-            "\tbool  bpmem_dither;\n"
-            "\tbool  bpmem_bounding_box;\n"
-            "\tuint4 bpmem_pack1[16];\n"  // .xy - combiners, .z - tevind
-            "\tuint4 bpmem_pack2[8];\n"   // .x - tevorder, .y - tevksel
-            "\tint4  konstLookup[32];\n"
-            "\tbool  blend_enable;\n"
-            "\tuint  blend_src_factor;\n"
-            "\tuint  blend_src_factor_alpha;\n"
-            "\tuint  blend_dst_factor;\n"
-            "\tuint  blend_dst_factor_alpha;\n"
-            "\tbool  blend_subtract;\n"
-            "\tbool  blend_subtract_alpha;\n"
-            "};\n\n");
+  {
+    if (ApiType == APIType::OpenGL || ApiType == APIType::Vulkan)
+      out.Write("UBO_BINDING(std140, 1) uniform PSBlock {\n");
+    else
+      out.Write("cbuffer PSBlock : register(b0) {\n");
+
+    out.Write(s_pixel_shader_uniforms);
+    out.Write("};\n\n");
+  }
   out.Write("#define bpmem_combiners(i) (bpmem_pack1[(i)].xy)\n"
             "#define bpmem_tevind(i) (bpmem_pack1[(i)].z)\n"
             "#define bpmem_iref(i) (bpmem_pack1[(i)].w)\n"
@@ -432,13 +445,20 @@ void WritePixelShaderCommonHeader(ShaderCode& out, APIType ApiType, u32 num_texg
   {
     out.Write("%s", s_lighting_struct);
 
-    if (ApiType == APIType::OpenGL || ApiType == APIType::Vulkan)
-      out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+    if (per_draw_constants)
+    {
+      WritePerDrawConstantBlock(out, "VS", 2, s_shader_uniforms);
+    }
     else
-      out.Write("cbuffer VSBlock : register(b1) {\n");
+    {
+      if (ApiType == APIType::OpenGL || ApiType == APIType::Vulkan)
+        out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+      else
+        out.Write("cbuffer VSBlock : register(b1) {\n");
 
-    out.Write(s_shader_uniforms);
-    out.Write("};\n");
+      out.Write(s_shader_uniforms);
+      out.Write("};\n");
+    }
   }
 
   if (bounding_box)
@@ -456,7 +476,7 @@ void WritePixelShaderCommonHeader(ShaderCode& out, APIType ApiType, u32 num_texg
   }
 
   out.Write("struct VS_OUTPUT {\n");
-  GenerateVSOutputMembers(out, ApiType, num_texgens, per_pixel_lighting, "");
+  GenerateVSOutputMembers(out, ApiType, num_texgens, per_pixel_lighting, "", per_draw_constants);
   out.Write("};\n");
 }
 
@@ -490,7 +510,7 @@ ShaderCode GeneratePixelShaderCode(APIType ApiType, const ShaderHostConfig& host
 
   // Stuff that is shared between ubershaders and pixelgen.
   WritePixelShaderCommonHeader(out, ApiType, uid_data->genMode_numtexgens, per_pixel_lighting,
-                               uid_data->bounding_box);
+                               uid_data->bounding_box, host_config.per_draw_constants);
 
   if (uid_data->forced_early_z && g_ActiveConfig.backend_info.bSupportsEarlyZ)
   {
@@ -590,7 +610,8 @@ ShaderCode GeneratePixelShaderCode(APIType ApiType, const ShaderHostConfig& host
     {
       out.Write("VARYING_LOCATION(0) in VertexData {\n");
       GenerateVSOutputMembers(out, ApiType, uid_data->genMode_numtexgens, per_pixel_lighting,
-                              GetInterpolationQualifier(msaa, ssaa, true, true));
+                              GetInterpolationQualifier(msaa, ssaa, true, true),
+                              host_config.per_draw_constants, true);
 
       if (stereo)
         out.Write("\tflat int layer;\n");
@@ -616,6 +637,8 @@ ShaderCode GeneratePixelShaderCode(APIType ApiType, const ShaderHostConfig& host
     }
 
     out.Write("void main()\n{\n");
+    if (host_config.per_draw_constants)
+      out.Write("\tdraw_index = draw;\n");
     out.Write("\tfloat4 rawpos = gl_FragCoord;\n");
     if (use_shader_blend)
     {
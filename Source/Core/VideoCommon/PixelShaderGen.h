@@ -167,6 +167,7 @@ typedef ShaderUid<pixel_shader_uid_data> PixelShaderUid;
 ShaderCode GeneratePixelShaderCode(APIType ApiType, const ShaderHostConfig& host_config,
                                    const pixel_shader_uid_data* uid_data);
 void WritePixelShaderCommonHeader(ShaderCode& out, APIType ApiType, u32 num_texgens,
-                                  bool per_pixel_lighting, bool bounding_box);
+                                  bool per_pixel_lighting, bool bounding_box,
+                                  bool per_draw_constants);
 void ClearUnusedPixelShaderUidBits(APIType ApiType, PixelShaderUid* uid);
 PixelShaderUid GetPixelShaderUid();
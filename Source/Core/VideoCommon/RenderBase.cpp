@@ -62,6 +62,7 @@
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 #include "VideoCommon/XFMemory.h"
 
 // TODO: Move these out of here.
@@ -686,6 +687,7 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
       // Begin new frame
       // Set default viewport and scissor, for the clear to work correctly
       // New frame
+      VideoProfiler::EndFrame();
       stats.ResetFrame();
 
       Core::Callback_VideoCopiedToXFB(true);
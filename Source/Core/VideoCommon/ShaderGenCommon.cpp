@@ -3,9 +3,13 @@
 // Refer to the license.txt file included.
 
 #include "VideoCommon/ShaderGenCommon.h"
+
+#include <sstream>
+
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
+#include "VideoCommon/ConstantManager.h"
 
 ShaderHostConfig ShaderHostConfig::GetCurrent()
 {
@@ -33,6 +37,7 @@ ShaderHostConfig ShaderHostConfig::GetCurrent()
   bits.backend_dynamic_sampler_indexing =
       g_ActiveConfig.backend_info.bSupportsDynamicSamplerIndexing;
   bits.backend_shader_framebuffer_fetch = g_ActiveConfig.backend_info.bSupportsFramebufferFetch;
+  bits.per_draw_constants = g_ActiveConfig.backend_info.bSupportsPerDrawConstants;
   return bits;
 }
 
@@ -69,7 +74,7 @@ std::string GetDiskShaderCacheFileName(APIType api_type, const char* type, bool
 
   if (include_host_config)
   {
-    // We're using 21 bits, so 6 hex characters.
+    // We're using 22 bits, so 6 hex characters.
     ShaderHostConfig host_config = ShaderHostConfig::GetCurrent();
     filename += StringFromFormat("-%06X", host_config.bits);
   }
@@ -77,3 +82,38 @@ std::string GetDiskShaderCacheFileName(APIType api_type, const char* type, bool
   filename += ".cache";
   return filename;
 }
+
+void WritePerDrawConstantBlock(ShaderCode& out, const char* name, u32 binding,
+                               const char* members)
+{
+  out.Write("struct %sConstants {\n", name);
+  out.Write("%s", members);
+  out.Write("};\n");
+  out.Write("UBO_BINDING(std140, %u) readonly buffer %sBlock {\n"
+            "\t%sConstants %s_draws[];\n"
+            "};\n",
+            binding, name, name, name);
+
+  // The name of each member is the last word before its array size or the semicolon.
+  std::istringstream stream(members);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    const size_t end = line.find_first_of("[;");
+    if (end == std::string::npos || line.find('#') != std::string::npos)
+      continue;
+
+    const size_t start = line.find_last_of(" \t", end) + 1;
+    const std::string member = line.substr(start, end - start);
+    out.Write("#define %s %s_draws[draw_index].%s\n", member.c_str(), name, member.c_str());
+  }
+}
+
+void WriteVertexDrawIndex(ShaderCode& out)
+{
+  // The last draw's range ends at UINT32_MAX. The bound only matters when no constants are bound.
+  out.Write("\tdraw_index = 0u;\n"
+            "\twhile (draw_index < %uu && uint(gl_VertexID) >= draw_end)\n"
+            "\t\tdraw_index++;\n",
+            MAX_DRAWS_PER_BATCH - 1);
+}
@@ -179,7 +179,8 @@ union ShaderHostConfig
     u32 backend_bitfield : 1;
     u32 backend_dynamic_sampler_indexing : 1;
     u32 backend_shader_framebuffer_fetch : 1;
-    u32 pad : 11;
+    u32 per_draw_constants : 1;
+    u32 pad : 10;
   };
 
   static ShaderHostConfig GetCurrent();
@@ -210,9 +211,12 @@ inline void DefineOutputMember(T& object, APIType api_type, const char* qualifie
   object.Write(";\n");
 }
 
+// With per-draw constants, the index of the vertex's draw is passed on to the pixel shader.
+// Integer outputs must be flat, but interpolation qualifiers aren't allowed in structs.
 template <class T>
 inline void GenerateVSOutputMembers(T& object, APIType api_type, u32 texgens,
-                                    bool per_pixel_lighting, const char* qualifier)
+                                    bool per_pixel_lighting, const char* qualifier,
+                                    bool per_draw_constants = false, bool interface_block = false)
 {
   DefineOutputMember(object, api_type, qualifier, "float4", "pos", -1, "POSITION");
   DefineOutputMember(object, api_type, qualifier, "float4", "colors_", 0, "COLOR", 0);
@@ -233,11 +237,17 @@ inline void GenerateVSOutputMembers(T& object, APIType api_type, u32 texgens,
 
   DefineOutputMember(object, api_type, qualifier, "float", "clipDist", 0, "SV_ClipDistance", 0);
   DefineOutputMember(object, api_type, qualifier, "float", "clipDist", 1, "SV_ClipDistance", 1);
+
+  if (per_draw_constants)
+  {
+    DefineOutputMember(object, api_type, interface_block ? "flat" : "", "uint", "draw", -1,
+                       "TEXCOORD", texgens + 3);
+  }
 }
 
 template <class T>
 inline void AssignVSOutputMembers(T& object, const char* a, const char* b, u32 texgens,
-                                  bool per_pixel_lighting)
+                                  bool per_pixel_lighting, bool per_draw_constants = false)
 {
   object.Write("\t%s.pos = %s.pos;\n", a, b);
   object.Write("\t%s.colors_0 = %s.colors_0;\n", a, b);
@@ -256,8 +266,21 @@ inline void AssignVSOutputMembers(T& object, const char* a, const char* b, u32 t
 
   object.Write("\t%s.clipDist0 = %s.clipDist0;\n", a, b);
   object.Write("\t%s.clipDist1 = %s.clipDist1;\n", a, b);
+
+  if (per_draw_constants)
+    object.Write("\t%s.draw = %s.draw;\n", a, b);
 }
 
+// Declares a storage buffer at the given binding which holds the constants of each draw of the
+// batch, using the members of the uniform block it replaces. The members are accessed through
+// macros which read them from the element of the current draw, so shaders must declare
+// draw_index and set it in main() before reading any constants.
+void WritePerDrawConstantBlock(ShaderCode& out, const char* name, u32 binding,
+                               const char* members);
+
+// Finds the draw which the current vertex belongs to from the vertex ranges of the draws.
+void WriteVertexDrawIndex(ShaderCode& out);
+
 // We use the flag "centroid" to fix some MSAA rendering bugs. With MSAA, the
 // pixel shader will be executed for each pixel which has at least one passed sample.
 // So there may be rendered pixels where the center of the pixel isn't in the primitive.
@@ -291,8 +314,8 @@ inline const char* GetInterpolationQualifier(bool msaa, bool ssaa,
 }
 
 // Constant variable names
-#define I_COLORS "color"
-#define I_KCOLORS "k"
+#define I_COLORS "ccolor"
+#define I_KCOLORS "ckcolor"
 #define I_ALPHA "alphaRef"
 #define I_TEXDIMS "texdim"
 #define I_ZBIAS "czbias"
@@ -333,6 +356,7 @@ static const char s_shader_uniforms[] = "\tuint    components;\n"
                                         "\tfloat4 " I_POSTTRANSFORMMATRICES "[64];\n"
                                         "\tfloat4 " I_PIXELCENTERCORRECTION ";\n"
                                         "\tfloat2 " I_VIEWPORT_SIZE ";\n"
+                                        "\tuint    draw_end;\n"
                                         "\tuint4   xfmem_pack1[8];\n"
                                         "\t#define xfmem_texMtxInfo(i) (xfmem_pack1[(i)].x)\n"
                                         "\t#define xfmem_postMtxInfo(i) (xfmem_pack1[(i)].y)\n"
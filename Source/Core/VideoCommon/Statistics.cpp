@@ -2,14 +2,17 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cinttypes>
 #include <cstring>
 #include <string>
 #include <utility>
 
 #include "Common/StringUtil.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 
 Statistics stats;
 
@@ -47,6 +50,12 @@ std::string Statistics::ToString()
   str += StringFromFormat("Textures created: %i\n", stats.numTexturesCreated);
   str += StringFromFormat("Textures uploaded: %i\n", stats.numTexturesUploaded);
   str += StringFromFormat("Textures alive: %i\n", stats.numTexturesAlive);
+  str += StringFromFormat("Texture cache hits: %i\n", stats.thisFrame.numTextureCacheHits);
+  str += StringFromFormat("Texture cache misses: %i\n", stats.thisFrame.numTextureCacheMisses);
+  str += StringFromFormat("Texture overlap candidates: %i\n",
+                          stats.thisFrame.numTextureOverlapCandidates);
+  str += StringFromFormat("Decoded texture cache hits: %i\n",
+                          stats.thisFrame.numDecodedTextureCacheHits);
   str += StringFromFormat("pshaders created: %i\n", stats.numPixelShadersCreated);
   str += StringFromFormat("pshaders alive: %i\n", stats.numPixelShadersAlive);
   str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
@@ -55,6 +64,10 @@ std::string Statistics::ToString()
   str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
   str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
   str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+  str += StringFromFormat("Flushes: %i\n", stats.thisFrame.numFlushes);
+  str += StringFromFormat("Merged state changes: %i\n", stats.thisFrame.numMergedStateChanges);
+  str += StringFromFormat("Draws merged by per-draw constants: %i\n",
+                          stats.thisFrame.numMergedDraws);
   str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
   str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
   str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
@@ -67,6 +80,18 @@ std::string Statistics::ToString()
   str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed / 1024);
   str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed / 1024);
   str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
+  str += StringFromFormat("Vertex cache hits: %i\n", stats.thisFrame.numVertexCacheHits);
+  str += StringFromFormat("Vertex cache misses: %i\n", stats.thisFrame.numVertexCacheMisses);
+  str += VideoProfiler::ToString();
+
+  u64 jit_dispatches, jit_fast_map_misses;
+  if (JitInterface::GetDispatchStats(&jit_dispatches, &jit_fast_map_misses) && jit_dispatches != 0)
+  {
+    str += StringFromFormat("JIT dispatches: %" PRIu64 "\n", jit_dispatches);
+    str += StringFromFormat("JIT fast block map misses: %" PRIu64 " (%.2f%% hits)\n",
+                            jit_fast_map_misses,
+                            100.0 * (jit_dispatches - jit_fast_map_misses) / jit_dispatches);
+  }
 
   std::string vertex_list = VertexLoaderManager::VertexLoadersToString();
 
@@ -6,6 +6,9 @@
 
 #include <string>
 
+#include "Common/CommonTypes.h"
+#include "VideoCommon/VideoProfiler.h"
+
 struct Statistics
 {
   int numPixelShadersCreated;
@@ -44,6 +47,9 @@ struct Statistics
 
     int numPrimitiveJoins;
     int numDrawCalls;
+    int numFlushes;
+    int numMergedStateChanges;
+    int numMergedDraws;
 
     int numDListsCalled;
 
@@ -61,6 +67,20 @@ struct Statistics
     int numVerticesLoaded;
     int tevPixelsIn;
     int tevPixelsOut;
+
+    int numTextureCacheHits;
+    int numTextureCacheMisses;
+    int numTextureOverlapCandidates;
+    int numDecodedTextureCacheHits;
+
+    int numVertexCacheHits;
+    int numVertexCacheMisses;
+
+    // In nanoseconds, only measured while VideoProfiler::g_timing_enabled is set
+    u64 videoStageTimes[VideoProfiler::NUM_STAGES];
+    int numFlushesByReason[VideoProfiler::NUM_FLUSH_REASONS];
+    int numFlushesByBPRegister[VideoProfiler::NUM_BP_REGISTERS];
+    int numFlushesByXFRegister[VideoProfiler::NUM_XF_REGISTERS];
   };
   ThisFrame thisFrame;
   void ResetFrame();
@@ -35,11 +35,15 @@
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 
 static const u64 TEXHASH_INVALID = 0;
 // Sonic the Fighters (inside Sonic Gems Collection) loops a 64 frames animation
 static const int TEXTURE_KILL_THRESHOLD = 64;
 static const int TEXTURE_POOL_KILL_THRESHOLD = 3;
+// Textures are indexed by the 64 KiB pages of memory they touch. Most textures fit into a single
+// page, and even the largest ones (4 MiB) only touch 65 of them.
+static const u32 TEXTURE_PAGE_SHIFT = 16;
 
 std::unique_ptr<TextureCacheBase> g_texture_cache;
 
@@ -75,11 +79,15 @@ TextureCacheBase::TextureCacheBase()
 
   TexDecoder_SetTexFmtOverlayOptions(backup_config.texfmt_overlay,
                                      backup_config.texfmt_overlay_center);
+  TexDecoder_SetDecodingThreads(backup_config.texture_decoding_threads);
 
   HiresTexture::Init();
 
   SetHash64Function();
 
+  if (backup_config.cache_decoded_textures)
+    decoded_texture_cache.Open(SConfig::GetInstance().GetGameID());
+
   InvalidateAllBindPoints();
 }
 
@@ -97,6 +105,7 @@ void TextureCacheBase::Invalidate()
   }
   textures_by_address.clear();
   textures_by_hash.clear();
+  textures_by_page.clear();
 
   texture_pool.clear();
 }
@@ -104,6 +113,7 @@ void TextureCacheBase::Invalidate()
 TextureCacheBase::~TextureCacheBase()
 {
   HiresTexture::Shutdown();
+  TexDecoder_SetDecodingThreads(1);
   Invalidate();
   Common::FreeAlignedMemory(temp);
   temp = nullptr;
@@ -130,6 +140,17 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
                                        g_ActiveConfig.bTexFmtOverlayCenter);
   }
 
+  if (config.GetTextureDecodingThreads() != backup_config.texture_decoding_threads)
+    TexDecoder_SetDecodingThreads(config.GetTextureDecodingThreads());
+
+  if (config.bCacheDecodedTextures != backup_config.cache_decoded_textures)
+  {
+    if (config.bCacheDecodedTextures)
+      decoded_texture_cache.Open(SConfig::GetInstance().GetGameID());
+    else
+      decoded_texture_cache.Close();
+  }
+
   if ((config.stereo_mode != StereoMode::Off) != backup_config.stereo_3d ||
       config.bStereoEFBMonoDepth != backup_config.efb_mono_depth)
   {
@@ -222,9 +243,11 @@ void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
   backup_config.texfmt_overlay_center = config.bTexFmtOverlayCenter;
   backup_config.hires_textures = config.bHiresTextures;
   backup_config.cache_hires_textures = config.bCacheHiresTextures;
+  backup_config.cache_decoded_textures = config.bCacheDecodedTextures;
   backup_config.stereo_3d = config.stereo_mode != StereoMode::Off;
   backup_config.efb_mono_depth = config.bStereoEFBMonoDepth;
   backup_config.gpu_texture_decoding = config.bEnableGPUTextureDecoding;
+  backup_config.texture_decoding_threads = config.GetTextureDecodingThreads();
 }
 
 TextureCacheBase::TCacheEntry*
@@ -248,7 +271,7 @@ TextureCacheBase::ApplyPaletteToEntry(TCacheEntry* entry, u8* palette, TLUTForma
   decoded_entry->may_have_overlapping_textures = entry->may_have_overlapping_textures;
 
   ConvertTexture(decoded_entry, entry, palette, tlutfmt);
-  textures_by_address.emplace(entry->addr, decoded_entry);
+  AddTextureToCache(decoded_entry);
 
   return decoded_entry;
 }
@@ -318,10 +341,9 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
 
   u32 numBlocksX = (entry_to_update->native_width + block_width - 1) / block_width;
 
-  auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
-  while (iter.first != iter.second)
+  for (TCacheEntry* entry :
+       FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes))
   {
-    TCacheEntry* entry = iter.first->second;
     if (entry != entry_to_update && entry->IsCopy() && !entry->tmem_only &&
         entry->references.count(entry_to_update) == 0 &&
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
@@ -343,7 +365,6 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
           }
           else
           {
-            ++iter.first;
             continue;
           }
         }
@@ -429,11 +450,9 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
       else
       {
         // If the hash does not match, this EFB copy will not be used for anything, so remove it
-        iter.first = InvalidateTexture(iter.first);
-        continue;
+        InvalidateTexture(GetTexCacheIter(entry));
       }
     }
-    ++iter.first;
   }
   return entry_to_update;
 }
@@ -615,6 +634,8 @@ private:
 
 TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
 {
+  VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::TextureCache);
+
   // if this stage was not invalidated by changes to texture registers, keep the current texture
   if (IsValidBindPoint(stage) && bound_textures[stage])
   {
@@ -780,9 +801,9 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   // done in vain.
   auto iter_range = textures_by_address.equal_range(address);
   TexAddrCache::iterator iter = iter_range.first;
-  TexAddrCache::iterator oldest_entry = iter;
+  TCacheEntry* oldest_entry = nullptr;
   int temp_frameCount = 0x7fffffff;
-  TexAddrCache::iterator unconverted_copy = textures_by_address.end();
+  TCacheEntry* unconverted_copy = nullptr;
 
   while (iter != iter_range.second)
   {
@@ -811,13 +832,16 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
         // texture formats. I'm not sure what effect checking width/height/levels
         // would have.
         if (!isPaletteTexture || !g_Config.backend_info.bSupportsPaletteConversion)
+        {
+          INCSTAT(stats.thisFrame.numTextureCacheHits);
           return entry;
+        }
 
         // Note that we found an unconverted EFB copy, then continue.  We'll
         // perform the conversion later.  Currently, we only convert EFB copies to
         // palette textures; we could do other conversions if it proved to be
         // beneficial.
-        unconverted_copy = iter;
+        unconverted_copy = entry;
       }
       else
       {
@@ -831,6 +855,13 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     }
     else
     {
+      // Replace the native texture once its custom texture might have finished loading
+      if (entry->IsCustomTexturePending())
+      {
+        iter = InvalidateTexture(iter);
+        continue;
+      }
+
       // For normal textures, all texture parameters need to match
       if (!entry->IsEfbCopy() && entry->hash == full_hash && entry->format == full_format &&
           entry->native_levels >= tex_levels && entry->native_width == nativeW &&
@@ -838,6 +869,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       {
         entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
 
+        INCSTAT(stats.thisFrame.numTextureCacheHits);
         return entry;
       }
     }
@@ -851,18 +883,18 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
         !entry->IsEfbCopy() && !(isPaletteTexture && entry->base_hash == base_hash))
     {
       temp_frameCount = entry->frameCount;
-      oldest_entry = iter;
+      oldest_entry = entry;
     }
     ++iter;
   }
 
-  if (unconverted_copy != textures_by_address.end())
+  if (unconverted_copy)
   {
-    TCacheEntry* decoded_entry =
-        ApplyPaletteToEntry(unconverted_copy->second, &texMem[tlutaddr], tlutfmt);
+    TCacheEntry* decoded_entry = ApplyPaletteToEntry(unconverted_copy, &texMem[tlutaddr], tlutfmt);
 
     if (decoded_entry)
     {
+      INCSTAT(stats.thisFrame.numTextureCacheHits);
       return decoded_entry;
     }
   }
@@ -883,10 +915,12 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       TCacheEntry* entry = hash_iter->second;
       // All parameters, except the address, need to match here
       if (entry->format == full_format && entry->native_levels >= tex_levels &&
-          entry->native_width == nativeW && entry->native_height == nativeH)
+          entry->native_width == nativeW && entry->native_height == nativeH &&
+          !entry->IsCustomTexturePending())
       {
         entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
 
+        INCSTAT(stats.thisFrame.numTextureCacheHits);
         return entry;
       }
       ++hash_iter;
@@ -897,14 +931,19 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   if (temp_frameCount != 0x7fffffff)
   {
     // pool this texture and make a new one later
-    InvalidateTexture(oldest_entry);
+    InvalidateTexture(GetTexCacheIter(oldest_entry));
   }
 
+  INCSTAT(stats.thisFrame.numTextureCacheMisses);
+
   std::shared_ptr<HiresTexture> hires_tex;
+  bool hires_tex_pending = false;
+  // Read before searching, so that a texture which finishes loading in between isn't missed
+  const u32 hires_tex_streamed_count = HiresTexture::GetStreamedTextureCount();
   if (g_ActiveConfig.bHiresTextures)
   {
     hires_tex = HiresTexture::Search(src_data, texture_size, &texMem[tlutaddr], palette_size, width,
-                                     height, texformat, use_mipmaps);
+                                     height, texformat, use_mipmaps, &hires_tex_pending);
 
     if (hires_tex)
     {
@@ -957,6 +996,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   // Initialized to null because only software loading uses this buffer
   u8* dst_buffer = nullptr;
 
+  // Set when the decoded texture cache is used, in which case all levels are either copied from it
+  // at once or added to it after decoding
+  std::optional<DecodedTextureCache::Key> decoded_cache_key;
+  bool decoded_from_cache = false;
+
   if (!hires_tex)
   {
     if (decode_on_gpu)
@@ -970,25 +1014,36 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     {
       size_t decoded_texture_size = expandedWidth * sizeof(u32) * expandedHeight;
 
-      // Allocate memory for all levels at once
-      size_t total_texture_size = decoded_texture_size;
+      // Allocate memory for all levels at once. Every level is padded to whole blocks, which
+      // makes the small levels larger than a quarter of the previous one.
+      const size_t decoded_levels_size =
+          DecodedTextureCache::GetDecodedSize(width, height, tex_levels, texformat);
 
       // For the downsample, we need 2 buffers; 1 is 1/4 of the original texture, the other 1/16
       size_t mip_downsample_buffer_size = decoded_texture_size * 5 / 16;
 
-      size_t prev_level_size = decoded_texture_size;
-      for (u32 i = 1; i < tex_levels; ++i)
-      {
-        prev_level_size /= 4;
-        total_texture_size += prev_level_size;
-      }
-
       // Add space for the downsampling at the end
-      total_texture_size += mip_downsample_buffer_size;
+      size_t total_texture_size = decoded_levels_size + mip_downsample_buffer_size;
 
       CheckTempSize(total_texture_size);
       dst_buffer = temp;
-      if (!(texformat == TextureFormat::RGBA8 && from_tmem))
+
+      // The format overlay changes the decoded data, so it can't be cached
+      if (decoded_texture_cache.IsOpen() && !from_tmem && !g_ActiveConfig.bTexFmtOverlayEnable &&
+          DecodedTextureCache::IsWorthCaching(texformat))
+      {
+        decoded_cache_key = DecodedTextureCache::MakeKey(
+            src_data, texture_size + additional_mips_size, tlut, palette_size, width, height,
+            tex_levels, texformat, tlutfmt);
+        decoded_from_cache =
+            decoded_texture_cache.Lookup(*decoded_cache_key, dst_buffer, decoded_levels_size);
+      }
+
+      if (decoded_from_cache)
+      {
+        INCSTAT(stats.thisFrame.numDecodedTextureCacheHits);
+      }
+      else if (!(texformat == TextureFormat::RGBA8 && from_tmem))
       {
         TexDecoder_Decode(dst_buffer, src_data, expandedWidth, expandedHeight, texformat, tlut,
                           tlutfmt);
@@ -1008,19 +1063,21 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     }
   }
 
-  iter = textures_by_address.emplace(address, entry);
-  if (textureCacheSafetyColorSampleSize == 0 ||
-      std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
-  {
-    entry->textures_by_hash_iter = textures_by_hash.emplace(full_hash, entry);
-  }
-
   entry->SetGeneralParameters(address, texture_size, full_format, false);
   entry->SetDimensions(nativeW, nativeH, tex_levels);
   entry->SetHashes(base_hash, full_hash);
   entry->is_custom_tex = hires_tex != nullptr;
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
+  entry->custom_tex_pending = hires_tex_pending;
+  entry->custom_tex_streamed_count = hires_tex_streamed_count;
+
+  AddTextureToCache(entry);
+  if (textureCacheSafetyColorSampleSize == 0 ||
+      std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
+  {
+    AddTextureToHashCache(entry, full_hash);
+  }
 
   std::string basename = "";
   if (g_ActiveConfig.bDumpTextures && !hires_tex)
@@ -1073,8 +1130,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       {
         // No need to call CheckTempSize here, as the whole buffer is preallocated at the beginning
         size_t decoded_mip_size = expanded_mip_width * sizeof(u32) * expanded_mip_height;
-        TexDecoder_Decode(dst_buffer, mip_src_data, expanded_mip_width, expanded_mip_height,
-                          texformat, tlut, tlutfmt);
+        if (!decoded_from_cache)
+        {
+          TexDecoder_Decode(dst_buffer, mip_src_data, expanded_mip_width, expanded_mip_height,
+                            texformat, tlut, tlutfmt);
+        }
         entry->texture->Load(level, mip_width, mip_height, expanded_mip_width, dst_buffer,
                              decoded_mip_size);
 
@@ -1085,6 +1145,9 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
 
       mip_src_data += mip_size;
     }
+
+    if (decoded_cache_key && !decoded_from_cache)
+      decoded_texture_cache.Insert(*decoded_cache_key, temp, dst_buffer - temp);
   }
 
   entry->has_arbitrary_mips = hires_tex ? hires_tex->HasArbitraryMipmaps() :
@@ -1101,7 +1164,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   INCSTAT(stats.numTexturesUploaded);
   SETSTAT(stats.numTexturesAlive, textures_by_address.size());
 
-  entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
+  entry = DoPartialTextureUpdates(entry, &texMem[tlutaddr], tlutfmt);
 
   return entry;
 }
@@ -1280,10 +1343,9 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
 
   u32 numBlocksX = entry_to_update->native_width / tex_info.block_width;
 
-  auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
-  while (iter.first != iter.second)
+  for (TCacheEntry* entry :
+       FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes))
   {
-    TCacheEntry* entry = iter.first->second;
     if (entry != entry_to_update && entry->IsCopy() && !entry->tmem_only &&
         entry->references.count(entry_to_update) == 0 &&
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
@@ -1306,7 +1368,6 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
           }
           else
           {
-            ++iter.first;
             continue;
           }
         }
@@ -1395,11 +1456,9 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
       else
       {
         // If the hash does not match, this EFB copy will not be used for anything, so remove it
-        iter.first = InvalidateTexture(iter.first);
-        continue;
+        InvalidateTexture(GetTexCacheIter(entry));
       }
     }
-    ++iter.first;
   }
 
   return updated_entry;
@@ -1422,14 +1481,6 @@ TextureCacheBase::CreateNormalTexture(const TextureLookupInformation& tex_info)
   if (!entry)
     return nullptr;
 
-  textures_by_address.emplace(tex_info.address, entry);
-  if (tex_info.texture_cache_safety_color_sample_size == 0 ||
-      std::max(tex_info.total_bytes, tex_info.palette_size) <=
-          (u32)tex_info.texture_cache_safety_color_sample_size * 8)
-  {
-    entry->textures_by_hash_iter = textures_by_hash.emplace(tex_info.full_hash, entry);
-  }
-
   entry->SetGeneralParameters(tex_info.address, tex_info.total_bytes, tex_info.full_format, false);
   entry->SetDimensions(tex_info.native_width, tex_info.native_height, tex_info.computed_levels);
   entry->SetHashes(tex_info.base_hash, tex_info.full_hash);
@@ -1437,6 +1488,14 @@ TextureCacheBase::CreateNormalTexture(const TextureLookupInformation& tex_info)
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
+  AddTextureToCache(entry);
+  if (tex_info.texture_cache_safety_color_sample_size == 0 ||
+      std::max(tex_info.total_bytes, tex_info.palette_size) <=
+          (u32)tex_info.texture_cache_safety_color_sample_size * 8)
+  {
+    AddTextureToHashCache(entry, tex_info.full_hash);
+  }
+
   INCSTAT(stats.numTexturesUploaded);
   SETSTAT(stats.numTexturesAlive, textures_by_address.size());
 
@@ -1672,11 +1731,8 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, EFBCopyFormat dstF
   // as our efb copy are marked to check them for partial texture updates.
   // TODO: The logic to detect overlapping strided efb copies is not 100% accurate.
   bool strided_efb_copy = dstStride != bytes_per_row;
-  auto iter = FindOverlappingTextures(dstAddr, covered_range);
-  while (iter.first != iter.second)
+  for (TCacheEntry* entry : FindOverlappingTextures(dstAddr, covered_range))
   {
-    TCacheEntry* entry = iter.first->second;
-
     if (entry->addr == dstAddr && entry->is_xfb_copy)
     {
       for (auto& reference : entry->references)
@@ -1693,7 +1749,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, EFBCopyFormat dstF
           (!strided_efb_copy && entry->size_in_bytes == overlap_range) ||
           (strided_efb_copy && entry->size_in_bytes == overlap_range && entry->addr == dstAddr))
       {
-        iter.first = InvalidateTexture(iter.first);
+        InvalidateTexture(GetTexCacheIter(entry));
         continue;
       }
       entry->may_have_overlapping_textures = true;
@@ -1713,13 +1769,8 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, EFBCopyFormat dstF
 
       // Do not load textures by hash, if they were at least partly overwritten by an efb copy.
       // In this case, comparing the hash is not enough to check, if two textures are identical.
-      if (entry->textures_by_hash_iter != textures_by_hash.end())
-      {
-        textures_by_hash.erase(entry->textures_by_hash_iter);
-        entry->textures_by_hash_iter = textures_by_hash.end();
-      }
+      RemoveTextureFromHashCache(entry);
     }
-    ++iter.first;
   }
 
   if (copy_to_vram)
@@ -1775,7 +1826,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, EFBCopyFormat dstF
                              0);
       }
 
-      textures_by_address.emplace(dstAddr, entry);
+      AddTextureToCache(entry);
     }
   }
 }
@@ -1816,7 +1867,6 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::AllocateCacheEntry(const Textur
     return nullptr;
   }
   TCacheEntry* cacheEntry = new TCacheEntry(std::move(texture));
-  cacheEntry->textures_by_hash_iter = textures_by_hash.end();
   cacheEntry->id = last_entry_id++;
   return cacheEntry;
 }
@@ -1873,21 +1923,59 @@ TextureCacheBase::GetTexCacheIter(TextureCacheBase::TCacheEntry* entry)
   return textures_by_address.end();
 }
 
-std::pair<TextureCacheBase::TexAddrCache::iterator, TextureCacheBase::TexAddrCache::iterator>
+void TextureCacheBase::AddTextureToCache(TCacheEntry* entry)
+{
+  textures_by_address.emplace(entry->addr, entry);
+
+  // Empty textures still get listed in the page of their address, so they can be found by it
+  entry->first_page = entry->addr >> TEXTURE_PAGE_SHIFT;
+  entry->last_page = (entry->addr + std::max(entry->size_in_bytes, 1u) - 1) >> TEXTURE_PAGE_SHIFT;
+  for (u32 page = entry->first_page; page <= entry->last_page; page++)
+    textures_by_page[page].push_back(entry);
+}
+
+void TextureCacheBase::AddTextureToHashCache(TCacheEntry* entry, u64 hash)
+{
+  textures_by_hash.emplace(hash, entry);
+  entry->textures_by_hash_key = hash;
+}
+
+void TextureCacheBase::RemoveTextureFromHashCache(TCacheEntry* entry)
+{
+  if (!entry->textures_by_hash_key)
+    return;
+
+  auto range = textures_by_hash.equal_range(*entry->textures_by_hash_key);
+  auto iter = std::find_if(range.first, range.second,
+                           [entry](const auto& hash_entry) { return hash_entry.second == entry; });
+  if (iter != range.second)
+    textures_by_hash.erase(iter);
+  entry->textures_by_hash_key.reset();
+}
+
+std::vector<TextureCacheBase::TCacheEntry*>
 TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
 {
-  // We index by the starting address only, so there is no way to query all textures
-  // which end after the given addr. But the GC textures have a limited size, so we
-  // look for all textures which have a start address bigger than addr minus the maximal
-  // texture size. But this yields false-positives which must be checked later on.
-
-  // 1024 x 1024 texel times 8 nibbles per texel
-  constexpr u32 max_texture_size = 1024 * 1024 * 4;
-  u32 lower_addr = addr > max_texture_size ? addr - max_texture_size : 0;
-  auto begin = textures_by_address.lower_bound(lower_addr);
-  auto end = textures_by_address.upper_bound(addr + size_in_bytes);
-
-  return std::make_pair(begin, end);
+  std::vector<TCacheEntry*> result;
+
+  const u32 first_page = addr >> TEXTURE_PAGE_SHIFT;
+  const u32 last_page = (addr + std::max(size_in_bytes, 1u) - 1) >> TEXTURE_PAGE_SHIFT;
+  for (u32 page = first_page; page <= last_page; page++)
+  {
+    auto bucket = textures_by_page.find(page);
+    if (bucket == textures_by_page.end())
+      continue;
+
+    for (TCacheEntry* entry : bucket->second)
+    {
+      // Textures which touch several of the pages are only reported for the first one of them
+      if (page == std::max(entry->first_page, first_page))
+        result.push_back(entry);
+    }
+  }
+
+  ADDSTAT(stats.thisFrame.numTextureOverlapCandidates, result.size());
+  return result;
 }
 
 TextureCacheBase::TexAddrCache::iterator
@@ -1898,11 +1986,7 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter)
 
   TCacheEntry* entry = iter->second;
 
-  if (entry->textures_by_hash_iter != textures_by_hash.end())
-  {
-    textures_by_hash.erase(entry->textures_by_hash_iter);
-    entry->textures_by_hash_iter = textures_by_hash.end();
-  }
+  RemoveTextureFromHashCache(entry);
 
   for (size_t i = 0; i < bound_textures.size(); ++i)
   {
@@ -1916,6 +2000,14 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter)
     }
   }
 
+  for (u32 page = entry->first_page; page <= entry->last_page; page++)
+  {
+    auto bucket = textures_by_page.find(page);
+    bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), entry));
+    if (bucket->second.empty())
+      textures_by_page.erase(bucket);
+  }
+
   auto config = entry->texture->GetConfig();
   texture_pool.emplace(config, TexPoolEntry(std::move(entry->texture)));
 
@@ -1968,6 +2060,12 @@ void TextureCacheBase::TCacheEntry::SetEfbCopy(u32 stride)
   size_in_bytes = memory_stride * NumBlocksY();
 }
 
+bool TextureCacheBase::TCacheEntry::IsCustomTexturePending() const
+{
+  return custom_tex_pending &&
+         custom_tex_streamed_count != HiresTexture::GetStreamedTextureCount();
+}
+
 void TextureCacheBase::TCacheEntry::SetNotCopy()
 {
   is_xfb_copy = false;
@@ -6,17 +6,18 @@
 
 #include <array>
 #include <bitset>
-#include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoCommon/AbstractTexture.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/DecodedTextureCache.h"
 #include "VideoCommon/TextureConfig.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
@@ -120,6 +121,10 @@ public:
     u32 memory_stride;
     bool is_efb_copy;
     bool is_custom_tex;
+    // Set while the custom texture is still being streamed in from a texture pack, the native
+    // texture is used until then
+    bool custom_tex_pending = false;
+    u32 custom_tex_streamed_count = 0;
     bool may_have_overlapping_textures = true;
     bool tmem_only = false;           // indicates that this texture only exists in the tmem cache
     bool has_arbitrary_mips = false;  // indicates that the mips in this texture are arbitrary
@@ -138,9 +143,12 @@ public:
     // used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
     int frameCount = FRAMECOUNT_INVALID;
 
-    // Keep an iterator to the entry in textures_by_hash, so it does not need to be searched when
-    // removing the cache entry
-    std::multimap<u64, TCacheEntry*>::iterator textures_by_hash_iter;
+    // The key of the entry in textures_by_hash, if it can be looked up by its hash
+    std::optional<u64> textures_by_hash_key;
+
+    // The pages of textures_by_page this entry was added to, the last one is inclusive
+    u32 first_page = 0;
+    u32 last_page = 0;
 
     // This is used to keep track of both:
     //   * efb copies used by this partially updated texture
@@ -191,6 +199,7 @@ public:
 
     bool IsEfbCopy() const { return is_efb_copy; }
     bool IsCopy() const { return is_xfb_copy || is_efb_copy; }
+    bool IsCustomTexturePending() const;
     u32 NumBlocksY() const;
     u32 BytesPerRow() const;
 
@@ -289,8 +298,9 @@ private:
     int frameCount = FRAMECOUNT_INVALID;
     TexPoolEntry(std::unique_ptr<AbstractTexture> tex) : texture(std::move(tex)) {}
   };
-  using TexAddrCache = std::multimap<u32, TCacheEntry*>;
-  using TexHashCache = std::multimap<u64, TCacheEntry*>;
+  using TexAddrCache = std::unordered_multimap<u32, TCacheEntry*>;
+  using TexHashCache = std::unordered_multimap<u64, TCacheEntry*>;
+  using TexPageCache = std::unordered_map<u32, std::vector<TCacheEntry*>>;
   using TexPool = std::unordered_multimap<TextureConfig, TexPoolEntry>;
 
   void SetBackupConfig(const VideoConfig& config);
@@ -308,10 +318,15 @@ private:
   TexPool::iterator FindMatchingTextureFromPool(const TextureConfig& config);
   TexAddrCache::iterator GetTexCacheIter(TCacheEntry* entry);
 
-  // Return all possible overlapping textures. As addr+size of the textures is not
-  // indexed, this may return false positives.
-  std::pair<TexAddrCache::iterator, TexAddrCache::iterator>
-  FindOverlappingTextures(u32 addr, u32 size_in_bytes);
+  // Adds an entry to textures_by_address and textures_by_page. The address and size of the entry
+  // must not change afterwards.
+  void AddTextureToCache(TCacheEntry* entry);
+  void AddTextureToHashCache(TCacheEntry* entry, u64 hash);
+  void RemoveTextureFromHashCache(TCacheEntry* entry);
+
+  // Return all possible overlapping textures. As textures are only indexed by the pages they
+  // touch, this may return false positives.
+  std::vector<TCacheEntry*> FindOverlappingTextures(u32 addr, u32 size_in_bytes);
 
   virtual void CopyEFBToCacheEntry(TCacheEntry* entry, bool is_depth_copy,
                                    const EFBRectangle& src_rect, bool scale_by_half,
@@ -324,8 +339,11 @@ private:
 
   TexAddrCache textures_by_address;
   TexHashCache textures_by_hash;
+  // Every entry is listed in the buckets of all pages its memory range touches
+  TexPageCache textures_by_page;
   TexPool texture_pool;
   u64 last_entry_id = 0;
+  DecodedTextureCache decoded_texture_cache;
 
   // Backup configuration values
   struct BackupConfig
@@ -335,10 +353,12 @@ private:
     bool texfmt_overlay_center;
     bool hires_textures;
     bool cache_hires_textures;
+    bool cache_decoded_textures;
     bool copy_cache_enable;
     bool stereo_3d;
     bool efb_mono_depth;
     bool gpu_texture_decoding;
+    u32 texture_decoding_threads;
   };
   BackupConfig backup_config = {};
 };
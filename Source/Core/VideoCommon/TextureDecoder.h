@@ -118,6 +118,8 @@ void TexDecoder_DecodeTexelRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* sr
                                          int imageWidth);
 
 void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
+// Images with at least 256x256 texels get decoded on this many threads, including the caller.
+void TexDecoder_SetDecodingThreads(u32 num_threads);
 
 /* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
@@ -5,11 +5,13 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <memory>
 
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
+#include "Common/ThreadPool.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -19,6 +21,10 @@
 static bool TexFmt_Overlay_Enable = false;
 static bool TexFmt_Overlay_Center = false;
 
+// Large images are split into horizontal strips of blocks which get decoded on these threads
+static std::unique_ptr<Common::ThreadPool> s_decoding_pool;
+static constexpr int PARALLEL_DECODE_MIN_TEXELS = 256 * 256;
+
 // TRAM
 // STATE_TO_SAVE
 alignas(16) u8 texMem[TMEM_SIZE];
@@ -257,6 +263,19 @@ void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center)
   TexFmt_Overlay_Center = center;
 }
 
+void TexDecoder_SetDecodingThreads(u32 num_threads)
+{
+  if (num_threads <= 1)
+  {
+    s_decoding_pool.reset();
+    return;
+  }
+
+  // The calling thread decodes a strip itself
+  if (!s_decoding_pool || s_decoding_pool->GetThreadCount() != num_threads - 1)
+    s_decoding_pool = std::make_unique<Common::ThreadPool>(num_threads - 1, "Texture decoder");
+}
+
 static const char* texfmt[] = {
     // pixel
     "I4", "I8", "IA4", "IA8", "RGB565", "RGB5A3", "RGBA8", "0x07", "C4", "C8", "C14X2", "0x0B",
@@ -315,10 +334,36 @@ static void TexDecoder_DrawOverlay(u8* dst, int width, int height, TextureFormat
   }
 }
 
+// Blocks are stored row by row, so every row of blocks can be decoded on its own.
+static void TexDecoder_DecodeParallel(u32* dst, const u8* src, int width, int height,
+                                      TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt)
+{
+  const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+  const int block_rows = height / block_height;
+  const int src_row_size = TexDecoder_GetTextureSizeInBytes(width, block_height, texformat);
+  const int num_strips =
+      std::min<int>(block_rows, static_cast<int>(s_decoding_pool->GetThreadCount()) + 1);
+
+  s_decoding_pool->ParallelFor(num_strips, [=](size_t strip) {
+    const int first_row = static_cast<int>(block_rows * strip / num_strips);
+    const int end_row = static_cast<int>(block_rows * (strip + 1) / num_strips);
+    _TexDecoder_DecodeImpl(dst + first_row * block_height * width, src + first_row * src_row_size,
+                           width, (end_row - first_row) * block_height, texformat, tlut, tlutfmt);
+  });
+}
+
 void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFormat texformat,
                        const u8* tlut, TLUTFormat tlutfmt)
 {
-  _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+  if (s_decoding_pool && width * height >= PARALLEL_DECODE_MIN_TEXELS &&
+      height % TexDecoder_GetBlockHeightInTexels(texformat) == 0)
+  {
+    TexDecoder_DecodeParallel((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+  }
+  else
+  {
+    _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
+  }
 
   if (TexFmt_Overlay_Enable)
     TexDecoder_DrawOverlay(dst, width, height, texformat);
@@ -213,6 +213,97 @@ static void DecodeDXTBlock(u32* dst, const DXTBlock* src, int pitch)
 // free to make the assumption that addresses are multiples of 16 in the aligned case.
 // TODO: complete SSE2 optimization of less often used texture formats.
 // TODO: refactor algorithms using _mm_loadl_epi64 unaligned loads to prefer 128-bit aligned loads.
+// The 4x4 blocks of the 16 and 32 bits per texel formats are decoded as a whole with AVX2: the
+// low 128 bits of `rows02` hold row 0 and the high 128 bits row 2, likewise for rows 1 and 3.
+FUNCTION_TARGET_AVX2
+static inline void StoreBlock4x4_AVX2(u32* dst, int width, __m256i rows02, __m256i rows13)
+{
+  _mm_storeu_si128((__m128i*)(dst + 0 * width), _mm256_castsi256_si128(rows02));
+  _mm_storeu_si128((__m128i*)(dst + 1 * width), _mm256_castsi256_si128(rows13));
+  _mm_storeu_si128((__m128i*)(dst + 2 * width), _mm256_extracti128_si256(rows02, 1));
+  _mm_storeu_si128((__m128i*)(dst + 3 * width), _mm256_extracti128_si256(rows13, 1));
+}
+
+// Repeats every 4-bit value of a 32 bits per texel vector into both halves of its byte.
+FUNCTION_TARGET_AVX2
+static inline __m256i ExpandHighNibbles_AVX2(__m256i v)
+{
+  const __m256i hi = _mm256_and_si256(v, _mm256_set1_epi8(static_cast<char>(0xf0)));
+  return _mm256_or_si256(hi, _mm256_srli_epi16(hi, 4));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i ExpandLowNibbles_AVX2(__m256i v)
+{
+  const __m256i lo = _mm256_and_si256(v, _mm256_set1_epi8(0x0f));
+  return _mm256_or_si256(lo, _mm256_slli_epi16(lo, 4));
+}
+
+// Repeats each of 8 bytes into a 32-bit texel: (hgfe dcba) -> (hhhh gggg ... bbbb aaaa)
+FUNCTION_TARGET_AVX2
+static inline __m256i SpreadBytes_AVX2(const u8* src)
+{
+  const __m256i mask = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,  //
+                                        4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+  return _mm256_shuffle_epi8(_mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)src)), mask);
+}
+
+// Decodes a TLUT into RGBA8 colors, so that palette formats only need a lookup per texel.
+static void DecodeTLUT(u32* palette, const u8* tlut_, TLUTFormat tlutfmt, int num_entries)
+{
+  const u16* tlut = (const u16*)tlut_;
+  for (int i = 0; i < num_entries; i++)
+  {
+    switch (tlutfmt)
+    {
+    case TLUTFormat::IA8:
+      palette[i] = DecodePixel_IA8(tlut[i]);
+      break;
+    case TLUTFormat::RGB565:
+      palette[i] = DecodePixel_RGB565(Common::swap16(tlut[i]));
+      break;
+    case TLUTFormat::RGB5A3:
+      palette[i] = DecodePixel_RGB5A3(Common::swap16(tlut[i]));
+      break;
+    default:
+      palette[i] = 0;
+      break;
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C4_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[16];
+  DecodeTLUT(palette, tlut, tlutfmt, 16);
+  const __m256i palette_lo = _mm256_load_si256((const __m256i*)palette);
+  const __m256i palette_hi = _mm256_load_si256((const __m256i*)palette + 1);
+
+  // Texel 2n comes from the high nibble of byte n, texel 2n+1 from the low nibble
+  const __m256i shifts = _mm256_setr_epi32(4, 0, 12, 8, 20, 16, 28, 24);
+  const __m256i kMask_x0f = _mm256_set1_epi32(0x0f);
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+      {
+        const __m256i bytes = _mm256_set1_epi32(*(const s32*)(src + 4 * xStep));
+        const __m256i index = _mm256_and_si256(_mm256_srlv_epi32(bytes, shifts), kMask_x0f);
+        // Bit 3 of the index picks the upper half of the palette
+        const __m256i upper = _mm256_srai_epi32(_mm256_slli_epi32(index, 28), 31);
+        const __m256i colors =
+            _mm256_blendv_epi8(_mm256_permutevar8x32_epi32(palette_lo, index),
+                               _mm256_permutevar8x32_epi32(palette_hi, index), upper);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), colors);
+      }
+    }
+  }
+}
+
 static void TexDecoder_DecodeImpl_C4(u32* dst, const u8* src, int width, int height,
                                      TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt,
                                      int Wsteps4, int Wsteps8)
@@ -251,6 +342,30 @@ static void TexDecoder_DecodeImpl_C4(u32* dst, const u8* src, int width, int hei
   }
 }
 
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_I4_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Every byte goes to two texels, the high nibble first
+  const __m256i mask = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,  //
+                                        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+      {
+        const __m256i bytes =
+            _mm256_shuffle_epi8(_mm256_set1_epi32(*(const s32*)(src + 4 * xStep)), mask);
+        const __m256i texels = _mm256_blend_epi32(ExpandHighNibbles_AVX2(bytes),
+                                                  ExpandLowNibbles_AVX2(bytes), 0xaa);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), texels);
+      }
+    }
+  }
+}
+
 FUNCTION_TARGET_SSSE3
 static void TexDecoder_DecodeImpl_I4_SSSE3(u32* dst, const u8* src, int width, int height,
                                            TextureFormat texformat, const u8* tlut,
@@ -391,6 +506,24 @@ static void TexDecoder_DecodeImpl_I4(u32* dst, const u8* src, int width, int hei
   }
 }
 
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_I8_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 4 * yStep; iy < 4; ++iy, xStep++)
+      {
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            SpreadBytes_AVX2(src + 8 * xStep));
+      }
+    }
+  }
+}
+
 FUNCTION_TARGET_SSSE3
 static void TexDecoder_DecodeImpl_I8_SSSE3(u32* dst, const u8* src, int width, int height,
                                            TextureFormat texformat, const u8* tlut,
@@ -522,6 +655,29 @@ static void TexDecoder_DecodeImpl_I8(u32* dst, const u8* src, int width, int hei
   }
 }
 
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C8_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[256];
+  DecodeTLUT(palette, tlut, tlutfmt, 256);
+
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+      {
+        const __m256i index =
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            _mm256_i32gather_epi32((const int*)palette, index, 4));
+      }
+    }
+  }
+}
+
 static void TexDecoder_DecodeImpl_C8(u32* dst, const u8* src, int width, int height,
                                      TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt,
                                      int Wsteps4, int Wsteps8)
@@ -560,6 +716,28 @@ static void TexDecoder_DecodeImpl_C8(u32* dst, const u8* src, int width, int hei
   }
 }
 
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_IA4_AVX2(u32* dst, const u8* src, int width, int height,
+                                           TextureFormat texformat, const u8* tlut,
+                                           TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Alpha comes from the high nibble, intensity from the low one
+  const __m256i kMask_xff000000 = _mm256_set1_epi32(0xff000000);
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+      {
+        const __m256i bytes = SpreadBytes_AVX2(src + 8 * xStep);
+        const __m256i texels = _mm256_blendv_epi8(
+            ExpandLowNibbles_AVX2(bytes), ExpandHighNibbles_AVX2(bytes), kMask_xff000000);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), texels);
+      }
+    }
+  }
+}
+
 static void TexDecoder_DecodeImpl_IA4(u32* dst, const u8* src, int width, int height,
                                       TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt,
                                       int Wsteps4, int Wsteps8)
@@ -576,6 +754,27 @@ static void TexDecoder_DecodeImpl_IA4(u32* dst, const u8* src, int width, int he
   }
 }
 
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_IA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                           TextureFormat texformat, const u8* tlut,
+                                           TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Same shuffle as the SSSE3 version, once for rows 0 and 2 and once for rows 1 and 3
+  const __m256i mask02 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(6, 7, 7, 7, 4, 5, 5, 5, 2, 3, 3, 3, 0, 1, 1, 1));
+  const __m256i mask13 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(14, 15, 15, 15, 12, 13, 13, 13, 10, 11, 11, 11, 8, 9, 9, 9));
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      const __m256i block = _mm256_loadu_si256((const __m256i*)(src + 32 * yStep));
+      StoreBlock4x4_AVX2(dst + y * width + x, width, _mm256_shuffle_epi8(block, mask02),
+                         _mm256_shuffle_epi8(block, mask13));
+    }
+  }
+}
+
 FUNCTION_TARGET_SSSE3
 static void TexDecoder_DecodeImpl_IA8_SSSE3(u32* dst, const u8* src, int width, int height,
                                             TextureFormat texformat, const u8* tlut,
@@ -700,6 +899,38 @@ static void TexDecoder_DecodeImpl_C14X2(u32* dst, const u8* src, int width, int
   }
 }
 
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB565_AVX2(__m256i c0)
+{
+  // Same as the SSE2 version, see there for how the bits move around
+  const __m256i r0 = _mm256_and_si256(c0, _mm256_set1_epi32(0x000000F8));
+  const __m256i r1 = _mm256_srli_epi32(r0, 5);
+  const __m256i gtmp = _mm256_srli_epi32(c0, 3);
+  const __m256i g0 = _mm256_and_si256(gtmp, _mm256_set1_epi32(0x0000FC00));
+  const __m256i g1 = _mm256_and_si256(_mm256_srli_epi32(gtmp, 6), _mm256_set1_epi32(0x00000300));
+  const __m256i b0 = _mm256_and_si256(_mm256_srli_epi32(c0, 5), _mm256_set1_epi32(0x00F80000));
+  const __m256i b1 = _mm256_srli_epi16(b0, 5);
+  return _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(r0, r1), _mm256_or_si256(g0, g1)),
+                         _mm256_or_si256(_mm256_or_si256(b0, b1), _mm256_set1_epi32(0xFF000000)));
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB565_AVX2(u32* dst, const u8* src, int width, int height,
+                                              TextureFormat texformat, const u8* tlut,
+                                              TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      const __m256i block = _mm256_loadu_si256((const __m256i*)(src + 32 * yStep));
+      StoreBlock4x4_AVX2(dst + y * width + x, width,
+                         DecodeRGB565_AVX2(_mm256_unpacklo_epi16(block, block)),
+                         DecodeRGB565_AVX2(_mm256_unpackhi_epi16(block, block)));
+    }
+  }
+}
+
 static void TexDecoder_DecodeImpl_RGB565(u32* dst, const u8* src, int width, int height,
                                          TextureFormat texformat, const u8* tlut,
                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
@@ -771,6 +1002,66 @@ static void TexDecoder_DecodeImpl_RGB565(u32* dst, const u8* src, int width, int
   }
 }
 
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB5A3_AVX2(__m256i valV)
+{
+  const __m256i kMask_x1f = _mm256_set1_epi32(0x0000001fL);
+  const __m256i kMask_x0f = _mm256_set1_epi32(0x0000000fL);
+  const __m256i kMask_x07 = _mm256_set1_epi32(0x00000007L);
+
+  // Both cases are computed for all texels, the top bit of each texel picks one of them.
+  // RGB555 with alpha = 0xFF. Swizzle bits: 00012345 -> 12345123
+  const __m256i tmpr5 = _mm256_and_si256(_mm256_srli_epi16(valV, 10), kMask_x1f);
+  const __m256i r5 = _mm256_or_si256(_mm256_slli_epi16(tmpr5, 3), _mm256_srli_epi16(tmpr5, 2));
+  const __m256i tmpg5 = _mm256_and_si256(_mm256_srli_epi16(valV, 5), kMask_x1f);
+  const __m256i g5 = _mm256_or_si256(_mm256_slli_epi16(tmpg5, 3), _mm256_srli_epi16(tmpg5, 2));
+  const __m256i tmpb5 = _mm256_and_si256(valV, kMask_x1f);
+  const __m256i b5 = _mm256_or_si256(_mm256_slli_epi16(tmpb5, 3), _mm256_srli_epi16(tmpb5, 2));
+  const __m256i rgb555 =
+      _mm256_or_si256(_mm256_or_si256(r5, _mm256_slli_epi32(g5, 8)),
+                      _mm256_or_si256(_mm256_slli_epi32(b5, 16), _mm256_set1_epi32(0xFF000000L)));
+
+  // RGBA4443. Swizzle bits: 00001234 -> 12341234
+  const __m256i tmpr4 = _mm256_and_si256(_mm256_srli_epi16(valV, 8), kMask_x0f);
+  const __m256i r4 = _mm256_or_si256(_mm256_slli_epi16(tmpr4, 4), tmpr4);
+  const __m256i tmpg4 = _mm256_and_si256(_mm256_srli_epi16(valV, 4), kMask_x0f);
+  const __m256i g4 = _mm256_or_si256(_mm256_slli_epi16(tmpg4, 4), tmpg4);
+  const __m256i tmpb4 = _mm256_and_si256(valV, kMask_x0f);
+  const __m256i b4 = _mm256_or_si256(_mm256_slli_epi16(tmpb4, 4), tmpb4);
+  const __m256i tmpa3 = _mm256_and_si256(_mm256_srli_epi16(valV, 12), kMask_x07);
+  const __m256i a3 =
+      _mm256_or_si256(_mm256_slli_epi16(tmpa3, 5),
+                      _mm256_or_si256(_mm256_slli_epi16(tmpa3, 2), _mm256_srli_epi16(tmpa3, 1)));
+  const __m256i rgba4443 =
+      _mm256_or_si256(_mm256_or_si256(r4, _mm256_slli_epi32(g4, 8)),
+                      _mm256_or_si256(_mm256_slli_epi32(b4, 16), _mm256_slli_epi32(a3, 24)));
+
+  const __m256i is_rgb555 = _mm256_srai_epi32(_mm256_slli_epi32(valV, 16), 31);
+  return _mm256_blendv_epi8(rgba4443, rgb555, is_rgb555);
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB5A3_AVX2(u32* dst, const u8* src, int width, int height,
+                                              TextureFormat texformat, const u8* tlut,
+                                              TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Byteswaps every texel into the low half of a 32-bit word
+  const __m256i mask02 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(-128, -128, 6, 7, -128, -128, 4, 5, -128, -128, 2, 3, -128, -128, 0, 1));
+  const __m256i mask13 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(-128, -128, 14, 15, -128, -128, 12, 13, -128, -128, 10, 11, -128, -128, 8, 9));
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      const __m256i block = _mm256_loadu_si256((const __m256i*)(src + 32 * yStep));
+      StoreBlock4x4_AVX2(dst + y * width + x, width,
+                         DecodeRGB5A3_AVX2(_mm256_shuffle_epi8(block, mask02)),
+                         DecodeRGB5A3_AVX2(_mm256_shuffle_epi8(block, mask13)));
+    }
+  }
+}
+
 FUNCTION_TARGET_SSSE3
 static void TexDecoder_DecodeImpl_RGB5A3_SSSE3(u32* dst, const u8* src, int width, int height,
                                                TextureFormat texformat, const u8* tlut,
@@ -998,6 +1289,27 @@ static void TexDecoder_DecodeImpl_RGB5A3(u32* dst, const u8* src, int width, int
   }
 }
 
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGBA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                             TextureFormat texformat, const u8* tlut,
+                                             TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  const __m256i mask0312 = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(12, 15, 13, 14, 8, 11, 9, 10, 4, 7, 5, 6, 0, 3, 1, 2));
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      const u8* src2 = src + 64 * yStep;
+      const __m256i ar = _mm256_loadu_si256((const __m256i*)src2);
+      const __m256i gb = _mm256_loadu_si256((const __m256i*)src2 + 1);
+      StoreBlock4x4_AVX2(dst + y * width + x, width,
+                         _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), mask0312),
+                         _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), mask0312));
+    }
+  }
+}
+
 FUNCTION_TARGET_SSSE3
 static void TexDecoder_DecodeImpl_RGBA8_SSSE3(u32* dst, const u8* src, int width, int height,
                                               TextureFormat texformat, const u8* tlut,
@@ -1154,6 +1466,109 @@ static void TexDecoder_DecodeImpl_RGBA8(u32* dst, const u8* src, int width, int
   }
 }
 
+// Decodes the four DXT blocks of an 8x8 CMPR tile at once. Bit-exact with DecodeDXTBlock.
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_CMPR_AVX2(u32* dst, const u8* src, int width, int height,
+                                            TextureFormat texformat, const u8* tlut,
+                                            TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // Byteswaps the two colors of both blocks in each 128-bit half into its low 64 bits
+  const __m256i color_mask = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(-128, -128, -128, -128, -128, -128, -128, -128, 10, 11, 8, 9, 2, 3, 0, 1));
+  // The colors of each block as (color0, color1, color2, color3)
+  const __m256i even_odd = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256i base_colors01 = _mm256_setr_epi32(0, 1, 0, 0, 2, 3, 0, 0);
+  const __m256i base_colors23 = _mm256_setr_epi32(4, 5, 0, 0, 6, 7, 0, 0);
+  const __m256i blended_colors01 = _mm256_setr_epi32(0, 0, 0, 2, 0, 0, 1, 3);
+  const __m256i blended_colors23 = _mm256_setr_epi32(0, 0, 4, 6, 0, 0, 5, 7);
+  // Each line byte holds four 2-bit indices, the leftmost texel in the top bits. The right
+  // block's colors are the upper four entries of the lookup table.
+  const __m256i index_shifts = _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0);
+  const __m256i index_offsets = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+  const __m256i kMask_x03 = _mm256_set1_epi32(3);
+  const __m256i kMask_rgb = _mm256_set1_epi64x(0x0000FFFFFFFFFFFFLL);
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      const u8* tile = src + sizeof(DXTBlock) * 4 * yStep;
+      const __m256i blocks = _mm256_loadu_si256((const __m256i*)tile);
+
+      // The endpoint colors of the four blocks as 16-bit values, then as 32-bit values:
+      // (b0c0, b0c1, b1c0, b1c1, b2c0, b2c1, b3c0, b3c1)
+      const __m256i c565 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(
+          _mm256_permute4x64_epi64(_mm256_shuffle_epi8(blocks, color_mask), 0x08)));
+
+      // RGB565 -> RGBA8
+      const __m256i r = _mm256_or_si256(
+          _mm256_and_si256(_mm256_srli_epi32(c565, 8), _mm256_set1_epi32(0xF8)),
+          _mm256_srli_epi32(c565, 13));
+      const __m256i g = _mm256_or_si256(
+          _mm256_and_si256(_mm256_srli_epi32(c565, 3), _mm256_set1_epi32(0xFC)),
+          _mm256_and_si256(_mm256_srli_epi32(c565, 9), _mm256_set1_epi32(0x03)));
+      const __m256i b = _mm256_or_si256(
+          _mm256_and_si256(_mm256_slli_epi32(c565, 3), _mm256_set1_epi32(0xF8)),
+          _mm256_and_si256(_mm256_srli_epi32(c565, 2), _mm256_set1_epi32(0x07)));
+      const __m256i base_colors = _mm256_or_si256(
+          _mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+          _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32(0xFF000000)));
+
+      // Per block: color0 in the low half, color1 in the high half
+      const __m256i split565 = _mm256_permutevar8x32_epi32(c565, even_odd);
+      const __m256i split = _mm256_permutevar8x32_epi32(base_colors, even_odd);
+      const __m256i rgba0 = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(split));
+      const __m256i rgba1 = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(split, 1));
+
+      // Blocks with color0 > color1 interpolate, the others average with a transparent color3.
+      // The interpolated colors are (5 * color0 + 3 * color1) / 8 and the reverse, like DXTBlend.
+      const __m256i sum = _mm256_add_epi16(rgba0, rgba1);
+      const __m256i blend2 = _mm256_srli_epi16(
+          _mm256_add_epi16(sum, _mm256_add_epi16(_mm256_slli_epi16(rgba0, 2),
+                                                 _mm256_slli_epi16(rgba1, 1))),
+          3);
+      const __m256i blend3 = _mm256_srli_epi16(
+          _mm256_add_epi16(sum, _mm256_add_epi16(_mm256_slli_epi16(rgba0, 1),
+                                                 _mm256_slli_epi16(rgba1, 2))),
+          3);
+      const __m256i average = _mm256_srli_epi16(sum, 1);
+      const __m256i interpolate = _mm256_cvtepi32_epi64(_mm_cmpgt_epi32(
+          _mm256_castsi256_si128(split565), _mm256_extracti128_si256(split565, 1)));
+      const __m256i rgba2 = _mm256_blendv_epi8(average, blend2, interpolate);
+      const __m256i rgba3 =
+          _mm256_blendv_epi8(_mm256_and_si256(average, kMask_rgb), blend3, interpolate);
+      // (b0c2, b1c2, b0c3, b1c3, b2c2, b3c2, b2c3, b3c3)
+      const __m256i blended_colors = _mm256_packus_epi16(rgba2, rgba3);
+
+      // Lookup tables for the left and right blocks of the upper and lower halves
+      const __m256i colors01 =
+          _mm256_blend_epi32(_mm256_permutevar8x32_epi32(base_colors, base_colors01),
+                             _mm256_permutevar8x32_epi32(blended_colors, blended_colors01), 0xcc);
+      const __m256i colors23 =
+          _mm256_blend_epi32(_mm256_permutevar8x32_epi32(base_colors, base_colors23),
+                             _mm256_permutevar8x32_epi32(blended_colors, blended_colors23), 0xcc);
+
+      for (int half = 0; half < 2; half++)
+      {
+        const DXTBlock* left = reinterpret_cast<const DXTBlock*>(tile) + half * 2;
+        const DXTBlock* right = left + 1;
+        const __m256i colors = half == 0 ? colors01 : colors23;
+        for (int iy = 0; iy < 4; iy++)
+        {
+          const __m256i lines =
+              _mm256_setr_epi32(left->lines[iy], left->lines[iy], left->lines[iy], left->lines[iy],
+                                right->lines[iy], right->lines[iy], right->lines[iy],
+                                right->lines[iy]);
+          const __m256i index = _mm256_add_epi32(
+              _mm256_and_si256(_mm256_srlv_epi32(lines, index_shifts), kMask_x03), index_offsets);
+          _mm256_storeu_si256((__m256i*)(dst + (y + half * 4 + iy) * width + x),
+                              _mm256_permutevar8x32_epi32(colors, index));
+        }
+      }
+    }
+  }
+}
+
 static void TexDecoder_DecodeImpl_CMPR(u32* dst, const u8* src, int width, int height,
                                        TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt,
                                        int Wsteps4, int Wsteps8)
@@ -1419,11 +1834,18 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
   switch (texformat)
   {
   case TextureFormat::C4:
-    TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_C4_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else
+      TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
     break;
 
   case TextureFormat::I4:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_I4_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_I4_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                      Wsteps8);
     else
@@ -1431,7 +1853,10 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::I8:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_I8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_I8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                      Wsteps8);
     else
@@ -1439,15 +1864,27 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::C8:
-    TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_C8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else
+      TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
     break;
 
   case TextureFormat::IA4:
-    TexDecoder_DecodeImpl_IA4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_IA4_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                     Wsteps8);
+    else
+      TexDecoder_DecodeImpl_IA4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                Wsteps8);
     break;
 
   case TextureFormat::IA8:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_IA8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                     Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_IA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                       Wsteps8);
     else
@@ -1461,12 +1898,19 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::RGB565:
-    TexDecoder_DecodeImpl_RGB565(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                 Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGB565_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                        Wsteps8);
+    else
+      TexDecoder_DecodeImpl_RGB565(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                   Wsteps8);
     break;
 
   case TextureFormat::RGB5A3:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGB5A3_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                        Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_RGB5A3_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                          Wsteps8);
     else
@@ -1475,7 +1919,10 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::RGBA8:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGBA8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                       Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_RGBA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                         Wsteps8);
     else
@@ -1484,7 +1931,12 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::CMPR:
-    TexDecoder_DecodeImpl_CMPR(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_CMPR_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                      Wsteps8);
+    else
+      TexDecoder_DecodeImpl_CMPR(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                 Wsteps8);
     break;
 
   case TextureFormat::XFB:
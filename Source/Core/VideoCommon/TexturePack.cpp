@@ -0,0 +1,260 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/TexturePack.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/Align.h"
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "VideoCommon/AbstractTexture.h"
+#include "VideoCommon/HiresTextures.h"
+
+static HiresTexture::ImageDataPointer AllocateLevelData(size_t size)
+{
+  return HiresTexture::ImageDataPointer(new u8[size], [](u8* data) { delete[] data; });
+}
+
+// Checks that a level holds at least as many bytes as uploading it will read
+static bool IsLevelSizeValid(AbstractTextureFormat format, const TexturePackLevel& level)
+{
+  if (level.width == 0 || level.height == 0 || level.row_length < level.width)
+    return false;
+
+  const bool is_compressed = AbstractTexture::IsCompressedFormat(format);
+  const u32 rows = is_compressed ? (level.height + 3) / 4 : level.height;
+  const size_t stride = AbstractTexture::CalculateStrideForFormat(format, level.row_length);
+
+  // Same as stride * rows <= data_size, without overflowing
+  return stride <= level.data_size / rows;
+}
+
+TexturePack::TexturePack(File::IOFile file, const std::string& path)
+    : m_path(path), m_file(std::move(file))
+{
+}
+
+std::unique_ptr<TexturePack> TexturePack::Open(const std::string& path)
+{
+  File::IOFile file(path, "rb");
+  if (!file)
+    return nullptr;
+
+  // Can't use make_unique due to private constructor.
+  std::unique_ptr<TexturePack> pack(new TexturePack(std::move(file), path));
+  if (!pack->ReadTables())
+    return nullptr;
+
+  return pack;
+}
+
+bool TexturePack::ReadTables()
+{
+  TexturePackHeader header;
+  if (!m_file.Seek(0, SEEK_SET) || !m_file.ReadArray(&header, 1) ||
+      header.magic != TEXTURE_PACK_MAGIC || header.version != TEXTURE_PACK_VERSION)
+  {
+    ERROR_LOG(VIDEO, "Texture pack %s has an unsupported header", m_path.c_str());
+    return false;
+  }
+
+  m_textures.resize(header.num_textures);
+  m_levels.resize(header.num_levels);
+  m_names.resize(header.names_size);
+  if (!m_file.Seek(header.tables_offset, SEEK_SET) ||
+      !m_file.ReadArray(m_textures.data(), m_textures.size()) ||
+      !m_file.ReadArray(m_levels.data(), m_levels.size()) ||
+      !m_file.ReadArray(m_names.data(), m_names.size()))
+  {
+    ERROR_LOG(VIDEO, "Texture pack %s is truncated", m_path.c_str());
+    return false;
+  }
+
+  for (const TexturePackTexture& texture : m_textures)
+  {
+    if (u64(texture.name_offset) + texture.name_size > m_names.size() ||
+        u64(texture.first_level) + texture.num_levels > m_levels.size() ||
+        texture.num_levels == 0 || texture.format >= AbstractTextureFormat::Undefined)
+    {
+      ERROR_LOG(VIDEO, "Texture pack %s has an invalid texture table", m_path.c_str());
+      return false;
+    }
+
+    for (u32 i = 0; i < texture.num_levels; i++)
+    {
+      if (!IsLevelSizeValid(texture.format, m_levels[texture.first_level + i]))
+      {
+        ERROR_LOG(VIDEO, "Texture pack %s has a level which is too small for its dimensions",
+                  m_path.c_str());
+        return false;
+      }
+    }
+  }
+
+  for (const TexturePackLevel& level : m_levels)
+  {
+    if (level.file_offset + level.stored_size > header.tables_offset ||
+        level.stored_size > level.data_size)
+    {
+      ERROR_LOG(VIDEO, "Texture pack %s has an invalid level table", m_path.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::string TexturePack::GetTextureName(u32 index) const
+{
+  const TexturePackTexture& texture = m_textures[index];
+  return std::string(m_names.data() + texture.name_offset, texture.name_size);
+}
+
+bool TexturePack::HasArbitraryMipmaps(u32 index) const
+{
+  return m_textures[index].has_arbitrary_mipmaps != 0;
+}
+
+bool TexturePack::LoadLevels(u32 index, std::vector<HiresTexture::Level>* levels)
+{
+  const TexturePackTexture& texture = m_textures[index];
+  levels->resize(texture.num_levels);
+  for (u32 i = 0; i < texture.num_levels; i++)
+  {
+    HiresTexture::Level& level = (*levels)[i];
+    level.format = texture.format;
+    if (!LoadLevel(m_levels[texture.first_level + i], &level))
+    {
+      ERROR_LOG(VIDEO, "Texture pack %s is corrupt", m_path.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool TexturePack::LoadLevel(const TexturePackLevel& entry, HiresTexture::Level* level)
+{
+  level->width = entry.width;
+  level->height = entry.height;
+  level->row_length = entry.row_length;
+  level->data_size = entry.data_size;
+  level->data = AllocateLevelData(entry.data_size);
+
+  const bool is_compressed = entry.stored_size != entry.data_size;
+  std::vector<u8> compressed(is_compressed ? entry.stored_size : 0);
+  u8* stored = is_compressed ? compressed.data() : level->data.get();
+  {
+    // Only the reading needs to be serialized, the decompression happens on the calling thread
+    std::lock_guard<std::mutex> lk(m_file_lock);
+    if (!m_file.Seek(entry.file_offset, SEEK_SET) || !m_file.ReadBytes(stored, entry.stored_size))
+      return false;
+  }
+
+  if (HashAdler32(stored, entry.stored_size) != entry.hash)
+    return false;
+
+  if (is_compressed)
+  {
+    uLongf data_size = entry.data_size;
+    if (uncompress(level->data.get(), &data_size, compressed.data(), entry.stored_size) != Z_OK ||
+        data_size != entry.data_size)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool TexturePackWriter::Open(const std::string& path)
+{
+  m_path = path;
+  if (!m_file.Open(path, "wb"))
+    return false;
+
+  // Seek past the header, it is written at the end
+  return m_file.Seek(sizeof(TexturePackHeader), SEEK_SET);
+}
+
+bool TexturePackWriter::AddTexture(const std::string& name, bool has_arbitrary_mipmaps,
+                                   const std::vector<HiresTexture::Level>& levels)
+{
+  TexturePackTexture texture;
+  texture.name_offset = static_cast<u32>(m_names.size());
+  texture.name_size = static_cast<u32>(name.size());
+  texture.first_level = static_cast<u32>(m_levels.size());
+  texture.num_levels = static_cast<u32>(levels.size());
+  texture.format = levels.at(0).format;
+  texture.has_arbitrary_mipmaps = has_arbitrary_mipmaps;
+
+  std::vector<u8> compressed;
+  for (const HiresTexture::Level& level : levels)
+  {
+    const u64 position = Common::AlignUp(m_file.Tell(), TEXTURE_PACK_LEVEL_ALIGNMENT);
+    if (!m_file.Seek(position, SEEK_SET))
+      return false;
+
+    TexturePackLevel entry;
+    entry.file_offset = position;
+    entry.data_size = static_cast<u32>(level.data_size);
+    entry.width = level.width;
+    entry.height = level.height;
+    entry.row_length = level.row_length;
+
+    uLongf compressed_size = compressBound(static_cast<uLong>(level.data_size));
+    compressed.resize(compressed_size);
+    const u8* stored = level.data.get();
+    entry.stored_size = entry.data_size;
+    if (compress2(compressed.data(), &compressed_size, level.data.get(),
+                  static_cast<uLong>(level.data_size), 9) == Z_OK &&
+        compressed_size < level.data_size)
+    {
+      stored = compressed.data();
+      entry.stored_size = static_cast<u32>(compressed_size);
+    }
+    entry.hash = HashAdler32(stored, entry.stored_size);
+
+    if (!m_file.WriteBytes(stored, entry.stored_size))
+      return false;
+
+    m_levels.push_back(entry);
+  }
+
+  m_textures.push_back(texture);
+  m_names += name;
+  return true;
+}
+
+bool TexturePackWriter::Finish()
+{
+  TexturePackHeader header;
+  header.magic = TEXTURE_PACK_MAGIC;
+  header.version = TEXTURE_PACK_VERSION;
+  header.tables_offset = m_file.Tell();
+  header.num_textures = static_cast<u32>(m_textures.size());
+  header.num_levels = static_cast<u32>(m_levels.size());
+  header.names_size = static_cast<u32>(m_names.size());
+  header.reserved = 0;
+
+  if (!m_file.WriteArray(m_textures.data(), m_textures.size()) ||
+      !m_file.WriteArray(m_levels.data(), m_levels.size()) ||
+      !m_file.WriteArray(m_names.data(), m_names.size()) || !m_file.Seek(0, SEEK_SET) ||
+      !m_file.WriteArray(&header, 1))
+  {
+    ERROR_LOG(VIDEO, "Failed to write texture pack %s", m_path.c_str());
+    return false;
+  }
+
+  return m_file.Close();
+}
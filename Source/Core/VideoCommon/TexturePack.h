@@ -0,0 +1,108 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Texture packs bundle the custom textures of a game into a single file. Their levels are stored
+// in the format they are uploaded in, so loading a texture doesn't decode any image files.
+// To create one, use Tools > Create Custom Texture Pack, which calls
+// HiresTexture::CreateTexturePack.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "VideoCommon/HiresTextures.h"
+
+static constexpr u32 TEXTURE_PACK_MAGIC = 0x4B505444;  // "DTPK" (byteswapped to little endian)
+static constexpr u32 TEXTURE_PACK_VERSION = 1;
+
+// Texture pack file structure:
+// TexturePackHeader
+// level data
+// TexturePackTexture textures[num_textures]
+// TexturePackLevel levels[num_levels]
+// char names[names_size]
+//
+// Every level starts at a multiple of TEXTURE_PACK_LEVEL_ALIGNMENT, so levels which are stored
+// uncompressed can be used in place when the file is mapped into memory. The tables come last,
+// so that a pack can be written in a single pass.
+static constexpr u64 TEXTURE_PACK_LEVEL_ALIGNMENT = 16;
+
+struct TexturePackHeader  // 32 bytes
+{
+  u32 magic;
+  u32 version;
+  u64 tables_offset;
+  u32 num_textures;
+  u32 num_levels;
+  u32 names_size;
+  u32 reserved;
+};
+
+struct TexturePackTexture  // 24 bytes
+{
+  u32 name_offset;  // In the names table, without the _mip and _arb suffixes
+  u32 name_size;
+  u32 first_level;
+  u32 num_levels;
+  AbstractTextureFormat format;
+  u32 has_arbitrary_mipmaps;
+};
+
+struct TexturePackLevel  // 32 bytes
+{
+  u64 file_offset;
+  u32 stored_size;
+  u32 data_size;  // Levels which don't get smaller with deflate are stored as they are
+  u32 width;
+  u32 height;
+  u32 row_length;
+  u32 hash;  // Adler-32 of the stored bytes
+};
+
+class TexturePack
+{
+public:
+  static std::unique_ptr<TexturePack> Open(const std::string& path);
+
+  u32 GetTextureCount() const { return static_cast<u32>(m_textures.size()); }
+  std::string GetTextureName(u32 index) const;
+  bool HasArbitraryMipmaps(u32 index) const;
+
+  // Reads and decompresses all levels of a texture. Can be called from several threads at once.
+  bool LoadLevels(u32 index, std::vector<HiresTexture::Level>* levels);
+
+private:
+  TexturePack(File::IOFile file, const std::string& path);
+  bool ReadTables();
+  bool LoadLevel(const TexturePackLevel& entry, HiresTexture::Level* level);
+
+  std::string m_path;
+  std::mutex m_file_lock;
+  File::IOFile m_file;
+  std::vector<TexturePackTexture> m_textures;
+  std::vector<TexturePackLevel> m_levels;
+  std::vector<char> m_names;
+};
+
+class TexturePackWriter
+{
+public:
+  bool Open(const std::string& path);
+  bool AddTexture(const std::string& name, bool has_arbitrary_mipmaps,
+                  const std::vector<HiresTexture::Level>& levels);
+  // Writes the tables and the header. The pack can't be opened before this has succeeded.
+  bool Finish();
+
+private:
+  std::string m_path;
+  File::IOFile m_file;
+  std::vector<TexturePackTexture> m_textures;
+  std::vector<TexturePackLevel> m_levels;
+  std::string m_names;
+};
@@ -30,6 +30,7 @@ ShaderCode GenVertexShader(APIType ApiType, const ShaderHostConfig& host_config,
   const bool ssaa = host_config.ssaa;
   const bool per_pixel_lighting = host_config.per_pixel_lighting;
   const bool vertex_rounding = host_config.vertex_rounding;
+  const bool per_draw_constants = host_config.per_draw_constants;
   const u32 numTexgen = uid_data->num_texgens;
   ShaderCode out;
 
@@ -37,15 +38,23 @@ ShaderCode GenVertexShader(APIType ApiType, const ShaderHostConfig& host_config,
   out.Write("%s", s_lighting_struct);
 
   // uniforms
-  if (ApiType == APIType::OpenGL || ApiType == APIType::Vulkan)
-    out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+  if (per_draw_constants)
+  {
+    out.Write("uint draw_index;\n");
+    WritePerDrawConstantBlock(out, "VS", 2, s_shader_uniforms);
+  }
   else
-    out.Write("cbuffer VSBlock {\n");
-  out.Write(s_shader_uniforms);
-  out.Write("};\n");
+  {
+    if (ApiType == APIType::OpenGL || ApiType == APIType::Vulkan)
+      out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+    else
+      out.Write("cbuffer VSBlock {\n");
+    out.Write(s_shader_uniforms);
+    out.Write("};\n");
+  }
 
   out.Write("struct VS_OUTPUT {\n");
-  GenerateVSOutputMembers(out, ApiType, numTexgen, per_pixel_lighting, "");
+  GenerateVSOutputMembers(out, ApiType, numTexgen, per_pixel_lighting, "", per_draw_constants);
   out.Write("};\n\n");
 
   WriteUberShaderCommonHeader(out, ApiType, host_config);
@@ -68,7 +77,8 @@ ShaderCode GenVertexShader(APIType ApiType, const ShaderHostConfig& host_config,
     {
       out.Write("VARYING_LOCATION(0) out VertexData {\n");
       GenerateVSOutputMembers(out, ApiType, numTexgen, per_pixel_lighting,
-                              GetInterpolationQualifier(msaa, ssaa, true, false));
+                              GetInterpolationQualifier(msaa, ssaa, true, false),
+                              per_draw_constants, true);
       out.Write("} vs;\n");
     }
     else
@@ -88,6 +98,8 @@ ShaderCode GenVertexShader(APIType ApiType, const ShaderHostConfig& host_config,
     }
 
     out.Write("void main()\n{\n");
+    if (per_draw_constants)
+      WriteVertexDrawIndex(out);
   }
   else  // D3D
   {
@@ -107,6 +119,8 @@ ShaderCode GenVertexShader(APIType ApiType, const ShaderHostConfig& host_config,
 
   out.Write("VS_OUTPUT o;\n"
             "\n");
+  if (per_draw_constants)
+    out.Write("o.draw = draw_index;\n");
 
   // Transforms
   out.Write("// Position matrix\n"
@@ -269,7 +283,7 @@ ShaderCode GenVertexShader(APIType ApiType, const ShaderHostConfig& host_config,
   {
     if (host_config.backend_geometry_shaders || ApiType == APIType::Vulkan)
     {
-      AssignVSOutputMembers(out, "vs", "o", numTexgen, per_pixel_lighting);
+      AssignVSOutputMembers(out, "vs", "o", numTexgen, per_pixel_lighting, per_draw_constants);
     }
     else
     {
@@ -18,6 +18,8 @@
 
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoader_Position.h"
+#include "VideoCommon/VertexLoader_TextCoord.h"
 
 #ifdef _M_X86_64
 #include "VideoCommon/VertexLoaderX64.h"
@@ -29,6 +31,7 @@ VertexLoaderBase::VertexLoaderBase(const TVtxDesc& vtx_desc, const VAT& vtx_attr
     : m_VtxDesc{vtx_desc}, m_vat{vtx_attr}
 {
   SetVAT(vtx_attr);
+  FindIndexedAttributes();
 }
 
 void VertexLoaderBase::SetVAT(const VAT& vat)
@@ -72,6 +75,65 @@ void VertexLoaderBase::SetVAT(const VAT& vat)
   m_VtxAttr.texCoord[7].Frac = vat.g2.Tex7Frac;
 };
 
+void VertexLoaderBase::FindIndexedAttributes()
+{
+  // Follows the order in which VertexLoader::CompileVertexTranslator reads the attributes
+  u32 offset = 0;
+  auto add_attribute = [&](u64 type, u32 array, u32 num_indices, u32 element_size,
+                           u32 direct_size) {
+    if (type == INDEX8 || type == INDEX16)
+    {
+      const u32 index_size = type == INDEX16 ? 2 : 1;
+      m_indexed_attributes.push_back({offset, index_size, num_indices, array, element_size});
+      offset += index_size * num_indices;
+    }
+    else if (type == DIRECT)
+    {
+      offset += direct_size;
+    }
+  };
+
+  // The matrix indices are always direct and one byte each
+  const u64 matrix_indices[9] = {m_VtxDesc.PosMatIdx,  m_VtxDesc.Tex0MatIdx, m_VtxDesc.Tex1MatIdx,
+                                 m_VtxDesc.Tex2MatIdx, m_VtxDesc.Tex3MatIdx, m_VtxDesc.Tex4MatIdx,
+                                 m_VtxDesc.Tex5MatIdx, m_VtxDesc.Tex6MatIdx, m_VtxDesc.Tex7MatIdx};
+  for (u64 present : matrix_indices)
+    offset += present ? 1 : 0;
+
+  const u32 pos_size =
+      VertexLoader_Position::GetSize(DIRECT, m_VtxAttr.PosFormat, m_VtxAttr.PosElements);
+  add_attribute(m_VtxDesc.Position, ARRAY_POSITION, 1, pos_size, pos_size);
+
+  // With NormalIndex3, each of the three indices reads one vector from the same array, at an
+  // offset of 0, 1 or 2 vectors. Treat every index as reading all of them.
+  const bool normal_index3 = m_VtxAttr.NormalElements && m_VtxAttr.NormalIndex3;
+  // Not taken from VertexLoader_Normal's table, which is only filled in by the first VertexLoader.
+  static constexpr std::array<u32, 8> component_sizes{{1, 1, 2, 2, 4, 0, 0, 0}};
+  const u32 normal_size =
+      (m_VtxAttr.NormalElements ? 9 : 3) * component_sizes[m_VtxAttr.NormalFormat];
+  add_attribute(m_VtxDesc.Normal, ARRAY_NORMAL, normal_index3 ? 3 : 1, normal_size, normal_size);
+
+  static constexpr std::array<u32, 8> color_sizes{{2, 3, 4, 2, 3, 4, 0, 0}};
+  const u64 colors[2] = {m_VtxDesc.Color0, m_VtxDesc.Color1};
+  for (u32 i = 0; i < 2; i++)
+  {
+    const u32 color_size = color_sizes[m_VtxAttr.color[i].Comp];
+    add_attribute(colors[i], ARRAY_COLOR + i, 1, color_size, color_size);
+  }
+
+  const u64 tex_coords[8] = {m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord,
+                             m_VtxDesc.Tex3Coord, m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord,
+                             m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord};
+  for (u32 i = 0; i < 8; i++)
+  {
+    const u32 tc_size = VertexLoader_TextCoord::GetSize(DIRECT, m_VtxAttr.texCoord[i].Format,
+                                                        m_VtxAttr.texCoord[i].Elements);
+    add_attribute(tex_coords[i], ARRAY_TEXCOORD0 + i, 1, tc_size, tc_size);
+  }
+
+  m_indexed_layout_size = offset;
+}
+
 std::string VertexLoaderBase::ToString() const
 {
   std::string dest;
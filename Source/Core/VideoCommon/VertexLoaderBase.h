@@ -7,6 +7,7 @@
 #include <array>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoCommon/CPMemory.h"
@@ -80,9 +81,24 @@ public:
   NativeVertexFormat* m_native_vertex_format = nullptr;
   int m_numLoadedVertices = 0;
 
+  // An attribute which is read from a vertex array, so that the array data a draw depends on can
+  // be found from the indices in the raw vertices.
+  struct IndexedAttribute
+  {
+    u32 offset;        // of the first index in a raw vertex
+    u32 index_size;    // 1 or 2 bytes, big endian
+    u32 num_indices;   // 3 for normal/binormal/tangent with NormalIndex3
+    u32 array;         // ARRAY_POSITION etc.
+    u32 element_size;  // bytes which are read from the array at index * stride
+  };
+  std::vector<IndexedAttribute> m_indexed_attributes;
+  // The raw vertex size implied by the attributes above, should always match m_VertexSize
+  u32 m_indexed_layout_size = 0;
+
 protected:
   VertexLoaderBase(const TVtxDesc& vtx_desc, const VAT& vtx_attr);
   void SetVAT(const VAT& vat);
+  void FindIndexedAttributes();
 
   // GC vertex format
   TVtxAttr m_VtxAttr;  // VAT decoded into easy format
@@ -3,6 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -13,6 +16,7 @@
 #include "Common/Assert.h"
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/Swap.h"
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/BPMemory.h"
@@ -24,6 +28,7 @@
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoProfiler.h"
 
 namespace VertexLoaderManager
 {
@@ -44,6 +49,79 @@ static VertexLoaderMap s_vertex_loader_map;
 
 u8* cached_arraybases[12];
 
+// Draws with at least this many vertices keep their converted vertices once they have been seen
+// twice, so that repeating them (e.g. static geometry in display lists called every frame) copies
+// the native vertices instead of converting them again. A draw is found by where its raw vertices
+// are, and its raw vertices and the array data they reference are compared with copies of them
+// to find out whether it changed. There's no tracking of writes to emulated memory. Comparing and
+// copying takes about half as long as VertexLoaderX64 needs to convert the vertices.
+static constexpr int MIN_CACHED_VERTEX_COUNT = 64;
+// Draws referencing larger array ranges aren't cached, comparing them would take longer than
+// converting the vertices.
+static constexpr u32 MAX_CACHED_ARRAY_RANGE = 256 * 1024;
+// Both caches are cleared when they grow beyond these.
+static constexpr size_t MAX_OUTPUT_CACHE_SIZE = 32 * 1024 * 1024;
+static constexpr size_t MAX_SEEN_INPUTS = 64 * 1024;
+// Draws whose input changed are kept again after 2, 4, ... up to 2^this sightings.
+static constexpr u32 MAX_SIGHTINGS_SHIFT = 8;
+
+namespace
+{
+struct CachedVerticesKey
+{
+  const VertexLoaderBase* loader;
+  const u8* src;
+  int count;
+
+  bool operator==(const CachedVerticesKey& other) const
+  {
+    return loader == other.loader && src == other.src && count == other.count;
+  }
+};
+
+struct CachedVerticesKeyHash
+{
+  size_t operator()(const CachedVerticesKey& key) const
+  {
+    return std::hash<const void*>()(key.src) ^ std::hash<const void*>()(key.loader) ^
+           std::hash<int>()(key.count);
+  }
+};
+
+// A copy of the part of a vertex array which the indices of a draw point to
+struct CachedArrayRange
+{
+  u32 array;
+  const u8* base;
+  u32 stride;
+  u32 offset;
+  std::vector<u8> contents;
+};
+
+// How often a draw has to be seen before its vertices are kept. Draws whose input keeps changing
+// wait longer each time, so that they don't copy their input every few draws.
+struct SeenInput
+{
+  u32 sightings_left;
+  u32 changes;
+};
+
+struct CachedVertices
+{
+  std::vector<u8> raw_vertices;
+  std::vector<CachedArrayRange> array_ranges;
+  int loaded_count;
+  std::vector<u8> data;
+  float position_cache[3][4];
+  u32 position_matrix_index[4];
+};
+}
+
+static std::unordered_map<CachedVerticesKey, CachedVertices, CachedVerticesKeyHash>
+    s_output_cache;
+static std::unordered_map<CachedVerticesKey, SeenInput, CachedVerticesKeyHash> s_seen_inputs;
+static size_t s_output_cache_size;
+
 void Init()
 {
   MarkAllDirty();
@@ -58,6 +136,9 @@ void Clear()
 {
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
   s_vertex_loader_map.clear();
+  s_output_cache.clear();
+  s_seen_inputs.clear();
+  s_output_cache_size = 0;
   s_native_vertex_map.clear();
 }
 
@@ -248,11 +329,145 @@ static VertexLoaderBase* RefreshLoader(int vtx_attr_group, bool preprocess = fal
   return loader;
 }
 
+// Copies the part of each vertex array which the indices of the raw vertices point to. Returns
+// false if the draw can't be cached.
+static bool GetArrayRanges(const VertexLoaderBase* loader, const u8* src, int count,
+                           std::vector<CachedArrayRange>* ranges)
+{
+  const u32 vertex_size = loader->m_VertexSize;
+  for (const VertexLoaderBase::IndexedAttribute& attribute : loader->m_indexed_attributes)
+  {
+    const u8* array_base = cached_arraybases[attribute.array];
+    if (!array_base)
+      return false;
+
+    // A position index with all bits set skips the vertex without reading the array
+    u32 skip_index = std::numeric_limits<u32>::max();
+    if (attribute.array == ARRAY_POSITION)
+      skip_index = attribute.index_size == 2 ? 0xFFFF : 0xFF;
+    u32 min_index = std::numeric_limits<u32>::max();
+    u32 max_index = 0;
+    const u8* indices = src + attribute.offset;
+    for (int i = 0; i < count; i++, indices += vertex_size)
+    {
+      for (u32 j = 0; j < attribute.num_indices; j++)
+      {
+        const u32 index =
+            attribute.index_size == 2 ? Common::swap16(indices + j * 2) : indices[j];
+        if (index == skip_index)
+          continue;
+        min_index = std::min(min_index, index);
+        max_index = std::max(max_index, index);
+      }
+    }
+    if (min_index > max_index)
+      continue;
+
+    const u32 stride = g_main_cp_state.array_strides[attribute.array];
+    const u32 range_size = (max_index - min_index) * stride + attribute.element_size;
+    if (range_size > MAX_CACHED_ARRAY_RANGE)
+      return false;
+
+    const u32 offset = min_index * stride;
+    ranges->push_back({attribute.array, array_base, stride, offset,
+                       std::vector<u8>(array_base + offset, array_base + offset + range_size)});
+  }
+  return true;
+}
+
+static void InsertCachedVertices(const CachedVerticesKey& key, int loaded_count, const u8* data)
+{
+  // Only keep draws which are repeated, where they are is all that is stored the first time
+  auto seen = s_seen_inputs.emplace(key, SeenInput{1, 0});
+  if (seen.second && s_seen_inputs.size() > MAX_SEEN_INPUTS)
+  {
+    s_seen_inputs.clear();
+    return;
+  }
+  if (seen.first->second.sightings_left > 0)
+  {
+    seen.first->second.sightings_left--;
+    return;
+  }
+
+  const VertexLoaderBase* loader = key.loader;
+  if (loader->m_indexed_layout_size != static_cast<u32>(loader->m_VertexSize))
+    return;
+  std::vector<CachedArrayRange> array_ranges;
+  if (!GetArrayRanges(loader, key.src, key.count, &array_ranges))
+    return;
+
+  const size_t size = loaded_count * loader->m_native_vtx_decl.stride;
+  if (s_output_cache_size + size > MAX_OUTPUT_CACHE_SIZE)
+  {
+    s_output_cache.clear();
+    s_output_cache_size = 0;
+  }
+
+  CachedVertices& entry = s_output_cache[key];
+  s_output_cache_size -= entry.data.size();
+  s_output_cache_size += size;
+  entry.raw_vertices.assign(key.src, key.src + key.count * loader->m_VertexSize);
+  entry.array_ranges = std::move(array_ranges);
+  entry.loaded_count = loaded_count;
+  entry.data.assign(data, data + size);
+  std::memcpy(entry.position_cache, position_cache, sizeof(position_cache));
+  std::memcpy(entry.position_matrix_index, position_matrix_index, sizeof(position_matrix_index));
+}
+
+static bool IsInputUnchanged(const CachedVertices& entry, const u8* src)
+{
+  if (std::memcmp(src, entry.raw_vertices.data(), entry.raw_vertices.size()) != 0)
+    return false;
+
+  // The indices are unchanged, so the draw still reads the same ranges of the arrays
+  for (const CachedArrayRange& range : entry.array_ranges)
+  {
+    if (cached_arraybases[range.array] != range.base ||
+        g_main_cp_state.array_strides[range.array] != range.stride ||
+        std::memcmp(range.base + range.offset, range.contents.data(), range.contents.size()) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies the converted vertices of an earlier identical draw to dst, along with the zfreeze state
+// the loader would have left behind. Returns the number of vertices, or -1 if there's no entry.
+static int LoadCachedVertices(const CachedVerticesKey& key, u8* dst)
+{
+  auto iter = s_output_cache.find(key);
+  if (iter == s_output_cache.end())
+    return -1;
+
+  const CachedVertices& entry = iter->second;
+  if (!IsInputUnchanged(entry, key.src))
+  {
+    s_output_cache_size -= entry.data.size();
+    s_output_cache.erase(iter);
+    auto seen = s_seen_inputs.find(key);
+    if (seen != s_seen_inputs.end())
+    {
+      seen->second.changes = std::min(seen->second.changes + 1, MAX_SIGHTINGS_SHIFT);
+      seen->second.sightings_left = 1u << seen->second.changes;
+    }
+    return -1;
+  }
+
+  std::memcpy(dst, entry.data.data(), entry.data.size());
+  std::memcpy(position_cache, entry.position_cache, sizeof(position_cache));
+  std::memcpy(position_matrix_index, entry.position_matrix_index, sizeof(position_matrix_index));
+  return entry.loaded_count;
+}
+
 int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess)
 {
   if (!count)
     return 0;
 
+  VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::VertexLoading, !is_preprocess);
+
   VertexLoaderBase* loader = RefreshLoader(vtx_attr_group, is_preprocess);
 
   int size = count * loader->m_VertexSize;
@@ -266,6 +481,7 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   if (loader->m_native_vertex_format != s_current_vtx_fmt ||
       loader->m_native_components != g_current_components)
   {
+    VideoProfiler::SetFlushReason(VideoProfiler::FlushReason::VertexFormat);
     g_vertex_manager->Flush();
   }
   s_current_vtx_fmt = loader->m_native_vertex_format;
@@ -280,7 +496,23 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   DataReader dst = g_vertex_manager->PrepareForAdditionalData(
       primitive, count, loader->m_native_vtx_decl.stride, cullall);
 
-  count = loader->RunVertices(src, dst, count);
+  const bool cacheable = count >= MIN_CACHED_VERTEX_COUNT;
+  const CachedVerticesKey cache_key{loader, src.GetPointer(), count};
+  const int loaded_count = cacheable ? LoadCachedVertices(cache_key, dst.GetPointer()) : -1;
+  if (loaded_count >= 0)
+  {
+    INCSTAT(stats.thisFrame.numVertexCacheHits);
+    count = loaded_count;
+  }
+  else
+  {
+    count = loader->RunVertices(src, dst, count);
+    if (cacheable)
+    {
+      INCSTAT(stats.thisFrame.numVertexCacheMisses);
+      InsertCachedVertices(cache_key, count, dst.GetPointer());
+    }
+  }
 
   IndexGenerator::AddIndices(primitive, count);
 
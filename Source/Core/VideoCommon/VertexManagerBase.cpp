@@ -6,6 +6,8 @@
 
 #include <array>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <memory>
 
 #include "Common/BitSet.h"
@@ -27,11 +29,13 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/SamplerCommon.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 #include "VideoCommon/XFMemory.h"
 
 std::unique_ptr<VertexManagerBase> g_vertex_manager;
@@ -79,6 +83,8 @@ static bool AspectIs16_9(float width, float height)
 
 VertexManagerBase::VertexManagerBase()
 {
+  m_draw_ps_constants.reserve(MAX_DRAWS_PER_BATCH - 1);
+  m_draw_vs_constants.reserve(MAX_DRAWS_PER_BATCH - 1);
 }
 
 VertexManagerBase::~VertexManagerBase()
@@ -102,6 +108,7 @@ DataReader VertexManagerBase::PrepareForAdditionalData(int primitive, u32 count,
                                          primitive_from_gx[primitive];
   if (m_current_primitive_type != new_primitive_type)
   {
+    VideoProfiler::SetFlushReason(VideoProfiler::FlushReason::PrimitiveType);
     Flush();
 
     // Have to update the rasterization state for point/line cull modes.
@@ -116,6 +123,7 @@ DataReader VertexManagerBase::PrepareForAdditionalData(int primitive, u32 count,
       (count > IndexGenerator::GetRemainingIndices() || count > GetRemainingIndices(primitive) ||
        needed_vertex_bytes > GetRemainingSize()))
   {
+    VideoProfiler::SetFlushReason(VideoProfiler::FlushReason::BufferFull);
     Flush();
 
     if (count > IndexGenerator::GetRemainingIndices())
@@ -273,6 +281,7 @@ static void SetSamplerState(u32 index, float custom_tex_scale, bool custom_tex,
 
 void VertexManagerBase::Flush()
 {
+  VideoProfiler::RecordFlush(!m_is_flushed);
   if (m_is_flushed)
     return;
 
@@ -349,39 +358,20 @@ void VertexManagerBase::Flush()
       }
     }
     g_texture_cache->BindTextures();
+
+    // Textures are only bound here, so the earlier draws of the batch use the same ones.
+    for (PixelShaderConstants& constants : m_draw_ps_constants)
+      constants.texdims = PixelShaderManager::constants.texdims;
   }
 
   // set global vertex constants
   VertexShaderManager::SetConstants();
 
-  // Track some stats used elsewhere by the anamorphic widescreen heuristic.
-  if (!SConfig::GetInstance().bWii)
+  // Changes after the last vertices of the batch don't apply to any of them
+  if (!IsLastDrawEmpty())
   {
-    float* rawProjection = xfmem.projection.rawProjection;
-    bool viewport_is_4_3 = AspectIs4_3(xfmem.viewport.wd, xfmem.viewport.ht);
-    if (AspectIs16_9(rawProjection[2], rawProjection[0]) && viewport_is_4_3)
-    {
-      // Projection is 16:9 and viewport is 4:3, we are rendering an anamorphic
-      // widescreen picture.
-      m_flush_count_anamorphic++;
-    }
-    else if (AspectIs4_3(rawProjection[2], rawProjection[0]) && viewport_is_4_3)
-    {
-      // Projection and viewports are both 4:3, we are rendering a normal image.
-      m_flush_count_4_3++;
-    }
-  }
-
-  // Calculate ZSlope for zfreeze
-  if (!bpmem.genMode.zfreeze)
-  {
-    // Must be done after VertexShaderManager::SetConstants()
-    CalculateZSlope(VertexLoaderManager::GetCurrentVertexFormat());
-  }
-  else if (m_zslope.dirty && !m_cull_all)  // or apply any dirty ZSlopes
-  {
-    PixelShaderManager::SetZSlope(m_zslope.dfdx, m_zslope.dfdy, m_zslope.f0);
-    m_zslope.dirty = false;
+    UpdateAspectRatioCount();
+    UpdateZSlope();
   }
 
   if (!m_cull_all)
@@ -392,7 +382,10 @@ void VertexManagerBase::Flush()
 
     if (PerfQueryBase::ShouldEmulate())
       g_perf_query->EnableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
-    g_vertex_manager->vFlush();
+    {
+      VideoProfiler::ScopedStage profile_stage(VideoProfiler::Stage::BackendSubmission);
+      g_vertex_manager->vFlush();
+    }
     if (PerfQueryBase::ShouldEmulate())
       g_perf_query->DisableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
   }
@@ -404,10 +397,111 @@ void VertexManagerBase::Flush()
               "xf.numtexgens (%d) does not match bp.numtexgens (%d). Error in command stream.",
               xfmem.numTexGen.numTexGens, bpmem.genMode.numtexgens.Value());
 
+  INCSTAT(stats.thisFrame.numFlushes);
+
+  m_draw_ps_constants.clear();
+  m_draw_vs_constants.clear();
   m_is_flushed = true;
   m_cull_all = false;
 }
 
+void VertexManagerBase::MergeStateChange()
+{
+  if (!m_is_flushed)
+    INCSTAT(stats.thisFrame.numMergedStateChanges);
+}
+
+void VertexManagerBase::SplitBatch(VideoProfiler::FlushReason reason, u32 address)
+{
+  if (m_is_flushed || m_cull_all || !g_ActiveConfig.backend_info.bSupportsPerDrawConstants ||
+      GetDrawCount() == MAX_DRAWS_PER_BATCH)
+  {
+    VideoProfiler::SetFlushReason(reason, address);
+    Flush();
+    return;
+  }
+
+  // Without new vertices since the last split, the change only affects the next draw.
+  if (IsLastDrawEmpty())
+  {
+    MergeStateChange();
+    return;
+  }
+
+  // Everything Flush() does with the current state that doesn't apply to the whole batch
+  VertexShaderManager::SetConstants();
+  UpdateAspectRatioCount();
+  UpdateZSlope();
+  PixelShaderManager::SetConstants();
+
+  m_draw_ps_constants.push_back(PixelShaderManager::constants);
+  m_draw_vs_constants.push_back(VertexShaderManager::constants);
+  m_draw_vs_constants.back().draw_end = IndexGenerator::GetNumVerts();
+
+  INCSTAT(stats.thisFrame.numMergedDraws);
+}
+
+bool VertexManagerBase::IsLastDrawEmpty() const
+{
+  return !m_draw_vs_constants.empty() &&
+         m_draw_vs_constants.back().draw_end == IndexGenerator::GetNumVerts();
+}
+
+void VertexManagerBase::WriteDrawConstants(u8* ps_dest, u8* vs_dest, u32 base_vertex) const
+{
+  for (size_t i = 0; i < m_draw_vs_constants.size(); ++i)
+  {
+    const u32 draw_end = base_vertex + m_draw_vs_constants[i].draw_end;
+    std::memcpy(ps_dest, &m_draw_ps_constants[i], sizeof(PixelShaderConstants));
+    std::memcpy(vs_dest, &m_draw_vs_constants[i], sizeof(VertexShaderConstants));
+    std::memcpy(vs_dest + offsetof(VertexShaderConstants, draw_end), &draw_end, sizeof(u32));
+    ps_dest += PS_DRAW_CONSTANTS_STRIDE;
+    vs_dest += VS_DRAW_CONSTANTS_STRIDE;
+  }
+
+  // The last draw takes the remaining vertices.
+  const u32 draw_end = UINT32_MAX;
+  std::memcpy(ps_dest, &PixelShaderManager::constants, sizeof(PixelShaderConstants));
+  std::memcpy(vs_dest, &VertexShaderManager::constants, sizeof(VertexShaderConstants));
+  std::memcpy(vs_dest + offsetof(VertexShaderConstants, draw_end), &draw_end, sizeof(u32));
+}
+
+// Tracks some stats used elsewhere by the anamorphic widescreen heuristic.
+void VertexManagerBase::UpdateAspectRatioCount()
+{
+  if (SConfig::GetInstance().bWii)
+    return;
+
+  float* rawProjection = xfmem.projection.rawProjection;
+  bool viewport_is_4_3 = AspectIs4_3(xfmem.viewport.wd, xfmem.viewport.ht);
+  if (AspectIs16_9(rawProjection[2], rawProjection[0]) && viewport_is_4_3)
+  {
+    // Projection is 16:9 and viewport is 4:3, we are rendering an anamorphic
+    // widescreen picture.
+    m_flush_count_anamorphic++;
+  }
+  else if (AspectIs4_3(rawProjection[2], rawProjection[0]) && viewport_is_4_3)
+  {
+    // Projection and viewports are both 4:3, we are rendering a normal image.
+    m_flush_count_4_3++;
+  }
+}
+
+// Must be done after VertexShaderManager::SetConstants()
+void VertexManagerBase::UpdateZSlope()
+{
+  // Calculate ZSlope for zfreeze
+  if (!bpmem.genMode.zfreeze)
+  {
+    CalculateZSlope(VertexLoaderManager::GetCurrentVertexFormat());
+  }
+  else if (m_zslope.dirty && !m_cull_all)  // or apply any dirty ZSlopes
+  {
+    PixelShaderManager::SetZSlope(m_zslope.dfdx, m_zslope.dfdy, m_zslope.f0);
+    m_zslope.dirty = false;
+  }
+}
+
 void VertexManagerBase::DoState(PointerWrap& p)
 {
   p.Do(m_zslope);
@@ -9,7 +9,9 @@
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "VideoCommon/ConstantManager.h"
 #include "VideoCommon/RenderState.h"
+#include "VideoCommon/VideoProfiler.h"
 
 class DataReader;
 class NativeVertexFormat;
@@ -50,6 +52,19 @@ public:
   void FlushData(u32 count, u32 stride);
 
   void Flush();
+  // Called instead of Flush() for state changes which don't affect the pending vertices
+  void MergeStateChange();
+  // Called instead of Flush() for state changes which only change shader constants. With
+  // per-draw constants, the constants of the pending vertices are kept and the batch continues
+  // with a new draw. Otherwise this flushes for the given reason.
+  void SplitBatch(VideoProfiler::FlushReason reason, u32 address = 0);
+
+  // The number of draws with their own constants in the current batch, including the last one
+  // which uses the current constants
+  u32 GetDrawCount() const { return static_cast<u32>(m_draw_vs_constants.size()) + 1; }
+  // Writes the constants of every draw at PS_DRAW_CONSTANTS_STRIDE and VS_DRAW_CONSTANTS_STRIDE.
+  // The vertex ranges are offset by base_vertex, which the shaders' vertex index includes.
+  void WriteDrawConstants(u8* ps_dest, u8* vs_dest, u32 base_vertex) const;
 
   virtual std::unique_ptr<NativeVertexFormat>
   CreateNativeVertexFormat(const PortableVertexDeclaration& vtx_decl) = 0;
@@ -71,6 +86,7 @@ protected:
 
   Slope m_zslope = {};
   void CalculateZSlope(NativeVertexFormat* format);
+  void UpdateZSlope();
 
   bool m_cull_all = false;
   PrimitiveType m_current_primitive_type = PrimitiveType::Points;
@@ -80,6 +96,14 @@ private:
   size_t m_flush_count_4_3 = 0;
   size_t m_flush_count_anamorphic = 0;
 
+  // Constants of the draws before the last one in the current batch. draw_end holds the number
+  // of vertices in the batch at the end of each draw.
+  std::vector<PixelShaderConstants> m_draw_ps_constants;
+  std::vector<VertexShaderConstants> m_draw_vs_constants;
+
+  bool IsLastDrawEmpty() const;
+  void UpdateAspectRatioCount();
+
   virtual void vFlush() = 0;
 
   virtual void CreateDeviceObjects() {}
@@ -85,20 +85,30 @@ ShaderCode GenerateVertexShaderCode(APIType api_type, const ShaderHostConfig& ho
   const bool msaa = host_config.msaa;
   const bool ssaa = host_config.ssaa;
   const bool vertex_rounding = host_config.vertex_rounding;
+  const bool per_draw_constants = host_config.per_draw_constants;
 
   out.Write("%s", s_lighting_struct);
 
   // uniforms
-  if (api_type == APIType::OpenGL || api_type == APIType::Vulkan)
-    out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+  if (per_draw_constants)
+  {
+    out.Write("uint draw_index;\n");
+    WritePerDrawConstantBlock(out, "VS", 2, s_shader_uniforms);
+  }
   else
-    out.Write("cbuffer VSBlock {\n");
+  {
+    if (api_type == APIType::OpenGL || api_type == APIType::Vulkan)
+      out.Write("UBO_BINDING(std140, 2) uniform VSBlock {\n");
+    else
+      out.Write("cbuffer VSBlock {\n");
 
-  out.Write(s_shader_uniforms);
-  out.Write("};\n");
+    out.Write(s_shader_uniforms);
+    out.Write("};\n");
+  }
 
   out.Write("struct VS_OUTPUT {\n");
-  GenerateVSOutputMembers(out, api_type, uid_data->numTexGens, per_pixel_lighting, "");
+  GenerateVSOutputMembers(out, api_type, uid_data->numTexGens, per_pixel_lighting, "",
+                          per_draw_constants);
   out.Write("};\n");
 
   if (api_type == APIType::OpenGL || api_type == APIType::Vulkan)
@@ -133,7 +143,8 @@ ShaderCode GenerateVertexShaderCode(APIType api_type, const ShaderHostConfig& ho
     {
       out.Write("VARYING_LOCATION(0) out VertexData {\n");
       GenerateVSOutputMembers(out, api_type, uid_data->numTexGens, per_pixel_lighting,
-                              GetInterpolationQualifier(msaa, ssaa, true, false));
+                              GetInterpolationQualifier(msaa, ssaa, true, false),
+                              per_draw_constants, true);
       out.Write("} vs;\n");
     }
     else
@@ -157,6 +168,8 @@ ShaderCode GenerateVertexShaderCode(APIType api_type, const ShaderHostConfig& ho
     }
 
     out.Write("void main()\n{\n");
+    if (per_draw_constants)
+      WriteVertexDrawIndex(out);
   }
   else  // D3D
   {
@@ -185,6 +198,8 @@ ShaderCode GenerateVertexShaderCode(APIType api_type, const ShaderHostConfig& ho
   }
 
   out.Write("VS_OUTPUT o;\n");
+  if (per_draw_constants)
+    out.Write("o.draw = draw_index;\n");
 
   // transforms
   if (uid_data->components & VB_HAS_POSMTXIDX)
@@ -487,7 +502,8 @@ ShaderCode GenerateVertexShaderCode(APIType api_type, const ShaderHostConfig& ho
   {
     if (host_config.backend_geometry_shaders || api_type == APIType::Vulkan)
     {
-      AssignVSOutputMembers(out, "vs", "o", uid_data->numTexGens, per_pixel_lighting);
+      AssignVSOutputMembers(out, "vs", "o", uid_data->numTexGens, per_pixel_lighting,
+                            per_draw_constants);
     }
     else
     {
@@ -25,6 +25,7 @@
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 #include "VideoCommon/XFMemory.h"
 
 alignas(16) static float g_fProjectionMatrix[16];
@@ -711,7 +712,7 @@ void VertexShaderManager::SetTexMatrixChangedA(u32 Value)
 {
   if (g_main_cp_state.matrix_index_a.Hex != Value)
   {
-    g_vertex_manager->Flush();
+    g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::MatrixIndex);
     if (g_main_cp_state.matrix_index_a.PosNormalMtxIdx != (Value & 0x3f))
       bPosNormalMatrixChanged = true;
     bTexMatricesChanged[0] = true;
@@ -723,7 +724,7 @@ void VertexShaderManager::SetTexMatrixChangedB(u32 Value)
 {
   if (g_main_cp_state.matrix_index_b.Hex != Value)
   {
-    g_vertex_manager->Flush();
+    g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::MatrixIndex);
     bTexMatricesChanged[1] = true;
     g_main_cp_state.matrix_index_b.Hex = Value;
   }
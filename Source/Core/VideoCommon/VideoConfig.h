@@ -85,6 +85,7 @@ struct VideoConfig final
   bool bTexFmtOverlayEnable;
   bool bTexFmtOverlayCenter;
   bool bLogRenderTimeToFile;
+  bool bLogVideoProfileToFile;
 
   // Render
   bool bWireFrame;
@@ -94,6 +95,10 @@ struct VideoConfig final
   bool bDumpTextures;
   bool bHiresTextures;
   bool bCacheHiresTextures;
+  // How many MiB of textures loaded from texture packs are kept in memory
+  int iHiresTexturesMemoryBudget;
+  // Keep textures that are slow to decode on disk, so later runs of the game don't decode them
+  bool bCacheDecodedTextures;
   bool bDumpEFBTarget;
   bool bDumpXFBTarget;
   bool bDumpFramesAsImages;
@@ -108,6 +113,10 @@ struct VideoConfig final
   bool bEnableGPUTextureDecoding;
   int iBitrateKbps;
 
+  // Number of threads decoding large textures on the CPU, including the video thread.
+  // -1 uses an automatic number based on the CPU threads.
+  int iTextureDecodingThreads;
+
   // Hacks
   bool bEFBAccessEnable;
   bool bPerfQueriesEnable;
@@ -126,6 +135,9 @@ struct VideoConfig final
   float fAspectRatioHackW, fAspectRatioHackH;
   bool bEnablePixelLighting;
   bool bFastDepthCalc;
+  // Read by the GL, Vulkan and D3D backends when they start. Lets a batch reference more than
+  // 65535 vertices, so that fewer of them have to be flushed early.
+  bool bUse32BitIndices;
   bool bVertexRounding;
   int iLog;           // CONF_ bits
   int iSaveTargetId;  // TODO: Should be dropped
@@ -150,6 +162,10 @@ struct VideoConfig final
   bool bDumpObjects;
   bool bDumpTevStages;
   bool bDumpTevTextureFetches;
+  // Number of threads drawing triangles, 0 means one per CPU core.
+  int iSWRasterizerThreads;
+  // Run the TEV for the pixels of a 2x2 quad at once instead of one pixel at a time.
+  bool bSWDrawQuads;
 
   // Enable API validation layers, currently only supported with Vulkan.
   bool bEnableValidationLayer;
@@ -227,6 +243,7 @@ struct VideoConfig final
     bool bSupportsDynamicSamplerIndexing;  // Needed by UberShaders, so must stay in VideoCommon
     bool bSupportsBPTCTextures;
     bool bSupportsFramebufferFetch;  // Used as an alternative to dual-source blend on GLES
+    bool bSupportsPerDrawConstants;  // Needed by ShaderGen, so must stay in VideoCommon
   } backend_info;
 
   // Utility
@@ -248,6 +265,8 @@ struct VideoConfig final
   bool UseVertexRounding() const { return bVertexRounding && iEFBScale != 1; }
   u32 GetShaderCompilerThreads() const;
   u32 GetShaderPrecompilerThreads() const;
+  u32 GetSWRasterizerThreads() const;
+  u32 GetTextureDecodingThreads() const;
   bool CanPrecompileUberShaders() const;
   bool CanBackgroundCompileShaders() const;
 };
@@ -0,0 +1,219 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/VideoProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace VideoProfiler
+{
+using Clock = std::chrono::steady_clock;
+
+// Number of registers listed per bank in the overlay. The log contains all of them.
+static constexpr size_t MAX_OVERLAY_REGISTERS = 8;
+
+static constexpr const char* STAGE_NAMES[NUM_STAGES] = {
+    "opcode_decoding", "vertex_loading", "texture_cache", "shader_lookup", "backend_submission",
+};
+
+static constexpr const char* FLUSH_REASON_NAMES[NUM_FLUSH_REASONS] = {
+    "other",         "bp_register",    "xf_register", "xf_memory", "matrix_index",
+    "vertex_format", "primitive_type", "buffer_full", "fifo_idle",
+};
+
+bool g_timing_enabled = false;
+
+static Stage s_current_stage = Stage::Count;
+static Clock::time_point s_stage_start;
+
+static FlushReason s_flush_reason = FlushReason::Other;
+static u32 s_flush_address = 0;
+
+static std::ofstream s_log_file;
+static u64 s_frame_number = 0;
+
+// Adds the time since the last stage change to the current stage
+static void AccountStageTime(Clock::time_point now)
+{
+  if (s_current_stage != Stage::Count)
+  {
+    stats.thisFrame.videoStageTimes[static_cast<size_t>(s_current_stage)] +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_stage_start).count();
+  }
+  s_stage_start = now;
+}
+
+void EnterStage(Stage stage, Stage* previous)
+{
+  AccountStageTime(Clock::now());
+  *previous = s_current_stage;
+  s_current_stage = stage;
+}
+
+void LeaveStage(Stage previous)
+{
+  AccountStageTime(Clock::now());
+  s_current_stage = previous;
+}
+
+void SetFlushReason(FlushReason reason, u32 address)
+{
+  s_flush_reason = reason;
+  s_flush_address = address;
+}
+
+void RecordFlush(bool has_data)
+{
+  if (has_data)
+  {
+    stats.thisFrame.numFlushesByReason[static_cast<size_t>(s_flush_reason)]++;
+    if (s_flush_reason == FlushReason::BPRegister && s_flush_address < NUM_BP_REGISTERS)
+    {
+      stats.thisFrame.numFlushesByBPRegister[s_flush_address]++;
+    }
+    else if (s_flush_reason == FlushReason::XFRegister && s_flush_address >= XF_REGISTER_BASE &&
+             s_flush_address < XF_REGISTER_BASE + NUM_XF_REGISTERS)
+    {
+      stats.thisFrame.numFlushesByXFRegister[s_flush_address - XF_REGISTER_BASE]++;
+    }
+  }
+
+  s_flush_reason = FlushReason::Other;
+  s_flush_address = 0;
+}
+
+// Returns the registers with at least one flush, the most frequent first
+static std::vector<std::pair<u32, int>> GetFlushRegisters(const int* counts, u32 num_registers,
+                                                          u32 base)
+{
+  std::vector<std::pair<u32, int>> registers;
+  for (u32 i = 0; i < num_registers; ++i)
+  {
+    if (counts[i])
+      registers.emplace_back(base + i, counts[i]);
+  }
+
+  std::stable_sort(registers.begin(), registers.end(),
+                   [](const auto& a, const auto& b) { return a.second > b.second; });
+  return registers;
+}
+
+std::string ToString()
+{
+  std::string str;
+
+  if (g_timing_enabled)
+  {
+    for (size_t i = 0; i < NUM_STAGES; ++i)
+    {
+      str += StringFromFormat("Time in %s: %.2f ms\n", STAGE_NAMES[i],
+                              stats.thisFrame.videoStageTimes[i] / 1000000.0);
+    }
+  }
+
+  str += "Flush reasons:";
+  for (size_t i = 0; i < NUM_FLUSH_REASONS; ++i)
+  {
+    const int count = stats.thisFrame.numFlushesByReason[i];
+    if (count)
+      str += StringFromFormat(" %s %i", FLUSH_REASON_NAMES[i], count);
+  }
+  str += '\n';
+
+  const auto append_registers = [&str](const char* name,
+                                       const std::vector<std::pair<u32, int>>& registers) {
+    str += StringFromFormat("Flushes by %s register:", name);
+    for (size_t i = 0; i < std::min(registers.size(), MAX_OVERLAY_REGISTERS); ++i)
+      str += StringFromFormat(" 0x%02x %i", registers[i].first, registers[i].second);
+    str += '\n';
+  };
+  append_registers("BP", GetFlushRegisters(stats.thisFrame.numFlushesByBPRegister,
+                                           NUM_BP_REGISTERS, 0));
+  append_registers("XF", GetFlushRegisters(stats.thisFrame.numFlushesByXFRegister,
+                                           NUM_XF_REGISTERS, XF_REGISTER_BASE));
+
+  return str;
+}
+
+static std::string FrameToJSON()
+{
+  std::string json = StringFromFormat("{\"frame\":%" PRIu64, s_frame_number);
+
+  json += ",\"stage_us\":{";
+  for (size_t i = 0; i < NUM_STAGES; ++i)
+  {
+    json += StringFromFormat("%s\"%s\":%.1f", i ? "," : "", STAGE_NAMES[i],
+                             stats.thisFrame.videoStageTimes[i] / 1000.0);
+  }
+
+  json += StringFromFormat("},\"draw_calls\":%i,\"flushes\":%i,\"flush_reasons\":{",
+                           stats.thisFrame.numDrawCalls, stats.thisFrame.numFlushes);
+  for (size_t i = 0; i < NUM_FLUSH_REASONS; ++i)
+  {
+    json += StringFromFormat("%s\"%s\":%i", i ? "," : "", FLUSH_REASON_NAMES[i],
+                             stats.thisFrame.numFlushesByReason[i]);
+  }
+
+  const auto append_registers = [&json](const char* name,
+                                        const std::vector<std::pair<u32, int>>& registers) {
+    json += StringFromFormat("},\"%s_registers\":{", name);
+    for (size_t i = 0; i < registers.size(); ++i)
+    {
+      json += StringFromFormat("%s\"0x%02x\":%i", i ? "," : "", registers[i].first,
+                               registers[i].second);
+    }
+  };
+  append_registers("bp", GetFlushRegisters(stats.thisFrame.numFlushesByBPRegister,
+                                           NUM_BP_REGISTERS, 0));
+  append_registers("xf", GetFlushRegisters(stats.thisFrame.numFlushesByXFRegister,
+                                           NUM_XF_REGISTERS, XF_REGISTER_BASE));
+  json += "}}";
+
+  return json;
+}
+
+void EndFrame()
+{
+  if (g_timing_enabled)
+    AccountStageTime(Clock::now());
+
+  if (g_ActiveConfig.bLogVideoProfileToFile)
+  {
+    if (!s_log_file.is_open())
+    {
+      File::OpenFStream(s_log_file, File::GetUserPath(D_LOGS_IDX) + "video_profile.json",
+                        std::ios_base::out);
+    }
+
+    s_log_file << FrameToJSON() << '\n';
+  }
+
+  s_frame_number++;
+
+  const bool was_enabled = g_timing_enabled;
+  g_timing_enabled = g_ActiveConfig.bOverlayStats || g_ActiveConfig.bLogVideoProfileToFile;
+  if (g_timing_enabled && !was_enabled)
+    s_stage_start = Clock::now();
+}
+
+void Shutdown()
+{
+  s_log_file.close();
+  s_frame_number = 0;
+  s_current_stage = Stage::Count;
+  g_timing_enabled = false;
+}
+}
@@ -0,0 +1,88 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+// Per-frame instrumentation of the video thread. The results are accumulated in stats.thisFrame,
+// shown with the statistics overlay and optionally logged as one line of JSON per frame.
+namespace VideoProfiler
+{
+// Parts of the video thread which are timed. Time spent in a nested stage only counts towards
+// that stage, so the times of a frame add up.
+enum class Stage
+{
+  OpcodeDecoding,
+  VertexLoading,
+  TextureCache,
+  ShaderLookup,
+  BackendSubmission,
+  Count
+};
+
+// What caused the vertex manager to flush. BP and XF register writes are counted per register.
+enum class FlushReason
+{
+  Other,
+  BPRegister,
+  XFRegister,
+  XFMemory,
+  MatrixIndex,
+  VertexFormat,
+  PrimitiveType,
+  BufferFull,
+  FifoIdle,
+  Count
+};
+
+constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::Count);
+constexpr size_t NUM_FLUSH_REASONS = static_cast<size_t>(FlushReason::Count);
+constexpr u32 NUM_BP_REGISTERS = 0x100;
+constexpr u32 XF_REGISTER_BASE = 0x1000;
+constexpr u32 NUM_XF_REGISTERS = 0x58;
+
+// Timing is only done while the statistics are shown or logged, and is updated once per frame
+extern bool g_timing_enabled;
+
+void EnterStage(Stage stage, Stage* previous);
+void LeaveStage(Stage previous);
+
+class ScopedStage
+{
+public:
+  explicit ScopedStage(Stage stage, bool active = true) : m_active(active && g_timing_enabled)
+  {
+    if (m_active)
+      EnterStage(stage, &m_previous);
+  }
+  ~ScopedStage()
+  {
+    if (m_active)
+      LeaveStage(m_previous);
+  }
+
+  ScopedStage(const ScopedStage&) = delete;
+  ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+  Stage m_previous = Stage::Count;
+  bool m_active;
+};
+
+// Sets the reason for the next flush. address is the register for BP and XF writes.
+void SetFlushReason(FlushReason reason, u32 address = 0);
+// Called by the vertex manager for every flush, including ones with nothing to draw
+void RecordFlush(bool has_data);
+
+// Returns the stage times and the flush reasons of the current frame as text
+std::string ToString();
+
+// Writes the current frame to the log if enabled, and starts timing the next frame
+void EndFrame();
+void Shutdown();
+}
@@ -15,16 +15,83 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/VideoProfiler.h"
 #include "VideoCommon/XFMemory.h"
 
+// Games often load the same matrices and lights again for every object, which doesn't need to
+// end the current batch.
+static bool XFMemChanged(u32 transferSize, u32 baseAddress, DataReader src)
+{
+  const u32* current = reinterpret_cast<const u32*>(&xfmem) + baseAddress;
+  for (u32 i = 0; i < transferSize; ++i)
+  {
+    if (current[i] != src.Peek<u32>(i * sizeof(u32)))
+      return true;
+  }
+  return false;
+}
+
+// The post-transform matrices are only read with dual texture transforms, and the lights only
+// with lighting. The registers enabling them flush when they change, so loads which only write
+// to unused ones don't need to end the current batch.
+static bool IsUnusedXFMem(u32 transferSize, u32 baseAddress)
+{
+  const u32 end = baseAddress + transferSize;
+  if (baseAddress < XFMEM_POSTMATRICES || end > XFMEM_LIGHTS_END)
+    return false;
+
+  if (baseAddress < XFMEM_POSTMATRICES_END && xfmem.dualTexTrans.enabled)
+    return false;
+
+  if (end > XFMEM_LIGHTS)
+  {
+    for (u32 i = 0; i < NUM_XF_COLOR_CHANNELS; ++i)
+    {
+      if (xfmem.color[i].enablelighting || xfmem.alpha[i].enablelighting)
+        return false;
+    }
+  }
+
+  return true;
+}
+
 static void XFMemWritten(u32 transferSize, u32 baseAddress)
 {
-  g_vertex_manager->Flush();
+  if (IsUnusedXFMem(transferSize, baseAddress))
+  {
+    g_vertex_manager->MergeStateChange();
+  }
+  else
+  {
+    // XF memory only holds matrices and lights, which are vertex shader constants
+    g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::XFMemory, baseAddress);
+  }
   VertexShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
+static void FlushForRegister(u32 address)
+{
+  VideoProfiler::SetFlushReason(VideoProfiler::FlushReason::XFRegister, address);
+  g_vertex_manager->Flush();
+}
+
+// Loads of only the material colors, or of only the projection while the geometry shader doesn't
+// read it, just change vertex shader constants. The registers are written after all of them were
+// checked, so loads which also flush for other registers must not split the batch before.
+static bool IsShaderConstantLoad(u32 transferSize, u32 baseAddress)
+{
+  const u32 end = baseAddress + transferSize;
+  if (baseAddress >= XFMEM_SETCHAN0_AMBCOLOR && end <= XFMEM_SETCHAN1_MATCOLOR + 1)
+    return true;
+
+  return baseAddress >= XFMEM_SETPROJECTION && end <= XFMEM_SETPROJECTION + 7 &&
+         g_ActiveConfig.stereo_mode == StereoMode::Off;
+}
+
 static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 {
+  const bool shader_constants = IsShaderConstantLoad(transferSize, baseAddress);
   u32 address = baseAddress;
   u32 dataIndex = 0;
 
@@ -55,7 +122,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 
     case XFMEM_SETNUMCHAN:
       if (xfmem.numChan.numColorChans != (newValue & 3))
-        g_vertex_manager->Flush();
+        FlushForRegister(address);
       VertexShaderManager::SetLightingConfigChanged();
       break;
 
@@ -65,7 +132,10 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
       u8 chan = address - XFMEM_SETCHAN0_AMBCOLOR;
       if (xfmem.ambColor[chan] != newValue)
       {
-        g_vertex_manager->Flush();
+        if (shader_constants)
+          g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::XFRegister, address);
+        else
+          FlushForRegister(address);
         VertexShaderManager::SetMaterialColorChanged(chan);
       }
       break;
@@ -77,7 +147,10 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
       u8 chan = address - XFMEM_SETCHAN0_MATCOLOR;
       if (xfmem.matColor[chan] != newValue)
       {
-        g_vertex_manager->Flush();
+        if (shader_constants)
+          g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::XFRegister, address);
+        else
+          FlushForRegister(address);
         VertexShaderManager::SetMaterialColorChanged(chan + 2);
       }
       break;
@@ -88,13 +161,13 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
     case XFMEM_SETCHAN0_ALPHA:  // Channel Alpha
     case XFMEM_SETCHAN1_ALPHA:
       if (((u32*)&xfmem)[address] != (newValue & 0x7fff))
-        g_vertex_manager->Flush();
+        FlushForRegister(address);
       VertexShaderManager::SetLightingConfigChanged();
       break;
 
     case XFMEM_DUALTEX:
       if (xfmem.dualTexTrans.enabled != (newValue & 1))
-        g_vertex_manager->Flush();
+        FlushForRegister(address);
       VertexShaderManager::SetTexMatrixInfoChanged(-1);
       break;
 
@@ -113,7 +186,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
     case XFMEM_SETVIEWPORT + 3:
     case XFMEM_SETVIEWPORT + 4:
     case XFMEM_SETVIEWPORT + 5:
-      g_vertex_manager->Flush();
+      FlushForRegister(address);
       VertexShaderManager::SetViewportChanged();
       PixelShaderManager::SetViewportChanged();
       GeometryShaderManager::SetViewportChanged();
@@ -128,7 +201,10 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
     case XFMEM_SETPROJECTION + 4:
     case XFMEM_SETPROJECTION + 5:
     case XFMEM_SETPROJECTION + 6:
-      g_vertex_manager->Flush();
+      if (shader_constants)
+        g_vertex_manager->SplitBatch(VideoProfiler::FlushReason::XFRegister, address);
+      else
+        FlushForRegister(address);
       VertexShaderManager::SetProjectionChanged();
       GeometryShaderManager::SetProjectionChanged();
 
@@ -137,7 +213,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 
     case XFMEM_SETNUMTEXGENS:  // GXSetNumTexGens
       if (xfmem.numTexGen.numTexGens != (newValue & 15))
-        g_vertex_manager->Flush();
+        FlushForRegister(address);
       break;
 
     case XFMEM_SETTEXMTXINFO:
@@ -148,7 +224,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
     case XFMEM_SETTEXMTXINFO + 5:
     case XFMEM_SETTEXMTXINFO + 6:
     case XFMEM_SETTEXMTXINFO + 7:
-      g_vertex_manager->Flush();
+      FlushForRegister(address);
       VertexShaderManager::SetTexMatrixInfoChanged(address - XFMEM_SETTEXMTXINFO);
 
       nextAddress = XFMEM_SETTEXMTXINFO + 8;
@@ -162,7 +238,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
     case XFMEM_SETPOSMTXINFO + 5:
     case XFMEM_SETPOSMTXINFO + 6:
     case XFMEM_SETPOSMTXINFO + 7:
-      g_vertex_manager->Flush();
+      FlushForRegister(address);
       VertexShaderManager::SetTexMatrixInfoChanged(address - XFMEM_SETPOSMTXINFO);
 
       nextAddress = XFMEM_SETPOSMTXINFO + 8;
@@ -237,10 +313,18 @@ void LoadXFReg(u32 transferSize, u32 baseAddress, DataReader src)
       transferSize = 0;
     }
 
-    XFMemWritten(xfMemTransferSize, xfMemBase);
-    for (u32 i = 0; i < xfMemTransferSize; i++)
+    if (XFMemChanged(xfMemTransferSize, xfMemBase, src))
     {
-      ((u32*)&xfmem)[xfMemBase + i] = src.Read<u32>();
+      XFMemWritten(xfMemTransferSize, xfMemBase);
+      for (u32 i = 0; i < xfMemTransferSize; i++)
+      {
+        ((u32*)&xfmem)[xfMemBase + i] = src.Read<u32>();
+      }
+    }
+    else
+    {
+      g_vertex_manager->MergeStateChange();
+      src.Skip<u32>(xfMemTransferSize);
     }
   }
 
@@ -289,6 +373,10 @@ void LoadIndexedXF(u32 val, int refarray)
     for (int i = 0; i < size; ++i)
       currData[i] = Common::swap32(newData[i]);
   }
+  else
+  {
+    g_vertex_manager->MergeStateChange();
+  }
 }
 
 void PreprocessIndexedXF(u32 val, int refarray)
@@ -0,0 +1,83 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FlatMultiMap.h"
+
+TEST(FlatMultiMap, Simple)
+{
+  Common::FlatMultiMap<int> map;
+  EXPECT_TRUE(map.Empty());
+  EXPECT_EQ(nullptr, map.Find(0x80003100));
+
+  map.Insert(0x80003100, 1);
+  map.Insert(0x80003100, 2);
+  map.Insert(0x80003200, 3);
+  EXPECT_EQ(2u, map.Size());
+
+  const std::vector<int>* values = map.Find(0x80003100);
+  ASSERT_NE(nullptr, values);
+  EXPECT_EQ(2u, values->size());
+
+  EXPECT_FALSE(map.Erase(0x80003100, 3));
+  EXPECT_TRUE(map.Erase(0x80003100, 1));
+  EXPECT_TRUE(map.Erase(0x80003100, 2));
+  EXPECT_EQ(nullptr, map.Find(0x80003100));
+  EXPECT_EQ(1u, map.Size());
+
+  map.EraseKey(0x80003200);
+  EXPECT_TRUE(map.Empty());
+}
+
+TEST(FlatMultiMap, MatchesMultimap)
+{
+  // Mimic the JIT block cache under heavy invalidation: clustered, aligned keys which are
+  // constantly inserted and erased.
+  Common::FlatMultiMap<u32> map;
+  std::multimap<u32, u32> reference;
+  std::mt19937 rng(1234);
+
+  for (u32 i = 0; i < 100000; ++i)
+  {
+    const u32 key = 0x80000000 | ((rng() % 0x4000) << 8);
+    if (rng() % 3 != 0)
+    {
+      map.Insert(key, i);
+      reference.emplace(key, i);
+    }
+    else
+    {
+      auto range = reference.equal_range(key);
+      if (range.first == range.second)
+      {
+        EXPECT_EQ(nullptr, map.Find(key));
+        continue;
+      }
+      EXPECT_TRUE(map.Erase(key, range.first->second));
+      reference.erase(range.first);
+    }
+  }
+
+  size_t total = 0;
+  map.ForEach([&](u32 key, const std::vector<u32>& values) {
+    std::vector<u32> expected;
+    auto range = reference.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+      expected.push_back(it->second);
+
+    std::vector<u32> actual = values;
+    std::sort(actual.begin(), actual.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, actual);
+    total += values.size();
+  });
+  EXPECT_EQ(reference.size(), total);
+}
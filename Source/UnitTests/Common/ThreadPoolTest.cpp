@@ -0,0 +1,40 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ThreadPool.h"
+
+TEST(ThreadPool, Schedule)
+{
+  Common::ThreadPool pool(4);
+  EXPECT_EQ(4u, pool.GetThreadCount());
+
+  std::atomic<int> counter{0};
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; ++i)
+    futures.push_back(pool.Schedule([&counter] { counter++; }));
+
+  for (std::future<void>& future : futures)
+    future.get();
+
+  EXPECT_EQ(100, counter.load());
+}
+
+TEST(ThreadPool, ParallelFor)
+{
+  Common::ThreadPool pool(3);
+  std::vector<int> values(1000, 0);
+  pool.ParallelFor(values.size(), [&values](size_t i) { values[i] += static_cast<int>(i); });
+
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i), values[i]);
+
+  // Nothing to do must not block.
+  pool.ParallelFor(0, [](size_t) { FAIL(); });
+}
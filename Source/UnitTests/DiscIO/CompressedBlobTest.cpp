@@ -0,0 +1,94 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CompressedBlob.h"
+
+namespace
+{
+constexpr u32 BLOCK_SIZE = 0x4000;
+
+bool Callback(const std::string&, float, void*)
+{
+  return true;
+}
+
+class CompressedBlobTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_temp_dir = File::CreateTempDir();
+    m_input_path = m_temp_dir + "/input.iso";
+    m_gcz_path = m_temp_dir + "/input.gcz";
+    m_output_path = m_temp_dir + "/output.iso";
+
+    // Several groups of blocks, with both compressible and incompressible blocks, and a
+    // partial block at the end
+    std::mt19937 rng(1234);
+    m_data.resize(300 * BLOCK_SIZE + 123);
+    for (size_t i = 0; i < m_data.size(); ++i)
+      m_data[i] = (i / BLOCK_SIZE) % 3 == 0 ? static_cast<u8>(rng()) : static_cast<u8>(i / 64);
+
+    File::IOFile file(m_input_path, "wb");
+    ASSERT_TRUE(file.WriteBytes(m_data.data(), m_data.size()));
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  std::vector<u8> ReadOutput() const
+  {
+    std::string data;
+    File::ReadFileToString(m_output_path, data);
+    return std::vector<u8>(data.begin(), data.end());
+  }
+
+  std::string m_temp_dir;
+  std::string m_input_path;
+  std::string m_gcz_path;
+  std::string m_output_path;
+  std::vector<u8> m_data;
+};
+}  // namespace
+
+TEST_F(CompressedBlobTest, RoundTrip)
+{
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(m_input_path, m_gcz_path, 0, BLOCK_SIZE, Callback));
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_gcz_path, m_output_path, Callback));
+  EXPECT_EQ(m_data, ReadOutput());
+}
+
+TEST_F(CompressedBlobTest, CorruptBlock)
+{
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(m_input_path, m_gcz_path, 0, BLOCK_SIZE, Callback));
+
+  {
+    // Overwrite a compressed block with data that can't be inflated
+    File::IOFile file(m_gcz_path, "r+b");
+    DiscIO::CompressedBlobHeader header;
+    ASSERT_TRUE(file.ReadArray(&header, 1));
+    std::vector<u64> offsets(header.num_blocks);
+    ASSERT_TRUE(file.ReadArray(offsets.data(), offsets.size()));
+
+    const u64 data_offset = sizeof(header) + (sizeof(u64) + sizeof(u32)) * header.num_blocks;
+    const u32 block = 1;
+    ASSERT_EQ(0u, offsets[block] >> 63);
+    const std::vector<u8> garbage(offsets[block + 1] - offsets[block], 0xFF);
+    file.Seek(data_offset + offsets[block], SEEK_SET);
+    ASSERT_TRUE(file.WriteBytes(garbage.data(), garbage.size()));
+  }
+
+  EXPECT_FALSE(DiscIO::DecompressBlobToFile(m_gcz_path, m_output_path, Callback));
+  EXPECT_FALSE(File::Exists(m_output_path));
+}
@@ -0,0 +1,239 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/DCZBlob.h"
+
+namespace
+{
+constexpr u64 PARTITION_OFFSET = 0x50000;
+constexpr u64 PARTITION_DATA_OFFSET = PARTITION_OFFSET + 0x20000;
+constexpr u32 CLUSTER_HEADER_SIZE = 0x400;
+constexpr u32 CLUSTER_DATA_SIZE = 0x7C00;
+constexpr u32 CLUSTER_SIZE = 0x8000;
+constexpr u32 CLUSTERS_PER_GROUP = 64;
+// One full group of clusters and one incomplete group
+constexpr u32 NUM_CLUSTERS = 80;
+// Filled with garbage, so its hash block doesn't match its data
+constexpr u32 GARBAGE_CLUSTER = 70;
+constexpr u64 TRAILER_SIZE = 0x12345;
+constexpr u64 DISC_SIZE = PARTITION_DATA_OFFSET + NUM_CLUSTERS * CLUSTER_SIZE + TRAILER_SIZE;
+
+bool Callback(const std::string&, float, void*)
+{
+  return true;
+}
+
+void WriteBE32(std::vector<u8>* disc, u64 offset, u32 value)
+{
+  const u32 swapped = Common::swap32(value);
+  std::memcpy(disc->data() + offset, &swapped, sizeof(swapped));
+}
+
+// Builds the hash blocks of a group of clusters the way a real disc has them:
+// H0 hashes every 0x400 bytes of data, H1 every cluster's H0 table, H2 every subgroup's H1 table
+void GenerateHashBlocks(const u8* data, u32 num_clusters, u8* hash_blocks)
+{
+  std::fill(hash_blocks, hash_blocks + num_clusters * CLUSTER_HEADER_SIZE, 0);
+  u8 h1[8][8 * 20] = {};
+  u8 h2[8 * 20] = {};
+
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    u8* hash_block = hash_blocks + i * CLUSTER_HEADER_SIZE;
+    for (u32 j = 0; j < 31; ++j)
+      mbedtls_sha1(data + i * CLUSTER_DATA_SIZE + j * 0x400, 0x400, hash_block + j * 20);
+    mbedtls_sha1(hash_block, 31 * 20, h1[i / 8] + i % 8 * 20);
+  }
+
+  for (u32 i = 0; i < (num_clusters + 7) / 8; ++i)
+    mbedtls_sha1(h1[i], sizeof(h1[i]), h2 + i * 20);
+
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    std::copy(std::begin(h1[i / 8]), std::end(h1[i / 8]),
+              hash_blocks + i * CLUSTER_HEADER_SIZE + 0x280);
+    std::copy(std::begin(h2), std::end(h2), hash_blocks + i * CLUSTER_HEADER_SIZE + 0x340);
+  }
+}
+
+class DCZBlobTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_temp_dir = File::CreateTempDir();
+    m_input_path = m_temp_dir + "/input.iso";
+    m_dcz_path = m_temp_dir + "/input.dcz";
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  // A Wii disc with a single partition between two raw regions
+  void BuildWiiDisc()
+  {
+    m_disc.assign(DISC_SIZE, 0);
+    std::mt19937 rng(1234);
+
+    WriteBE32(&m_disc, 0x18, 0x5D1C9EA3);
+    WriteBE32(&m_disc, 0x40000, 1);
+    WriteBE32(&m_disc, 0x40004, 0x40020 >> 2);
+    WriteBE32(&m_disc, 0x40020, PARTITION_OFFSET >> 2);
+    WriteBE32(&m_disc, 0x40024, 0);
+
+    std::vector<u8> ticket(sizeof(IOS::ES::Ticket));
+    WriteBE32(&ticket, 0, 0x10001);  // RSA-2048 signature
+    for (size_t i = 0; i < 16; ++i)
+      ticket[offsetof(IOS::ES::Ticket, title_key) + i] = static_cast<u8>(rng());
+    WriteBE32(&ticket, offsetof(IOS::ES::Ticket, title_id), 0x00010000);
+    WriteBE32(&ticket, offsetof(IOS::ES::Ticket, title_id) + 4, 0x52534245);
+    std::copy(ticket.begin(), ticket.end(), m_disc.begin() + PARTITION_OFFSET);
+    WriteBE32(&m_disc, PARTITION_OFFSET + 0x2B8, 0x20000 >> 2);
+    WriteBE32(&m_disc, PARTITION_OFFSET + 0x2BC, NUM_CLUSTERS * CLUSTER_SIZE >> 2);
+
+    const std::array<u8, 16> title_key = IOS::ES::TicketReader(ticket).GetTitleKey();
+    mbedtls_aes_context aes_context;
+    mbedtls_aes_setkey_enc(&aes_context, title_key.data(), 128);
+
+    m_decrypted.resize(NUM_CLUSTERS * CLUSTER_DATA_SIZE);
+    for (size_t i = 0; i < m_decrypted.size(); ++i)
+      m_decrypted[i] = static_cast<u8>(i / CLUSTER_DATA_SIZE * 7 + i / 0x100);
+
+    for (u32 group = 0; group < NUM_CLUSTERS; group += CLUSTERS_PER_GROUP)
+    {
+      const u32 num_clusters = std::min(CLUSTERS_PER_GROUP, NUM_CLUSTERS - group);
+      std::vector<u8> hash_blocks(num_clusters * CLUSTER_HEADER_SIZE);
+      GenerateHashBlocks(m_decrypted.data() + group * CLUSTER_DATA_SIZE, num_clusters,
+                         hash_blocks.data());
+
+      for (u32 i = 0; i < num_clusters; ++i)
+      {
+        u8* out = m_disc.data() + PARTITION_DATA_OFFSET + (group + i) * CLUSTER_SIZE;
+        u8 iv[16] = {};
+        mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_ENCRYPT, CLUSTER_HEADER_SIZE, iv,
+                              hash_blocks.data() + i * CLUSTER_HEADER_SIZE, out);
+        std::copy(out + 0x3D0, out + 0x3E0, iv);
+        mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_ENCRYPT, CLUSTER_DATA_SIZE, iv,
+                              m_decrypted.data() + (group + i) * CLUSTER_DATA_SIZE,
+                              out + CLUSTER_HEADER_SIZE);
+      }
+    }
+
+    u8* garbage = m_disc.data() + PARTITION_DATA_OFFSET + GARBAGE_CLUSTER * CLUSTER_SIZE;
+    std::generate(garbage, garbage + CLUSTER_SIZE, [&rng] { return static_cast<u8>(rng()); });
+
+    for (u64 i = DISC_SIZE - TRAILER_SIZE; i < DISC_SIZE; ++i)
+      m_disc[i] = static_cast<u8>(i % 251);
+
+    WriteInput();
+  }
+
+  void WriteInput()
+  {
+    File::IOFile file(m_input_path, "wb");
+    ASSERT_TRUE(file.WriteBytes(m_disc.data(), m_disc.size()));
+  }
+
+  std::unique_ptr<DiscIO::BlobReader> Convert()
+  {
+    EXPECT_TRUE(DiscIO::ConvertToDCZ(m_input_path, m_dcz_path, DiscIO::DCZ_DEFAULT_CHUNK_SIZE,
+                                     Callback));
+    std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_dcz_path);
+    EXPECT_NE(nullptr, reader);
+    if (reader)
+    {
+      EXPECT_EQ(DiscIO::BlobType::DCZ, reader->GetBlobType());
+      EXPECT_EQ(m_disc.size(), reader->GetDataSize());
+    }
+    return reader;
+  }
+
+  void ExpectSameData(DiscIO::BlobReader* reader, u64 offset, u64 size)
+  {
+    std::vector<u8> data(size);
+    ASSERT_TRUE(reader->Read(offset, size, data.data()));
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), m_disc.begin() + offset))
+        << "offset " << offset << ", size " << size;
+  }
+
+  std::string m_temp_dir;
+  std::string m_input_path;
+  std::string m_dcz_path;
+  std::vector<u8> m_disc;
+  std::vector<u8> m_decrypted;
+};
+}  // namespace
+
+TEST_F(DCZBlobTest, RawDisc)
+{
+  std::mt19937 rng(5678);
+  m_disc.resize(0x345678);
+  for (size_t i = 0; i < m_disc.size(); ++i)
+    m_disc[i] = i < 0x100000 ? static_cast<u8>(rng()) : static_cast<u8>(i / 0x1000);
+  WriteInput();
+
+  std::unique_ptr<DiscIO::BlobReader> reader = Convert();
+  ASSERT_NE(nullptr, reader);
+  EXPECT_FALSE(reader->SupportsReadWiiDecrypted());
+  ExpectSameData(reader.get(), 0, m_disc.size());
+  ExpectSameData(reader.get(), DiscIO::DCZ_DEFAULT_CHUNK_SIZE - 10, 20);
+  EXPECT_LT(reader->GetRawSize(), m_disc.size());
+}
+
+TEST_F(DCZBlobTest, WiiDisc)
+{
+  BuildWiiDisc();
+
+  std::unique_ptr<DiscIO::BlobReader> reader = Convert();
+  ASSERT_NE(nullptr, reader);
+  ExpectSameData(reader.get(), 0, m_disc.size());
+
+  // Reads crossing the region borders and the garbage cluster
+  ExpectSameData(reader.get(), PARTITION_DATA_OFFSET - 100, 300);
+  ExpectSameData(reader.get(), PARTITION_DATA_OFFSET + CLUSTER_SIZE * CLUSTERS_PER_GROUP - 5, 10);
+  ExpectSameData(reader.get(), PARTITION_DATA_OFFSET + GARBAGE_CLUSTER * CLUSTER_SIZE + 0x3F0,
+                 0x20);
+  ExpectSameData(reader.get(), DISC_SIZE - TRAILER_SIZE - 1, 2);
+
+  // Everything but the garbage cluster compresses well, since it's stored decrypted
+  EXPECT_LT(reader->GetRawSize(), 3 * CLUSTER_SIZE);
+}
+
+TEST_F(DCZBlobTest, WiiDiscReadDecrypted)
+{
+  BuildWiiDisc();
+
+  std::unique_ptr<DiscIO::BlobReader> reader = Convert();
+  ASSERT_NE(nullptr, reader);
+  ASSERT_TRUE(reader->SupportsReadWiiDecrypted());
+
+  const u64 before_garbage = GARBAGE_CLUSTER * CLUSTER_DATA_SIZE;
+  std::vector<u8> data(before_garbage);
+  ASSERT_TRUE(reader->ReadWiiDecrypted(0, data.size(), data.data(), PARTITION_OFFSET));
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), m_decrypted.begin()));
+
+  const u64 after_garbage = (GARBAGE_CLUSTER + 1) * CLUSTER_DATA_SIZE;
+  data.resize(m_decrypted.size() - after_garbage);
+  ASSERT_TRUE(reader->ReadWiiDecrypted(after_garbage, data.size(), data.data(), PARTITION_OFFSET));
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), m_decrypted.begin() + after_garbage));
+
+  EXPECT_FALSE(reader->ReadWiiDecrypted(0, 1, data.data(), PARTITION_OFFSET + 1));
+}
@@ -0,0 +1,190 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TevJit.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+// The color and depth bytes of a pixel, and whether it passed all tests
+struct PixelResult
+{
+  std::array<u8, 3> color;
+  std::array<u8, 3> depth;
+  u32 pixels_out;
+
+  bool operator==(const PixelResult& other) const
+  {
+    return color == other.color && depth == other.depth && pixels_out == other.pixels_out;
+  }
+};
+}  // namespace
+
+class TevJitTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::memset(static_cast<void*>(&bpmem), 0, sizeof(bpmem));
+    g_ActiveConfig.bDumpTevStages = false;
+    g_ActiveConfig.bDumpTevTextureFetches = false;
+    m_tev = std::make_unique<Tev>();
+    m_tev->Init();
+  }
+
+  void TearDown() override { TevJit::Shutdown(); }
+
+  // Random combiners, alpha test, depth test and blending, without textures, indirect stages and
+  // fog, which the JIT doesn't deal with
+  void RandomizeState()
+  {
+    bpmem.genMode.numtevstages = m_rng() % 16;
+    for (TevStageCombiner& combiner : bpmem.combiners)
+    {
+      combiner.colorC.hex = m_rng() & 0xFFFFFF;
+      combiner.alphaC.hex = m_rng() & 0xFFFFFF;
+
+      // Compare modes are interpreted, so most stages shouldn't use them
+      if (m_rng() % 8 != 0)
+      {
+        if (combiner.colorC.bias == 3)
+          combiner.colorC.bias = m_rng() % 3;
+        if (combiner.alphaC.bias == 3)
+          combiner.alphaC.bias = m_rng() % 3;
+      }
+    }
+    // Only the rasterized color channels
+    for (TwoTevStageOrders& order : bpmem.tevorders)
+      order.hex = m_rng() & 0x380380;
+    for (TevKSel& ksel : bpmem.tevksel)
+      ksel.hex = m_rng() & 0xFFFFFF;
+
+    bpmem.alpha_test.hex = m_rng() & 0xFFFFFF;
+    bpmem.zmode.hex = m_rng() & 0x1F;
+    bpmem.blendmode.hex = m_rng() & 0xFFFF;
+    bpmem.dstalpha.hex = m_rng() & 0x1FF;
+    bpmem.zcontrol.hex = m_rng() % 4;
+
+    for (int i = 0; i < 4; i++)
+    {
+      for (int comp = 0; comp < 4; comp++)
+      {
+        PixelShaderManager::constants.colors[i][comp] = static_cast<int>(m_rng() % 2048) - 1024;
+        m_tev->SetRegColor(i, comp, static_cast<s16>(m_rng() % 256));
+      }
+    }
+    for (auto& color : m_tev->Color)
+    {
+      for (u8& comp : color)
+        comp = static_cast<u8>(m_rng());
+    }
+
+    m_tev->Position[0] = m_rng() % EFB_WIDTH;
+    m_tev->Position[1] = m_rng() % EFB_HEIGHT;
+    m_tev->Position[2] = m_rng() & 0xFFFFFF;
+
+    u8* color = EfbInterface::GetPixelPointer(m_tev->Position[0], m_tev->Position[1], false);
+    u8* depth = EfbInterface::GetPixelPointer(m_tev->Position[0], m_tev->Position[1], true);
+    for (int i = 0; i < 3; i++)
+    {
+      color[i] = static_cast<u8>(m_rng());
+      depth[i] = static_cast<u8>(m_rng());
+    }
+    // Make the equal compare modes pass sometimes
+    if (m_rng() % 4 == 0)
+      std::memcpy(depth, &m_tev->Position[2], 3);
+  }
+
+  PixelResult Draw(const TevJit::PixelFunctions& functions)
+  {
+    const s32 z = m_tev->Position[2];
+    const u32 pixels_out = m_tev->counters.tev_pixels_out;
+    m_tev->SetPixelJit(functions);
+    m_tev->Draw();
+    m_tev->Position[2] = z;
+
+    PixelResult result;
+    const u8* color = EfbInterface::GetPixelPointer(m_tev->Position[0], m_tev->Position[1], false);
+    const u8* depth = EfbInterface::GetPixelPointer(m_tev->Position[0], m_tev->Position[1], true);
+    std::memcpy(result.color.data(), color, 3);
+    std::memcpy(result.depth.data(), depth, 3);
+    result.pixels_out = m_tev->counters.tev_pixels_out - pixels_out;
+    return result;
+  }
+
+  std::mt19937 m_rng{1234};
+  std::unique_ptr<Tev> m_tev;
+};
+
+TEST_F(TevJitTest, MatchesInterpreter)
+{
+  int compiled_combiners = 0;
+  for (int i = 0; i < 20000; i++)
+  {
+    RandomizeState();
+    const TevJit::PixelFunctions functions = TevJit::GetPixelFunctions();
+    ASSERT_NE(nullptr, functions.depth);
+    ASSERT_NE(nullptr, functions.blend);
+    if (functions.combiners)
+      compiled_combiners++;
+
+    u8* color = EfbInterface::GetPixelPointer(m_tev->Position[0], m_tev->Position[1], false);
+    u8* depth = EfbInterface::GetPixelPointer(m_tev->Position[0], m_tev->Position[1], true);
+    u8 old_color[3];
+    u8 old_depth[3];
+    std::memcpy(old_color, color, 3);
+    std::memcpy(old_depth, depth, 3);
+
+    const PixelResult interpreted = Draw({});
+    std::memcpy(color, old_color, 3);
+    std::memcpy(depth, old_depth, 3);
+    const PixelResult compiled = Draw(functions);
+
+    ASSERT_TRUE(interpreted == compiled)
+        << "iteration " << i << ", stages " << bpmem.genMode.numtevstages + 1 << ", alpha test "
+        << std::hex << bpmem.alpha_test.hex << ", zmode " << bpmem.zmode.hex << ", blendmode "
+        << bpmem.blendmode.hex << ", dstalpha " << bpmem.dstalpha.hex << ", format "
+        << bpmem.zcontrol.hex;
+  }
+
+  EXPECT_GT(compiled_combiners, 10000);
+}
+
+TEST_F(TevJitTest, UnsupportedPixelFormat)
+{
+  bpmem.zcontrol.pixel_format = PEControl::Y8;
+  const TevJit::PixelFunctions functions = TevJit::GetPixelFunctions();
+  EXPECT_NE(nullptr, functions.combiners);
+  EXPECT_EQ(nullptr, functions.depth);
+  EXPECT_EQ(nullptr, functions.blend);
+}
+
+TEST_F(TevJitTest, CacheIsBounded)
+{
+  // Far more programs than fit into the cache, which would take hundreds of megabytes if none
+  // were freed
+  for (u32 i = 0; i < 0x10000; i++)
+  {
+    bpmem.blendmode.hex = i;
+    ASSERT_NE(nullptr, TevJit::GetPixelFunctions().blend);
+  }
+
+  // Programs compiled after clearing the cache still work
+  RandomizeState();
+  const PixelResult compiled = Draw(TevJit::GetPixelFunctions());
+  EXPECT_LE(compiled.pixels_out, 1u);
+}
@@ -0,0 +1,240 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TevJit.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+// The inputs of a pixel which the rasterizer sets up for the Tev
+struct PixelInputs
+{
+  s32 position[3];
+  u8 color[2][4];
+};
+
+// The color and depth bytes of the pixels of a quad
+using QuadResult = std::array<std::array<u8, 6>, 4>;
+}  // namespace
+
+class TevTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::memset(static_cast<void*>(&bpmem), 0, sizeof(bpmem));
+    std::memset(static_cast<void*>(&xfmem), 0, sizeof(xfmem));
+    g_ActiveConfig.bDumpTevStages = false;
+    g_ActiveConfig.bDumpTevTextureFetches = false;
+    m_tev = std::make_unique<Tev>();
+    m_tev->Init();
+  }
+
+  void TearDown() override
+  {
+#ifdef _M_X86
+    TevJit::Shutdown();
+#endif
+  }
+
+  // Random combiners including the compare modes, alpha test, z texture, fog, depth test and
+  // blending, for up to four pixels of a quad. Textures and indirect stages are left out.
+  void RandomizeState()
+  {
+    bpmem.genMode.numtevstages = m_rng() % 16;
+    for (TevStageCombiner& combiner : bpmem.combiners)
+    {
+      combiner.colorC.hex = m_rng() & 0xFFFFFF;
+      combiner.alphaC.hex = m_rng() & 0xFFFFFF;
+    }
+    // Only the rasterized color channels
+    for (TwoTevStageOrders& order : bpmem.tevorders)
+      order.hex = m_rng() & 0x380380;
+    for (TevKSel& ksel : bpmem.tevksel)
+      ksel.hex = m_rng() & 0xFFFFFF;
+
+    bpmem.alpha_test.hex = m_rng() & 0xFFFFFF;
+    bpmem.ztex1.bias = m_rng() & 0xFFFFFF;
+    bpmem.ztex2.hex = m_rng() & 0xF;
+    bpmem.zmode.hex = m_rng() & 0x1F;
+    bpmem.zcontrol.hex = m_rng() & 0x43;
+    bpmem.blendmode.hex = m_rng() & 0xFFFF;
+    bpmem.dstalpha.hex = m_rng() & 0x1FF;
+    g_ActiveConfig.bZComploc = m_rng() % 2 != 0;
+
+    bpmem.fog.a.hex = m_rng() & 0xFFFFF;
+    bpmem.fog.b_magnitude = m_rng() & 0xFFFFFF;
+    bpmem.fog.b_shift = m_rng() % 24;
+    bpmem.fog.c_proj_fsel.hex = m_rng() & 0xFFFFFF;
+    // Mostly values which don't saturate the fog, but also infinities and NaNs
+    if (m_rng() % 8 != 0)
+    {
+      bpmem.fog.a.exp = 124 + m_rng() % 6;
+      bpmem.fog.c_proj_fsel.c_exp = 120 + m_rng() % 8;
+      bpmem.fog.b_magnitude = (m_rng() & 0xFFFFF) + 0x100000;
+    }
+    else if (m_rng() % 2 != 0)
+    {
+      bpmem.fog.a.exp = 255;
+    }
+    bpmem.fog.color.hex = m_rng() & 0xFFFFFF;
+    bpmem.fogRange.Base.hex = m_rng() & 0x7FF;
+    for (FogRangeKElement& k : bpmem.fogRange.K)
+      k.HEX = m_rng() & 0xFFFFFF;
+    xfmem.viewport.wd = static_cast<float>(m_rng() % 640 + 1);
+
+    for (int i = 0; i < 4; i++)
+    {
+      for (int comp = 0; comp < 4; comp++)
+      {
+        PixelShaderManager::constants.colors[i][comp] = static_cast<int>(m_rng() % 2048) - 1024;
+        m_tev->SetRegColor(i, comp, static_cast<s16>(m_rng() % 256));
+      }
+    }
+
+    // A random subset of the quad at a random position
+    const s32 x = (m_rng() % (EFB_WIDTH / 2)) * 2;
+    const s32 y = (m_rng() % (EFB_HEIGHT / 2)) * 2;
+    m_pixels.clear();
+    for (s32 i = 0; i < 4; i++)
+    {
+      if (m_rng() % 4 == 0)
+        continue;
+
+      PixelInputs pixel;
+      pixel.position[0] = x + (i & 1);
+      pixel.position[1] = y + (i >> 1);
+      pixel.position[2] = m_rng() & 0xFFFFFF;
+      for (auto& color : pixel.color)
+      {
+        for (u8& comp : color)
+          comp = static_cast<u8>(m_rng());
+      }
+      m_pixels.push_back(pixel);
+
+      u8* efb_color = EfbInterface::GetPixelPointer(pixel.position[0], pixel.position[1], false);
+      u8* efb_depth = EfbInterface::GetPixelPointer(pixel.position[0], pixel.position[1], true);
+      for (int j = 0; j < 3; j++)
+      {
+        efb_color[j] = static_cast<u8>(m_rng());
+        efb_depth[j] = static_cast<u8>(m_rng());
+      }
+    }
+  }
+
+  void SetInputs(const PixelInputs& pixel)
+  {
+    std::memcpy(m_tev->Position, pixel.position, sizeof(pixel.position));
+    std::memcpy(m_tev->Color, pixel.color, sizeof(pixel.color));
+  }
+
+  QuadResult ReadResult() const
+  {
+    QuadResult result = {};
+    for (size_t i = 0; i < m_pixels.size(); i++)
+    {
+      const s32* position = m_pixels[i].position;
+      std::memcpy(&result[i][0], EfbInterface::GetPixelPointer(position[0], position[1], false),
+                  3);
+      std::memcpy(&result[i][3], EfbInterface::GetPixelPointer(position[0], position[1], true),
+                  3);
+    }
+    return result;
+  }
+
+  void WriteResult(const QuadResult& result) const
+  {
+    for (size_t i = 0; i < m_pixels.size(); i++)
+    {
+      const s32* position = m_pixels[i].position;
+      std::memcpy(EfbInterface::GetPixelPointer(position[0], position[1], false), &result[i][0],
+                  3);
+      std::memcpy(EfbInterface::GetPixelPointer(position[0], position[1], true), &result[i][3],
+                  3);
+    }
+  }
+
+  // Draws the pixels one at a time and as a quad, starting from the same EFB contents
+  void ExpectSameResults(int iteration)
+  {
+    const QuadResult initial = ReadResult();
+    const Tev::Counters initial_counters = m_tev->counters;
+
+    for (const PixelInputs& pixel : m_pixels)
+    {
+      SetInputs(pixel);
+      m_tev->Draw();
+    }
+    const QuadResult single = ReadResult();
+    const Tev::Counters single_counters = m_tev->counters;
+
+    WriteResult(initial);
+    m_tev->counters = initial_counters;
+    for (const PixelInputs& pixel : m_pixels)
+    {
+      SetInputs(pixel);
+      m_tev->AddPixel();
+    }
+    m_tev->DrawQuad();
+    const QuadResult quad = ReadResult();
+    const Tev::Counters& quad_counters = m_tev->counters;
+
+    ASSERT_EQ(single, quad) << "iteration " << iteration << ", pixels " << m_pixels.size()
+                            << ", stages " << bpmem.genMode.numtevstages + 1 << std::hex
+                            << ", alpha test " << bpmem.alpha_test.hex << ", fog "
+                            << bpmem.fog.c_proj_fsel.hex << ", fog range "
+                            << bpmem.fogRange.Base.hex << ", ztex " << bpmem.ztex2.hex;
+    ASSERT_EQ(single_counters.tev_pixels_in, quad_counters.tev_pixels_in);
+    ASSERT_EQ(single_counters.tev_pixels_out, quad_counters.tev_pixels_out);
+    for (int i = 0; i < PQ_NUM_MEMBERS; i++)
+      ASSERT_EQ(single_counters.perf_pixels[i], quad_counters.perf_pixels[i]);
+    for (int i = 0; i < 4; i++)
+      ASSERT_EQ(single_counters.bounding_box[i], quad_counters.bounding_box[i]);
+  }
+
+  std::mt19937 m_rng{1234};
+  std::unique_ptr<Tev> m_tev;
+  std::vector<PixelInputs> m_pixels;
+};
+
+TEST_F(TevTest, QuadMatchesSinglePixels)
+{
+  for (int i = 0; i < 20000; i++)
+  {
+    RandomizeState();
+    m_tev->SetPixelJit({});
+    ExpectSameResults(i);
+    if (HasFatalFailure())
+      return;
+  }
+}
+
+#ifdef _M_X86
+TEST_F(TevTest, QuadMatchesSinglePixelsWithJit)
+{
+  for (int i = 0; i < 20000; i++)
+  {
+    RandomizeState();
+    m_tev->SetPixelJit(TevJit::GetPixelFunctions());
+    ExpectSameResults(i);
+    if (HasFatalFailure())
+      return;
+  }
+}
+#endif
@@ -0,0 +1,160 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/TransformUnit.h"
+#include "VideoBackends/Software/Vec3.h"
+#include "VideoCommon/XFMemory.h"
+
+class TransformUnitTest : public testing::Test
+{
+protected:
+  void SetUp() override { std::memset(static_cast<void*>(&xfmem), 0, sizeof(xfmem)); }
+
+  float RandomFloat(float min, float max)
+  {
+    return std::uniform_real_distribution<float>(min, max)(m_rng);
+  }
+
+  Vec3 RandomVec3(float min, float max)
+  {
+    return Vec3(RandomFloat(min, max), RandomFloat(min, max), RandomFloat(min, max));
+  }
+
+  // Random matrices, projection and lights. The lights are placed away from the vertices, which
+  // keeps spot lights from dividing by a zero distance.
+  void RandomizeState(u32 projection_type)
+  {
+    for (float& value : xfmem.posMatrices)
+      value = RandomFloat(-2.0f, 2.0f);
+    for (float& value : xfmem.normalMatrices)
+      value = RandomFloat(-2.0f, 2.0f);
+    for (float& value : xfmem.projection.rawProjection)
+      value = RandomFloat(-2.0f, 2.0f);
+    xfmem.projection.type = projection_type;
+
+    for (Light& light : xfmem.lights)
+    {
+      for (u8& comp : light.color)
+        comp = static_cast<u8>(m_rng());
+      for (int i = 0; i < 3; i++)
+      {
+        light.cosatt[i] = RandomFloat(-1.0f, 1.0f);
+        light.distatt[i] = RandomFloat(0.0f, 1.0f);
+        light.dpos[i] = RandomFloat(-1000.0f, 1000.0f);
+        light.ddir[i] = RandomFloat(-1.0f, 1.0f);
+      }
+    }
+
+    for (u32 chan = 0; chan < NUM_XF_COLOR_CHANNELS; chan++)
+    {
+      xfmem.ambColor[chan] = m_rng();
+      xfmem.matColor[chan] = m_rng();
+    }
+  }
+
+  void RandomizeVertices(InputVertexData* vertices, u32 count)
+  {
+    for (u32 i = 0; i < count; i++)
+    {
+      InputVertexData& vertex = vertices[i];
+      vertex = {};
+      vertex.posMtx = static_cast<u8>((m_rng() % 10) * 3);
+      vertex.position = RandomVec3(-100.0f, 100.0f);
+      for (Vec3& normal : vertex.normal)
+        normal = RandomVec3(-1.0f, 1.0f);
+      for (auto& color : vertex.color)
+      {
+        for (u8& comp : color)
+          comp = static_cast<u8>(m_rng());
+      }
+    }
+  }
+
+  // A random light mask on top of the given matsource, enablelighting and ambsource bits
+  void SetChannel(LitChannel* channel, u32 config, u32 diffuse_func, u32 attn_func)
+  {
+    channel->hex = 0;
+    channel->matsource = config & 1;
+    channel->enablelighting = (config >> 1) & 1;
+    channel->ambsource = (config >> 2) & 1;
+    channel->diffusefunc = diffuse_func;
+    channel->attnfunc = attn_func;
+    channel->lightMask0_3 = m_rng() & 0xF;
+    channel->lightMask4_7 = m_rng() & 0xF;
+  }
+
+  std::mt19937 m_rng{0x5EED};
+};
+
+static bool SameBits(const void* a, const void* b, size_t size)
+{
+  return std::memcmp(a, b, size) == 0;
+}
+
+// The batched transform has to give bit-identical results to transforming each vertex on its
+// own, for every kind of light and channel configuration.
+TEST_F(TransformUnitTest, BatchMatchesScalar)
+{
+  const u32 projection_types[] = {GX_PERSPECTIVE, GX_ORTHOGRAPHIC};
+  for (u32 projection_type : projection_types)
+  {
+    for (u32 attn_func = LIGHTATTN_NONE; attn_func <= LIGHTATTN_SPOT; attn_func++)
+    {
+      for (u32 diffuse_func = LIGHTDIF_NONE; diffuse_func <= LIGHTDIF_CLAMP; diffuse_func++)
+      {
+        // Every combination of matsource, enablelighting and ambsource for the color and the
+        // alpha part of the first channel. The second channel gets random ones.
+        for (u32 config = 0; config < 64; config++)
+        {
+          RandomizeState(projection_type);
+          SetChannel(&xfmem.color[0], config & 7, diffuse_func, attn_func);
+          SetChannel(&xfmem.alpha[0], config >> 3, diffuse_func, attn_func);
+          SetChannel(&xfmem.color[1], m_rng() & 7, diffuse_func, attn_func);
+          SetChannel(&xfmem.alpha[1], m_rng() & 7, diffuse_func, attn_func);
+
+          const u32 count = m_rng() % TransformUnit::VERTEX_BATCH_SIZE + 1;
+          const bool has_normals = m_rng() % 4 != 0;
+          const bool nbt = has_normals && m_rng() % 2 != 0;
+          InputVertexData src[TransformUnit::VERTEX_BATCH_SIZE];
+          RandomizeVertices(src, count);
+
+          OutputVertexData expected[TransformUnit::VERTEX_BATCH_SIZE];
+          for (u32 i = 0; i < count; i++)
+          {
+            TransformUnit::TransformPosition(&src[i], &expected[i]);
+            if (has_normals)
+              TransformUnit::TransformNormal(&src[i], nbt, &expected[i]);
+            TransformUnit::TransformColor(&src[i], &expected[i]);
+            TransformUnit::TransformTexCoord(&src[i], &expected[i], false);
+          }
+
+          OutputVertexData actual[TransformUnit::VERTEX_BATCH_SIZE];
+          TransformUnit::TransformVertices(src, actual, count, has_normals, nbt, false);
+
+          for (u32 i = 0; i < count; i++)
+          {
+            SCOPED_TRACE(testing::Message()
+                         << "projection " << projection_type << ", attn " << attn_func
+                         << ", diffuse " << diffuse_func << ", config " << config << ", vertex "
+                         << i << " of " << count << ", normals " << has_normals << ", nbt "
+                         << nbt);
+            EXPECT_TRUE(SameBits(&expected[i].mvPosition, &actual[i].mvPosition, sizeof(Vec3)));
+            EXPECT_TRUE(SameBits(&expected[i].projectedPosition, &actual[i].projectedPosition,
+                                 sizeof(Vec4)));
+            EXPECT_TRUE(SameBits(expected[i].normal.data(), actual[i].normal.data(),
+                                 sizeof(expected[i].normal)));
+            EXPECT_EQ(expected[i].color, actual[i].color);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,115 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/Align.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "UICommon/UICommon.h"
+#include "VideoCommon/DecodedTextureCache.h"
+#include "VideoCommon/TextureDecoder.h"
+
+class DecodedTextureCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_profile_path); }
+
+  // Decodes all levels one after another, the way the texture cache does it
+  static std::vector<u8> DecodeLevels(const std::vector<u8>& src, u32 width, u32 height,
+                                      u32 levels, TextureFormat format)
+  {
+    const u32 block_width = TexDecoder_GetBlockWidthInTexels(format);
+    const u32 block_height = TexDecoder_GetBlockHeightInTexels(format);
+
+    std::vector<u8> decoded;
+    const u8* src_ptr = src.data();
+    for (u32 level = 0; level < levels; ++level)
+    {
+      const u32 expanded_width = Common::AlignUp(std::max(width >> level, 1u), block_width);
+      const u32 expanded_height = Common::AlignUp(std::max(height >> level, 1u), block_height);
+      const size_t offset = decoded.size();
+      decoded.resize(offset + expanded_width * expanded_height * sizeof(u32));
+      TexDecoder_Decode(decoded.data() + offset, src_ptr, expanded_width, expanded_height, format,
+                        nullptr, TLUTFormat::IA8);
+      src_ptr += TexDecoder_GetTextureSizeInBytes(expanded_width, expanded_height, format);
+    }
+    return decoded;
+  }
+
+  std::string m_profile_path;
+};
+
+TEST_F(DecodedTextureCacheTest, DecodedSizePadsLevelsToBlocks)
+{
+  // 16x16, 8x8, and the 4x4, 2x2 and 1x1 levels padded to a whole 8x8 CMPR block. Dividing the
+  // size by 4 for every level would only give 1364 bytes.
+  EXPECT_EQ(16u * 16 * 4 + 4 * 8 * 8 * 4,
+            DecodedTextureCache::GetDecodedSize(16, 16, 5, TextureFormat::CMPR));
+  // 64x4, 32x2 and 16x1, all padded to a height of 8
+  EXPECT_EQ((64u + 32 + 16) * 8 * 4,
+            DecodedTextureCache::GetDecodedSize(64, 4, 3, TextureFormat::CMPR));
+  // I8 uses 8x4 blocks, RGBA8 uses 4x4 blocks
+  EXPECT_EQ(8u * 4 * 4 + 8 * 4 * 4,
+            DecodedTextureCache::GetDecodedSize(2, 2, 2, TextureFormat::I8));
+  EXPECT_EQ(32u * 32 * 4, DecodedTextureCache::GetDecodedSize(32, 32, 1, TextureFormat::RGBA8));
+}
+
+TEST_F(DecodedTextureCacheTest, MipmappedCMPR)
+{
+  constexpr u32 WIDTH = 32;
+  constexpr u32 HEIGHT = 16;
+  constexpr u32 LEVELS = 6;
+
+  size_t src_size = 0;
+  for (u32 level = 0; level < LEVELS; ++level)
+  {
+    src_size += TexDecoder_GetTextureSizeInBytes(
+        Common::AlignUp(std::max(WIDTH >> level, 1u), 8u),
+        Common::AlignUp(std::max(HEIGHT >> level, 1u), 8u), TextureFormat::CMPR);
+  }
+  std::vector<u8> src(src_size);
+  std::mt19937 rng(1234);
+  std::generate(src.begin(), src.end(), [&rng] { return static_cast<u8>(rng()); });
+
+  const std::vector<u8> decoded = DecodeLevels(src, WIDTH, HEIGHT, LEVELS, TextureFormat::CMPR);
+  const size_t size =
+      DecodedTextureCache::GetDecodedSize(WIDTH, HEIGHT, LEVELS, TextureFormat::CMPR);
+  ASSERT_EQ(decoded.size(), size);
+
+  const DecodedTextureCache::Key key =
+      DecodedTextureCache::MakeKey(src.data(), src.size(), nullptr, 0, WIDTH, HEIGHT, LEVELS,
+                                   TextureFormat::CMPR, TLUTFormat::IA8);
+  {
+    DecodedTextureCache cache;
+    cache.Open("TEST01");
+    cache.Insert(key, decoded.data(), decoded.size());
+  }
+
+  // The entry has to survive being written to and read back from the file
+  DecodedTextureCache cache;
+  cache.Open("TEST01");
+  std::vector<u8> cached(size);
+  ASSERT_TRUE(cache.Lookup(key, cached.data(), size));
+  EXPECT_EQ(decoded, cached);
+
+  EXPECT_FALSE(cache.Lookup(key, cached.data(), size - 1));
+
+  src[src.size() - 1] ^= 1;
+  const DecodedTextureCache::Key changed_key =
+      DecodedTextureCache::MakeKey(src.data(), src.size(), nullptr, 0, WIDTH, HEIGHT, LEVELS,
+                                   TextureFormat::CMPR, TLUTFormat::IA8);
+  EXPECT_FALSE(cache.Lookup(changed_key, cached.data(), size));
+}
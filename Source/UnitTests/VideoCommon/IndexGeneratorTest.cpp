@@ -0,0 +1,96 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VideoConfig.h"
+
+class IndexGeneratorTest : public testing::Test
+{
+protected:
+  void SetUp() override { SetPrimitiveRestart(false); }
+  void SetPrimitiveRestart(bool enabled)
+  {
+    g_Config.backend_info.bSupportsPrimitiveRestart = enabled;
+    IndexGenerator::Init();
+  }
+
+  // Generates the indices of two primitives, so that the second one has a base index
+  template <typename T>
+  std::vector<u32> Generate(int primitive, u32 num_vertices)
+  {
+    std::vector<T> buffer(6 * num_vertices + 16);
+    IndexGenerator::Start(buffer.data());
+    IndexGenerator::AddIndices(primitive, num_vertices);
+    IndexGenerator::AddIndices(primitive, num_vertices);
+    EXPECT_EQ(2 * num_vertices, IndexGenerator::GetNumVerts());
+    EXPECT_EQ(sizeof(T), IndexGenerator::GetIndexSize());
+
+    std::vector<u32> indices(buffer.begin(), buffer.begin() + IndexGenerator::GetIndexLen());
+    // Make the primitive restart index the same for both sizes
+    for (u32& index : indices)
+    {
+      if (index == static_cast<T>(-1))
+        index = UINT32_MAX;
+    }
+    return indices;
+  }
+};
+
+TEST_F(IndexGeneratorTest, Quads)
+{
+  SetPrimitiveRestart(true);
+  const std::vector<u32> restart = {1,  2,  0,  3,  UINT32_MAX, 5,  6,  4,  7,  UINT32_MAX,
+                                    9,  10, 8,  11, UINT32_MAX, 13, 14, 12, 15, UINT32_MAX};
+  EXPECT_EQ(restart, Generate<u16>(OpcodeDecoder::GX_DRAW_QUADS, 8));
+
+  SetPrimitiveRestart(false);
+  const std::vector<u32> expected = {0, 1,  2,  0, 2,  3,  4,  5,  6,  4,  6,  7,
+                                     8, 9,  10, 8, 10, 11, 12, 13, 14, 12, 14, 15};
+  EXPECT_EQ(expected, Generate<u16>(OpcodeDecoder::GX_DRAW_QUADS, 8));
+}
+
+TEST_F(IndexGeneratorTest, TriangleStrip)
+{
+  SetPrimitiveRestart(true);
+  const std::vector<u32> restart = {0, 1, 2, 3, 4, UINT32_MAX, 5, 6, 7, 8, 9, UINT32_MAX};
+  EXPECT_EQ(restart, Generate<u16>(OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP, 5));
+
+  SetPrimitiveRestart(false);
+  const std::vector<u32> expected = {0, 1, 2, 1, 3, 2, 2, 3, 4, 5, 6, 7, 6, 8, 7, 7, 8, 9};
+  EXPECT_EQ(expected, Generate<u16>(OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP, 5));
+}
+
+TEST_F(IndexGeneratorTest, SameIndicesForBothSizes)
+{
+  for (bool primitive_restart : {false, true})
+  {
+    SetPrimitiveRestart(primitive_restart);
+    for (int primitive = 0; primitive < 8; ++primitive)
+    {
+      for (u32 num_vertices = 0; num_vertices < 100; ++num_vertices)
+      {
+        EXPECT_EQ(Generate<u16>(primitive, num_vertices), Generate<u32>(primitive, num_vertices))
+            << "primitive restart " << primitive_restart << ", primitive " << primitive << ", "
+            << num_vertices << " vertices";
+      }
+    }
+  }
+}
+
+TEST_F(IndexGeneratorTest, RemainingIndices)
+{
+  std::vector<u32> buffer(16);
+  IndexGenerator::Start(buffer.data());
+  EXPECT_LT(65535u, IndexGenerator::GetRemainingIndices());
+
+  std::vector<u16> short_buffer(16);
+  IndexGenerator::Start(short_buffer.data());
+  EXPECT_EQ(65534u, IndexGenerator::GetRemainingIndices());
+}
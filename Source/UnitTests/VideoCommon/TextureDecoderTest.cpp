@@ -0,0 +1,118 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+constexpr TextureFormat FORMATS[] = {
+    TextureFormat::I4,     TextureFormat::I8,    TextureFormat::IA4,  TextureFormat::IA8,
+    TextureFormat::RGB565, TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::C4,
+    TextureFormat::C8,     TextureFormat::C14X2, TextureFormat::CMPR,
+};
+
+constexpr const char* FORMAT_NAMES[] = {
+    "I4", "I8", "IA4", "IA8", "RGB565", "RGB5A3", "RGBA8", "C4", "C8", "C14X2", "CMPR",
+};
+}
+
+class TextureDecoderTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::mt19937 rng(1234);
+    m_src.resize(1024 * 1024 * 4);
+    for (u8& byte : m_src)
+      byte = static_cast<u8>(rng());
+    // C14X2 textures can index all of the 16384 entries
+    m_tlut.resize(16384 * 2);
+    for (u8& byte : m_tlut)
+      byte = static_cast<u8>(rng());
+  }
+
+  void TearDown() override
+  {
+    cpu_info = CPUInfo();
+    TexDecoder_SetDecodingThreads(1);
+  }
+
+  std::vector<u32> Decode(TextureFormat format, TLUTFormat tlut_format, int width, int height)
+  {
+    std::vector<u32> dst(width * height);
+    TexDecoder_Decode(reinterpret_cast<u8*>(dst.data()), m_src.data(), width, height, format,
+                      m_tlut.data(), tlut_format);
+    return dst;
+  }
+
+  std::vector<u8> m_src;
+  std::vector<u8> m_tlut;
+};
+
+// The SIMD decoders must produce exactly the same texels as the SSE2 ones for every format.
+TEST_F(TextureDecoderTest, SIMDMatchesSSE2)
+{
+  const bool has_ssse3 = cpu_info.bSSSE3;
+  const bool has_avx2 = cpu_info.bAVX2;
+
+  for (TLUTFormat tlut_format : {TLUTFormat::IA8, TLUTFormat::RGB565, TLUTFormat::RGB5A3})
+  {
+    for (size_t i = 0; i < sizeof(FORMATS) / sizeof(FORMATS[0]); i++)
+    {
+      for (int size : {8, 16, 64, 256})
+      {
+        cpu_info.bSSSE3 = false;
+        cpu_info.bAVX2 = false;
+        const std::vector<u32> expected = Decode(FORMATS[i], tlut_format, size, size);
+
+        if (has_ssse3)
+        {
+          cpu_info.bSSSE3 = true;
+          EXPECT_EQ(expected, Decode(FORMATS[i], tlut_format, size, size))
+              << "SSSE3 " << FORMAT_NAMES[i] << " " << size;
+        }
+        if (has_avx2)
+        {
+          cpu_info.bAVX2 = true;
+          EXPECT_EQ(expected, Decode(FORMATS[i], tlut_format, size, size))
+              << "AVX2 " << FORMAT_NAMES[i] << " " << size;
+        }
+      }
+    }
+  }
+}
+
+// Splitting large textures into strips of block rows mustn't change a single texel, even when the
+// number of block rows isn't a multiple of the number of strips.
+TEST_F(TextureDecoderTest, ParallelMatchesSerial)
+{
+  // All of them are large enough to be decoded in parallel, and whole blocks high
+  const std::pair<int, int> sizes[] = {{256, 256}, {256, 264}, {328, 328}, {1024, 72}, {512, 136}};
+
+  for (size_t i = 0; i < sizeof(FORMATS) / sizeof(FORMATS[0]); i++)
+  {
+    for (const auto& size : sizes)
+    {
+      TexDecoder_SetDecodingThreads(1);
+      const std::vector<u32> expected =
+          Decode(FORMATS[i], TLUTFormat::RGB5A3, size.first, size.second);
+
+      for (u32 threads : {2, 3, 4, 7})
+      {
+        TexDecoder_SetDecodingThreads(threads);
+        EXPECT_EQ(expected, Decode(FORMATS[i], TLUTFormat::RGB5A3, size.first, size.second))
+            << FORMAT_NAMES[i] << " " << size.first << "x" << size.second << ", " << threads
+            << " threads";
+      }
+    }
+  }
+}
@@ -0,0 +1,149 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/TexturePack.h"
+
+namespace
+{
+HiresTexture::Level MakeLevel(AbstractTextureFormat format, u32 width, u32 height, u32 row_length,
+                              size_t data_size, bool compressible)
+{
+  static std::mt19937 rng(1234);
+
+  HiresTexture::Level level;
+  level.data =
+      HiresTexture::ImageDataPointer(new u8[data_size], [](u8* data) { delete[] data; });
+  level.format = format;
+  level.width = width;
+  level.height = height;
+  level.row_length = row_length;
+  level.data_size = data_size;
+  for (size_t i = 0; i < data_size; ++i)
+    level.data.get()[i] = compressible ? static_cast<u8>(i / 64) : static_cast<u8>(rng());
+  return level;
+}
+
+void ExpectSameLevels(const std::vector<HiresTexture::Level>& expected,
+                      const std::vector<HiresTexture::Level>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    EXPECT_EQ(expected[i].format, actual[i].format);
+    EXPECT_EQ(expected[i].width, actual[i].width);
+    EXPECT_EQ(expected[i].height, actual[i].height);
+    EXPECT_EQ(expected[i].row_length, actual[i].row_length);
+    ASSERT_EQ(expected[i].data_size, actual[i].data_size);
+    EXPECT_TRUE(std::equal(expected[i].data.get(), expected[i].data.get() + expected[i].data_size,
+                           actual[i].data.get()))
+        << "level " << i;
+  }
+}
+}  // namespace
+
+class TexturePackTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_temp_dir = File::CreateTempDir();
+    m_pack_path = m_temp_dir + "/textures.dtp";
+
+    // Compressible RGBA8 levels, with a row length larger than the width
+    m_rgba.push_back(MakeLevel(AbstractTextureFormat::RGBA8, 30, 16, 32, 32 * 16 * 4, true));
+    m_rgba.push_back(MakeLevel(AbstractTextureFormat::RGBA8, 15, 8, 16, 16 * 8 * 4, true));
+
+    // Incompressible DXT1 levels, down to a single 4x4 block for the 2x2 and 1x1 levels
+    m_dxt1.push_back(MakeLevel(AbstractTextureFormat::DXT1, 8, 8, 8, 2 * 2 * 8, false));
+    m_dxt1.push_back(MakeLevel(AbstractTextureFormat::DXT1, 4, 4, 4, 8, false));
+    m_dxt1.push_back(MakeLevel(AbstractTextureFormat::DXT1, 2, 2, 4, 8, false));
+    m_dxt1.push_back(MakeLevel(AbstractTextureFormat::DXT1, 1, 1, 4, 8, false));
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  void WritePack()
+  {
+    TexturePackWriter writer;
+    ASSERT_TRUE(writer.Open(m_pack_path));
+    ASSERT_TRUE(writer.AddTexture("tex1_30x16_0123456789abcdef_2", false, m_rgba));
+    ASSERT_TRUE(writer.AddTexture("tex1_8x8_m_fedcba9876543210_14", true, m_dxt1));
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  std::string m_temp_dir;
+  std::string m_pack_path;
+  std::vector<HiresTexture::Level> m_rgba;
+  std::vector<HiresTexture::Level> m_dxt1;
+};
+
+TEST_F(TexturePackTest, RoundTrip)
+{
+  WritePack();
+
+  std::unique_ptr<TexturePack> pack = TexturePack::Open(m_pack_path);
+  ASSERT_NE(nullptr, pack);
+  ASSERT_EQ(2u, pack->GetTextureCount());
+
+  EXPECT_EQ("tex1_30x16_0123456789abcdef_2", pack->GetTextureName(0));
+  EXPECT_FALSE(pack->HasArbitraryMipmaps(0));
+  std::vector<HiresTexture::Level> levels;
+  ASSERT_TRUE(pack->LoadLevels(0, &levels));
+  ExpectSameLevels(m_rgba, levels);
+
+  EXPECT_EQ("tex1_8x8_m_fedcba9876543210_14", pack->GetTextureName(1));
+  EXPECT_TRUE(pack->HasArbitraryMipmaps(1));
+  ASSERT_TRUE(pack->LoadLevels(1, &levels));
+  ExpectSameLevels(m_dxt1, levels);
+}
+
+TEST_F(TexturePackTest, CorruptLevelData)
+{
+  WritePack();
+
+  {
+    // Flip a byte in the middle of the first level
+    File::IOFile file(m_pack_path, "r+b");
+    ASSERT_TRUE(file.Seek(sizeof(TexturePackHeader) + 8, SEEK_SET));
+    u8 byte;
+    ASSERT_TRUE(file.ReadBytes(&byte, 1));
+    byte ^= 0xFF;
+    ASSERT_TRUE(file.Seek(-1, SEEK_CUR));
+    ASSERT_TRUE(file.WriteBytes(&byte, 1));
+  }
+
+  std::unique_ptr<TexturePack> pack = TexturePack::Open(m_pack_path);
+  ASSERT_NE(nullptr, pack);
+  std::vector<HiresTexture::Level> levels;
+  EXPECT_FALSE(pack->LoadLevels(0, &levels));
+  EXPECT_TRUE(pack->LoadLevels(1, &levels));
+}
+
+TEST_F(TexturePackTest, LevelSmallerThanDimensions)
+{
+  // A level whose stored data is one row short of what its dimensions need
+  m_rgba[1].data_size -= 16 * 4;
+  WritePack();
+  EXPECT_EQ(nullptr, TexturePack::Open(m_pack_path));
+}
+
+TEST_F(TexturePackTest, CompressedLevelSmallerThanDimensions)
+{
+  // The 1x1 level still needs a whole 4x4 block
+  m_dxt1[3].data_size = 4;
+  WritePack();
+  EXPECT_EQ(nullptr, TexturePack::Open(m_pack_path));
+}
@@ -2,11 +2,14 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>  // NOLINT
 
@@ -14,9 +17,13 @@
 #include "Common/MathUtil.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexManagerBase.h"
 
 TEST(VertexLoaderUID, UniqueEnough)
 {
@@ -62,6 +69,7 @@ protected:
   {
     m_loader = VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr);
     ASSERT_EQ((int)input_size, m_loader->m_VertexSize);
+    ASSERT_EQ((u32)input_size, m_loader->m_indexed_layout_size);
     ASSERT_EQ((int)output_size, m_loader->m_native_vtx_decl.stride);
   }
 
@@ -245,6 +253,290 @@ TEST_F(VertexLoaderTest, PositionIndex16FloatXY)
   ExpectOut(2);
 }
 
+TEST_F(VertexLoaderTest, IndexedAttributes)
+{
+  m_vtx_desc.PosMatIdx = 1;
+  m_vtx_desc.Position = INDEX16;
+  m_vtx_desc.Normal = INDEX8;
+  m_vtx_desc.Color0 = DIRECT;
+  m_vtx_desc.Tex0Coord = INDEX16;
+  m_vtx_attr.g0.PosElements = 1;  // XYZ
+  m_vtx_attr.g0.PosFormat = FORMAT_SHORT;
+  m_vtx_attr.g0.NormalElements = 1;  // NBT
+  m_vtx_attr.g0.NormalIndex3 = 1;
+  m_vtx_attr.g0.NormalFormat = FORMAT_FLOAT;
+  m_vtx_attr.g0.Color0Comp = FORMAT_24B_888;
+  m_vtx_attr.g0.Tex0CoordElements = 1;  // ST
+  m_vtx_attr.g0.Tex0CoordFormat = FORMAT_UBYTE;
+  CreateAndCheckSizes(1 + 2 + 3 + 3 + 2, 4 + 12 + 36 + 4 + 8);
+
+  const auto& attributes = m_loader->m_indexed_attributes;
+  ASSERT_EQ(3u, attributes.size());
+  EXPECT_EQ(1u, attributes[0].offset);
+  EXPECT_EQ(2u, attributes[0].index_size);
+  EXPECT_EQ((u32)ARRAY_POSITION, attributes[0].array);
+  EXPECT_EQ(3 * sizeof(s16), attributes[0].element_size);
+  EXPECT_EQ(3u, attributes[1].offset);
+  EXPECT_EQ(1u, attributes[1].index_size);
+  EXPECT_EQ(3u, attributes[1].num_indices);
+  EXPECT_EQ((u32)ARRAY_NORMAL, attributes[1].array);
+  EXPECT_EQ(9 * sizeof(float), attributes[1].element_size);
+  EXPECT_EQ(9u, attributes[2].offset);
+  EXPECT_EQ((u32)ARRAY_TEXCOORD0, attributes[2].array);
+  EXPECT_EQ(2 * sizeof(u8), attributes[2].element_size);
+}
+
+namespace
+{
+class TestNativeVertexFormat : public NativeVertexFormat
+{
+};
+
+// Keeps the loaded vertices in memory. The tests never flush a batch, since that needs a renderer.
+class TestVertexManager : public VertexManagerBase
+{
+public:
+  TestVertexManager() : m_vertices(MAXVBUFFERSIZE), m_indices(MAXIBUFFERSIZE)
+  {
+    TestVertexManager::ResetBuffer(0);
+  }
+
+  std::unique_ptr<NativeVertexFormat>
+  CreateNativeVertexFormat(const PortableVertexDeclaration& vtx_decl) override
+  {
+    return std::make_unique<TestNativeVertexFormat>();
+  }
+
+  const u8* GetCurrentPointer() const { return m_cur_buffer_pointer; }
+
+protected:
+  void ResetBuffer(u32 stride) override
+  {
+    m_cur_buffer_pointer = m_base_buffer_pointer = m_vertices.data();
+    m_end_buffer_pointer = m_cur_buffer_pointer + m_vertices.size();
+    IndexGenerator::Start(m_indices.data());
+  }
+
+private:
+  void vFlush() override {}
+
+  std::vector<u8> m_vertices;
+  std::vector<u16> m_indices;
+};
+}  // namespace
+
+// Draws through VertexLoaderManager, which keeps the converted vertices of repeated draws
+class VertexLoaderManagerTest : public VertexLoaderTest
+{
+protected:
+  static constexpr int NUM_VERTICES = 64;
+  static constexpr u32 ARRAY_OFFSET = 1024 * 1024;
+  // Position matrix index and XYZ position
+  static constexpr size_t NATIVE_STRIDE = sizeof(u32) + 3 * sizeof(float);
+
+  void SetUp() override
+  {
+    VertexLoaderTest::SetUp();
+    IndexGenerator::Init();
+    g_vertex_manager = std::make_unique<TestVertexManager>();
+    VertexLoaderManager::Clear();
+    stats.ResetFrame();
+
+    m_vtx_desc.PosMatIdx = 1;
+    m_vtx_desc.Position = INDEX16;
+    m_vtx_attr.g0.PosElements = 1;  // XYZ
+    m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+
+    VertexLoaderManager::cached_arraybases[ARRAY_POSITION] = input_memory + ARRAY_OFFSET;
+    g_main_cp_state.array_strides[ARRAY_POSITION] = 3 * sizeof(float);
+    for (int i = 0; i < NUM_VERTICES; i++)
+      SetPosition(i, static_cast<float>(i));
+  }
+
+  void TearDown() override
+  {
+    VertexLoaderManager::Clear();
+    g_vertex_manager.reset();
+  }
+
+  void SetPosition(u32 index, float value)
+  {
+    u8* position = input_memory + ARRAY_OFFSET + index * 3 * sizeof(float);
+    DataReader array(position, position + 3 * sizeof(float));
+    for (int i = 0; i < 3; i++)
+      array.Write<float, true>(value + i);
+  }
+
+  // Writes one raw vertex per index, each with a different position matrix
+  void WriteVertices(const std::vector<u32>& indices)
+  {
+    ResetPointers();
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+      Input<u8>(static_cast<u8>(i & 0x3f));
+      if (m_vtx_desc.Position == INDEX16)
+        Input<u16>(static_cast<u16>(indices[i]));
+      else
+        Input<u8>(static_cast<u8>(indices[i]));
+    }
+  }
+
+  // Draws the raw vertices as points and returns the converted ones
+  std::vector<u8> Draw(int count)
+  {
+    g_main_cp_state.vtx_desc = m_vtx_desc;
+    g_main_cp_state.vtx_attr[0] = m_vtx_attr;
+    VertexLoaderManager::MarkAllDirty();
+
+    const TestVertexManager* manager = static_cast<TestVertexManager*>(g_vertex_manager.get());
+    const u8* start = manager->GetCurrentPointer();
+    const int vertex_size = m_vtx_desc.Position == INDEX16 ? 3 : 2;
+    const int primitive = OpcodeDecoder::GX_DRAW_POINTS;
+    DataReader src(input_memory, input_memory + sizeof(input_memory));
+    EXPECT_EQ(count * vertex_size,
+              VertexLoaderManager::RunVertices(0, primitive, count, src, false));
+    return std::vector<u8>(start, manager->GetCurrentPointer());
+  }
+
+  static std::vector<u32> SequentialIndices()
+  {
+    std::vector<u32> indices(NUM_VERTICES);
+    for (u32 i = 0; i < NUM_VERTICES; i++)
+      indices[i] = i;
+    return indices;
+  }
+
+  // Returns the X coordinate of a converted vertex, which follows the position matrix index
+  float ReadPosition(const std::vector<u8>& vertices, size_t vertex) const
+  {
+    float position;
+    std::memcpy(&position, &vertices[vertex * NATIVE_STRIDE + sizeof(u32)], sizeof(float));
+    return position;
+  }
+
+  void ExpectSkippedVerticesCached(int index_type, u32 skip_index)
+  {
+    m_vtx_desc.Position = index_type;
+    std::vector<u32> indices = SequentialIndices();
+    indices[3] = skip_index;
+    indices[40] = skip_index;
+    WriteVertices(indices);
+
+    const std::vector<u8> first = Draw(NUM_VERTICES);
+    Draw(NUM_VERTICES);
+    const std::vector<u8> third = Draw(NUM_VERTICES);
+    EXPECT_EQ(1, stats.thisFrame.numVertexCacheHits);
+    EXPECT_EQ(2, stats.thisFrame.numVertexCacheMisses);
+    EXPECT_EQ((NUM_VERTICES - 2) * NATIVE_STRIDE, first.size());
+    EXPECT_EQ(first, third);
+  }
+};
+
+TEST_F(VertexLoaderManagerTest, CacheHitAfterTwoIdenticalDraws)
+{
+  WriteVertices(SequentialIndices());
+  const std::vector<u8> first = Draw(NUM_VERTICES);
+  const std::vector<u8> second = Draw(NUM_VERTICES);
+  EXPECT_EQ(0, stats.thisFrame.numVertexCacheHits);
+  EXPECT_EQ(2, stats.thisFrame.numVertexCacheMisses);
+
+  // The second draw stored the vertices, so the third copies them
+  const std::vector<u8> third = Draw(NUM_VERTICES);
+  EXPECT_EQ(1, stats.thisFrame.numVertexCacheHits);
+  EXPECT_EQ(2, stats.thisFrame.numVertexCacheMisses);
+  ASSERT_EQ(NUM_VERTICES * NATIVE_STRIDE, first.size());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first, third);
+}
+
+TEST_F(VertexLoaderManagerTest, CacheMissAfterArrayChange)
+{
+  WriteVertices(SequentialIndices());
+  Draw(NUM_VERTICES);
+  const std::vector<u8> old_vertices = Draw(NUM_VERTICES);
+
+  SetPosition(NUM_VERTICES / 2, 1000.f);
+  const std::vector<u8> new_vertices = Draw(NUM_VERTICES);
+  EXPECT_EQ(0, stats.thisFrame.numVertexCacheHits);
+  EXPECT_EQ(3, stats.thisFrame.numVertexCacheMisses);
+  ASSERT_EQ(NUM_VERTICES * NATIVE_STRIDE, new_vertices.size());
+  EXPECT_EQ(static_cast<float>(NUM_VERTICES / 2), ReadPosition(old_vertices, NUM_VERTICES / 2));
+  EXPECT_EQ(1000.f, ReadPosition(new_vertices, NUM_VERTICES / 2));
+}
+
+TEST_F(VertexLoaderManagerTest, CacheMissAfterVertexChange)
+{
+  WriteVertices(SequentialIndices());
+  Draw(NUM_VERTICES);
+  Draw(NUM_VERTICES);
+
+  // The same number of vertices at the same place, but with other indices
+  std::vector<u32> indices = SequentialIndices();
+  std::reverse(indices.begin(), indices.end());
+  WriteVertices(indices);
+  const std::vector<u8> vertices = Draw(NUM_VERTICES);
+  EXPECT_EQ(0, stats.thisFrame.numVertexCacheHits);
+  EXPECT_EQ(3, stats.thisFrame.numVertexCacheMisses);
+  ASSERT_EQ(NUM_VERTICES * NATIVE_STRIDE, vertices.size());
+  EXPECT_EQ(static_cast<float>(NUM_VERTICES - 1), ReadPosition(vertices, 0));
+}
+
+TEST_F(VertexLoaderManagerTest, CacheWaitsLongerAfterChange)
+{
+  WriteVertices(SequentialIndices());
+  Draw(NUM_VERTICES);
+  Draw(NUM_VERTICES);
+
+  // Vertices at a place where they have changed before are kept on their third draw, not the second
+  SetPosition(0, 1000.f);
+  for (int i = 0; i < 3; i++)
+    Draw(NUM_VERTICES);
+  EXPECT_EQ(0, stats.thisFrame.numVertexCacheHits);
+  EXPECT_EQ(5, stats.thisFrame.numVertexCacheMisses);
+  const std::vector<u8> vertices = Draw(NUM_VERTICES);
+  EXPECT_EQ(1, stats.thisFrame.numVertexCacheHits);
+  ASSERT_EQ(NUM_VERTICES * NATIVE_STRIDE, vertices.size());
+  EXPECT_EQ(1000.f, ReadPosition(vertices, 0));
+}
+
+// Vertices with a position index of all ones are skipped. The hashed array range mustn't include
+// that index, with 16 bit indices it would be too large to be cached.
+TEST_F(VertexLoaderManagerTest, CacheSkippedIndex8)
+{
+  ExpectSkippedVerticesCached(INDEX8, 0xFF);
+}
+
+TEST_F(VertexLoaderManagerTest, CacheSkippedIndex16)
+{
+  ExpectSkippedVerticesCached(INDEX16, 0xFFFF);
+}
+
+TEST_F(VertexLoaderManagerTest, CacheRestoresZFreezeState)
+{
+  WriteVertices(SequentialIndices());
+  Draw(NUM_VERTICES);
+  Draw(NUM_VERTICES);
+
+  float position_cache[3][4];
+  u32 position_matrix_index[4];
+  std::memcpy(position_cache, VertexLoaderManager::position_cache, sizeof(position_cache));
+  std::memcpy(position_matrix_index, VertexLoaderManager::position_matrix_index,
+              sizeof(position_matrix_index));
+
+  // A smaller draw of other vertices changes the state, which the cache hit has to put back
+  WriteVertices({1, 2, 3});
+  Draw(3);
+  EXPECT_NE(0, std::memcmp(position_cache, VertexLoaderManager::position_cache,
+                           sizeof(position_cache)));
+  WriteVertices(SequentialIndices());
+  Draw(NUM_VERTICES);
+  EXPECT_EQ(1, stats.thisFrame.numVertexCacheHits);
+  EXPECT_EQ(0, std::memcmp(position_cache, VertexLoaderManager::position_cache,
+                           sizeof(position_cache)));
+  EXPECT_EQ(0, std::memcmp(position_matrix_index, VertexLoaderManager::position_matrix_index,
+                           sizeof(position_matrix_index)));
+}
+
 class VertexLoaderSpeedTest : public VertexLoaderTest,
                               public ::testing::WithParamInterface<std::tuple<int, int>>
 {